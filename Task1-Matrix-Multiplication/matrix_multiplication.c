@@ -6,7 +6,7 @@
  *   Divides large matrices into sub-blocks for better cache locality.
  *   Each thread multiplies block pairs and accumulates results.
  * 
- * Compilation: gcc -fopenmp -o matrix_multiplication.exe matrix_multiplication.c -lm
+ * Compilation: make task1  (links libdatapatterns: ../kernels, ../common)
  * Usage: ./matrix_multiplication.exe [matrix_size] [block_size]
  * 
  * Author: High Performance Computing Course
@@ -17,38 +17,45 @@
 #include <stdlib.h>
 #include <omp.h>
 #include <math.h>
-#include <string.h>
+#include "gemm.h"
+#include "numa_alloc.h"
+#include "arena.h"
+#include "rng.h"
+#include "bench.h"
+#include "array_utils.h"
 
 #define DEFAULT_SIZE 512
 #define DEFAULT_BLOCK_SIZE 64
 
 // Function prototypes
-void initialize_matrix(double *matrix, int N, int seed);
-void sequential_multiply(double *A, double *B, double *C, int N);
-void parallel_multiply_blocked(double *A, double *B, double *C, int N, int block_size);
-void print_matrix(double *matrix, int N, int max_print);
-int verify_results(double *C1, double *C2, int N);
+void initialize_matrix(double *matrix, index_t N, int seed);
 
 int main(int argc, char *argv[]) {
-    int N = DEFAULT_SIZE;
+    index_t N = DEFAULT_SIZE;
     int block_size = DEFAULT_BLOCK_SIZE;
+    MemoryPlacement placement = placement_from_env();
     
-    if (argc > 1) N = atoi(argv[1]);
+    if (argc > 1 && !parse_index_arg(argv[1], "matrix size", &N)) return 1;
     if (argc > 2) block_size = atoi(argv[2]);
+    if (!check_index_count((double)N * N, "matrix")) return 1;
     
     printf("==============================================\n");
     printf("  PARALLEL MATRIX MULTIPLICATION (BLOCKED)   \n");
     printf("==============================================\n");
-    printf("Matrix Size: %d x %d\n", N, N);
+    printf("Matrix Size: %ld x %ld (%s)\n", (long)N, (long)N, INDEX_MODE);
     printf("Block Size: %d x %d\n", block_size, block_size);
     printf("Number of threads: %d\n", omp_get_max_threads());
+    printf("Memory placement: %s\n", placement_name(placement));
     printf("==============================================\n\n");
     
-    // Allocate matrices
-    double *A = (double *)malloc(N * N * sizeof(double));
-    double *B = (double *)malloc(N * N * sizeof(double));
-    double *C_seq = (double *)malloc(N * N * sizeof(double));
-    double *C_par = (double *)malloc(N * N * sizeof(double));
+    // Allocate matrices from the shared arena (ARENA_PAGES / ARENA_POPULATE)
+    Arena *arena = arena_shared();
+    long setup_faults = process_page_faults();
+    double setup_start = omp_get_wtime();
+    double *A = (double *)arena_alloc_placed(arena, (size_t)N * N, sizeof(double), placement);
+    double *B = (double *)arena_alloc_placed(arena, (size_t)N * N, sizeof(double), placement);
+    double *C_seq = (double *)arena_alloc_placed(arena, (size_t)N * N, sizeof(double), placement);
+    double *C_par = (double *)arena_alloc_placed(arena, (size_t)N * N, sizeof(double), placement);
     
     if (!A || !B || !C_seq || !C_par) {
         fprintf(stderr, "Memory allocation failed!\n");
@@ -59,34 +66,45 @@ int main(int argc, char *argv[]) {
     printf("Initializing matrices...\n");
     initialize_matrix(A, N, 42);
     initialize_matrix(B, N, 123);
+    printf("Setup: %.3f s, %ld page faults (allocation + initialization)\n",
+           omp_get_wtime() - setup_start, process_page_faults() - setup_faults);
+    arena_print_stats(arena, "shared");
     
     // Print small sample (if small matrix)
     if (N <= 8) {
         printf("\nMatrix A:\n");
-        print_matrix(A, N, N);
+        print_matrix(A, N, N, N);
         printf("\nMatrix B:\n");
-        print_matrix(B, N, N);
+        print_matrix(B, N, N, N);
     }
     
     // Sequential multiplication
+    // Work per run: 2N^3 FLOPs, compulsory traffic A + B + C
+    double flops = 2.0 * N * N * N;
+    double bytes = 3.0 * N * N * sizeof(double);
+    char context[64];
+    snprintf(context, sizeof(context), "block_size=%d", block_size);
+    bench_set_context(context);
+    
     printf("\n[1] Running SEQUENTIAL multiplication...\n");
-    double start_seq = omp_get_wtime();
-    sequential_multiply(A, B, C_seq, N);
-    double end_seq = omp_get_wtime();
-    double time_seq = end_seq - start_seq;
-    printf("    Time: %.6f seconds\n", time_seq);
+    Benchmark b_seq = bench_begin("matrix_multiplication", "sequential", N, flops, bytes);
+    while (bench_next(&b_seq)) {
+        sequential_multiply(A, B, C_seq, N);
+    }
+    double time_seq = bench_end(&b_seq).median;
     
     // Parallel blocked multiplication
     printf("\n[2] Running PARALLEL BLOCKED multiplication...\n");
-    double start_par = omp_get_wtime();
-    parallel_multiply_blocked(A, B, C_par, N, block_size);
-    double end_par = omp_get_wtime();
-    double time_par = end_par - start_par;
-    printf("    Time: %.6f seconds\n", time_par);
+    printf("    Using %d threads for blocked multiplication\n", omp_get_max_threads());
+    Benchmark b_par = bench_begin("matrix_multiplication", "parallel_blocked", N, flops, bytes);
+    while (bench_next(&b_par)) {
+        parallel_multiply_blocked(A, B, C_par, N, block_size);
+    }
+    double time_par = bench_end(&b_par).median;
     
     // Verify results
     printf("\n[3] Verifying results...\n");
-    int correct = verify_results(C_seq, C_par, N);
+    int correct = verify_results(C_seq, C_par, (long)N * N, 1e-6);
     if (correct) {
         printf("    ✓ Results match! Correctness verified.\n");
     } else {
@@ -96,151 +114,30 @@ int main(int argc, char *argv[]) {
     // Print results if small matrix
     if (N <= 8) {
         printf("\nResult Matrix C:\n");
-        print_matrix(C_par, N, N);
+        print_matrix(C_par, N, N, N);
     }
     
     // Performance summary
     printf("\n==============================================\n");
     printf("  PERFORMANCE SUMMARY\n");
     printf("==============================================\n");
-    printf("Sequential time:   %.6f seconds\n", time_seq);
-    printf("Parallel time:     %.6f seconds\n", time_par);
+    printf("Sequential time:   %.6f seconds (median)\n", time_seq);
+    printf("Parallel time:     %.6f seconds (median)\n", time_par);
     printf("Speedup:           %.2fx\n", time_seq / time_par);
     printf("Efficiency:        %.1f%%\n", (time_seq / time_par) / omp_get_max_threads() * 100);
     printf("==============================================\n");
     
     // Cleanup
-    free(A);
-    free(B);
-    free(C_seq);
-    free(C_par);
+    arena_free(arena, A);
+    arena_free(arena, B);
+    arena_free(arena, C_seq);
+    arena_free(arena, C_par);
     
     return 0;
 }
 
-// Initialize matrix with pseudo-random values
-void initialize_matrix(double *matrix, int N, int seed) {
-    srand(seed);
-    for (int i = 0; i < N * N; i++) {
-        matrix[i] = (double)(rand() % 10);
-    }
-}
-
-// Sequential matrix multiplication
-void sequential_multiply(double *A, double *B, double *C, int N) {
-    // Initialize result matrix to zero
-    memset(C, 0, N * N * sizeof(double));
-    
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            double sum = 0.0;
-            for (int k = 0; k < N; k++) {
-                sum += A[i * N + k] * B[k * N + j];
-            }
-            C[i * N + j] = sum;
-        }
-    }
-}
-
-// Parallel blocked matrix multiplication
-void parallel_multiply_blocked(double *A, double *B, double *C, int N, int block_size) {
-    // Initialize result matrix to zero
-    memset(C, 0, N * N * sizeof(double));
-    
-    /*
-     * CRITICAL OPTIMIZATION: Proper work partitioning without synchronization
-     * 
-     * BAD APPROACH (causes 65K+ atomic operations):
-     *   - Parallelize over (bi, bj, bk) with collapse(3)
-     *   - Use atomic to accumulate: C[i][j] += partial_sum
-     *   - Result: Massive contention, 30x SLOWER than sequential
-     * 
-     * CORRECT APPROACH (this implementation):
-     *   - Parallelize ONLY over output blocks (bi, bj)
-     *   - Each thread computes COMPLETE result for its assigned elements
-     *   - The k-loop runs sequentially inside each thread
-     *   - NO atomic operations needed - each thread owns its output elements
-     *   - Result: 8-12x speedup
-     */
-    #pragma omp parallel
-    {
-        int thread_id = omp_get_thread_num();
-        int num_threads = omp_get_num_threads();
-        
-        #pragma omp single
-        {
-            printf("    Using %d threads for blocked multiplication\n", num_threads);
-        }
-        
-        // Parallelize over OUTPUT blocks only (bi, bj)
-        // Each thread gets exclusive ownership of output elements
-        #pragma omp for collapse(2) schedule(dynamic)
-        for (int bi = 0; bi < N; bi += block_size) {
-            for (int bj = 0; bj < N; bj += block_size) {
-                // Compute block boundaries
-                int i_end = (bi + block_size < N) ? bi + block_size : N;
-                int j_end = (bj + block_size < N) ? bj + block_size : N;
-                
-                // For each element in this output block
-                for (int i = bi; i < i_end; i++) {
-                    for (int j = bj; j < j_end; j++) {
-                        double sum = 0.0;
-                        
-                        // SEQUENTIAL k-loop: Compute complete dot product
-                        // This is NOT parallelized - runs inside each thread
-                        for (int bk = 0; bk < N; bk += block_size) {
-                            int k_end = (bk + block_size < N) ? bk + block_size : N;
-                            
-                            // Inner product computation
-                            for (int k = bk; k < k_end; k++) {
-                                sum += A[i * N + k] * B[k * N + j];
-                            }
-                        }
-                        
-                        // Write final result - NO synchronization needed
-                        // This thread exclusively owns C[i][j]
-                        C[i * N + j] = sum;
-                    }
-                }
-            }
-        }
-    }
-}
-
-// Print matrix (up to max_print x max_print)
-void print_matrix(double *matrix, int N, int max_print) {
-    int limit = (N < max_print) ? N : max_print;
-    for (int i = 0; i < limit; i++) {
-        for (int j = 0; j < limit; j++) {
-            printf("%6.1f ", matrix[i * N + j]);
-        }
-        if (limit < N) printf("...");
-        printf("\n");
-    }
-    if (limit < N) {
-        printf("...\n");
-    }
-}
-
-// Verify that two matrices are equal (within tolerance)
-int verify_results(double *C1, double *C2, int N) {
-    double tolerance = 1e-6;
-    int errors = 0;
-    
-    for (int i = 0; i < N * N; i++) {
-        if (fabs(C1[i] - C2[i]) > tolerance) {
-            errors++;
-            if (errors <= 5) {
-                printf("    Error at index %d: seq=%.6f, par=%.6f\n", 
-                       i, C1[i], C2[i]);
-            }
-        }
-    }
-    
-    if (errors > 5) {
-        printf("    ... and %d more errors\n", errors - 5);
-    }
-    
-    return (errors == 0);
+// Initialize matrix with pseudo-random integers 0-9 (in parallel, the same
+// values for any thread count)
+void initialize_matrix(double *matrix, index_t N, int seed) {
+    rng_fill_int_values(matrix, N * N, 10, (uint64_t)seed);
 }
-
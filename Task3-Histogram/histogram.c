@@ -5,7 +5,7 @@
  *   Computes a histogram of integers (0-9) from a large array.
  *   Uses data partitioning among threads with proper synchronization.
  * 
- * Compilation: gcc -fopenmp -o histogram.exe histogram.c
+ * Compilation: make task3  (links libdatapatterns: ../kernels, ../common)
  * Usage: ./histogram.exe [array_size]
  * 
  * Author: High Performance Computing Course
@@ -16,33 +16,33 @@
 #include <stdlib.h>
 #include <string.h>
 #include <omp.h>
+#include "histogram.h"
+#include "numa_alloc.h"
+#include "bench.h"
+#include "array_utils.h"
+#include "rng.h"
 
-#define NUM_BINS 10
 #define DEFAULT_SIZE 10000000  // 10 million elements
 
 // Function prototypes
-void generate_data(int *data, int size);
-void histogram_sequential(int *data, int size, int *histogram);
-void histogram_parallel_atomic(int *data, int size, int *histogram);
-void histogram_parallel_reduction(int *data, int size, int *histogram);
-void print_histogram(int *histogram, const char *title);
-int verify_histograms(int *h1, int *h2);
+void generate_data(int *data, index_t size);
+void print_histogram(index_t *histogram, const char *title);
 
 int main(int argc, char *argv[]) {
-    int size = DEFAULT_SIZE;
+    index_t size = DEFAULT_SIZE;
     
-    if (argc > 1) size = atoi(argv[1]);
+    if (argc > 1 && !parse_index_arg(argv[1], "array size", &size)) return 1;
     
     printf("==============================================\n");
     printf("    PARALLEL HISTOGRAM COMPUTATION (0-9)     \n");
     printf("==============================================\n");
-    printf("Array size: %d elements\n", size);
+    printf("Array size: %ld elements (%s)\n", (long)size, INDEX_MODE);
     printf("Number of bins: %d (0-9)\n", NUM_BINS);
     printf("Number of threads: %d\n", omp_get_max_threads());
     printf("==============================================\n\n");
     
     // Allocate data array
-    int *data = (int *)malloc(size * sizeof(int));
+    int *data = (int *)malloc_array(size, sizeof(int));
     if (!data) {
         fprintf(stderr, "Memory allocation failed!\n");
         return 1;
@@ -50,38 +50,46 @@ int main(int argc, char *argv[]) {
     
     // Generate random data
     printf("Generating random data (0-9)...\n");
+    double generate_start = omp_get_wtime();
     generate_data(data, size);
+    printf("Generated in %.3f s\n", omp_get_wtime() - generate_start);
     
     // Allocate histogram arrays
-    int histogram_seq[NUM_BINS] = {0};
-    int histogram_atomic[NUM_BINS] = {0};
-    int histogram_reduction[NUM_BINS] = {0};
+    index_t histogram_seq[NUM_BINS] = {0};
+    index_t histogram_atomic[NUM_BINS] = {0};
+    index_t histogram_reduction[NUM_BINS] = {0};
+    
+    // Every run streams the input once (bins stay in cache)
+    double bytes = (double)size * sizeof(int);
     
     // Sequential histogram
     printf("\n[1] Running SEQUENTIAL histogram...\n");
-    double start_seq = omp_get_wtime();
-    histogram_sequential(data, size, histogram_seq);
-    double end_seq = omp_get_wtime();
-    double time_seq = end_seq - start_seq;
-    printf("    Time: %.6f seconds\n", time_seq);
+    Benchmark b_seq = bench_begin("histogram", "sequential", size, 0.0, bytes);
+    while (bench_next(&b_seq)) {
+        histogram_sequential(data, size, histogram_seq);
+    }
+    double time_seq = bench_end(&b_seq).median;
     print_histogram(histogram_seq, "Sequential Histogram");
     
     // Parallel histogram with atomic operations
     printf("\n[2] Running PARALLEL histogram (ATOMIC)...\n");
-    double start_atomic = omp_get_wtime();
-    histogram_parallel_atomic(data, size, histogram_atomic);
-    double end_atomic = omp_get_wtime();
-    double time_atomic = end_atomic - start_atomic;
-    printf("    Time: %.6f seconds\n", time_atomic);
+    printf("    Using %d threads with atomic operations\n", omp_get_max_threads());
+    printf("    WARNING: Atomic version is demonstrably SLOW due to contention\n");
+    Benchmark b_atomic = bench_begin("histogram", "parallel_atomic", size, 0.0, bytes);
+    while (bench_next(&b_atomic)) {
+        histogram_parallel_atomic(data, size, histogram_atomic);
+    }
+    double time_atomic = bench_end(&b_atomic).median;
     print_histogram(histogram_atomic, "Parallel Histogram (Atomic)");
     
     // Parallel histogram with reduction
     printf("\n[3] Running PARALLEL histogram (REDUCTION)...\n");
-    double start_reduction = omp_get_wtime();
-    histogram_parallel_reduction(data, size, histogram_reduction);
-    double end_reduction = omp_get_wtime();
-    double time_reduction = end_reduction - start_reduction;
-    printf("    Time: %.6f seconds\n", time_reduction);
+    printf("    Using %d threads with local histogram reduction\n", omp_get_max_threads());
+    Benchmark b_reduction = bench_begin("histogram", "parallel_reduction", size, 0.0, bytes);
+    while (bench_next(&b_reduction)) {
+        histogram_parallel_reduction(data, size, histogram_reduction);
+    }
+    double time_reduction = bench_end(&b_reduction).median;
     print_histogram(histogram_reduction, "Parallel Histogram (Reduction)");
     
     // Verify results
@@ -99,7 +107,7 @@ int main(int argc, char *argv[]) {
     printf("\n==============================================\n");
     printf("  PERFORMANCE SUMMARY\n");
     printf("==============================================\n");
-    printf("Sequential time:      %.6f seconds\n", time_seq);
+    printf("Sequential time:      %.6f seconds (median)\n", time_seq);
     printf("Parallel (atomic):    %.6f seconds (%.2fx speedup, %.1f%% efficiency)\n", 
            time_atomic, time_seq / time_atomic, 
            (time_seq / time_atomic) / omp_get_max_threads() * 100);
@@ -121,109 +129,29 @@ int main(int argc, char *argv[]) {
     return 0;
 }
 
-// Generate random data in range [0, 9]
-void generate_data(int *data, int size) {
-    srand(42);  // Fixed seed for reproducibility
-    for (int i = 0; i < size; i++) {
-        data[i] = rand() % NUM_BINS;
-    }
-}
-
-// Sequential histogram computation
-void histogram_sequential(int *data, int size, int *histogram) {
-    // Initialize histogram to zero
-    memset(histogram, 0, NUM_BINS * sizeof(int));
-    
-    // Count occurrences
-    for (int i = 0; i < size; i++) {
-        histogram[data[i]]++;
-    }
-}
-
-// Parallel histogram with atomic operations
-// WARNING: This implementation is SLOW due to excessive contention
-// Atomic operations on every element cause cache line bouncing and serialization
-// Expected performance: 100-1000x SLOWER than sequential for high contention
-// Use histogram_parallel_reduction() for good performance
-void histogram_parallel_atomic(int *data, int size, int *histogram) {
-    // Initialize histogram to zero
-    memset(histogram, 0, NUM_BINS * sizeof(int));
-    
-    #pragma omp parallel
-    {
-        #pragma omp single
-        {
-            printf("    Using %d threads with atomic operations\n", omp_get_num_threads());
-            printf("    WARNING: Atomic version is demonstrably SLOW due to contention\n");
-        }
-        
-        // Each thread processes its portion of data
-        // PERFORMANCE ISSUE: Atomic on every iteration causes massive contention
-        // With only 10 bins, all threads constantly compete for the same memory locations
-        #pragma omp for
-        for (int i = 0; i < size; i++) {
-            // Atomic increment to avoid race conditions
-            // This serializes execution when multiple threads access same bin
-            #pragma omp atomic
-            histogram[data[i]]++;
-        }
-    }
-}
-
-// Parallel histogram with local histograms and reduction
-// CORRECT APPROACH: Each thread builds private histogram, then combines at end
-// This minimizes synchronization overhead - only 10 bins need to be merged
-void histogram_parallel_reduction(int *data, int size, int *histogram) {
-    // Initialize global histogram to zero
-    memset(histogram, 0, NUM_BINS * sizeof(int));
-    
-    #pragma omp parallel
-    {
-        // Each thread has its own local histogram - NO CONTENTION during counting
-        int local_hist[NUM_BINS] = {0};
-        
-        #pragma omp single
-        {
-            printf("    Using %d threads with local histogram reduction\n", omp_get_num_threads());
-        }
-        
-        // Phase 1: Each thread computes its local histogram independently
-        // NO synchronization needed - each thread works on private data
-        #pragma omp for nowait
-        for (int i = 0; i < size; i++) {
-            local_hist[data[i]]++;  // Fast - no atomic, no contention
-        }
-        
-        // Phase 2: Combine local histograms into global histogram
-        // Only NUM_BINS operations per thread (very few compared to data size)
-        // Using critical section for the entire reduction is more efficient than
-        // atomic on each bin since we're updating multiple related values
-        #pragma omp critical
-        {
-            for (int bin = 0; bin < NUM_BINS; bin++) {
-                histogram[bin] += local_hist[bin];
-            }
-        }
-    }
+// Generate random data in range [0, 9] (parallel; fixed seed, so the same
+// data for any thread count)
+void generate_data(int *data, index_t size) {
+    rng_fill_ints(data, size, NUM_BINS, 42);
 }
 
 // Print histogram in a nice format
-void print_histogram(int *histogram, const char *title) {
+void print_histogram(index_t *histogram, const char *title) {
     printf("\n    %s:\n", title);
     printf("    --------------------------------\n");
     
     // Find max count for scaling
-    int max_count = 0;
+    index_t max_count = 0;
     for (int i = 0; i < NUM_BINS; i++) {
         if (histogram[i] > max_count) max_count = histogram[i];
     }
     
     // Print bars
     for (int i = 0; i < NUM_BINS; i++) {
-        int bar_length = (histogram[i] * 50) / max_count;
+        int bar_length = (int)((double)histogram[i] * 50 / max_count);
         if (bar_length == 0 && histogram[i] > 0) bar_length = 1;
         
-        printf("    %d: %10d |", i, histogram[i]);
+        printf("    %d: %10ld |", i, (long)histogram[i]);
         for (int j = 0; j < bar_length; j++) {
             printf("█");
         }
@@ -232,22 +160,9 @@ void print_histogram(int *histogram, const char *title) {
     printf("    --------------------------------\n");
     
     // Print statistics
-    int total = 0;
+    index_t total = 0;
     for (int i = 0; i < NUM_BINS; i++) {
         total += histogram[i];
     }
-    printf("    Total: %d elements\n", total);
+    printf("    Total: %ld elements\n", (long)total);
 }
-
-// Verify that two histograms are equal
-int verify_histograms(int *h1, int *h2) {
-    int errors = 0;
-    for (int i = 0; i < NUM_BINS; i++) {
-        if (h1[i] != h2[i]) {
-            printf("    Error in bin %d: h1=%d, h2=%d\n", i, h1[i], h2[i]);
-            errors++;
-        }
-    }
-    return (errors == 0);
-}
-
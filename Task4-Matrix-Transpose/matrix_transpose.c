@@ -4,9 +4,11 @@
  * Description:
  *   Implements parallel matrix transpose using block-based decomposition.
  *   Divides the matrix into smaller sub-blocks for cache efficiency.
+ *   Also provides a batched transpose over a stack of matrices and a
+ *   general axis permutation for 3D/4D tensors (e.g. NCHW <-> NHWC).
  * 
- * Compilation: gcc -fopenmp -o matrix_transpose.exe matrix_transpose.c -lm
- * Usage: ./matrix_transpose.exe [matrix_size] [block_size]
+ * Compilation: make task4  (links libdatapatterns: ../kernels, ../common)
+ * Usage: ./matrix_transpose.exe [matrix_size] [block_size] [N C H W]
  * 
  * Author: High Performance Computing Course
  * Date: November 2025
@@ -17,40 +19,55 @@
 #include <string.h>
 #include <omp.h>
 #include <math.h>
+#include "transpose.h"
+#include "numa_alloc.h"
+#include "bench.h"
+#include "array_utils.h"
 
 // Note: Transpose is memory-bound. For good speedup, use large matrices
 // Small matrices have parallel overhead > computation time
 #define DEFAULT_SIZE 4096       // Increased from 2048 for better parallelization
 #define DEFAULT_BLOCK_SIZE 64
 
+// Default tensor shape for the layout conversion benchmark (NCHW)
+#define DEFAULT_TENSOR_N 16
+#define DEFAULT_TENSOR_C 64
+#define DEFAULT_TENSOR_H 56
+#define DEFAULT_TENSOR_W 56
+
 // Function prototypes
-void initialize_matrix(double *matrix, int rows, int cols, int seed);
-void transpose_sequential(double *A, double *B, int N);
-void transpose_parallel_naive(double *A, double *B, int N);
-void transpose_parallel_blocked(double *A, double *B, int N, int block_size);
-void print_matrix(double *matrix, int rows, int cols, int max_print);
-int verify_transpose(double *A, double *B, int N);
+void initialize_matrix(double *matrix, index_t rows, index_t cols, int seed);
+void benchmark_permutations(const int *shape, int block_size);
 
 int main(int argc, char *argv[]) {
-    int N = DEFAULT_SIZE;
+    index_t N = DEFAULT_SIZE;
     int block_size = DEFAULT_BLOCK_SIZE;
+    MemoryPlacement placement = placement_from_env();
     
-    if (argc > 1) N = atoi(argv[1]);
+    if (argc > 1 && !parse_index_arg(argv[1], "matrix size", &N)) return 1;
     if (argc > 2) block_size = atoi(argv[2]);
+    if (!check_index_count((double)N * N, "matrix")) return 1;
+    
+    int tensor_shape[MAX_TENSOR_DIMS] = {DEFAULT_TENSOR_N, DEFAULT_TENSOR_C,
+                                         DEFAULT_TENSOR_H, DEFAULT_TENSOR_W};
+    for (int d = 0; d < MAX_TENSOR_DIMS && argc > 3 + d; d++) {
+        tensor_shape[d] = atoi(argv[3 + d]);
+    }
     
     printf("==============================================\n");
     printf("    PARALLEL MATRIX TRANSPOSE (BLOCKED)      \n");
     printf("==============================================\n");
-    printf("Matrix Size: %d x %d\n", N, N);
+    printf("Matrix Size: %ld x %ld (%s)\n", (long)N, (long)N, INDEX_MODE);
     printf("Block Size: %d x %d\n", block_size, block_size);
     printf("Number of threads: %d\n", omp_get_max_threads());
+    printf("Memory placement: %s\n", placement_name(placement));
     printf("==============================================\n\n");
     
     // Allocate matrices
-    double *A = (double *)malloc(N * N * sizeof(double));
-    double *B_seq = (double *)malloc(N * N * sizeof(double));
-    double *B_naive = (double *)malloc(N * N * sizeof(double));
-    double *B_blocked = (double *)malloc(N * N * sizeof(double));
+    double *A = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    double *B_seq = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    double *B_naive = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    double *B_blocked = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
     
     if (!A || !B_seq || !B_naive || !B_blocked) {
         fprintf(stderr, "Memory allocation failed!\n");
@@ -67,29 +84,38 @@ int main(int argc, char *argv[]) {
         print_matrix(A, N, N, N);
     }
     
+    // Every element is read once and written once
+    double bytes = 2.0 * N * N * sizeof(double);
+    char context[64];
+    snprintf(context, sizeof(context), "block_size=%d", block_size);
+    bench_set_context(context);
+    
     // Sequential transpose
     printf("\n[1] Running SEQUENTIAL transpose...\n");
-    double start_seq = omp_get_wtime();
-    transpose_sequential(A, B_seq, N);
-    double end_seq = omp_get_wtime();
-    double time_seq = end_seq - start_seq;
-    printf("    Time: %.6f seconds\n", time_seq);
+    Benchmark b_seq = bench_begin("matrix_transpose", "sequential", N, 0.0, bytes);
+    while (bench_next(&b_seq)) {
+        transpose_sequential(A, B_seq, N);
+    }
+    double time_seq = bench_end(&b_seq).median;
     
     // Parallel naive transpose
     printf("\n[2] Running PARALLEL NAIVE transpose...\n");
-    double start_naive = omp_get_wtime();
-    transpose_parallel_naive(A, B_naive, N);
-    double end_naive = omp_get_wtime();
-    double time_naive = end_naive - start_naive;
-    printf("    Time: %.6f seconds\n", time_naive);
+    printf("    Using %d threads (naive approach)\n", omp_get_max_threads());
+    Benchmark b_naive = bench_begin("matrix_transpose", "parallel_naive", N, 0.0, bytes);
+    while (bench_next(&b_naive)) {
+        transpose_parallel_naive(A, B_naive, N);
+    }
+    double time_naive = bench_end(&b_naive).median;
     
     // Parallel blocked transpose
     printf("\n[3] Running PARALLEL BLOCKED transpose...\n");
-    double start_blocked = omp_get_wtime();
-    transpose_parallel_blocked(A, B_blocked, N, block_size);
-    double end_blocked = omp_get_wtime();
-    double time_blocked = end_blocked - start_blocked;
-    printf("    Time: %.6f seconds\n", time_blocked);
+    printf("    Using %d threads (blocked approach, block=%dx%d)\n",
+           omp_get_max_threads(), block_size, block_size);
+    Benchmark b_blocked = bench_begin("matrix_transpose", "parallel_blocked", N, 0.0, bytes);
+    while (bench_next(&b_blocked)) {
+        transpose_parallel_blocked(A, B_blocked, N, block_size);
+    }
+    double time_blocked = bench_end(&b_blocked).median;
     
     // Verify results
     printf("\n[4] Verifying results...\n");
@@ -112,7 +138,7 @@ int main(int argc, char *argv[]) {
     printf("\n==============================================\n");
     printf("  PERFORMANCE SUMMARY\n");
     printf("==============================================\n");
-    printf("Sequential time:      %.6f seconds\n", time_seq);
+    printf("Sequential time:      %.6f seconds (median)\n", time_seq);
     printf("Parallel (naive):     %.6f seconds (%.2fx speedup, %.1f%% eff.)\n", 
            time_naive, time_seq / time_naive,
            (time_seq / time_naive) / omp_get_max_threads() * 100);
@@ -128,131 +154,115 @@ int main(int argc, char *argv[]) {
     printf("  • Small matrices: Overhead may dominate → slower parallel\n");
     
     // Cleanup
-    free(A);
-    free(B_seq);
-    free(B_naive);
-    free(B_blocked);
+    numa_aware_free(A);
+    numa_aware_free(B_seq);
+    numa_aware_free(B_naive);
+    numa_aware_free(B_blocked);
+    
+    // Tensor layout conversions (batched transpose, NCHW <-> NHWC, ...)
+    benchmark_permutations(tensor_shape, block_size);
     
     return 0;
 }
 
 // Initialize matrix with values
-void initialize_matrix(double *matrix, int rows, int cols, int seed) {
+void initialize_matrix(double *matrix, index_t rows, index_t cols, int seed) {
     srand(seed);
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
+    for (index_t i = 0; i < rows; i++) {
+        for (index_t j = 0; j < cols; j++) {
             matrix[i * cols + j] = (double)(i * cols + j);  // Sequential values for easy verification
         }
     }
 }
 
-// Sequential matrix transpose
-void transpose_sequential(double *A, double *B, int N) {
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            B[j * N + i] = A[i * N + j];
-        }
-    }
-}
-
-// Parallel naive transpose (simple parallelization)
-void transpose_parallel_naive(double *A, double *B, int N) {
-    #pragma omp parallel
-    {
-        #pragma omp single
-        {
-            printf("    Using %d threads (naive approach)\n", omp_get_num_threads());
-        }
-        
-        #pragma omp for collapse(2)
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                B[j * N + i] = A[i * N + j];
-            }
-        }
-    }
-}
-
-// Parallel blocked transpose (cache-efficient)
-void transpose_parallel_blocked(double *A, double *B, int N, int block_size) {
-    /*
-     * CORRECT IMPLEMENTATION: No synchronization needed
-     * 
-     * Key insight: Each output element B[j][i] is written exactly once
-     * by the thread that processes block (bi, bj) containing that element.
-     * 
-     * No race conditions because:
-     * - Block (bi, bj) owns output elements B[bj:bj+block][bi:bi+block]
-     * - Different blocks write to disjoint memory regions
-     * - NO shared writes = NO atomic/critical sections needed
-     */
-    #pragma omp parallel
-    {
-        #pragma omp single
-        {
-            printf("    Using %d threads (blocked approach, block=%dx%d)\n", 
-                   omp_get_num_threads(), block_size, block_size);
-        }
-        
-        // Parallelize over blocks - each block is independent
-        // Dynamic scheduling handles edge blocks and load imbalances better
-        #pragma omp for collapse(2) schedule(dynamic)
-        for (int bi = 0; bi < N; bi += block_size) {
-            for (int bj = 0; bj < N; bj += block_size) {
-                // Compute block boundaries
-                int i_end = (bi + block_size < N) ? bi + block_size : N;
-                int j_end = (bj + block_size < N) ? bj + block_size : N;
-                
-                // Transpose this block
-                // Each B[j*N+i] is written exactly once - no conflicts
-                for (int i = bi; i < i_end; i++) {
-                    for (int j = bj; j < j_end; j++) {
-                        B[j * N + i] = A[i * N + j];
-                    }
-                }
-            }
-        }
-    }
-}
-
-// Print matrix
-void print_matrix(double *matrix, int rows, int cols, int max_print) {
-    int row_limit = (rows < max_print) ? rows : max_print;
-    int col_limit = (cols < max_print) ? cols : max_print;
+// Throughput benchmark for common layout conversions of an NCHW tensor
+void benchmark_permutations(const int *shape, int block_size) {
+    typedef struct {
+        const char *name;
+        const char *kernel;   // Benchmark record name
+        int ndim;
+        int dims[MAX_TENSOR_DIMS];
+        int perm[MAX_TENSOR_DIMS];
+    } PermuteCase;
     
-    for (int i = 0; i < row_limit; i++) {
-        for (int j = 0; j < col_limit; j++) {
-            printf("%6.0f ", matrix[i * cols + j]);
-        }
-        if (col_limit < cols) printf("...");
-        printf("\n");
+    int n = shape[0], c = shape[1], h = shape[2], w = shape[3];
+    PermuteCase cases[] = {
+        {"NCHW -> NHWC",          "permute_nchw_nhwc",   4, {n, c, h, w}, {0, 2, 3, 1}},
+        {"NHWC -> NCHW",          "permute_nhwc_nchw",   4, {n, h, w, c}, {0, 3, 1, 2}},
+        {"NCHW -> CNHW",          "permute_nchw_cnhw",   4, {n, c, h, w}, {1, 0, 2, 3}},
+        {"CHW -> HWC (3D)",       "permute_chw_hwc",     3, {c, h, w},    {1, 2, 0}},
+        {"Batched HxW transpose", "transpose_batched",   4, {n, c, h, w}, {0, 1, 3, 2}},
+    };
+    int num_cases = sizeof(cases) / sizeof(cases[0]);
+    long elems = (long)n * c * h * w;
+    MemoryPlacement placement = placement_from_env();
+    
+    printf("\n==============================================\n");
+    printf("  TENSOR LAYOUT CONVERSIONS (PERMUTE)\n");
+    printf("==============================================\n");
+    printf("Tensor shape: %d x %d x %d x %d (%.2f MB)\n",
+           n, c, h, w, elems * sizeof(double) / (1024.0 * 1024.0));
+    printf("Tile size: %d x %d, threads: %d\n",
+           block_size, block_size, omp_get_max_threads());
+    printf("==============================================\n");
+    
+    double *T = (double *)numa_aware_alloc_array(elems, sizeof(double), placement);
+    double *R_seq = (double *)numa_aware_alloc_array(elems, sizeof(double), placement);
+    double *R_par = (double *)numa_aware_alloc_array(elems, sizeof(double), placement);
+    
+    if (!T || !R_seq || !R_par) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        numa_aware_free(T);
+        numa_aware_free(R_seq);
+        numa_aware_free(R_par);
+        return;
     }
-    if (row_limit < rows) {
-        printf("...\n");
+    
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < elems; i++) {
+        T[i] = (double)i;  // Sequential values for easy verification
     }
-}
-
-// Verify transpose: B[j][i] should equal A[i][j]
-int verify_transpose(double *A, double *B, int N) {
-    int errors = 0;
-    double tolerance = 1e-9;
     
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            if (fabs(B[j * N + i] - A[i * N + j]) > tolerance) {
-                errors++;
-                if (errors <= 5) {
-                    printf("    Error at (%d,%d): A[%d][%d]=%.2f, B[%d][%d]=%.2f\n",
-                           i, j, i, j, A[i * N + j], j, i, B[j * N + i]);
-                }
+    char context[96];
+    snprintf(context, sizeof(context), "shape=%dx%dx%dx%d block_size=%d", n, c, h, w, block_size);
+    bench_set_context(context);
+    
+    for (int t = 0; t < num_cases; t++) {
+        PermuteCase *pc = &cases[t];
+        int batched = (t == num_cases - 1);
+        long case_elems = 1;
+        for (int k = 0; k < pc->ndim; k++) case_elems *= pc->dims[k];
+        
+        printf("\n[%d] %s  perm=(", 5 + t, pc->name);
+        for (int k = 0; k < pc->ndim; k++) {
+            printf("%d%s", pc->perm[k], (k < pc->ndim - 1) ? "," : ")\n");
+        }
+        
+        double start_seq = omp_get_wtime();
+        permute_sequential(T, R_seq, pc->dims, pc->perm, pc->ndim);
+        double time_seq = omp_get_wtime() - start_seq;
+        
+        // Every element is read once and written once
+        double bytes = 2.0 * case_elems * sizeof(double);
+        printf("    Sequential: %.6f s (%.2f GB/s)\n", time_seq, bytes / 1e9 / time_seq);
+        
+        Benchmark b = bench_begin("matrix_transpose", pc->kernel, case_elems, 0.0, bytes);
+        while (bench_next(&b)) {
+            if (batched) {
+                transpose_batched(T, R_par, n * c, h, w, block_size);
+            } else {
+                permute_parallel_blocked(T, R_par, pc->dims, pc->perm, pc->ndim, block_size);
             }
         }
+        double time_par = bench_end(&b).median;
+        
+        int correct = (memcmp(R_seq, R_par, case_elems * sizeof(double)) == 0);
+        printf("    Parallel speedup: %.2fx %s\n", time_seq / time_par,
+               correct ? "✓" : "✗ MISMATCH");
     }
+    printf("==============================================\n");
     
-    if (errors > 5) {
-        printf("    ... and %d more errors\n", errors - 5);
-    }
-    
-    return (errors == 0);
+    numa_aware_free(T);
+    numa_aware_free(R_seq);
+    numa_aware_free(R_par);
 }
-
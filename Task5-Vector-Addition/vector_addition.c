@@ -4,8 +4,17 @@
  * Description:
  *   Implements parallel addition of two large vectors.
  *   Partitions elements evenly among threads using OpenMP.
+ *   Also provides fused vector kernels (AXPY, triad, scale-add, multiply-add
+ *   chains) that evaluate a whole chain of operations in one memory pass,
+ *   and an explicit AVX2/AVX-512 path with non-temporal stores and tuned
+ *   software prefetching (VECTOR_ISA=scalar|avx2|avx512 to compare).
  * 
- * Compilation: gcc -fopenmp -o vector_addition.exe vector_addition.c
+ *   Vectors come from the shared arena (ARENA_PAGES=4k|thp|2m|1g,
+ *   ARENA_POPULATE=1, see arena.h) with a NUMA placement policy; set
+ *   NUMA_PLACEMENT=first-touch|interleave and OMP_PROC_BIND/OMP_PLACES to
+ *   keep each thread's static chunk on its own socket.
+ * 
+ * Compilation: make task5  (links libdatapatterns: ../kernels, ../common)
  * Usage: ./vector_addition.exe [vector_size]
  * 
  * Author: High Performance Computing Course
@@ -14,8 +23,14 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <omp.h>
 #include <math.h>
+#include "vector_ops.h"
+#include "numa_alloc.h"
+#include "arena.h"
+#include "bench.h"
+#include "array_utils.h"
 
 // Vector addition is MEMORY-BOUND, not CPU-bound
 // Performance limited by memory bandwidth, not computation
@@ -23,33 +38,60 @@
 // For testing: Use large vectors (100M+ elements) to amortize parallel overhead
 #define DEFAULT_SIZE 100000000  // 100 million elements
 
+// Fused chain benchmark: best of FUSION_REPETITIONS runs per chain
+#define FUSION_REPETITIONS 3
+
+// Invocation overhead sweep: repeat each size until ~OVERHEAD_WORK elements
+// have been processed so per-call times are well above timer resolution
+#define OVERHEAD_WORK 20000000L
+#define OVERHEAD_MIN_ITERATIONS 20
+
+// Scheduling strategy comparison (VECTOR_SCHEDULE=spec,... overrides the set)
+#define MAX_SCHEDULES 16
+
+// Per-call allocation comparison: vectors of at most this many elements
+#define ALLOCATION_MAX_ELEMENTS (16L << 20)
+
 // Function prototypes
-void initialize_vector(double *vec, int size, double value);
-void vector_add_sequential(double *A, double *B, double *C, int size);
-void vector_add_parallel_static(double *A, double *B, double *C, int size);
-void vector_add_parallel_dynamic(double *A, double *B, double *C, int size);
-int verify_results(double *C1, double *C2, int size);
-void print_vector_sample(double *vec, int size, const char *name);
+void initialize_vector(double *vec, index_t size, double value);
+void benchmark_fused_kernels(double *x, double *w, double *y, double *z, double *t, index_t size);
+void vector_add_node_report(double *A, double *B, double *C, index_t size);
+void benchmark_invocation_overhead(double *A, double *B, double *C, index_t max_size);
+void benchmark_simd_vector_add(double *A, double *B, double *C, double *reference, index_t size,
+                               const char *context);
+void benchmark_schedulers(double *A, double *B, double *C, double *reference, index_t size);
+void benchmark_allocation(index_t size);
 
 int main(int argc, char *argv[]) {
-    int size = DEFAULT_SIZE;
+    index_t size = DEFAULT_SIZE;
+    MemoryPlacement placement = placement_from_env();
     
-    if (argc > 1) size = atoi(argv[1]);
+    if (argc > 1 && !parse_index_arg(argv[1], "vector size", &size)) return 1;
     
     printf("==============================================\n");
     printf("     PARALLEL VECTOR ADDITION (ELEMENT)      \n");
     printf("==============================================\n");
-    printf("Vector size: %d elements\n", size);
+    printf("Vector size: %ld elements (%s)\n", (long)size, INDEX_MODE);
     printf("Memory: %.2f MB per vector\n", (size * sizeof(double)) / (1024.0 * 1024.0));
     printf("Number of threads: %d\n", omp_get_max_threads());
+    printf("Memory placement: %s\n", placement_name(placement));
+    print_thread_binding();
     printf("==============================================\n\n");
     
-    // Allocate vectors
-    double *A = (double *)malloc(size * sizeof(double));
-    double *B = (double *)malloc(size * sizeof(double));
-    double *C_seq = (double *)malloc(size * sizeof(double));
-    double *C_static = (double *)malloc(size * sizeof(double));
-    double *C_dynamic = (double *)malloc(size * sizeof(double));
+    // Allocate vectors from the shared arena (first-touch placement happens
+    // here, in parallel, unless ARENA_POPULATE pre-faulted the pages). The
+    // parallel initialization of A and B is their first touch, so they skip
+    // the placement pass instead of writing every page twice.
+    Arena *arena = arena_shared();
+    long setup_faults = process_page_faults();
+    double setup_start = omp_get_wtime();
+    MemoryPlacement input_placement =
+        (placement == PLACEMENT_FIRST_TOUCH) ? PLACEMENT_DEFAULT : placement;
+    double *A = (double *)arena_alloc_placed(arena, size, sizeof(double), input_placement);
+    double *B = (double *)arena_alloc_placed(arena, size, sizeof(double), input_placement);
+    double *C_seq = (double *)arena_alloc_placed(arena, size, sizeof(double), placement);
+    double *C_static = (double *)arena_alloc_placed(arena, size, sizeof(double), placement);
+    double *C_dynamic = (double *)arena_alloc_placed(arena, size, sizeof(double), placement);
     
     if (!A || !B || !C_seq || !C_static || !C_dynamic) {
         fprintf(stderr, "Memory allocation failed!\n");
@@ -60,44 +102,56 @@ int main(int argc, char *argv[]) {
     printf("Initializing vectors...\n");
     initialize_vector(A, size, 1.0);
     initialize_vector(B, size, 2.0);
+    printf("Setup: %.3f s, %ld page faults (allocation + initialization)\n",
+           omp_get_wtime() - setup_start, process_page_faults() - setup_faults);
+    arena_print_stats(arena, "shared");
     
     // Print samples
     if (size <= 20) {
-        print_vector_sample(A, size, "Vector A");
-        print_vector_sample(B, size, "Vector B");
+        print_vector(A, size, "Vector A", 20);
+        print_vector(B, size, "Vector B", 20);
     }
     
+    // One add per element; read A and B, write C
+    double flops = (double)size;
+    double bytes = 3.0 * size * sizeof(double);
+    bench_set_context(placement_name(placement));
+    
     // Sequential addition
     printf("\n[1] Running SEQUENTIAL vector addition...\n");
-    double start_seq = omp_get_wtime();
-    vector_add_sequential(A, B, C_seq, size);
-    double end_seq = omp_get_wtime();
-    double time_seq = end_seq - start_seq;
-    printf("    Time: %.6f seconds\n", time_seq);
+    Benchmark b_seq = bench_begin("vector_addition", "sequential", size, flops, bytes);
+    while (bench_next(&b_seq)) {
+        vector_add_sequential(A, B, C_seq, size);
+    }
+    double time_seq = bench_end(&b_seq).median;
     printf("    Throughput: %.2f Million ops/sec\n", (size / 1e6) / time_seq);
     
     // Parallel static scheduling
     printf("\n[2] Running PARALLEL vector addition (STATIC)...\n");
-    double start_static = omp_get_wtime();
-    vector_add_parallel_static(A, B, C_static, size);
-    double end_static = omp_get_wtime();
-    double time_static = end_static - start_static;
-    printf("    Time: %.6f seconds\n", time_static);
+    printf("    Using %d threads with STATIC scheduling\n", omp_get_max_threads());
+    printf("    Chunk size per thread: ~%ld elements\n",
+           (long)((size + omp_get_max_threads() - 1) / omp_get_max_threads()));
+    Benchmark b_static = bench_begin("vector_addition", "parallel_static", size, flops, bytes);
+    while (bench_next(&b_static)) {
+        vector_add_parallel_static(A, B, C_static, size);
+    }
+    double time_static = bench_end(&b_static).median;
     printf("    Throughput: %.2f Million ops/sec\n", (size / 1e6) / time_static);
     
     // Parallel dynamic scheduling
     printf("\n[3] Running PARALLEL vector addition (DYNAMIC)...\n");
-    double start_dynamic = omp_get_wtime();
-    vector_add_parallel_dynamic(A, B, C_dynamic, size);
-    double end_dynamic = omp_get_wtime();
-    double time_dynamic = end_dynamic - start_dynamic;
-    printf("    Time: %.6f seconds\n", time_dynamic);
+    printf("    Using %d threads with DYNAMIC scheduling\n", omp_get_max_threads());
+    Benchmark b_dynamic = bench_begin("vector_addition", "parallel_dynamic", size, flops, bytes);
+    while (bench_next(&b_dynamic)) {
+        vector_add_parallel_dynamic(A, B, C_dynamic, size);
+    }
+    double time_dynamic = bench_end(&b_dynamic).median;
     printf("    Throughput: %.2f Million ops/sec\n", (size / 1e6) / time_dynamic);
     
     // Verify results
     printf("\n[4] Verifying results...\n");
-    int static_correct = verify_results(C_seq, C_static, size);
-    int dynamic_correct = verify_results(C_seq, C_dynamic, size);
+    int static_correct = verify_results(C_seq, C_static, size, 1e-9);
+    int dynamic_correct = verify_results(C_seq, C_dynamic, size, 1e-9);
     
     if (static_correct && dynamic_correct) {
         printf("    ✓ All results match! Correctness verified.\n");
@@ -107,14 +161,14 @@ int main(int argc, char *argv[]) {
     
     // Print result samples
     if (size <= 20) {
-        print_vector_sample(C_static, size, "Result C");
+        print_vector(C_static, size, "Result C", 20);
     }
     
     // Performance summary
     printf("\n==============================================\n");
     printf("  PERFORMANCE SUMMARY\n");
     printf("==============================================\n");
-    printf("Sequential time:     %.6f seconds\n", time_seq);
+    printf("Sequential time:     %.6f seconds (median)\n", time_seq);
     printf("Parallel (static):   %.6f seconds (%.2fx speedup, %.1f%% eff.)\n", 
            time_static, time_seq / time_static,
            (time_seq / time_static) / omp_get_max_threads() * 100);
@@ -134,102 +188,513 @@ int main(int argc, char *argv[]) {
     printf("  • Large vectors (> 100M): Best speedup (up to memory bandwidth limit)\n");
     printf("  • Speedup ceiling: ~4-8x on typical systems (memory channels)\n");
     
+    // Where did the static kernel's traffic come from?
+    vector_add_node_report(A, B, C_static, size);
+    
+    // Per-call overhead of fork/join vs. a persistent team
+    benchmark_invocation_overhead(A, B, C_static, size);
+    
+    // Element scheduling strategies (same answer, different distribution)
+    benchmark_schedulers(A, B, C_dynamic, C_seq, size);
+    
+    // Explicit SIMD path: streaming stores and prefetch distance
+    benchmark_simd_vector_add(A, B, C_dynamic, C_seq, size, placement_name(placement));
+    
+    // Fused multi-op chains (reuses the already allocated vectors)
+    benchmark_fused_kernels(A, B, C_seq, C_static, C_dynamic, size);
+    
     // Cleanup
-    free(A);
-    free(B);
-    free(C_seq);
-    free(C_static);
-    free(C_dynamic);
+    arena_free(arena, A);
+    arena_free(arena, B);
+    arena_free(arena, C_seq);
+    arena_free(arena, C_static);
+    arena_free(arena, C_dynamic);
+    
+    // Short runs: page faults of per-call allocation against a reused arena
+    benchmark_allocation(size);
     
     return 0;
 }
 
-// Initialize vector with a constant value
-void initialize_vector(double *vec, int size, double value) {
-    for (int i = 0; i < size; i++) {
+// Initialize vector with a constant value (static partition: first touch
+// places each page on the node of the thread that later processes it)
+void initialize_vector(double *vec, index_t size, double value) {
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < size; i++) {
         vec[i] = value;
     }
 }
 
-// Sequential vector addition
-void vector_add_sequential(double *A, double *B, double *C, int size) {
-    for (int i = 0; i < size; i++) {
-        C[i] = A[i] + B[i];
+// Restore an array a chain updates in place (e.g. y = a*x + y) to 1.0, so
+// every run starts from the same state; no-op for NULL
+static void reset_chain_state(double *reset, index_t size) {
+    if (!reset) return;
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < size; i++) reset[i] = 1.0;
+}
+
+// Best-of-N time of a chain; `reset` is restored before every run
+static double time_vector_chain(const VectorOp *ops, int num_ops, index_t size, int fused,
+                                double *reset) {
+    double best = 0.0;
+    for (int rep = 0; rep < FUSION_REPETITIONS; rep++) {
+        reset_chain_state(reset, size);
+        double start = omp_get_wtime();
+        if (fused) {
+            vector_chain_fused(ops, num_ops, size);
+        } else {
+            vector_chain_unfused(ops, num_ops, size);
+        }
+        double elapsed = omp_get_wtime() - start;
+        if (rep == 0 || elapsed < best) best = elapsed;
     }
+    return best;
 }
 
-// Parallel vector addition with static scheduling
-void vector_add_parallel_static(double *A, double *B, double *C, int size) {
-    #pragma omp parallel
-    {
-        int thread_id = omp_get_thread_num();
-        int num_threads = omp_get_num_threads();
+// Copy of `result` after one unfused run of the chain (NULL if out of memory)
+static double *unfused_reference(const VectorOp *ops, int num_ops, index_t size,
+                                 const double *result, double *reset) {
+    double *reference = (double *)malloc_array(size, sizeof(double));
+    if (!reference) return NULL;
+    reset_chain_state(reset, size);
+    vector_chain_unfused(ops, num_ops, size);
+    memcpy(reference, result, size * sizeof(double));
+    return reference;
+}
+
+void benchmark_fused_kernels(double *x, double *w, double *y, double *z, double *t, index_t size) {
+    typedef struct {
+        const char *name;
+        int num_ops;
+        VectorOp ops[MAX_CHAIN_OPS];
+        double *result;   // Array compared between fused and unfused runs
+        double *reset;    // Array updated in place by the chain
+    } VectorChain;
+    
+    VectorChain chains[] = {
+        {"AXPY: y = 2x + y", 1,
+         {{VOP_AXPY, y, x, y, 2.0, 0.0}}, y, y},
+        {"Scale-add: z = 3x + 1", 1,
+         {{VOP_SCALE_ADD, z, x, NULL, 3.0, 1.0}}, z, NULL},
+        {"y = 2x + y; z = y*w + 0.5", 2,
+         {{VOP_AXPY, y, x, y, 2.0, 0.0},
+          {VOP_MUL_ADD, z, y, w, 0.0, 0.5}}, z, y},
+        {"t = x + 3w; t = t*y + 1; z = 0.5t + 2; z = z + x", 4,
+         {{VOP_TRIAD, t, x, w, 3.0, 0.0},
+          {VOP_MUL_ADD, t, t, y, 0.0, 1.0},
+          {VOP_SCALE_ADD, z, t, NULL, 0.5, 2.0},
+          {VOP_ADD, z, z, x, 0.0, 0.0}}, z, NULL},
+    };
+    int num_chains = sizeof(chains) / sizeof(chains[0]);
+    
+    printf("\n==============================================\n");
+    printf("  FUSED VECTOR KERNELS (ONE PASS PER CHAIN)\n");
+    printf("==============================================\n");
+    
+    // STREAM-style roofline: t = x + 3*w, 24 bytes moved per element
+    VectorOp triad = {VOP_TRIAD, t, x, w, 3.0, 0.0};
+    double *triad_reference = unfused_reference(&triad, 1, size, t, NULL);
+    double time_triad = time_vector_chain(&triad, 1, size, 1, NULL);
+    double roofline = vector_chain_bytes(&triad, 1, size, 1) / time_triad / 1e9;
+    int triad_correct = !triad_reference || verify_results(triad_reference, t, size, 1e-9);
+    free(triad_reference);
+    printf("STREAM triad roofline: %.2f GB/s (best of %d) %s\n", roofline, FUSION_REPETITIONS,
+           triad_correct ? "✓" : "✗");
+    printf("==============================================\n");
+    
+    for (int c = 0; c < num_chains; c++) {
+        VectorChain *vc = &chains[c];
+        double flops = vector_chain_flops(vc->ops, vc->num_ops, size);
         
-        #pragma omp single
-        {
-            printf("    Using %d threads with STATIC scheduling\n", num_threads);
-        }
+        printf("\n[%d] %s (%d op%s)\n", 5 + c, vc->name, vc->num_ops, vc->num_ops > 1 ? "s" : "");
         
-        #pragma omp for schedule(static)
-        for (int i = 0; i < size; i++) {
-            C[i] = A[i] + B[i];
+        // The unfused result is the reference for every chain; multi-op
+        // chains also time it
+        double time_unfused = 0.0;
+        if (vc->num_ops > 1) {
+            time_unfused = time_vector_chain(vc->ops, vc->num_ops, size, 0, vc->reset);
+            double bytes = vector_chain_bytes(vc->ops, vc->num_ops, size, 0);
+            printf("    Unfused: %.6f s  %6.2f GB/s  %6.2f GFLOP/s  (%.0f%% of roofline)\n",
+                   time_unfused, bytes / time_unfused / 1e9, flops / time_unfused / 1e9,
+                   100.0 * bytes / time_unfused / 1e9 / roofline);
         }
+        double *reference = unfused_reference(vc->ops, vc->num_ops, size, vc->result, vc->reset);
         
-        // Show work distribution
-        #pragma omp single
-        {
-            int chunk_size = (size + num_threads - 1) / num_threads;
-            printf("    Chunk size per thread: ~%d elements\n", chunk_size);
+        double time_fused = time_vector_chain(vc->ops, vc->num_ops, size, 1, vc->reset);
+        double bytes = vector_chain_bytes(vc->ops, vc->num_ops, size, 1);
+        printf("    Fused:   %.6f s  %6.2f GB/s  %6.2f GFLOP/s  (%.0f%% of roofline)\n",
+               time_fused, bytes / time_fused / 1e9, flops / time_fused / 1e9,
+               100.0 * bytes / time_fused / 1e9 / roofline);
+        
+        int correct = 1;
+        if (reference) {
+            correct = verify_results(reference, vc->result, size, 1e-9);
+            free(reference);
+        } else {
+            fprintf(stderr, "Memory allocation failed! (fused chain not verified)\n");
+        }
+        if (vc->num_ops > 1) {
+            printf("    Fusion speedup: %.2fx, traffic %.0f -> %.0f MB %s\n",
+                   time_unfused / time_fused,
+                   vector_chain_bytes(vc->ops, vc->num_ops, size, 0) / (1024.0 * 1024.0),
+                   bytes / (1024.0 * 1024.0), correct ? "✓" : "✗");
+        } else {
+            printf("    Matches unfused: %s\n", correct ? "✓" : "✗");
         }
     }
+    printf("==============================================\n");
 }
 
-// Parallel vector addition with dynamic scheduling
-void vector_add_parallel_dynamic(double *A, double *B, double *C, int size) {
+// Per-socket bandwidth of the static kernel: every thread times its own
+// static chunk, and traffic is attributed to the node it ran on
+void vector_add_node_report(double *A, double *B, double *C, index_t size) {
+    int max_threads = omp_get_max_threads();
+    int *thread_node = (int *)calloc(max_threads, sizeof(int));
+    double *thread_bytes = (double *)calloc(max_threads, sizeof(double));
+    double *thread_seconds = (double *)calloc(max_threads, sizeof(double));
+    
+    if (!thread_node || !thread_bytes || !thread_seconds) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(thread_node);
+        free(thread_bytes);
+        free(thread_seconds);
+        return;
+    }
+    
+    printf("\n==============================================\n");
+    printf("  NUMA PLACEMENT REPORT (STATIC KERNEL)\n");
+    printf("==============================================\n");
+    
+    int num_threads = 1;
     #pragma omp parallel
     {
+        int tid = omp_get_thread_num();
+        long count = 0;
+        
         #pragma omp single
-        {
-            printf("    Using %d threads with DYNAMIC scheduling\n", omp_get_num_threads());
-        }
+        num_threads = omp_get_num_threads();
         
-        #pragma omp for schedule(dynamic, 10000)
-        for (int i = 0; i < size; i++) {
+        // Same partition as vector_add_parallel_static (and the first touch)
+        #pragma omp barrier
+        double start = omp_get_wtime();
+        #pragma omp for schedule(static) nowait
+        for (index_t i = 0; i < size; i++) {
             C[i] = A[i] + B[i];
+            count++;
         }
+        thread_seconds[tid] = omp_get_wtime() - start;
+        thread_bytes[tid] = 3.0 * count * sizeof(double);  // Read A, B; write C
+        thread_node[tid] = current_numa_node();
     }
+    
+    print_node_bandwidth(thread_node, thread_bytes, thread_seconds, num_threads);
+    printf("==============================================\n");
+    
+    free(thread_node);
+    free(thread_bytes);
+    free(thread_seconds);
 }
 
-// Verify that two vectors are equal
-int verify_results(double *C1, double *C2, int size) {
-    double tolerance = 1e-9;
-    int errors = 0;
+// Per-invocation cost vs. problem size for sequential, fork/join and
+// persistent-team execution, and the size where parallel starts to win
+void benchmark_invocation_overhead(double *A, double *B, double *C, index_t max_size) {
+    int num_threads = omp_get_max_threads();
+    long break_even_fork = -1, break_even_persistent = -1;
+    
+    printf("\n==============================================\n");
+    printf("  INVOCATION OVERHEAD (FORK/JOIN vs PERSISTENT)\n");
+    printf("==============================================\n");
+    printf("Threads: %d, time per call in microseconds\n", num_threads);
+    printf("Overhead = parallel time - sequential time / threads\n\n");
+    printf("    %10s %11s %11s %11s %10s %10s\n", "Size", "Sequential",
+           "Fork/join", "Persistent", "FJ ovh", "Pers ovh");
     
-    for (int i = 0; i < size; i++) {
-        if (fabs(C1[i] - C2[i]) > tolerance) {
-            errors++;
-            if (errors <= 5) {
-                printf("    Error at index %d: C1=%.6f, C2=%.6f\n", i, C1[i], C2[i]);
+    for (long n = 1000; n <= max_size; n *= 10) {
+        for (int step = 0; step < 2; step++) {
+            index_t size = (index_t)(step == 0 ? n : 3 * n);
+            if (size > max_size) break;
+            
+            int iterations = (int)(OVERHEAD_WORK / size);
+            if (iterations < OVERHEAD_MIN_ITERATIONS) iterations = OVERHEAD_MIN_ITERATIONS;
+            
+            double start = omp_get_wtime();
+            for (int it = 0; it < iterations; it++) {
+                vector_add_sequential(A, B, C, size);
             }
+            double t_seq = (omp_get_wtime() - start) / iterations * 1e6;
+            
+            start = omp_get_wtime();
+            vector_add_fork_join(A, B, C, size, iterations);
+            double t_fork = (omp_get_wtime() - start) / iterations * 1e6;
+            
+            start = omp_get_wtime();
+            vector_add_persistent(A, B, C, size, iterations);
+            double t_pers = (omp_get_wtime() - start) / iterations * 1e6;
+            
+            printf("    %10ld %11.3f %11.3f %11.3f %10.3f %10.3f\n", (long)size, t_seq, t_fork, t_pers,
+                   t_fork - t_seq / num_threads, t_pers - t_seq / num_threads);
+            
+            if (break_even_fork < 0 && t_fork < t_seq) break_even_fork = size;
+            if (break_even_persistent < 0 && t_pers < t_seq) break_even_persistent = size;
         }
     }
     
-    if (errors > 5) {
-        printf("    ... and %d more errors\n", errors - 5);
+    printf("\nBreak-even (parallel faster than sequential):\n");
+    if (break_even_fork > 0) {
+        printf("    Fork/join:  >= %ld elements\n", break_even_fork);
+    } else {
+        printf("    Fork/join:  not reached up to %ld elements\n", (long)max_size);
     }
+    if (break_even_persistent > 0) {
+        printf("    Persistent: >= %ld elements\n", break_even_persistent);
+    } else {
+        printf("    Persistent: not reached up to %ld elements\n", (long)max_size);
+    }
+    printf("==============================================\n");
+}
+
+// Best-of-N time of the SIMD kernel with a given store type and prefetch distance
+static double time_simd_vector_add(double *A, double *B, double *C, index_t size, int streaming,
+                                   int prefetch_distance) {
+    double best = 0.0;
+    for (int rep = 0; rep < FUSION_REPETITIONS; rep++) {
+        double start = omp_get_wtime();
+        vector_add_simd(A, B, C, size, streaming, prefetch_distance);
+        double elapsed = omp_get_wtime() - start;
+        if (rep == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+// Compare auto-vectorized, SIMD temporal and SIMD streaming-store kernels
+void benchmark_simd_vector_add(double *A, double *B, double *C, double *reference, index_t size,
+                               const char *context) {
+    static const int distances[] = {0, 64, 128, 256, 512, 1024};
+    int num_distances = (int)(sizeof(distances) / sizeof(distances[0]));
+    SimdIsa isa = vector_simd_isa();
+    size_t llc = last_level_cache_bytes();
+    int streaming_default = vector_add_streaming_default(size);
+    
+    printf("\n==============================================\n");
+    printf("  SIMD VECTOR ADDITION (STREAMING STORES)\n");
+    printf("==============================================\n");
+    printf("Instruction set:     %s\n", simd_isa_name(isa));
+    printf("Last-level cache:    %.1f MB%s\n", llc / (1024.0 * 1024.0),
+           llc ? "" : " (unknown, assuming 32 MB)");
+    printf("Working set (A+B+C): %.1f MB -> %s stores by default\n",
+           3.0 * size * sizeof(double) / (1024.0 * 1024.0),
+           streaming_default ? "non-temporal" : "regular");
+    
+    // Prefetch distance sweep with the default store type
+    printf("\nPrefetch distance sweep (best of %d):\n", FUSION_REPETITIONS);
+    int best_distance = VECTOR_PREFETCH_DEFAULT;
+    double best_time = 0.0;
+    for (int d = 0; d < num_distances; d++) {
+        double t = time_simd_vector_add(A, B, C, size, streaming_default, distances[d]);
+        printf("    %5d elements (%5d B ahead): %10.3f ms %8.2f GB/s\n", distances[d],
+               distances[d] * (int)sizeof(double), t * 1e3,
+               3.0 * size * sizeof(double) / t / 1e9);
+        if (d == 0 || t < best_time) {
+            best_time = t;
+            best_distance = distances[d];
+        }
+    }
+    printf("    Best distance: %d elements\n", best_distance);
+    
+    /*
+     * Bandwidth two ways: "compulsory" counts the 24 B/element the
+     * algorithm needs (read A, B; write C). A regular store first reads
+     * C's line into cache (write-allocate / RFO), so the memory system
+     * really moves 32 B/element; a non-temporal store skips that read.
+     */
+    typedef struct {
+        const char *kernel;   // Benchmark record name
+        const char *label;
+        int simd;
+        int streaming;
+    } SimdCase;
+    SimdCase cases[] = {
+        {"parallel_static",     "auto-vectorized", 0, 0},
+        {"simd_temporal",       "SIMD regular",    1, 0},
+        {"simd_streaming",      "SIMD streaming",  1, 1},
+    };
+    int num_cases = (int)(sizeof(cases) / sizeof(cases[0]));
+    double compulsory = 3.0 * size * sizeof(double);
+    double results[3][2];
+    int all_correct = 1;
+    
+    char simd_context[128];
+    snprintf(simd_context, sizeof(simd_context), "%s isa=%s prefetch=%d", context,
+             simd_isa_name(isa), best_distance);
+    bench_set_context(simd_context);
+    
+    for (int c = 0; c < num_cases; c++) {
+        printf("\n[%s]\n", cases[c].label);
+        Benchmark b = bench_begin("vector_addition", cases[c].kernel, size, (double)size,
+                                  compulsory);
+        while (bench_next(&b)) {
+            if (cases[c].simd) {
+                vector_add_simd(A, B, C, size, cases[c].streaming, best_distance);
+            } else {
+                vector_add_parallel_static(A, B, C, size);
+            }
+        }
+        double t = bench_end(&b).median;
+        double moved = compulsory + (cases[c].streaming ? 0.0 : size * sizeof(double));
+        results[c][0] = compulsory / t / 1e9;
+        results[c][1] = moved / t / 1e9;
+        all_correct &= verify_results(reference, C, size, 1e-9);
+    }
+    bench_set_context(context);
     
-    return (errors == 0);
+    printf("\n    %-16s %16s %22s\n", "Kernel", "GB/s compulsory", "GB/s incl. write-alloc");
+    for (int c = 0; c < num_cases; c++) {
+        printf("    %-16s %16.2f %22.2f\n", cases[c].label, results[c][0], results[c][1]);
+    }
+    printf("    Streaming vs regular SIMD: %.2fx\n", results[2][0] / results[1][0]);
+    printf("    %s\n", all_correct ? "✓ All SIMD results match" : "✗ SIMD results differ!");
+    printf("==============================================\n");
 }
 
-// Print vector sample
-void print_vector_sample(double *vec, int size, const char *name) {
-    printf("\n%s: [", name);
-    int print_count = (size < 20) ? size : 20;
-    for (int i = 0; i < print_count; i++) {
-        printf("%.1f", vec[i]);
-        if (i < print_count - 1) printf(", ");
+// Compare the pluggable scheduling strategies on vector addition
+void benchmark_schedulers(double *A, double *B, double *C, double *reference, index_t size) {
+    // "dynamic:10000" is the chunking of vector_add_parallel_dynamic
+    static const char *default_specs[] = {"static", "dynamic:10000", "guided", "taskloop",
+                                          "steal", "adaptive"};
+    Schedule schedules[MAX_SCHEDULES];
+    int num_schedules = schedule_list_from_env("VECTOR_SCHEDULE", schedules, MAX_SCHEDULES);
+    if (num_schedules == 0) {
+        num_schedules = (int)(sizeof(default_specs) / sizeof(default_specs[0]));
+        for (int k = 0; k < num_schedules; k++) schedule_parse(default_specs[k], &schedules[k]);
     }
-    if (size > 20) printf(", ...");
-    printf("]\n");
+    
+    printf("\n==============================================\n");
+    printf("  ELEMENT SCHEDULING STRATEGIES\n");
+    printf("==============================================\n");
+    
+    double bytes = 3.0 * size * sizeof(double);
+    char names[MAX_SCHEDULES][48];
+    double times[MAX_SCHEDULES];
+    long chunks[MAX_SCHEDULES];
+    int correct[MAX_SCHEDULES];
+    
+    for (int k = 0; k < num_schedules; k++) {
+        char spec[32];
+        schedule_format(schedules[k], spec, sizeof(spec));
+        snprintf(names[k], sizeof(names[k]), "scheduled_%s", spec);
+        printf("\n[%s]\n", spec);
+        
+        Benchmark b = bench_begin("vector_addition", names[k], size, (double)size, bytes);
+        while (bench_next(&b)) {
+            chunks[k] = vector_add_scheduled(A, B, C, size, schedules[k]);
+        }
+        times[k] = bench_end(&b).median;
+        correct[k] = verify_results(reference, C, size, 1e-9);
+    }
+    
+    printf("\n    %-22s %12s %10s %10s %8s\n", "Schedule", "Median (ms)", "GB/s", "Chunk", "Check");
+    int best = 0;
+    for (int k = 0; k < num_schedules; k++) {
+        printf("    %-22s %12.3f %10.2f %10ld %8s\n", names[k] + 10, times[k] * 1e3,
+               bytes / times[k] / 1e9, chunks[k], correct[k] ? "✓" : "✗");
+        if (times[k] < times[best]) best = k;
+    }
+    printf("    Fastest: %s\n", names[best] + 10);
+    printf("==============================================\n");
+}
+
+// One short run: three vectors allocated (malloc, or the arena if given),
+// initialized, added and released; returns C[n - 1] for the check
+static double allocation_call(Arena *arena, index_t n) {
+    double *A = arena ? (double *)arena_alloc_array(arena, n, sizeof(double))
+                      : (double *)malloc_array(n, sizeof(double));
+    double *B = arena ? (double *)arena_alloc_array(arena, n, sizeof(double))
+                      : (double *)malloc_array(n, sizeof(double));
+    double *C = arena ? (double *)arena_alloc_array(arena, n, sizeof(double))
+                      : (double *)malloc_array(n, sizeof(double));
+    double check = -1.0;
+    if (A && B && C) {
+        #pragma omp parallel for schedule(static)
+        for (index_t i = 0; i < n; i++) {
+            A[i] = 1.0;
+            B[i] = 2.0;
+        }
+        vector_add_parallel_static(A, B, C, n);
+        check = C[n - 1];
+    }
+    if (arena) {
+        arena_free(arena, C);
+        arena_free(arena, B);
+        arena_free(arena, A);
+    } else {
+        free(C);
+        free(B);
+        free(A);
+    }
+    return check;
 }
 
+// First-call and repeated-call cost of allocating per call: malloc maps
+// and faults fresh pages every time, an arena only on its first call
+void benchmark_allocation(index_t size) {
+    index_t n = (size < ALLOCATION_MAX_ELEMENTS) ? size : ALLOCATION_MAX_ELEMENTS;
+    if (n <= 0) return;
+    printf("\n==============================================\n");
+    printf("  ALLOCATION: per-call malloc vs arena\n");
+    printf("==============================================\n");
+    printf("Per call: 3 vectors of %ld elements (%.1f MB each) allocated, initialized,\n"
+           "added and released\n", (long)n, n * sizeof(double) / (1024.0 * 1024.0));
+    
+    enum { NUM_STRATEGIES = 5 };
+    const char *names[NUM_STRATEGIES] = {"alloc_malloc", "alloc_arena", "alloc_arena_populate",
+                                         "alloc_arena_thp", "alloc_arena_thp_populate"};
+    PageSize pages[NUM_STRATEGIES] = {PAGES_DEFAULT, PAGES_DEFAULT, PAGES_DEFAULT,
+                                      PAGES_TRANSPARENT, PAGES_TRANSPARENT};
+    int populate[NUM_STRATEGIES] = {0, 0, 1, 0, 1};
+    double first_time[NUM_STRATEGIES], repeat_time[NUM_STRATEGIES];
+    long first_faults[NUM_STRATEGIES];
+    double repeat_faults[NUM_STRATEGIES];
+    int correct[NUM_STRATEGIES];
+    for (int s = 0; s < NUM_STRATEGIES; s++) {
+        Arena arena;
+        arena_init(&arena, pages[s], populate[s]);
+        Arena *use = (s == 0) ? NULL : &arena;
+        printf("\n[%s]\n", names[s]);
+        
+        // The first call is what a short run pays
+        long faults = process_page_faults();
+        double start = omp_get_wtime();
+        double check = allocation_call(use, n);
+        first_time[s] = omp_get_wtime() - start;
+        first_faults[s] = process_page_faults() - faults;
+        correct[s] = (check == 3.0);
+        
+        faults = process_page_faults();
+        Benchmark b = bench_begin("vector_addition", names[s], n, (double)n,
+                                  3.0 * n * sizeof(double));
+        int runs = b.result.warmup + b.result.reps;
+        while (bench_next(&b)) {
+            check = allocation_call(use, n);
+        }
+        repeat_time[s] = bench_end(&b).median;
+        repeat_faults[s] = (double)(process_page_faults() - faults) / runs;
+        correct[s] &= (check == 3.0);
+        if (use) arena_destroy(&arena);
+    }
+    
+    printf("\n    %-26s %12s %10s %12s %12s %6s\n", "Strategy", "First (ms)", "Faults",
+           "Repeat (ms)", "Faults/call", "Check");
+    for (int s = 0; s < NUM_STRATEGIES; s++) {
+        printf("    %-26s %12.3f %10ld %12.3f %12.1f %6s\n", names[s] + 6, first_time[s] * 1e3,
+               first_faults[s], repeat_time[s] * 1e3, repeat_faults[s], correct[s] ? "✓" : "✗");
+    }
+    int best_first = 1, best_repeat = 1;
+    for (int s = 2; s < NUM_STRATEGIES; s++) {
+        if (first_time[s] < first_time[best_first]) best_first = s;
+        if (repeat_time[s] < repeat_time[best_repeat]) best_repeat = s;
+    }
+    printf("Saved against malloc: %.3f ms on the first call (%s), %.3f ms per repeated call (%s)\n",
+           (first_time[0] - first_time[best_first]) * 1e3, names[best_first] + 6,
+           (repeat_time[0] - repeat_time[best_repeat]) * 1e3, names[best_repeat] + 6);
+    printf("==============================================\n");
+}
@@ -5,8 +5,9 @@
  *   Implements sparse matrix-vector multiplication using CSR format.
  *   Assigns row blocks to threads and handles irregular workload balancing.
  * 
- * Compilation: gcc -fopenmp -o sparse_matrix_vector.exe sparse_matrix_vector.c -lm
+ * Compilation: make task6  (links libdatapatterns: ../kernels, ../common)
  * Usage: ./sparse_matrix_vector.exe [num_rows] [density]
+ *        ./sparse_matrix_vector.exe matrix.mtx|matrix.csr
  * 
  * Author: High Performance Computing Course
  * Date: November 2025
@@ -17,58 +18,100 @@
 #include <omp.h>
 #include <math.h>
 #include <string.h>
+#include <ctype.h>
+#include "spmv.h"
+#include "sparse_io.h"
+#include "sparse_formats.h"
+#include "reorder.h"
+#include "sparse_compress.h"
+#include "sparse_symmetric.h"
+#include "solvers.h"
+#include "spgemm.h"
+#include "sparse_stats.h"
+#include "sparse_dynamic.h"
+#include "vector_ops.h"
+#include "numa_alloc.h"
+#include "bench.h"
+#include "array_utils.h"
 
 // SpMV is memory-bound with irregular access patterns
 // For good parallel speedup, use larger matrices (50K+ rows)
 // Dynamic scheduling handles load imbalance from irregular sparsity
 #define DEFAULT_ROWS 50000        // Increased from 10K for better parallelization
 #define DEFAULT_DENSITY 0.05      // 5% non-zero elements
-
-// CSR (Compressed Sparse Row) format
-typedef struct {
-    int num_rows;
-    int num_cols;
-    int nnz;              // Number of non-zero elements
-    double *values;       // Non-zero values
-    int *col_indices;     // Column index for each value
-    int *row_ptr;         // Row pointer array
-} CSRMatrix;
+#define REPEATED_SPMV_ITERATIONS 100
+#define MAX_SCHEDULES 16
+#define SKEWED_ROW_EXPONENT 1.2   // Power-law row lengths of the synthetic stress matrix
+#define MAX_FORMAT_FILL 4.0       // Skip formats storing more than 4 slots per non-zero
+#define SOLVER_TOLERANCE 1e-8     // Relative residual the solver benchmark converges to
+#define SOLVER_MAX_ITERATIONS 500
+#define SPGEMM_MAX_PRODUCTS 2e8   // Larger A * A products run on a sparser matrix
+#define SPGEMM_ROW_NNZ 16         // Non-zeros per row of that matrix
+#define DYNAMIC_BATCH_UPDATES 4096   // Edge inserts + deletes between two SpMV sweeps
+#define DYNAMIC_DELETE_SHARE 0.5
 
 // Function prototypes
-CSRMatrix* create_random_sparse_matrix(int rows, int cols, double density);
-void free_csr_matrix(CSRMatrix *matrix);
-void print_csr_format(CSRMatrix *matrix);
-void spmv_sequential(CSRMatrix *A, double *x, double *y);
-void spmv_parallel_static(CSRMatrix *A, double *x, double *y);
-void spmv_parallel_dynamic(CSRMatrix *A, double *x, double *y);
-int verify_results(double *y1, double *y2, int size);
-void print_vector(double *vec, int size, const char *name);
+void benchmark_repeated_spmv(CSRMatrix *A, double *x, double *y, int iterations);
+void benchmark_schedulers(CSRMatrix *A, double *x, double *y, double *reference,
+                          double flops, double bytes);
+void benchmark_index_widths(CSRMatrix *A, double *x, double *y, double *reference);
+void benchmark_load_balance(CSRMatrix *A, const char *label);
+void benchmark_formats(CSRMatrix *A, const char *label);
+void benchmark_spmm(CSRMatrix *A);
+void benchmark_reordering(CSRMatrix *A);
+void benchmark_compression(CSRMatrix *A);
+void benchmark_symmetric(CSRMatrix *A);
+void benchmark_solvers(CSRMatrix *A);
+void benchmark_spgemm(CSRMatrix *A);
+void benchmark_dynamic(CSRMatrix *A);
+static void analyze_matrix(CSRMatrix *A, SpmvAdvice *advice);
 
 int main(int argc, char *argv[]) {
-    int num_rows = DEFAULT_ROWS;
+    index_t num_rows = DEFAULT_ROWS;
     double density = DEFAULT_DENSITY;
+    const char *matrix_file = NULL;
     
-    if (argc > 1) num_rows = atoi(argv[1]);
-    if (argc > 2) density = atof(argv[2]);
+    // A non-numeric first argument is a matrix file (.mtx or .csr)
+    if (argc > 1 && !isdigit((unsigned char)argv[1][0])) {
+        matrix_file = argv[1];
+    } else {
+        if (argc > 1 && !parse_index_arg(argv[1], "row count", &num_rows)) return 1;
+        if (argc > 2) density = atof(argv[2]);
+    }
     
-    int num_cols = num_rows;  // Square matrix
+    // Create sparse matrix in CSR format
+    double load_start = omp_get_wtime();
+    CSRMatrix *A = matrix_file ? csr_load(matrix_file)
+                               : create_random_sparse_matrix(num_rows, num_rows, density);
+    if (!A) return 1;
+    double load_time = omp_get_wtime() - load_start;
+    num_rows = A->num_rows;
+    index_t num_cols = A->num_cols;
+    double dense_elems = (double)num_rows * num_cols;
     
     printf("==============================================\n");
     printf("  SPARSE MATRIX-VECTOR MULTIPLICATION (CSR)  \n");
     printf("==============================================\n");
-    printf("Matrix size: %d x %d\n", num_rows, num_cols);
-    printf("Density: %.2f%%\n", density * 100);
+    printf("Matrix size: %ld x %ld (%s)\n", (long)num_rows, (long)num_cols, INDEX_MODE);
+    if (matrix_file) {
+        printf("Matrix file: %s\n", matrix_file);
+    } else {
+        printf("Density: %.2f%%\n", density * 100);
+    }
     printf("Number of threads: %d\n", omp_get_max_threads());
     printf("==============================================\n\n");
     
-    // Create sparse matrix in CSR format
-    printf("Generating random sparse matrix...\n");
-    CSRMatrix *A = create_random_sparse_matrix(num_rows, num_cols, density);
-    printf("Matrix created: %d non-zero elements out of %d (%.2f%%)\n",
-           A->nnz, num_rows * num_cols, (A->nnz * 100.0) / (num_rows * num_cols));
+    printf("Matrix %s in %.3f s: %ld non-zero elements out of %.0f (%.2f%%)\n",
+           matrix_file ? "loaded" : "generated", load_time,
+           (long)A->nnz, dense_elems, (A->nnz * 100.0) / dense_elems);
     printf("Memory saved: %.2f MB (vs %.2f MB for dense)\n",
-           (A->nnz * (sizeof(double) + sizeof(int)) + (num_rows + 1) * sizeof(int)) / (1024.0 * 1024.0),
-           (num_rows * num_cols * sizeof(double)) / (1024.0 * 1024.0));
+           csr_matrix_bytes(A) / (1024.0 * 1024.0),
+           dense_elems * sizeof(double) / (1024.0 * 1024.0));
+    
+    // Structure statistics (recorded with every JSON result) and the
+    // partition / storage they favor
+    SpmvAdvice advice;
+    analyze_matrix(A, &advice);
     
     // Print CSR format for small matrices
     if (num_rows <= 10) {
@@ -76,7 +119,7 @@ int main(int argc, char *argv[]) {
     }
     
     // Allocate input vector x and output vector y
-    double *x = (double *)malloc(num_cols * sizeof(double));
+    double *x = (double *)malloc_array(num_cols, sizeof(double));
     double *y_seq = (double *)calloc(num_rows, sizeof(double));
     double *y_static = (double *)calloc(num_rows, sizeof(double));
     double *y_dynamic = (double *)calloc(num_rows, sizeof(double));
@@ -87,47 +130,80 @@ int main(int argc, char *argv[]) {
     }
     
     // Initialize input vector x
-    for (int i = 0; i < num_cols; i++) {
+    for (index_t i = 0; i < num_cols; i++) {
         x[i] = 1.0;  // Simple initialization
     }
     
     if (num_cols <= 10) {
-        print_vector(x, num_cols, "Input vector x");
+        print_vector(x, num_cols, "Input vector x", 10);
+    }
+    
+    // 2 FLOPs per non-zero; traffic: values + col_indices + row_ptr + x + y
+    double flops = 2.0 * A->nnz;
+    double bytes = csr_matrix_bytes(A) + (double)(num_cols + num_rows) * sizeof(double);
+    char context[64];
+    if (matrix_file) {
+        const char *base = strrchr(matrix_file, '/');
+        snprintf(context, sizeof(context), "matrix=%s", base ? base + 1 : matrix_file);
+    } else {
+        snprintf(context, sizeof(context), "density=%g", density);
     }
+    bench_set_context(context);
     
     // Sequential SpMV
     printf("\n[1] Running SEQUENTIAL SpMV...\n");
-    double start_seq = omp_get_wtime();
-    spmv_sequential(A, x, y_seq);
-    double end_seq = omp_get_wtime();
-    double time_seq = end_seq - start_seq;
-    printf("    Time: %.6f seconds\n", time_seq);
-    printf("    GFLOPS: %.3f\n", (2.0 * A->nnz / 1e9) / time_seq);
+    Benchmark b_seq = bench_begin("sparse_matrix_vector", "sequential", num_rows, flops, bytes);
+    while (bench_next(&b_seq)) {
+        spmv_sequential(A, x, y_seq);
+    }
+    double time_seq = bench_end(&b_seq).median;
     
     // Parallel SpMV with static scheduling
     printf("\n[2] Running PARALLEL SpMV (STATIC)...\n");
-    double start_static = omp_get_wtime();
-    spmv_parallel_static(A, x, y_static);
-    double end_static = omp_get_wtime();
-    double time_static = end_static - start_static;
-    printf("    Time: %.6f seconds\n", time_static);
-    printf("    GFLOPS: %.3f\n", (2.0 * A->nnz / 1e9) / time_static);
+    printf("    Using %d threads with STATIC scheduling\n", omp_get_max_threads());
+    Benchmark b_static = bench_begin("sparse_matrix_vector", "parallel_static", num_rows, flops, bytes);
+    while (bench_next(&b_static)) {
+        spmv_parallel_static(A, x, y_static);
+    }
+    double time_static = bench_end(&b_static).median;
     
     // Parallel SpMV with dynamic scheduling
     printf("\n[3] Running PARALLEL SpMV (DYNAMIC)...\n");
-    double start_dynamic = omp_get_wtime();
-    spmv_parallel_dynamic(A, x, y_dynamic);
-    double end_dynamic = omp_get_wtime();
-    double time_dynamic = end_dynamic - start_dynamic;
-    printf("    Time: %.6f seconds\n", time_dynamic);
-    printf("    GFLOPS: %.3f\n", (2.0 * A->nnz / 1e9) / time_dynamic);
+    printf("    Using %d threads with DYNAMIC scheduling (chunk=%d)\n", omp_get_max_threads(),
+           spmv_dynamic_chunk_size(num_rows, omp_get_max_threads()));
+    Benchmark b_dynamic = bench_begin("sparse_matrix_vector", "parallel_dynamic", num_rows, flops, bytes);
+    while (bench_next(&b_dynamic)) {
+        spmv_parallel_dynamic(A, x, y_dynamic);
+    }
+    double time_dynamic = bench_end(&b_dynamic).median;
+    
+    // Parallel SpMV with the advised partition and storage
+    printf("\n[4] Running ADVISED SpMV...\n");
+    printf("    %s partition, %s storage\n", spmv_partition_name(advice.partition),
+           sparse_format_name(advice.format));
+    SpmvPlan *plan = spmv_plan_create(A, &advice);
+    double *y_advised = (double *)calloc(num_rows, sizeof(double));
+    if (!plan || !y_advised) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 1;
+    }
+    Benchmark b_advised = bench_begin("sparse_matrix_vector", "advised", num_rows, flops,
+                                      bytes - csr_matrix_bytes(A) + spmv_plan_bytes(plan));
+    while (bench_next(&b_advised)) {
+        spmv_plan_run(plan, x, y_advised);
+    }
+    double time_advised = bench_end(&b_advised).median;
+    free_spmv_plan(plan);
     
     // Verify results
-    printf("\n[4] Verifying results...\n");
-    int static_correct = verify_results(y_seq, y_static, num_rows);
-    int dynamic_correct = verify_results(y_seq, y_dynamic, num_rows);
+    printf("\n[5] Verifying results...\n");
+    int static_correct = verify_results(y_seq, y_static, num_rows, 1e-9);
+    int dynamic_correct = verify_results(y_seq, y_dynamic, num_rows, 1e-9);
+    // merge path sums split rows in a different order
+    int advised_correct = verify_results(y_seq, y_advised, num_rows, 1e-6);
+    free(y_advised);
     
-    if (static_correct && dynamic_correct) {
+    if (static_correct && dynamic_correct && advised_correct) {
         printf("    ✓ All results match! Correctness verified.\n");
     } else {
         printf("    ✗ Results differ! Check implementation.\n");
@@ -135,20 +211,23 @@ int main(int argc, char *argv[]) {
     
     // Print result for small matrices
     if (num_rows <= 10) {
-        print_vector(y_seq, num_rows, "Output vector y");
+        print_vector(y_seq, num_rows, "Output vector y", 10);
     }
     
     // Performance summary
     printf("\n==============================================\n");
     printf("  PERFORMANCE SUMMARY\n");
     printf("==============================================\n");
-    printf("Sequential time:     %.6f seconds\n", time_seq);
+    printf("Sequential time:     %.6f seconds (median)\n", time_seq);
     printf("Parallel (static):   %.6f seconds (%.2fx speedup, %.1f%% eff.)\n", 
            time_static, time_seq / time_static,
            (time_seq / time_static) / omp_get_max_threads() * 100);
     printf("Parallel (dynamic):  %.6f seconds (%.2fx speedup, %.1f%% eff.)\n", 
            time_dynamic, time_seq / time_dynamic,
            (time_seq / time_dynamic) / omp_get_max_threads() * 100);
+    printf("Parallel (advised):  %.6f seconds (%.2fx speedup, %.1f%% eff.)\n",
+           time_advised, time_seq / time_advised,
+           (time_seq / time_advised) / omp_get_max_threads() * 100);
     printf("==============================================\n");
     printf("\n⚠️  PERFORMANCE CHARACTERISTICS:\n");
     printf("  • SpMV is MEMORY-BOUND with irregular access patterns\n");
@@ -161,6 +240,54 @@ int main(int argc, char *argv[]) {
     printf("  • Large (> 100K rows): Best speedup 4-8x with dynamic scheduling\n");
     printf("  • Static vs Dynamic: Dynamic better for power-law sparsity patterns\n");
     
+    // Repeated products: fork/join per call vs. persistent team
+    benchmark_repeated_spmv(A, x, y_static, REPEATED_SPMV_ITERATIONS);
+    
+    // Row scheduling strategies (SPMV_SCHEDULE=spec,... to choose)
+    benchmark_schedulers(A, x, y_dynamic, y_seq, flops, bytes);
+    
+    // Bandwidth cost of 32- vs 64-bit row pointers and column indices
+    benchmark_index_widths(A, x, y_dynamic, y_seq);
+    
+    // Row vs. non-zero balanced partitions and storage formats on this matrix
+    benchmark_load_balance(A, matrix_file ? "file" : "uniform");
+    benchmark_formats(A, matrix_file ? "file" : "uniform");
+    
+    // Blocks of right-hand sides: one SpMM against k separate SpMVs
+    benchmark_spmm(A);
+    
+    // Locality: RCM / degree orderings, their cost and when they pay off
+    benchmark_reordering(A);
+    
+    // Fewer bytes per non-zero: encoded columns, float / half values
+    benchmark_compression(A);
+    
+    // Upper-triangle storage for symmetric matrices, and y = A^T x
+    benchmark_symmetric(A);
+    
+    // Iterative solvers: whole CG / BiCGSTAB solves in one parallel region
+    benchmark_solvers(A);
+    
+    // Sparse times sparse: C = A * A, two phases, hash / dense accumulators
+    benchmark_spgemm(A);
+    
+    // Slowly changing matrix: update batches between sweeps, delta buffers
+    // against a rebuild per batch
+    benchmark_dynamic(A);
+    
+    // Row vs. non-zero balanced partitions, on this matrix and on a
+    // power-law matrix of the same size and mean density
+    double mean_density = (dense_elems > 0) ? A->nnz / dense_elems : 0.0;
+    CSRMatrix *skewed = create_skewed_sparse_matrix(num_rows, num_cols, mean_density,
+                                                    SKEWED_ROW_EXPONENT);
+    if (skewed) {
+        SpmvAdvice skewed_advice;
+        analyze_matrix(skewed, &skewed_advice);
+        benchmark_load_balance(skewed, "skewed");
+        benchmark_formats(skewed, "skewed");
+        free_csr_matrix(skewed);
+    }
+    
     // Cleanup
     free_csr_matrix(A);
     free(x);
@@ -171,213 +298,974 @@ int main(int argc, char *argv[]) {
     return 0;
 }
 
-// Create random sparse matrix in CSR format
-CSRMatrix* create_random_sparse_matrix(int rows, int cols, double density) {
-    CSRMatrix *matrix = (CSRMatrix *)malloc(sizeof(CSRMatrix));
-    matrix->num_rows = rows;
-    matrix->num_cols = cols;
-    
-    // Estimate number of non-zeros
-    int estimated_nnz = (int)(rows * cols * density);
-    
-    // Allocate temporary storage
-    double *temp_values = (double *)malloc(estimated_nnz * 2 * sizeof(double));
-    int *temp_cols = (int *)malloc(estimated_nnz * 2 * sizeof(int));
-    matrix->row_ptr = (int *)malloc((rows + 1) * sizeof(int));
-    
-    srand(42);  // Fixed seed for reproducibility
-    int nnz = 0;
-    matrix->row_ptr[0] = 0;
-    
-    // Generate sparse matrix row by row
-    for (int i = 0; i < rows; i++) {
-        int row_nnz = 0;
-        for (int j = 0; j < cols; j++) {
-            double rand_val = (double)rand() / RAND_MAX;
-            if (rand_val < density) {
-                temp_values[nnz] = ((double)rand() / RAND_MAX) * 10.0;  // Random value 0-10
-                temp_cols[nnz] = j;
-                nnz++;
-                row_nnz++;
-            }
+// Time `iterations` back-to-back products with a fork/join per call and with
+// a single persistent team
+void benchmark_repeated_spmv(CSRMatrix *A, double *x, double *y, int iterations) {
+    printf("\n==============================================\n");
+    printf("  REPEATED SpMV (%d products)\n", iterations);
+    printf("==============================================\n");
+    
+    double start = omp_get_wtime();
+    for (int it = 0; it < iterations; it++) {
+        #pragma omp parallel
+        spmv_team(A, x, y);
+    }
+    double time_fork = (omp_get_wtime() - start) / iterations;
+    
+    start = omp_get_wtime();
+    spmv_persistent(A, x, y, iterations);
+    double time_persistent = (omp_get_wtime() - start) / iterations;
+    
+    printf("Fork/join per call:  %.3f us/call (%.3f GFLOPS)\n",
+           time_fork * 1e6, (2.0 * A->nnz / 1e9) / time_fork);
+    printf("Persistent team:     %.3f us/call (%.3f GFLOPS)\n",
+           time_persistent * 1e6, (2.0 * A->nnz / 1e9) / time_persistent);
+    printf("Saved per call:      %.3f us\n", (time_fork - time_persistent) * 1e6);
+    printf("==============================================\n");
+}
+
+// Compare the pluggable row scheduling strategies on this matrix
+void benchmark_schedulers(CSRMatrix *A, double *x, double *y, double *reference,
+                          double flops, double bytes) {
+    static const char *default_specs[] = {"static", "dynamic", "guided", "taskloop",
+                                          "steal", "adaptive"};
+    Schedule schedules[MAX_SCHEDULES];
+    int num_schedules = schedule_list_from_env("SPMV_SCHEDULE", schedules, MAX_SCHEDULES);
+    if (num_schedules == 0) {
+        num_schedules = (int)(sizeof(default_specs) / sizeof(default_specs[0]));
+        for (int k = 0; k < num_schedules; k++) schedule_parse(default_specs[k], &schedules[k]);
+    }
+    
+    printf("\n==============================================\n");
+    printf("  ROW SCHEDULING STRATEGIES\n");
+    printf("==============================================\n");
+    
+    char names[MAX_SCHEDULES][48];
+    double times[MAX_SCHEDULES];
+    long chunks[MAX_SCHEDULES];
+    int correct[MAX_SCHEDULES];
+    
+    for (int k = 0; k < num_schedules; k++) {
+        char spec[32];
+        schedule_format(schedules[k], spec, sizeof(spec));
+        snprintf(names[k], sizeof(names[k]), "scheduled_%s", spec);
+        printf("\n[%s]\n", spec);
+        
+        Benchmark b = bench_begin("sparse_matrix_vector", names[k], A->num_rows, flops, bytes);
+        while (bench_next(&b)) {
+            chunks[k] = spmv_scheduled(A, x, y, schedules[k]);
         }
-        matrix->row_ptr[i + 1] = nnz;
+        times[k] = bench_end(&b).median;
+        correct[k] = verify_results(reference, y, A->num_rows, 1e-9);
     }
     
-    // Allocate final storage
-    matrix->nnz = nnz;
-    matrix->values = (double *)malloc(nnz * sizeof(double));
-    matrix->col_indices = (int *)malloc(nnz * sizeof(int));
+    printf("\n    %-22s %12s %10s %10s %8s\n", "Schedule", "Median (ms)", "GFLOP/s", "Chunk", "Check");
+    int best = 0;
+    for (int k = 0; k < num_schedules; k++) {
+        printf("    %-22s %12.3f %10.3f %10ld %8s\n", names[k] + 10, times[k] * 1e3,
+               flops / times[k] / 1e9, chunks[k], correct[k] ? "✓" : "✗");
+        if (times[k] < times[best]) best = k;
+    }
+    printf("    Fastest: %s\n", names[best] + 10);
+    printf("==============================================\n");
+}
+
+// Same matrix and partition with every row_ptr / col_indices width
+// combination: the time difference is the bandwidth cost of wider indices
+void benchmark_index_widths(CSRMatrix *A, double *x, double *y, double *reference) {
+    static const struct {
+        const char *name;
+        int row_ptr_bytes;
+        int col_bytes;
+    } layouts[] = {
+        {"index_32_32", 4, 4},
+        {"index_64_32", 8, 4},
+        {"index_64_64", 8, 8},
+    };
+    int num_layouts = (int)(sizeof(layouts) / sizeof(layouts[0]));
+    double flops = 2.0 * A->nnz;
+    double vector_bytes = (double)(A->num_cols + A->num_rows) * sizeof(double);
     
-    // Copy data
-    memcpy(matrix->values, temp_values, nnz * sizeof(double));
-    memcpy(matrix->col_indices, temp_cols, nnz * sizeof(int));
+    printf("\n==============================================\n");
+    printf("  INDEX WIDTH COST (row_ptr / col_indices)\n");
+    printf("==============================================\n");
+    printf("Build index mode: %s (row_ptr %d B, col_indices %d B)\n", INDEX_MODE,
+           (int)sizeof(index_t), (int)sizeof(col_index_t));
     
-    free(temp_values);
-    free(temp_cols);
+    double times[3], bytes_per_nnz[3], traffic[3];
+    int measured[3], correct[3];
     
-    return matrix;
+    for (int k = 0; k < num_layouts; k++) {
+        CSRIndexWidths widths;
+        measured[k] = csr_index_widths_create(A, layouts[k].row_ptr_bytes, layouts[k].col_bytes,
+                                              &widths);
+        if (!measured[k]) {
+            printf("\n[%s] skipped: matrix does not fit 32-bit indices\n", layouts[k].name);
+            continue;
+        }
+        traffic[k] = csr_index_widths_bytes(&widths) + vector_bytes;
+        bytes_per_nnz[k] = (A->nnz > 0) ? csr_index_widths_bytes(&widths) / A->nnz : 0.0;
+        
+        printf("\n[%s]\n", layouts[k].name);
+        Benchmark b = bench_begin("sparse_matrix_vector", layouts[k].name, A->num_rows, flops,
+                                  traffic[k]);
+        while (bench_next(&b)) {
+            spmv_index_widths(&widths, x, y);
+        }
+        times[k] = bench_end(&b).median;
+        correct[k] = verify_results(reference, y, A->num_rows, 1e-9);
+        csr_index_widths_free(&widths);
+    }
+    
+    printf("\n    %-14s %10s %12s %10s %10s %8s\n", "Layout", "Bytes/nnz", "Median (ms)",
+           "GB/s", "vs 32/32", "Check");
+    for (int k = 0; k < num_layouts; k++) {
+        if (!measured[k]) continue;
+        double relative = measured[0] ? times[k] / times[0] : 1.0;
+        printf("    %-14s %10.2f %12.3f %10.2f %9.2fx %8s\n", layouts[k].name, bytes_per_nnz[k],
+               times[k] * 1e3, traffic[k] / times[k] / 1e9, relative, correct[k] ? "✓" : "✗");
+    }
+    printf("==============================================\n");
 }
 
-// Free CSR matrix
-void free_csr_matrix(CSRMatrix *matrix) {
-    if (matrix) {
-        free(matrix->values);
-        free(matrix->col_indices);
-        free(matrix->row_ptr);
-        free(matrix);
+// Largest / mean non-zeros per thread when rows are cut into `parts` blocks
+// of equal row count (nnz_blocks == 0) or of equal nnz (nnz_blocks == 1)
+static double partition_imbalance(const CSRMatrix *A, int parts, int nnz_blocks) {
+    index_t largest = 0;
+    for (int p = 0; p < parts; p++) {
+        index_t begin = nnz_blocks ? csr_nnz_partition(A, parts, p)
+                                   : (index_t)((int64_t)A->num_rows * p / parts);
+        index_t end = nnz_blocks ? csr_nnz_partition(A, parts, p + 1)
+                                 : (index_t)((int64_t)A->num_rows * (p + 1) / parts);
+        index_t nnz = A->row_ptr[end] - A->row_ptr[begin];
+        if (nnz > largest) largest = nnz;
     }
+    return (A->nnz > 0) ? largest / ((double)A->nnz / parts) : 1.0;
 }
 
-// Print CSR format
-void print_csr_format(CSRMatrix *matrix) {
-    printf("\nCSR Format Representation:\n");
-    printf("---------------------------\n");
-    printf("values:      [");
-    for (int i = 0; i < matrix->nnz && i < 20; i++) {
-        printf("%.1f", matrix->values[i]);
-        if (i < matrix->nnz - 1) printf(", ");
-    }
-    if (matrix->nnz > 20) printf(", ...");
-    printf("]\n");
-    
-    printf("col_indices: [");
-    for (int i = 0; i < matrix->nnz && i < 20; i++) {
-        printf("%d", matrix->col_indices[i]);
-        if (i < matrix->nnz - 1) printf(", ");
-    }
-    if (matrix->nnz > 20) printf(", ...");
-    printf("]\n");
-    
-    printf("row_ptr:     [");
-    for (int i = 0; i <= matrix->num_rows && i < 20; i++) {
-        printf("%d", matrix->row_ptr[i]);
-        if (i < matrix->num_rows) printf(", ");
-    }
-    if (matrix->num_rows > 20) printf(", ...");
-    printf("]\n");
-    printf("---------------------------\n");
+// Row-partitioned kernels against the nnz-balanced and merge-path kernels
+void benchmark_load_balance(CSRMatrix *A, const char *label) {
+    static const char *engines[] = {"static", "dynamic", "nnz_balanced", "merge_path"};
+    int num_engines = (int)(sizeof(engines) / sizeof(engines[0]));
+    int threads = omp_get_max_threads();
+    
+    double *x = (double *)malloc_array(A->num_cols, sizeof(double));
+    double *y = (double *)malloc_array(A->num_rows, sizeof(double));
+    double *reference = (double *)malloc_array(A->num_rows, sizeof(double));
+    if (!x || !y || !reference) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(x);
+        free(y);
+        free(reference);
+        return;
+    }
+    for (index_t i = 0; i < A->num_cols; i++) x[i] = 1.0 + (i % 7);
+    spmv_sequential(A, x, reference);
+    
+    index_t longest = 0;
+    for (index_t i = 0; i < A->num_rows; i++) {
+        index_t len = A->row_ptr[i + 1] - A->row_ptr[i];
+        if (len > longest) longest = len;
+    }
+    
+    printf("\n==============================================\n");
+    printf("  LOAD BALANCE: %s matrix\n", label);
+    printf("==============================================\n");
+    printf("Rows: %ld, non-zeros: %ld, mean row %.1f, longest row %ld\n", (long)A->num_rows,
+           (long)A->nnz, A->num_rows ? (double)A->nnz / A->num_rows : 0.0, (long)longest);
+    printf("Max/mean nnz per thread (%d threads): row blocks %.2f, nnz blocks %.2f\n", threads,
+           partition_imbalance(A, threads, 0), partition_imbalance(A, threads, 1));
+    
+    double flops = 2.0 * A->nnz;
+    double bytes = csr_matrix_bytes(A) + (double)(A->num_cols + A->num_rows) * sizeof(double);
+    double times[4];
+    int correct[4];
+    char name[48];
+    
+    for (int e = 0; e < num_engines; e++) {
+        snprintf(name, sizeof(name), "%s_%s", label, engines[e]);
+        printf("\n[%s]\n", name);
+        Benchmark b = bench_begin("sparse_matrix_vector", name, A->num_rows, flops, bytes);
+        while (bench_next(&b)) {
+            if (e == 0) spmv_parallel_static(A, x, y);
+            else if (e == 1) spmv_parallel_dynamic(A, x, y);
+            else if (e == 2) spmv_nnz_balanced(A, x, y);
+            else spmv_merge_path(A, x, y);
+        }
+        times[e] = bench_end(&b).median;
+        // merge_path sums split rows in a different order
+        correct[e] = verify_results(reference, y, A->num_rows, (e == 3) ? 1e-6 : 1e-9);
+    }
+    
+    printf("\n    %-14s %12s %10s %10s %8s\n", "Partition", "Median (ms)", "GFLOP/s", "vs static",
+           "Check");
+    for (int e = 0; e < num_engines; e++) {
+        printf("    %-14s %12.3f %10.3f %9.2fx %8s\n", engines[e], times[e] * 1e3,
+               flops / times[e] / 1e9, times[0] / times[e], correct[e] ? "✓" : "✗");
+    }
+    printf("==============================================\n");
+    
+    free(x);
+    free(y);
+    free(reference);
 }
 
-// Sequential sparse matrix-vector multiplication
-void spmv_sequential(CSRMatrix *A, double *x, double *y) {
-    for (int i = 0; i < A->num_rows; i++) {
-        double sum = 0.0;
-        for (int j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
-            sum += A->values[j] * x[A->col_indices[j]];
+// CSR against ELL, unsorted SELL-C-1 and SELL-C-sigma (SIMD gather kernels)
+void benchmark_formats(CSRMatrix *A, const char *label) {
+    static const struct {
+        const char *name;
+        index_t chunk;    // 0 = ELL (one slice of all rows)
+        index_t sigma;
+    } layouts[] = {
+        {"ell", 0, 1},
+        {"sell_8_1", SELL_DEFAULT_CHUNK, 1},
+        {"sell_8_512", SELL_DEFAULT_CHUNK, SELL_DEFAULT_SIGMA},
+        {"sell_32_4096", 32, 4096},
+    };
+    int num_layouts = (int)(sizeof(layouts) / sizeof(layouts[0]));
+    
+    double *x = (double *)malloc_array(A->num_cols, sizeof(double));
+    double *y = (double *)malloc_array(A->num_rows, sizeof(double));
+    double *reference = (double *)malloc_array(A->num_rows, sizeof(double));
+    if (!x || !y || !reference) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(x);
+        free(y);
+        free(reference);
+        return;
+    }
+    for (index_t i = 0; i < A->num_cols; i++) x[i] = 1.0 + (i % 7);
+    
+    RowLengthStats stats;
+    row_length_stats(A, &stats);
+    printf("\n==============================================\n");
+    printf("  STORAGE FORMATS: %s matrix (%s gathers)\n", label, simd_isa_name(vector_simd_isa()));
+    printf("==============================================\n");
+    printf("Row lengths: min %ld, max %ld, mean %.1f, cv %.2f -> auto-selected: %s\n",
+           (long)stats.min, (long)stats.max, stats.mean, stats.cv,
+           sparse_format_name(sparse_format_select(A)));
+    
+    double flops = 2.0 * A->nnz;
+    double vector_bytes = (double)(A->num_cols + A->num_rows) * sizeof(double);
+    char name[48];
+    
+    snprintf(name, sizeof(name), "%s_csr", label);
+    printf("\n[%s]\n", name);
+    Benchmark b_csr = bench_begin("sparse_matrix_vector", name, A->num_rows, flops,
+                                  csr_matrix_bytes(A) + vector_bytes);
+    while (bench_next(&b_csr)) {
+        spmv_parallel_dynamic(A, x, reference);
+    }
+    double time_csr = bench_end(&b_csr).median;
+    
+    double times[4], fill[4], bytes_per_nnz[4];
+    int measured[4], correct[4];
+    for (int k = 0; k < num_layouts; k++) {
+        fill[k] = layouts[k].chunk ? sell_fill_ratio(A, layouts[k].chunk, layouts[k].sigma)
+                                   : ell_fill_ratio(A);
+        measured[k] = 0;
+        if (fill[k] > MAX_FORMAT_FILL) {
+            printf("\n[%s_%s] skipped: %.1f stored slots per non-zero\n", label,
+                   layouts[k].name, fill[k]);
+            continue;
         }
-        y[i] = sum;
+        SellMatrix *S = layouts[k].chunk ? sell_from_csr(A, layouts[k].chunk, layouts[k].sigma)
+                                         : ell_from_csr(A);
+        if (!S) continue;
+        bytes_per_nnz[k] = (A->nnz > 0) ? sell_matrix_bytes(S) / A->nnz : 0.0;
+        
+        snprintf(name, sizeof(name), "%s_%s", label, layouts[k].name);
+        printf("\n[%s]\n", name);
+        Benchmark b = bench_begin("sparse_matrix_vector", name, A->num_rows, flops,
+                                  sell_matrix_bytes(S) + vector_bytes);
+        while (bench_next(&b)) {
+            sell_spmv(S, x, y);
+        }
+        times[k] = bench_end(&b).median;
+        correct[k] = verify_results(reference, y, A->num_rows, 1e-9);
+        measured[k] = 1;
+        free_sell_matrix(S);
+    }
+    
+    printf("\n    %-14s %10s %10s %12s %10s %9s %8s\n", "Format", "Padding", "Bytes/nnz",
+           "Median (ms)", "GFLOP/s", "vs CSR", "Check");
+    printf("    %-14s %9.1f%% %10.2f %12.3f %10.3f %8.2fx %8s\n", "csr", 0.0,
+           (A->nnz > 0) ? csr_matrix_bytes(A) / A->nnz : 0.0, time_csr * 1e3,
+           flops / time_csr / 1e9, 1.0, "-");
+    for (int k = 0; k < num_layouts; k++) {
+        if (!measured[k]) continue;
+        printf("    %-14s %9.1f%% %10.2f %12.3f %10.3f %8.2fx %8s\n", layouts[k].name,
+               (fill[k] - 1.0) * 100.0, bytes_per_nnz[k], times[k] * 1e3, flops / times[k] / 1e9,
+               time_csr / times[k], correct[k] ? "✓" : "✗");
     }
+    printf("==============================================\n");
+    
+    free(x);
+    free(y);
+    free(reference);
 }
 
-// Parallel SpMV with static scheduling
-void spmv_parallel_static(CSRMatrix *A, double *x, double *y) {
-    /*
-     * CORRECT IMPLEMENTATION: No synchronization needed
-     * 
-     * Key insight: Each row is computed independently
-     * - Thread i computes y[rows assigned to i]
-     * - Different threads write to different y[] elements
-     * - NO shared writes = NO atomic/critical sections needed
-     * 
-     * Static scheduling:
-     * - Good for uniform row workloads (regular sparsity)
-     * - May have load imbalance for irregular patterns
-     */
-    #pragma omp parallel
-    {
-        #pragma omp single
-        {
-            printf("    Using %d threads with STATIC scheduling\n", omp_get_num_threads());
+// k right-hand sides: k calls of spmv_parallel_dynamic vs one spmm_csr
+void benchmark_spmm(CSRMatrix *A) {
+    static const int rhs_counts[] = {8, 16, 32, 64};
+    int num_counts = (int)(sizeof(rhs_counts) / sizeof(rhs_counts[0]));
+    index_t rows = A->num_rows, cols = A->num_cols;
+    
+    printf("\n==============================================\n");
+    printf("  SpMM: %ld x %ld CSR times k vectors (%s)\n", (long)rows, (long)cols,
+           simd_isa_name(vector_simd_isa()));
+    printf("==============================================\n");
+    
+    double times_loop[4], times_spmm[4];
+    int correct[4], measured[4];
+    char name[48];
+    
+    for (int n = 0; n < num_counts; n++) {
+        int k = rhs_counts[n];
+        measured[n] = 0;
+        // Row-major blocks for SpMM, the same vectors one after another for SpMV
+        double *X = (double *)malloc_array((size_t)cols * k, sizeof(double));
+        double *Y = (double *)malloc_array((size_t)rows * k, sizeof(double));
+        double *X_vectors = (double *)malloc_array((size_t)cols * k, sizeof(double));
+        double *Y_vectors = (double *)malloc_array((size_t)rows * k, sizeof(double));
+        double *Y_check = (double *)malloc_array((size_t)rows * k, sizeof(double));
+        if (!X || !Y || !X_vectors || !Y_vectors || !Y_check) {
+            fprintf(stderr, "Memory allocation failed!\n");
+            free(X);
+            free(Y);
+            free(X_vectors);
+            free(Y_vectors);
+            free(Y_check);
+            break;
+        }
+        #pragma omp parallel for schedule(static)
+        for (index_t c = 0; c < cols; c++) {
+            for (int r = 0; r < k; r++) {
+                X[(size_t)c * k + r] = 1.0 + ((c + r) % 7);
+                X_vectors[(size_t)r * cols + c] = X[(size_t)c * k + r];
+            }
         }
         
-        // Parallelize over rows - each row is independent
-        #pragma omp for schedule(static)
-        for (int i = 0; i < A->num_rows; i++) {
-            double sum = 0.0;
-            for (int j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
-                sum += A->values[j] * x[A->col_indices[j]];
+        double flops = 2.0 * A->nnz * k;
+        double vector_bytes = (double)(cols + rows) * k * sizeof(double);
+        
+        snprintf(name, sizeof(name), "spmv_x%d", k);
+        printf("\n[%s]\n", name);
+        Benchmark b_loop = bench_begin("sparse_matrix_vector", name, rows, flops,
+                                       k * csr_matrix_bytes(A) + vector_bytes);
+        while (bench_next(&b_loop)) {
+            for (int r = 0; r < k; r++) {
+                spmv_parallel_dynamic(A, X_vectors + (size_t)r * cols, Y_vectors + (size_t)r * rows);
             }
-            y[i] = sum;  // No race condition - this thread owns y[i]
         }
+        times_loop[n] = bench_end(&b_loop).median;
+        
+        snprintf(name, sizeof(name), "spmm_%d", k);
+        printf("\n[%s]\n", name);
+        Benchmark b_spmm = bench_begin("sparse_matrix_vector", name, rows, flops,
+                                       csr_matrix_bytes(A) + vector_bytes);
+        while (bench_next(&b_spmm)) {
+            spmm_csr(A, X, Y, k);
+        }
+        times_spmm[n] = bench_end(&b_spmm).median;
+        
+        // Compare in the SpMV layout; FMA may round the sums differently
+        #pragma omp parallel for schedule(static)
+        for (index_t i = 0; i < rows; i++) {
+            for (int r = 0; r < k; r++) Y_check[(size_t)r * rows + i] = Y[(size_t)i * k + r];
+        }
+        correct[n] = verify_results(Y_vectors, Y_check, (long)rows * k, 1e-6);
+        measured[n] = 1;
+        
+        free(X);
+        free(Y);
+        free(X_vectors);
+        free(Y_vectors);
+        free(Y_check);
     }
+    
+    printf("\n    %4s %14s %12s %10s %10s %8s\n", "k", "k x SpMV (ms)", "SpMM (ms)", "GFLOP/s",
+           "Speedup", "Check");
+    for (int n = 0; n < num_counts; n++) {
+        if (!measured[n]) continue;
+        printf("    %4d %14.3f %12.3f %10.3f %9.2fx %8s\n", rhs_counts[n], times_loop[n] * 1e3,
+               times_spmm[n] * 1e3, 2.0 * A->nnz * rhs_counts[n] / times_spmm[n] / 1e9,
+               times_loop[n] / times_spmm[n], correct[n] ? "✓" : "✗");
+    }
+    printf("==============================================\n");
 }
 
-// Parallel SpMV with dynamic scheduling
-void spmv_parallel_dynamic(CSRMatrix *A, double *x, double *y) {
-    /*
-     * OPTIMIZED IMPLEMENTATION: Dynamic scheduling for load balancing
-     * 
-     * Why dynamic scheduling is better for sparse matrices:
-     * - Rows can have vastly different numbers of non-zeros
-     * - Static gives equal rows to each thread → unequal work
-     * - Dynamic distributes work at runtime → better balance
-     * 
-     * Adaptive chunk size:
-     * - Too small (1): High scheduling overhead
-     * - Too large (1000s): Poor load balancing
-     * - Optimal: ~10-100 rows per chunk
-     */
-    #pragma omp parallel
-    {
-        int num_threads;
-        int chunk_size;
+static void print_locality(const char *label, const LocalityStats *stats) {
+    printf("    %-10s bandwidth %10ld  profile %12.4g  reuse distance %10.1f nnz  hit rate %5.1f%%\n",
+           label, (long)stats->bandwidth, stats->profile, stats->mean_reuse_nnz,
+           stats->reuse_hit_rate * 100.0);
+}
+
+// Reorder, compare locality and SpMV time, and amortize the reordering cost
+void benchmark_reordering(CSRMatrix *A) {
+    static const ReorderKind kinds[] = {REORDER_RCM, REORDER_DEGREE};
+    int num_kinds = (int)(sizeof(kinds) / sizeof(kinds[0]));
+    index_t n = A->num_rows;
+    
+    printf("\n==============================================\n");
+    printf("  REORDERING: %ld x %ld, %ld non-zeros\n", (long)n, (long)A->num_cols, (long)A->nnz);
+    printf("==============================================\n");
+    if (A->num_rows != A->num_cols) {
+        printf("Skipped: reordering needs a square matrix\n");
+        return;
+    }
+    
+    double *x = (double *)malloc_array(n, sizeof(double));
+    double *x_perm = (double *)malloc_array(n, sizeof(double));
+    double *y = (double *)malloc_array(n, sizeof(double));
+    double *y_perm = (double *)malloc_array(n, sizeof(double));
+    double *reference = (double *)malloc_array(n, sizeof(double));
+    if (!x || !x_perm || !y || !y_perm || !reference) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(x);
+        free(x_perm);
+        free(y);
+        free(y_perm);
+        free(reference);
+        return;
+    }
+    for (index_t i = 0; i < n; i++) x[i] = 1.0 + (i % 7);
+    
+    LocalityStats before;
+    locality_stats(A, 0, &before);
+    print_locality("original", &before);
+    
+    double flops = 2.0 * A->nnz;
+    double bytes = csr_matrix_bytes(A) + 2.0 * n * sizeof(double);
+    printf("\n[reorder_original]\n");
+    Benchmark b_orig = bench_begin("sparse_matrix_vector", "reorder_original", n, flops, bytes);
+    while (bench_next(&b_orig)) {
+        spmv_parallel_dynamic(A, x, reference);
+    }
+    double time_orig = bench_end(&b_orig).median;
+    
+    double costs[2], times[2];
+    int measured[2], correct[2];
+    LocalityStats after[2];
+    char name[48];
+    for (int k = 0; k < num_kinds; k++) {
+        measured[k] = 0;
+        // One-off cost: permutation, permuted matrix and permuted x
+        double start = omp_get_wtime();
+        index_t *perm = reorder_permutation(A, kinds[k]);
+        CSRMatrix *B = perm ? csr_permute(A, perm) : NULL;
+        if (B) permute_vector(x, perm, n, x_perm);
+        costs[k] = omp_get_wtime() - start;
+        if (!B) {
+            free(perm);
+            continue;
+        }
+        
+        locality_stats(B, 0, &after[k]);
+        print_locality(reorder_name(kinds[k]), &after[k]);
         
-        #pragma omp single
-        {
-            num_threads = omp_get_num_threads();
-            // Adaptive chunk size: aim for ~100 chunks per thread
-            chunk_size = (A->num_rows / (num_threads * 100));
-            if (chunk_size < 10) chunk_size = 10;
-            if (chunk_size > 1000) chunk_size = 1000;
-            
-            printf("    Using %d threads with DYNAMIC scheduling (chunk=%d)\n", 
-                   num_threads, chunk_size);
+        snprintf(name, sizeof(name), "reorder_%s", reorder_name(kinds[k]));
+        printf("\n[%s]\n", name);
+        Benchmark b = bench_begin("sparse_matrix_vector", name, n, flops, bytes);
+        while (bench_next(&b)) {
+            spmv_parallel_dynamic(B, x_perm, y_perm);
         }
+        times[k] = bench_end(&b).median;
+        unpermute_vector(y_perm, perm, n, y);
+        correct[k] = verify_results(reference, y, n, 1e-9);
+        measured[k] = 1;
         
-        // Dynamic scheduling: runtime load balancing for irregular workloads
-        // Each thread computes different rows - no synchronization needed
-        #pragma omp for schedule(dynamic, chunk_size)
-        for (int i = 0; i < A->num_rows; i++) {
-            double sum = 0.0;
-            for (int j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
-                sum += A->values[j] * x[A->col_indices[j]];
-            }
-            y[i] = sum;  // No race condition - exclusive ownership
+        free_csr_matrix(B);
+        free(perm);
+    }
+    
+    printf("\n    %-10s %10s %10s %12s %12s %10s %14s %8s\n", "Ordering", "Bandwidth",
+           "Hit rate", "Median (ms)", "Cost (ms)", "Speedup", "Break-even", "Check");
+    printf("    %-10s %10ld %9.1f%% %12.3f %12s %9.2fx %14s %8s\n", "none", (long)before.bandwidth,
+           before.reuse_hit_rate * 100.0, time_orig * 1e3, "-", 1.0, "-", "-");
+    for (int k = 0; k < num_kinds; k++) {
+        if (!measured[k]) continue;
+        // SpMVs needed before the saved time covers the reordering cost
+        char break_even[32];
+        if (times[k] < time_orig) {
+            snprintf(break_even, sizeof(break_even), "%.0f SpMVs",
+                     ceil(costs[k] / (time_orig - times[k])));
+        } else {
+            snprintf(break_even, sizeof(break_even), "never");
         }
+        printf("    %-10s %10ld %9.1f%% %12.3f %12.3f %9.2fx %14s %8s\n", reorder_name(kinds[k]),
+               (long)after[k].bandwidth, after[k].reuse_hit_rate * 100.0, times[k] * 1e3,
+               costs[k] * 1e3, time_orig / times[k], break_even, correct[k] ? "✓" : "✗");
     }
+    printf("==============================================\n");
+    
+    free(x);
+    free(x_perm);
+    free(y);
+    free(y_perm);
+    free(reference);
 }
 
-// Verify results
-int verify_results(double *y1, double *y2, int size) {
-    double tolerance = 1e-9;
-    int errors = 0;
-    
-    for (int i = 0; i < size; i++) {
-        if (fabs(y1[i] - y2[i]) > tolerance) {
-            errors++;
-            if (errors <= 5) {
-                printf("    Error at index %d: y1=%.6f, y2=%.6f\n", i, y1[i], y2[i]);
-            }
+// max |y - reference| / max |reference|
+static double normwise_error(const double *reference, const double *y, index_t n) {
+    double error = 0.0, scale = 0.0;
+    #pragma omp parallel for schedule(static) reduction(max:error, scale)
+    for (index_t i = 0; i < n; i++) {
+        double diff = fabs(y[i] - reference[i]);
+        if (diff > error) error = diff;
+        if (fabs(reference[i]) > scale) scale = fabs(reference[i]);
+    }
+    return (scale > 0.0) ? error / scale : error;
+}
+
+// Compressed CSR: every column codec with every value precision against CSR
+void benchmark_compression(CSRMatrix *A) {
+    static const ColumnCodec codecs[] = {COLUMN_CODEC_VARINT, COLUMN_CODEC_BLOCK16};
+    static const ValuePrecision precisions[] = {
+        VALUE_PRECISION_DOUBLE, VALUE_PRECISION_FLOAT, VALUE_PRECISION_HALF
+    };
+    // Normwise error allowed per precision (unit roundoff with headroom)
+    static const double tolerances[] = {1e-12, 1e-6, 1e-3};
+    int num_variants = 6;
+    
+    double *x = (double *)malloc_array(A->num_cols, sizeof(double));
+    double *y = (double *)malloc_array(A->num_rows, sizeof(double));
+    double *reference = (double *)malloc_array(A->num_rows, sizeof(double));
+    if (!x || !y || !reference) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(x);
+        free(y);
+        free(reference);
+        return;
+    }
+    for (index_t i = 0; i < A->num_cols; i++) x[i] = 1.0 + (i % 7);
+    
+    printf("\n==============================================\n");
+    printf("  COMPRESSED CSR: %ld x %ld, %ld non-zeros\n", (long)A->num_rows, (long)A->num_cols,
+           (long)A->nnz);
+    printf("==============================================\n");
+    
+    double flops = 2.0 * A->nnz;
+    double vector_bytes = (double)(A->num_cols + A->num_rows) * sizeof(double);
+    printf("\n[compressed_csr_baseline]\n");
+    Benchmark b_csr = bench_begin("sparse_matrix_vector", "compressed_csr_baseline", A->num_rows,
+                                  flops, csr_matrix_bytes(A) + vector_bytes);
+    while (bench_next(&b_csr)) {
+        spmv_parallel_dynamic(A, x, reference);
+    }
+    double time_csr = bench_end(&b_csr).median;
+    
+    double times[6], bytes_per_nnz[6], errors[6];
+    int measured[6];
+    char name[48];
+    for (int v = 0; v < num_variants; v++) {
+        ColumnCodec codec = codecs[v / 3];
+        ValuePrecision precision = precisions[v % 3];
+        measured[v] = 0;
+        CompressedCSR *M = compressed_csr_from_csr(A, codec, precision);
+        if (!M) continue;
+        bytes_per_nnz[v] = (A->nnz > 0) ? compressed_csr_bytes(M) / A->nnz : 0.0;
+        
+        snprintf(name, sizeof(name), "compressed_%s_%s", column_codec_name(codec),
+                 value_precision_name(precision));
+        printf("\n[%s]\n", name);
+        Benchmark b = bench_begin("sparse_matrix_vector", name, A->num_rows, flops,
+                                  compressed_csr_bytes(M) + vector_bytes);
+        while (bench_next(&b)) {
+            spmv_compressed(M, x, y);
         }
+        times[v] = bench_end(&b).median;
+        errors[v] = normwise_error(reference, y, A->num_rows);
+        measured[v] = 1;
+        free_compressed_csr(M);
     }
     
-    if (errors > 5) {
-        printf("    ... and %d more errors\n", errors - 5);
+    printf("\n    %-8s %-7s %10s %12s %10s %9s %10s %6s\n", "Columns", "Values", "Bytes/nnz",
+           "Median (ms)", "GFLOP/s", "vs CSR", "Error", "Check");
+    printf("    %-8s %-7s %10.2f %12.3f %10.3f %8.2fx %10s %6s\n", "csr", "double",
+           (A->nnz > 0) ? csr_matrix_bytes(A) / A->nnz : 0.0, time_csr * 1e3,
+           flops / time_csr / 1e9, 1.0, "-", "-");
+    for (int v = 0; v < num_variants; v++) {
+        if (!measured[v]) continue;
+        printf("    %-8s %-7s %10.2f %12.3f %10.3f %8.2fx %10.1e %6s\n",
+               column_codec_name(codecs[v / 3]), value_precision_name(precisions[v % 3]),
+               bytes_per_nnz[v], times[v] * 1e3, flops / times[v] / 1e9, time_csr / times[v],
+               errors[v], errors[v] <= tolerances[v % 3] ? "✓" : "✗");
     }
+    printf("==============================================\n");
     
-    return (errors == 0);
+    free(x);
+    free(y);
+    free(reference);
 }
 
-// Print vector
-void print_vector(double *vec, int size, const char *name) {
-    printf("\n%s: [", name);
-    int print_count = (size < 10) ? size : 10;
-    for (int i = 0; i < print_count; i++) {
-        printf("%.1f", vec[i]);
-        if (i < print_count - 1) printf(", ");
-    }
-    if (size > 10) printf(", ...");
-    printf("]\n");
+// Symmetric SpMV from the upper triangle vs full CSR; A^T x directly vs
+// through an explicit transpose
+void benchmark_symmetric(CSRMatrix *A) {
+    printf("\n==============================================\n");
+    printf("  SYMMETRIC AND TRANSPOSED PRODUCTS\n");
+    printf("==============================================\n");
+    if (A->num_rows != A->num_cols) {
+        printf("Skipped: symmetric storage needs a square matrix\n");
+        return;
+    }
+    index_t n = A->num_rows;
+    
+    // Symmetric test matrix: A itself, or A's upper triangle mirrored
+    CSRMatrix *F = A;
+    if (!csr_is_symmetric(A)) {
+        F = csr_symmetrize_upper(A);
+        if (!F) return;
+        printf("Matrix is not symmetric: using its upper triangle mirrored (%ld non-zeros)\n",
+               (long)F->nnz);
+    }
+    double build_start = omp_get_wtime();
+    SymmetricCSR *S = symmetric_from_csr(F);
+    double build_time = omp_get_wtime() - build_start;
+    double transpose_start = omp_get_wtime();
+    CSRMatrix *T = csr_transpose(A);
+    double transpose_time = omp_get_wtime() - transpose_start;
+    
+    double *x = (double *)malloc_array(n, sizeof(double));
+    double *y = (double *)malloc_array(n, sizeof(double));
+    double *reference = (double *)malloc_array(n, sizeof(double));
+    if (!S || !T || !x || !y || !reference) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_symmetric_csr(S);
+        free_csr_matrix(T);
+        if (F != A) free_csr_matrix(F);
+        free(x);
+        free(y);
+        free(reference);
+        return;
+    }
+    for (index_t i = 0; i < n; i++) x[i] = 1.0 + (i % 7);
+    double vector_bytes = 2.0 * n * sizeof(double);
+    
+    printf("\n[symmetric_full_csr]\n");
+    Benchmark b_full = bench_begin("sparse_matrix_vector", "symmetric_full_csr", n, 2.0 * F->nnz,
+                                   csr_matrix_bytes(F) + vector_bytes);
+    while (bench_next(&b_full)) {
+        spmv_parallel_dynamic(F, x, reference);
+    }
+    double time_full = bench_end(&b_full).median;
+    
+    printf("\n[symmetric_upper]\n");
+    Benchmark b_upper = bench_begin("sparse_matrix_vector", "symmetric_upper", n, 2.0 * F->nnz,
+                                    symmetric_csr_bytes(S) + vector_bytes);
+    while (bench_next(&b_upper)) {
+        spmv_symmetric(S, x, y);
+    }
+    double time_upper = bench_end(&b_upper).median;
+    double error_upper = normwise_error(reference, y, n);
+    
+    printf("\n[transpose_explicit]\n");
+    Benchmark b_explicit = bench_begin("sparse_matrix_vector", "transpose_explicit", n,
+                                       2.0 * A->nnz, csr_matrix_bytes(T) + vector_bytes);
+    while (bench_next(&b_explicit)) {
+        spmv_parallel_dynamic(T, x, reference);
+    }
+    double time_explicit = bench_end(&b_explicit).median;
+    
+    printf("\n[transpose_direct]\n");
+    Benchmark b_direct = bench_begin("sparse_matrix_vector", "transpose_direct", n, 2.0 * A->nnz,
+                                     csr_matrix_bytes(A) + vector_bytes);
+    while (bench_next(&b_direct)) {
+        spmv_transpose(A, x, y);
+    }
+    double time_direct = bench_end(&b_direct).median;
+    double error_direct = normwise_error(reference, y, n);
+    
+    printf("\n    %-20s %12s %12s %12s %10s %8s\n", "Product", "Matrix (MB)", "Setup (ms)",
+           "Median (ms)", "GFLOP/s", "Check");
+    printf("    %-20s %12.2f %12s %12.3f %10.3f %8s\n", "A x (full CSR)",
+           csr_matrix_bytes(F) / 1e6, "-", time_full * 1e3, 2.0 * F->nnz / time_full / 1e9, "-");
+    printf("    %-20s %12.2f %12.3f %12.3f %10.3f %8s\n", "A x (upper only)",
+           symmetric_csr_bytes(S) / 1e6, build_time * 1e3, time_upper * 1e3,
+           2.0 * F->nnz / time_upper / 1e9, error_upper <= 1e-12 ? "✓" : "✗");
+    printf("    %-20s %12.2f %12.3f %12.3f %10.3f %8s\n", "A^T x (transpose)",
+           csr_matrix_bytes(T) / 1e6, transpose_time * 1e3, time_explicit * 1e3,
+           2.0 * A->nnz / time_explicit / 1e9, "-");
+    printf("    %-20s %12.2f %12s %12.3f %10.3f %8s\n", "A^T x (direct)",
+           csr_matrix_bytes(A) / 1e6, "-", time_direct * 1e3, 2.0 * A->nnz / time_direct / 1e9,
+           error_direct <= 1e-12 ? "✓" : "✗");
+    printf("==============================================\n");
+    
+    free_symmetric_csr(S);
+    free_csr_matrix(T);
+    if (F != A) free_csr_matrix(F);
+    free(x);
+    free(y);
+    free(reference);
+}
+
+// One solve of A x = b from x = 0 (after an untimed warm-up solve); prints a
+// table row, returns 1 when the true residual confirms convergence
+static int run_solver(const char *label, SolverResult (*solve)(CSRMatrix *, const double *,
+                      double *, const SolverOptions *), CSRMatrix *A, const double *b, double *x,
+                      const SolverOptions *opt) {
+    index_t n = A->num_rows;
+    SolverResult r = {0, 0, 0.0, 0.0, 0.0, 0.0};
+    for (int run = 0; run < 2; run++) {
+        for (index_t i = 0; i < n; i++) x[i] = 0.0;
+        r = solve(A, b, x, opt);
+    }
+    double true_residual = solver_true_residual(A, b, x);
+    int ok = r.converged && true_residual <= 10.0 * opt->tolerance;
+    int it = (r.iterations > 0) ? r.iterations : 1;
+    double per_iteration = r.seconds / it;
+    printf("    %-22s %6d %10.2e %14.4f %10.2f %10.3f %8s\n", label, r.iterations,
+           true_residual, per_iteration * 1e3, r.bytes_per_iteration / per_iteration / 1e9,
+           r.flops_per_iteration / per_iteration / 1e9, ok ? "✓" : "✗");
+    return ok;
+}
+
+// CG on a symmetric positive definite version of A (upper triangle mirrored,
+// diagonal made dominant), BiCGSTAB on A with a dominant diagonal
+void benchmark_solvers(CSRMatrix *A) {
+    printf("\n==============================================\n");
+    printf("  ITERATIVE SOLVERS (CG, BiCGSTAB)\n");
+    printf("==============================================\n");
+    if (A->num_rows != A->num_cols) {
+        printf("Skipped: solvers need a square matrix\n");
+        return;
+    }
+    index_t n = A->num_rows;
+    CSRMatrix *F = csr_is_symmetric(A) ? A : csr_symmetrize_upper(A);
+    CSRMatrix *spd = F ? csr_diagonally_dominant(F, 1.0) : NULL;
+    CSRMatrix *general = csr_diagonally_dominant(A, 1.0);
+    double *b = (double *)malloc_array(n, sizeof(double));
+    double *x = (double *)malloc_array(n, sizeof(double));
+    if (!F || !spd || !general || !b || !x) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        if (F && F != A) free_csr_matrix(F);
+        free_csr_matrix(spd);
+        free_csr_matrix(general);
+        free(b);
+        free(x);
+        return;
+    }
+    if (F != A) free_csr_matrix(F);
+    for (index_t i = 0; i < n; i++) b[i] = 1.0 + (i % 5);
+    printf("Threads: %d, tolerance %.0e, at most %d iterations\n", omp_get_max_threads(),
+           SOLVER_TOLERANCE, SOLVER_MAX_ITERATIONS);
+    printf("SPD matrix (CG): %ld non-zeros, general matrix (BiCGSTAB): %ld non-zeros\n",
+           (long)spd->nnz, (long)general->nnz);
+    
+    SolverOptions plain = {SOLVER_MAX_ITERATIONS, SOLVER_TOLERANCE, 0};
+    SolverOptions jacobi = {SOLVER_MAX_ITERATIONS, SOLVER_TOLERANCE, 1};
+    printf("\n    %-22s %6s %10s %14s %10s %10s %8s\n", "Solver", "Iters", "Residual",
+           "Per iter (ms)", "GB/s", "GFLOP/s", "Check");
+    run_solver("CG (unfused)", cg_solve_unfused, spd, b, x, &plain);
+    run_solver("CG (fused)", cg_solve, spd, b, x, &plain);
+    run_solver("CG + Jacobi (unfused)", cg_solve_unfused, spd, b, x, &jacobi);
+    run_solver("CG + Jacobi (fused)", cg_solve, spd, b, x, &jacobi);
+    run_solver("BiCGSTAB", bicgstab_solve, general, b, x, &plain);
+    run_solver("BiCGSTAB + Jacobi", bicgstab_solve, general, b, x, &jacobi);
+    printf("Residual: true ||b - Ax|| / ||b||; GB/s from the streaming model per iteration\n");
+    printf("==============================================\n");
+    
+    free_csr_matrix(spd);
+    free_csr_matrix(general);
+    free(b);
+    free(x);
+}
+
+// C = A * A (A * A^T if A is not square) with every accumulator against the
+// sequential reference; products beyond SPGEMM_MAX_PRODUCTS switch to a
+// random matrix with the same rows and SPGEMM_ROW_NNZ non-zeros per row
+void benchmark_spgemm(CSRMatrix *A) {
+    printf("\n==============================================\n");
+    printf("  SPARSE MATRIX-MATRIX PRODUCT (SpGEMM)\n");
+    printf("==============================================\n");
+    CSRMatrix *B = (A->num_rows == A->num_cols) ? A : csr_transpose(A);
+    CSRMatrix *left = A;
+    double products = B ? spgemm_products(A, B) : 0.0;
+    if (B && products > SPGEMM_MAX_PRODUCTS) {
+        printf("A * B needs %.3g multiply-adds: using a random %ld x %ld matrix with %d "
+               "non-zeros per row\n", products, (long)A->num_rows, (long)A->num_rows,
+               SPGEMM_ROW_NNZ);
+        if (B != A) free_csr_matrix(B);
+        left = create_random_sparse_matrix(A->num_rows, A->num_rows,
+                                           (double)SPGEMM_ROW_NNZ / A->num_rows);
+        B = left;
+        products = left ? spgemm_products(left, B) : 0.0;
+    }
+    double start = omp_get_wtime();
+    CSRMatrix *reference = B ? spgemm_sequential(left, B) : NULL;
+    double sequential_time = omp_get_wtime() - start;
+    if (!reference) {
+        if (B && B != A) free_csr_matrix(B);
+        if (left != A) free_csr_matrix(left);
+        return;
+    }
+    // Both phases read A and the gathered rows of B, the numeric one writes C
+    double bytes = 2.0 * (csr_matrix_bytes(left) + products * (sizeof(double) + sizeof(col_index_t)))
+                 + csr_matrix_bytes(reference);
+    printf("%ld x %ld times %ld x %ld: %.3g multiply-adds, C has %ld non-zeros "
+           "(%.2f products per entry)\n", (long)left->num_rows, (long)left->num_cols,
+           (long)B->num_rows, (long)B->num_cols, products, (long)reference->nnz,
+           reference->nnz > 0 ? products / reference->nnz : 0.0);
+    
+    SpgemmAccumulator accumulators[3] = {SPGEMM_HASH, SPGEMM_DENSE, SPGEMM_AUTO};
+    SpgemmStats stats[3];
+    memset(stats, 0, sizeof(stats));
+    double times[3];
+    int correct[3];
+    for (int a = 0; a < 3; a++) {
+        char name[32];
+        snprintf(name, sizeof(name), "spgemm_%s", spgemm_accumulator_name(accumulators[a]));
+        printf("\n[%s]\n", name);
+        CSRMatrix *C = NULL;
+        Benchmark b = bench_begin("sparse_matrix_vector", name, left->num_rows, 2.0 * products,
+                                  bytes);
+        while (bench_next(&b)) {
+            free_csr_matrix(C);
+            C = spgemm(left, B, accumulators[a], &stats[a]);
+        }
+        times[a] = bench_end(&b).median;
+        correct[a] = C && csr_matrices_match(C, reference, 1e-12);
+        free_csr_matrix(C);
+    }
+    
+    printf("\n    %-12s %10s %10s %12s %12s %12s %10s %8s\n", "Accumulator", "Hash rows",
+           "Dense rows", "Symbolic(ms)", "Numeric(ms)", "Median (ms)", "GFLOP/s", "Check");
+    printf("    %-12s %10s %10s %12s %12s %12.3f %10.3f %8s\n", "sequential", "-", "-", "-", "-",
+           sequential_time * 1e3, 2.0 * products / sequential_time / 1e9, "-");
+    for (int a = 0; a < 3; a++) {
+        printf("    %-12s %10ld %10ld %12.3f %12.3f %12.3f %10.3f %8s\n",
+               spgemm_accumulator_name(accumulators[a]), (long)stats[a].hash_rows,
+               (long)stats[a].dense_rows, stats[a].symbolic_seconds * 1e3,
+               stats[a].numeric_seconds * 1e3, times[a] * 1e3, 2.0 * products / times[a] / 1e9,
+               correct[a] ? "✓" : "✗");
+    }
+    printf("Phase times are from the last run; auto picks dense while one accumulator\n");
+    printf("per thread fits the last-level cache, else per row by product count\n");
+    printf("==============================================\n");
+    
+    free_csr_matrix(reference);
+    if (B != A && B != left) free_csr_matrix(B);
+    if (left != A) free_csr_matrix(left);
 }
 
+// Batches of random inserts / deletes, each followed by one SpMV: merged
+// into a fresh CSR per batch (rebuild) or kept in delta buffers until the
+// compaction threshold (delta). Both see the same batches.
+void benchmark_dynamic(CSRMatrix *A) {
+    printf("\n==============================================\n");
+    printf("  DYNAMIC UPDATES (CSR + delta buffers)\n");
+    printf("==============================================\n");
+    index_t batch = DYNAMIC_BATCH_UPDATES;
+    double *x = (double *)malloc_array(A->num_cols, sizeof(double));
+    double *y = (double *)malloc_array(A->num_rows, sizeof(double));
+    double *y_ref = (double *)malloc_array(A->num_rows, sizeof(double));
+    if (!x || !y || !y_ref) {
+        free(x);
+        free(y);
+        free(y_ref);
+        return;
+    }
+    for (index_t i = 0; i < A->num_cols; i++) x[i] = 1.0 + (i % 7);
+    printf("%ld non-zeros; batches of %ld updates (%.0f%% deletes), each followed by one SpMV;\n"
+           "delta compacts at %.0f%% pending changes\n", (long)A->nnz, (long)batch,
+           DYNAMIC_DELETE_SHARE * 100.0, DYNAMIC_COMPACT_RATIO * 100.0);
+    
+    double flops = 2.0 * A->nnz;
+    double vector_bytes = (double)(A->num_cols + A->num_rows) * sizeof(double);
+    double bytes = csr_matrix_bytes(A) + vector_bytes + (double)batch * sizeof(SparseUpdate);
+    const char *names[2] = {"dynamic_rebuild", "dynamic_delta"};
+    double times[2] = {0.0, 0.0}, update_ms[2] = {0.0, 0.0}, compact_ms[2] = {0.0, 0.0};
+    long compactions[2] = {0, 0};
+    int correct[2] = {0, 0};
+    CSRMatrix *final[2] = {NULL, NULL};
+    double pending_time = 0.0, compacted_time = 0.0;
+    index_t pending = 0;
+    for (int s = 0; s < 2; s++) {
+        DynamicCSR *D = dynamic_csr_create(A, (s == 0) ? INFINITY : 0.0);
+        if (!D) continue;
+        printf("\n[%s]\n", names[s]);
+        Benchmark b = bench_begin("sparse_matrix_vector", names[s], A->num_rows, flops, bytes);
+        int runs = b.result.warmup + b.result.reps;
+        SparseUpdate *updates = (SparseUpdate *)malloc_array((size_t)runs * batch,
+                                                             sizeof(SparseUpdate));
+        int applied = (updates != NULL);
+        for (int r = 0; applied && r < runs; r++) {
+            dynamic_random_updates(A, batch, DYNAMIC_DELETE_SHARE, SPARSE_RANDOM_SEED, r,
+                                   updates + (size_t)r * batch);
+        }
+        while (bench_next(&b)) {
+            if (!applied) continue;
+            applied &= dynamic_csr_apply(D, updates + (size_t)(b.iteration - 1) * batch, batch);
+            if (s == 0) applied &= dynamic_csr_compact(D);
+            dynamic_csr_spmv(D, x, y);
+        }
+        times[s] = bench_end(&b).median;
+        free(updates);
+        update_ms[s] = D->update_seconds / runs * 1e3;
+        compact_ms[s] = D->compactions ? D->compact_seconds / D->compactions * 1e3 : 0.0;
+        compactions[s] = D->compactions;
+        
+        final[s] = applied ? dynamic_csr_snapshot(D) : NULL;
+        if (final[s]) {
+            spmv_sequential(final[s], x, y_ref);
+            correct[s] = verify_results(y_ref, y, A->num_rows, 1e-9);
+        }
+        
+        // The SpMV alone: base + delta runs against the compacted matrix
+        if (s == 1 && final[s]) {
+            pending = D->delta_count + D->removed_count;
+            printf("\n[dynamic_spmv_pending]\n");
+            Benchmark bp = bench_begin("sparse_matrix_vector", "dynamic_spmv_pending",
+                                       A->num_rows, 2.0 * dynamic_csr_nnz(D),
+                                       dynamic_csr_bytes(D) + vector_bytes);
+            while (bench_next(&bp)) {
+                dynamic_csr_spmv(D, x, y);
+            }
+            pending_time = bench_end(&bp).median;
+            printf("\n[dynamic_spmv_compacted]\n");
+            Benchmark bc = bench_begin("sparse_matrix_vector", "dynamic_spmv_compacted",
+                                       A->num_rows, 2.0 * final[s]->nnz,
+                                       csr_matrix_bytes(final[s]) + vector_bytes);
+            while (bench_next(&bc)) {
+                spmv_nnz_balanced(final[s], x, y);
+            }
+            compacted_time = bench_end(&bc).median;
+        }
+        free_dynamic_csr(D);
+    }
+    int same = final[0] && final[1] && csr_matrices_match(final[0], final[1], 0.0);
+    
+    printf("\n    %-10s %12s %14s %12s %14s %8s\n", "Strategy", "Median (ms)", "Update (ms)",
+           "Compactions", "Compact (ms)", "Check");
+    for (int s = 0; s < 2; s++) {
+        printf("    %-10s %12.3f %14.3f %12ld %14.3f %8s\n", names[s] + 8, times[s] * 1e3,
+               update_ms[s], compactions[s], compact_ms[s], correct[s] ? "✓" : "✗");
+    }
+    printf("Times per batch + SpMV; update and compaction times are means over all runs\n");
+    printf("Both strategies end with the same matrix: %s\n", same ? "✓" : "✗");
+    if (compacted_time > 0.0) {
+        printf("SpMV with %ld pending changes: %.3f ms (%.3f ms compacted, %.2fx)\n",
+               (long)pending, pending_time * 1e3, compacted_time * 1e3,
+               pending_time / compacted_time);
+    }
+    printf("==============================================\n");
+    
+    free_csr_matrix(final[0]);
+    free_csr_matrix(final[1]);
+    free(x);
+    free(y);
+    free(y_ref);
+}
+
+// Print the structure statistics of A with the advice, and attach them to
+// every following JSON benchmark result
+static void analyze_matrix(CSRMatrix *A, SpmvAdvice *advice) {
+    SparseMatrixStats stats;
+    double start = omp_get_wtime();
+    sparse_matrix_stats(A, 0, &stats);
+    spmv_advise(&stats, advice);
+    printf("\nMatrix structure (%.3f s to analyze):\n", omp_get_wtime() - start);
+    sparse_stats_print(&stats, advice);
+    char json[1024];
+    if (sparse_stats_json(&stats, advice, json, sizeof(json))) bench_set_json_fields(json);
+}
@@ -0,0 +1,343 @@
+/*
+ * Shared: Arena Allocator with Huge Pages and Pre-Faulting
+ * 
+ * See arena.h for the page options and the reuse rule.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <omp.h>
+
+#include "arena.h"
+#include "index_types.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#define SMALL_PAGE (4UL << 10)
+#define HUGE_PAGE_2MB (2UL << 20)
+#define HUGE_PAGE_1GB (1UL << 30)
+
+// In front of every allocation (ARENA_ALIGN bytes, keeps the block aligned);
+// links the live blocks newest first, so frees can be reclaimed in order
+typedef struct ArenaBlock {
+    struct ArenaBlock *prev;  // Allocated before this one
+    size_t bytes;             // Header included
+    size_t prev_used;         // Region fill before this block
+    int region;
+    int prev_current;
+    int freed;
+} ArenaBlock;
+
+static size_t page_bytes(PageSize pages) {
+    switch (pages) {
+    case PAGES_HUGE_1GB: return HUGE_PAGE_1GB;
+    case PAGES_HUGE_2MB:
+    case PAGES_TRANSPARENT: return HUGE_PAGE_2MB;
+    default: return SMALL_PAGE;
+    }
+}
+
+static size_t round_up(size_t bytes, size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+// Fault every page of the range in with one call where the kernel allows it
+static void populate_range(char *base, size_t bytes) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(base, bytes, MADV_POPULATE_WRITE) == 0) return;
+#endif
+    for (size_t offset = 0; offset < bytes; offset += SMALL_PAGE) {
+        ((volatile char *)base)[offset] = 0;
+    }
+}
+
+// Map a region of at least `bytes`; 0 on failure
+static int map_region(Arena *arena, ArenaRegion *region, size_t bytes) {
+    PageSize pages = arena->pages;
+    double start = omp_get_wtime();
+    
+    if (pages == PAGES_HUGE_2MB || pages == PAGES_HUGE_1GB) {
+        size_t size = round_up(bytes, page_bytes(pages));
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (arena->populate ? MAP_POPULATE : 0);
+        flags |= ((pages == PAGES_HUGE_1GB) ? 30 : 21) << MAP_HUGE_SHIFT;
+        void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (map != MAP_FAILED) {
+            region->map = region->base = (char *)map;
+            region->map_bytes = region->bytes = size;
+        } else {
+            static int warned[2] = {0, 0};
+            if (!warned[pages == PAGES_HUGE_1GB]) {
+                fprintf(stderr, "Warning: no %s hugetlbfs pages reserved "
+                                "(/proc/sys/vm/nr_hugepages), using transparent huge pages\n",
+                        page_size_name(pages));
+                warned[pages == PAGES_HUGE_1GB] = 1;
+            }
+            pages = PAGES_TRANSPARENT;
+        }
+    }
+    
+    if (pages == PAGES_TRANSPARENT) {
+        // Over-map by one huge page so the usable range starts on a 2 MB boundary
+        size_t size = round_up(bytes, HUGE_PAGE_2MB);
+        void *map = mmap(NULL, size + HUGE_PAGE_2MB, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED) return 0;
+        region->map = (char *)map;
+        region->map_bytes = size + HUGE_PAGE_2MB;
+        region->base = (char *)round_up((uintptr_t)map, HUGE_PAGE_2MB);
+        region->bytes = size;
+        madvise(region->base, size, MADV_HUGEPAGE);
+        if (arena->populate) populate_range(region->base, size);
+    } else if (pages == PAGES_DEFAULT) {
+        size_t size = round_up(bytes, SMALL_PAGE);
+        void *map = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | (arena->populate ? MAP_POPULATE : 0), -1, 0);
+        if (map == MAP_FAILED) return 0;
+        region->map = region->base = (char *)map;
+        region->map_bytes = region->bytes = size;
+    }
+    
+    region->used = 0;
+    region->touched = arena->populate ? region->bytes : 0;
+    region->pages = pages;
+    arena->mapped_bytes += region->bytes;
+    arena->map_seconds += omp_get_wtime() - start;
+    return 1;
+}
+
+void arena_init(Arena *arena, PageSize pages, int populate) {
+    memset(arena, 0, sizeof(*arena));
+    arena->pages = pages;
+    arena->populate = populate;
+}
+
+// Offset of a block's data from region->used: right after the header, or
+// (own_page) on the next page boundary so the header has the page before
+// the data to itself
+static size_t data_offset(const ArenaRegion *region, int own_page) {
+    if (!own_page) return ARENA_ALIGN;
+    return round_up(region->used + ARENA_ALIGN, page_bytes(region->pages)) - region->used;
+}
+
+// Carve a block; *fresh (if given) is where its never-handed-out pages start
+static void *alloc_block(Arena *arena, size_t bytes, int own_page, char **fresh) {
+    if (bytes > SIZE_MAX - HUGE_PAGE_1GB - 2 * ARENA_ALIGN) return NULL;
+    size_t body = round_up(bytes, ARENA_ALIGN);
+    
+    // First region from the current one with room; else map a new one
+    int r = arena->current;
+    while (r < arena->num_regions &&
+           arena->regions[r].bytes - arena->regions[r].used <
+           data_offset(&arena->regions[r], own_page) + body) r++;
+    if (r == arena->num_regions) {
+        if (r == ARENA_MAX_REGIONS) return NULL;
+        size_t need = (own_page ? page_bytes(arena->pages) : ARENA_ALIGN) + body;
+        size_t size = (need > ARENA_MIN_REGION) ? need : ARENA_MIN_REGION;
+        if (!map_region(arena, &arena->regions[r], size)) return NULL;
+        arena->num_regions++;
+    } else {
+        arena->reused++;
+    }
+    
+    ArenaRegion *region = &arena->regions[r];
+    size_t need = data_offset(region, own_page) + body;
+    char *data = region->base + region->used + need - body;
+    if (fresh) {
+        char *untouched = region->base + round_up(region->touched, page_bytes(region->pages));
+        *fresh = (untouched > data) ? untouched : data;
+    }
+    
+    ArenaBlock *block = (ArenaBlock *)(data - ARENA_ALIGN);
+    block->prev = (ArenaBlock *)arena->top;
+    block->bytes = need;
+    block->prev_used = region->used;
+    block->region = r;
+    block->prev_current = arena->current;
+    block->freed = 0;
+    region->used += need;
+    if (region->used > region->touched) region->touched = region->used;
+    arena->current = r;
+    arena->top = block;
+    arena->allocations++;
+    arena->live_bytes += need;
+    if (arena->live_bytes > arena->peak_bytes) arena->peak_bytes = arena->live_bytes;
+    return data;
+}
+
+void *arena_alloc(Arena *arena, size_t bytes) {
+    return alloc_block(arena, bytes, 0, NULL);
+}
+
+void *arena_alloc_array(Arena *arena, size_t count, size_t elem_size) {
+    size_t bytes;
+    if (!checked_array_bytes(count, elem_size, &bytes)) {
+        fprintf(stderr, "Allocation of %zu x %zu bytes overflows size_t\n", count, elem_size);
+        return NULL;
+    }
+    return arena_alloc(arena, bytes);
+}
+
+void *arena_alloc_placed(Arena *arena, size_t count, size_t elem_size, MemoryPlacement placement) {
+    size_t bytes;
+    if (!checked_array_bytes(count, elem_size, &bytes)) {
+        fprintf(stderr, "Allocation of %zu x %zu bytes overflows size_t\n", count, elem_size);
+        return NULL;
+    }
+    char *fresh;
+    char *ptr = (char *)alloc_block(arena, bytes, 1, &fresh);
+    if (ptr && fresh < ptr + bytes) numa_place_pages(fresh, (size_t)(ptr + bytes - fresh), placement);
+    return ptr;
+}
+
+void arena_free(Arena *arena, void *ptr) {
+    if (!ptr) return;
+    ArenaBlock *block = (ArenaBlock *)((char *)ptr - ARENA_ALIGN);
+    block->freed = 1;
+    arena->live_bytes -= block->bytes;
+    
+    // Unwind the newest blocks while they are free
+    ArenaBlock *top = (ArenaBlock *)arena->top;
+    while (top && top->freed) {
+        arena->regions[top->region].used = top->prev_used;
+        arena->current = top->prev_current;
+        top = top->prev;
+    }
+    arena->top = top;
+}
+
+int arena_owns(const Arena *arena, const void *ptr) {
+    for (int r = 0; r < arena->num_regions; r++) {
+        const ArenaRegion *region = &arena->regions[r];
+        if ((const char *)ptr >= region->base && (const char *)ptr < region->base + region->bytes) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void arena_reset(Arena *arena) {
+    for (int r = 0; r < arena->num_regions; r++) arena->regions[r].used = 0;
+    arena->current = 0;
+    arena->top = NULL;
+    arena->live_bytes = 0;
+}
+
+void arena_destroy(Arena *arena) {
+    for (int r = 0; r < arena->num_regions; r++) {
+        munmap(arena->regions[r].map, arena->regions[r].map_bytes);
+    }
+    arena_init(arena, arena->pages, arena->populate);
+}
+
+void arena_print_stats(const Arena *arena, const char *label) {
+    PageSize granted = (arena->num_regions > 0) ? arena->regions[0].pages : arena->pages;
+    printf("Arena %s: %d regions, %.1f MB mapped (%s pages%s), %ld allocations "
+           "(%ld reused), peak %.1f MB, %.3f ms mapping\n", label, arena->num_regions,
+           arena->mapped_bytes / (1024.0 * 1024.0), page_size_name(granted),
+           arena->populate ? ", populated" : "", arena->allocations, arena->reused,
+           arena->peak_bytes / (1024.0 * 1024.0), arena->map_seconds * 1e3);
+}
+
+// Page size and populate flag from ARENA_PAGES / ARENA_POPULATE
+static void arena_init_from_env(Arena *arena) {
+    PageSize pages = PAGES_DEFAULT;
+    const char *env = getenv("ARENA_PAGES");
+    if (env && !page_size_parse(env, &pages)) {
+        fprintf(stderr, "Warning: unknown ARENA_PAGES '%s' (use 4k, thp, 2m or 1g)\n", env);
+    }
+    env = getenv("ARENA_POPULATE");
+    arena_init(arena, pages, env && atoi(env) > 0);
+}
+
+Arena *arena_shared(void) {
+    static Arena shared;
+    static int initialized = 0;
+    if (!initialized) {
+        arena_init_from_env(&shared);
+        initialized = 1;
+    }
+    return &shared;
+}
+
+// Per-thread arenas: created on first use, unmapped when their thread exits
+static pthread_key_t thread_arena_key;
+static pthread_once_t thread_arena_once = PTHREAD_ONCE_INIT;
+
+static void thread_arena_release(void *arena) {
+    arena_destroy((Arena *)arena);
+    free(arena);
+}
+
+static void thread_arena_key_create(void) {
+    pthread_key_create(&thread_arena_key, thread_arena_release);
+}
+
+static Arena *thread_arena_existing(void) {
+    pthread_once(&thread_arena_once, thread_arena_key_create);
+    return (Arena *)pthread_getspecific(thread_arena_key);
+}
+
+Arena *arena_thread(void) {
+    Arena *arena = thread_arena_existing();
+    if (!arena) {
+        arena = (Arena *)malloc(sizeof(Arena));
+        if (!arena) return NULL;
+        arena_init_from_env(arena);
+        if (pthread_setspecific(thread_arena_key, arena) != 0) {
+            free(arena);
+            return NULL;
+        }
+    }
+    return arena;
+}
+
+void *scratch_alloc(size_t count, size_t elem_size) {
+    size_t bytes;
+    if (!checked_array_bytes(count, elem_size, &bytes)) {
+        fprintf(stderr, "Allocation of %zu x %zu bytes overflows size_t\n", count, elem_size);
+        return NULL;
+    }
+    Arena *arena = omp_in_parallel() ? NULL : arena_thread();
+    void *ptr = arena ? arena_alloc(arena, bytes) : NULL;
+    return ptr ? ptr : malloc(bytes);
+}
+
+void scratch_free(void *ptr) {
+    if (!ptr) return;
+    Arena *arena = thread_arena_existing();
+    if (arena && arena_owns(arena, ptr)) arena_free(arena, ptr);
+    else free(ptr);
+}
+
+long process_page_faults(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+static const char *page_size_names[] = {"4k", "thp", "2m", "1g"};
+
+const char *page_size_name(PageSize pages) {
+    return page_size_names[pages];
+}
+
+int page_size_parse(const char *name, PageSize *pages) {
+    for (int k = 0; k < (int)(sizeof(page_size_names) / sizeof(page_size_names[0])); k++) {
+        if (strcmp(name, page_size_names[k]) == 0) {
+            *pages = (PageSize)k;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Shared: Arena Allocator with Huge Pages and Pre-Faulting
+ * 
+ * Description:
+ *   A fresh malloc of a large array returns untouched pages: the first
+ *   write to every 4 KB page faults into the kernel, which zeroes it. For
+ *   a short run over a few hundred MB those faults are a visible share of
+ *   the time, and a kernel that allocates scratch on every call pays them
+ *   again each time. An Arena keeps its mappings instead:
+ * 
+ *     reuse     allocations are carved from mapped regions; freeing them
+ *               (in any order) or arena_reset keeps the pages, so repeated
+ *               calls fault only on the first one;
+ *     pages     4 KB, transparent huge pages (madvise, 2 MB where the
+ *               kernel can), or hugetlbfs 2 MB / 1 GB pages (MAP_HUGETLB,
+ *               needs reserved pages in /proc/sys/vm/nr_hugepages; falls
+ *               back to transparent huge pages otherwise);
+ *     populate  fault every page in when the region is mapped
+ *               (MAP_POPULATE / MADV_POPULATE_WRITE), in one kernel call
+ *               instead of one fault per page.
+ * 
+ *   Pre-faulted pages land on the NUMA node of the mapping thread, so
+ *   populate and first-touch placement exclude each other.
+ * 
+ *   An Arena is not thread-safe. arena_shared() is the process-wide
+ *   arena for single-threaded setup code; arena_thread() is the calling
+ *   thread's own, unmapped when the thread exits. Both are configured from
+ * 
+ *     ARENA_PAGES=4k|thp|2m|1g   page size (default 4k)
+ *     ARENA_POPULATE=1           pre-fault new regions (default 0)
+ * 
+ *   Kernels take per-call scratch through scratch_alloc / scratch_free:
+ *   from the calling thread's arena outside a parallel region, from
+ *   malloc inside one, so several threads may call kernels at once. A
+ *   scratch buffer is freed by the thread that allocated it.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include "numa_alloc.h"
+
+#define ARENA_ALIGN 64                    // Cache line / AVX-512 alignment
+#define ARENA_MIN_REGION (16UL << 20)     // Smallest region mapped (16 MB)
+#define ARENA_MAX_REGIONS 64
+
+typedef enum {
+    PAGES_DEFAULT,            // 4 KB
+    PAGES_TRANSPARENT,        // madvise(MADV_HUGEPAGE)
+    PAGES_HUGE_2MB,           // MAP_HUGETLB
+    PAGES_HUGE_1GB
+} PageSize;
+
+typedef struct {
+    char *map;                // mmap'd range (map_bytes, for munmap)
+    size_t map_bytes;
+    char *base;               // Usable range: aligned to the page size
+    size_t bytes;
+    size_t used;
+    size_t touched;           // Most ever used (all of it when populated)
+    PageSize pages;           // Granted page size (after any fallback)
+} ArenaRegion;
+
+typedef struct {
+    PageSize pages;           // Requested for new regions
+    int populate;
+    ArenaRegion regions[ARENA_MAX_REGIONS];
+    int num_regions;
+    int current;              // Region the next allocation tries first
+    void *top;                // Newest live block (see arena.c)
+    size_t live_bytes;        // Allocated and not yet freed
+    size_t peak_bytes;
+    
+    // Statistics since arena_init
+    size_t mapped_bytes;
+    long allocations;
+    long reused;              // Allocations served by already-mapped memory
+    double map_seconds;       // mmap (and populate) time
+} Arena;
+
+void arena_init(Arena *arena, PageSize pages, int populate);
+
+// 64-byte aligned, uninitialized; NULL on failure or count * elem_size overflow
+void *arena_alloc(Arena *arena, size_t bytes);
+void *arena_alloc_array(Arena *arena, size_t count, size_t elem_size);
+
+// arena_alloc_array, then the placement policy (see numa_place_pages) on
+// the pages never handed out before; pages reused or populated keep their
+// node and are not written again. The data starts on a page boundary with
+// the block header alone on the page before it (one page of the region's
+// size per call), so writing the header places no data page.
+void *arena_alloc_placed(Arena *arena, size_t count, size_t elem_size, MemoryPlacement placement);
+
+// Memory is reclaimed once everything allocated after it is freed too
+void arena_free(Arena *arena, void *ptr);
+int arena_owns(const Arena *arena, const void *ptr);
+
+// Drop every allocation at once (mappings stay); unmap everything
+void arena_reset(Arena *arena);
+void arena_destroy(Arena *arena);
+
+void arena_print_stats(const Arena *arena, const char *label);
+
+// Process-wide arena from ARENA_PAGES / ARENA_POPULATE (one thread at a time)
+Arena *arena_shared(void);
+
+// The calling thread's arena, same settings; NULL if it cannot be created
+Arena *arena_thread(void);
+
+// Per-call kernel scratch (see above); scratch_free accepts either origin
+void *scratch_alloc(size_t count, size_t elem_size);
+void scratch_free(void *ptr);
+
+// Minor + major page faults of the process so far (getrusage)
+long process_page_faults(void);
+
+const char *page_size_name(PageSize pages);
+int page_size_parse(const char *name, PageSize *pages);
+
+#endif // ARENA_H
@@ -0,0 +1,167 @@
+/*
+ * Shared: Result Verification and Printing Helpers
+ * 
+ * See array_utils.h for the interface.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "array_utils.h"
+
+long verify_sample_count(long count) {
+    const char *env = getenv("VERIFY_SAMPLE");
+    long sample = env ? atol(env) : 0;
+    return (sample > 0 && sample < count) ? sample : count;
+}
+
+void verify_accumulate(const double *expected, const double *actual, long n,
+                       double tolerance, VerifyStats *stats) {
+    long differ = 0;
+    double max_abs = stats->max_abs;
+    #pragma omp simd reduction(+:differ) reduction(max:max_abs)
+    for (long i = 0; i < n; i++) {
+        double diff = fabs(expected[i] - actual[i]);
+        differ += (diff != 0.0);   // NaN included
+        max_abs = (diff > max_abs) ? diff : max_abs;
+    }
+    stats->max_abs = max_abs;
+    stats->checked += n;
+    if (differ == 0) return;
+    
+    // Relative and ULP error, only where something differs
+    for (long i = 0; i < n; i++) {
+        double diff = fabs(expected[i] - actual[i]);
+        double rel = (expected[i] != 0.0) ? diff / fabs(expected[i]) : 0.0;
+        double ulps = ulp_distance(expected[i], actual[i]);
+        if (rel > stats->max_rel) stats->max_rel = rel;
+        if (ulps > stats->max_ulps) stats->max_ulps = ulps;
+        stats->errors += verify_mismatch(expected[i], actual[i], tolerance);
+    }
+}
+
+void verify_merge(VerifyStats *into, const VerifyStats *part) {
+    into->checked += part->checked;
+    into->errors += part->errors;
+    if (part->max_abs > into->max_abs) into->max_abs = part->max_abs;
+    if (part->max_rel > into->max_rel) into->max_rel = part->max_rel;
+    if (part->max_ulps > into->max_ulps) into->max_ulps = part->max_ulps;
+}
+
+void verify_print_stats(const VerifyStats *stats) {
+    printf("    Max error: %.3e abs, %.3e rel, %.4g ulp (%ld of %ld elements%s)\n",
+           stats->max_abs, stats->max_rel, stats->max_ulps, stats->checked, stats->count,
+           (stats->checked < stats->count) ? ", sampled" : "");
+}
+
+void verify_report(const VerifyStats *stats) {
+    if (stats->errors > 5) {
+        printf("    ... and %ld more errors\n", stats->errors - 5);
+    }
+    const char *env = getenv("VERIFY_STATS");
+    if (stats->errors > 0 || stats->checked < stats->count || (env && atoi(env) > 0)) {
+        verify_print_stats(stats);
+    }
+}
+
+// Verify that two arrays are equal (within tolerance): chunks in parallel
+// (sampled elements gathered first), then the first mismatches in order
+int verify_results_stats(const double *expected, const double *actual, long count,
+                         double tolerance, VerifyStats *stats) {
+    long checked = verify_sample_count(count);
+    memset(stats, 0, sizeof(*stats));
+    stats->count = count;
+    
+    #pragma omp parallel
+    {
+        VerifyStats part = {0};
+        double gathered[2][VERIFY_CHUNK];
+        #pragma omp for schedule(static)
+        for (long start = 0; start < checked; start += VERIFY_CHUNK) {
+            long n = (checked - start < VERIFY_CHUNK) ? checked - start : VERIFY_CHUNK;
+            if (checked == count) {
+                verify_accumulate(expected + start, actual + start, n, tolerance, &part);
+                continue;
+            }
+            for (long k = 0; k < n; k++) {
+                long i = verify_sample_index(start + k, checked, count);
+                gathered[0][k] = expected[i];
+                gathered[1][k] = actual[i];
+            }
+            verify_accumulate(gathered[0], gathered[1], n, tolerance, &part);
+        }
+        #pragma omp critical(verify_merge)
+        verify_merge(stats, &part);
+    }
+    
+    long printed = 0;
+    for (long k = 0; k < checked && printed < 5 && stats->errors > 0; k++) {
+        long i = verify_sample_index(k, checked, count);
+        if (verify_mismatch(expected[i], actual[i], tolerance)) {
+            printf("    Error at index %ld: expected=%.6f, actual=%.6f\n",
+                   i, expected[i], actual[i]);
+            printed++;
+        }
+    }
+    verify_report(stats);
+    return (stats->errors == 0);
+}
+
+int verify_results(const double *expected, const double *actual, long count, double tolerance) {
+    VerifyStats stats;
+    return verify_results_stats(expected, actual, count, tolerance, &stats);
+}
+
+// Print matrix (up to max_print x max_print)
+void print_matrix(const double *matrix, index_t rows, index_t cols, int max_print) {
+    int row_limit = (rows < max_print) ? (int)rows : max_print;
+    int col_limit = (cols < max_print) ? (int)cols : max_print;
+    
+    for (int i = 0; i < row_limit; i++) {
+        for (int j = 0; j < col_limit; j++) {
+            printf("%6.1f ", matrix[(long)i * cols + j]);
+        }
+        if (col_limit < cols) printf("...");
+        printf("\n");
+    }
+    if (row_limit < rows) {
+        printf("...\n");
+    }
+}
+
+// Print vector sample
+void print_vector(const double *vec, long size, const char *name, int max_print) {
+    printf("\n%s: [", name);
+    long print_count = (size < max_print) ? size : max_print;
+    for (long i = 0; i < print_count; i++) {
+        printf("%.1f", vec[i]);
+        if (i < print_count - 1) printf(", ");
+    }
+    if (size > max_print) printf(", ...");
+    printf("]\n");
+}
+
+// Parse a positive problem size that fits index_t
+int parse_index_arg(const char *text, const char *what, index_t *value) {
+    char *end;
+    long long parsed = strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 1) {
+        fprintf(stderr, "Invalid %s '%s'\n", what, text);
+        return 0;
+    }
+    if (!check_index_count((double)parsed, what)) return 0;
+    *value = (index_t)parsed;
+    return 1;
+}
+
+// Can index_t (this build's index width) address `count` elements?
+int check_index_count(double count, const char *what) {
+    if (index_count_fits(count)) return 1;
+    fprintf(stderr, "%s: %.0f elements exceed the %s build (max %lld); "
+            "rebuild with `make INDEX64=1`\n", what, count, INDEX_MODE, (long long)INDEX_MAX);
+    return 0;
+}
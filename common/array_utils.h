@@ -0,0 +1,112 @@
+/*
+ * Shared: Result Verification and Printing Helpers
+ * 
+ * Description:
+ *   Element-wise comparison of a computed array against a reference and
+ *   small-sample printing of matrices and vectors. Used by every task and
+ *   by the kernel driver so all programs report mismatches the same way.
+ * 
+ *   Verification runs in parallel over chunks of VERIFY_CHUNK elements and
+ *   reduces the maximum absolute, relative and ULP error. A SIMD pass
+ *   finds the absolute error; relative and ULP errors (a division and
+ *   64-bit integer arithmetic that does not vectorize on baseline x86-64)
+ *   are only computed for chunks where something differs, so an exact
+ *   match costs one streaming pass.
+ *   An element passes within the absolute tolerance or within
+ *   VERIFY_MAX_ULPS units in the last place, so large values are not held
+ *   to an absolute bound finer than their own precision. Environment:
+ * 
+ *     VERIFY_SAMPLE=n   check n random elements only (smoke tests of big runs)
+ *     VERIFY_STATS=1    print the error statistics after every check (they
+ *                       are always printed on failure and when sampling)
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef ARRAY_UTILS_H
+#define ARRAY_UTILS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "index_types.h"
+#include "rng.h"
+
+#define VERIFY_MAX_ULPS 4          // ULP distance that passes at any magnitude
+#define VERIFY_SAMPLE_SEED 0x5eed  // Indices checked under VERIFY_SAMPLE
+#define VERIFY_CHUNK 4096          // Elements per chunk (gathered into buffers if strided)
+
+typedef struct {
+    long count;                    // Elements in the arrays
+    long checked;                  // Elements compared (count, or the sample)
+    long errors;
+    double max_abs;                // max |expected - actual|
+    double max_rel;                // ... / |expected|, over expected != 0
+    double max_ulps;               // Representable doubles between the two
+} VerifyStats;
+
+// Number of representable doubles between a and b (0 if equal, also for
+// +0 / -0); branch-free so verification loops vectorize. A NaN is far from
+// every number and passes only against a NaN with the same bits.
+static inline double ulp_distance(double a, double b) {
+    int64_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    // Sign-magnitude to a monotonic integer order
+    ia = (ia < 0) ? INT64_MIN - ia : ia;
+    ib = (ib < 0) ? INT64_MIN - ib : ib;
+    uint64_t d = (ia > ib) ? (uint64_t)ia - (uint64_t)ib : (uint64_t)ib - (uint64_t)ia;
+    return (double)d;
+}
+
+// Does actual fail against expected (see above)?
+static inline int verify_mismatch(double expected, double actual, double tolerance) {
+    return !(fabs(expected - actual) <= tolerance) &&
+           ulp_distance(expected, actual) > VERIFY_MAX_ULPS;
+}
+
+// Returns 1 if every checked i (all, or the VERIFY_SAMPLE subset) has
+// |expected[i] - actual[i]| <= tolerance or lies within VERIFY_MAX_ULPS
+// ULPs of expected[i]. The first five mismatches are printed, then the max
+// absolute / relative / ULP error on failure, when sampling or with
+// VERIFY_STATS=1
+int verify_results(const double *expected, const double *actual, long count, double tolerance);
+
+// The same check, also returning the statistics (stats may not be NULL)
+int verify_results_stats(const double *expected, const double *actual, long count,
+                         double tolerance, VerifyStats *stats);
+
+// Building blocks for checks of other layouts (see verify_transpose):
+// accumulate one contiguous chunk into a thread's stats, merge the stats
+// of the team, and print the first mismatches and the summary
+void verify_accumulate(const double *expected, const double *actual, long n,
+                       double tolerance, VerifyStats *stats);
+void verify_merge(VerifyStats *into, const VerifyStats *part);
+void verify_report(const VerifyStats *stats);
+
+// Elements a check of `count` compares (VERIFY_SAMPLE), and the index of
+// the k-th of them: all in order, or uniform random ones under sampling
+long verify_sample_count(long count);
+
+static inline long verify_sample_index(long k, long checked, long count) {
+    if (checked == count) return k;
+    return (long)(rng_bits(VERIFY_SAMPLE_SEED, 0, (uint64_t)k) % (uint64_t)count);
+}
+
+// "    Max error: ..." line
+void verify_print_stats(const VerifyStats *stats);
+
+// Print the top-left max_print x max_print corner of a row-major matrix
+void print_matrix(const double *matrix, index_t rows, index_t cols, int max_print);
+
+// Print the first max_print entries of a vector as "name: [a, b, ...]"
+void print_vector(const double *vec, long size, const char *name, int max_print);
+
+// Command-line problem sizes: parse_index_arg accepts 1..INDEX_MAX, and
+// check_index_count that an array of `count` elements is addressable by
+// index_t. Both print why a size is rejected (e.g. "rebuild with INDEX64=1").
+int parse_index_arg(const char *text, const char *what, index_t *value);
+int check_index_count(double count, const char *what);
+
+#endif // ARRAY_UTILS_H
@@ -0,0 +1,321 @@
+/*
+ * Shared: Repeated-Iteration Benchmark Harness
+ * 
+ * See bench.h for the usage pattern and environment variables.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+
+#include "bench.h"
+#include "index_types.h"
+#include "trace.h"
+
+#define DEFAULT_WARMUP 1
+#define DEFAULT_REPS 5
+
+static char bench_context[256] = "";
+static char bench_json_fields[2048] = "";
+
+static int env_int(const char *name, int fallback, int min_value) {
+    const char *env = getenv(name);
+    if (!env) return fallback;
+    int value = atoi(env);
+    return (value >= min_value) ? value : fallback;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+void bench_set_context(const char *context) {
+    snprintf(bench_context, sizeof(bench_context), "%s", context ? context : "");
+}
+
+void bench_set_json_fields(const char *fields) {
+    snprintf(bench_json_fields, sizeof(bench_json_fields), "%s", fields ? fields : "");
+}
+
+// Counters are opened once per process, for the maximum team size
+static int bench_perf_available(void) {
+    static int state = -1;  // -1 = not tried yet
+    if (state < 0) {
+        const char *env = getenv("BENCH_PERF");
+        state = (env && atoi(env) > 0) ? (perf_counters_open(omp_get_max_threads()) > 0) : 0;
+    }
+    return state;
+}
+
+Benchmark bench_begin(const char *task, const char *kernel, long size,
+                      double flops, double bytes) {
+    Benchmark b;
+    memset(&b, 0, sizeof(b));
+    
+    b.result.task = task;
+    b.result.kernel = kernel;
+    b.result.size = size;
+    b.result.threads = omp_get_max_threads();
+    b.result.warmup = env_int("BENCH_WARMUP", DEFAULT_WARMUP, 0);
+    b.result.reps = env_int("BENCH_REPS", DEFAULT_REPS, 1);
+    b.result.flops = flops;
+    b.result.bytes = bytes;
+    b.samples = (double *)malloc(b.result.reps * sizeof(double));
+    if (!b.samples) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    trace_init();
+    b.result.perf_enabled = bench_perf_available();
+    if (b.result.perf_enabled) {
+        perf_counters_disable();
+        perf_counters_reset();
+    }
+    return b;
+}
+
+// Close the previous iteration (if timed) and decide whether to run another
+int bench_next(Benchmark *b) {
+    double now = omp_get_wtime();
+    int timed = b->iteration - b->result.warmup;  // Index of the iteration just finished
+    
+    if (b->iteration > 0) {
+        // Every run (warmup included) is a span on the driver track
+        trace_record(trace_num_threads, b->result.kernel, b->trace_start, b->iteration);
+    }
+    if (b->iteration > 0 && timed > 0) {
+        b->samples[timed - 1] = now - b->start;
+        if (b->result.perf_enabled) perf_counters_disable();
+    }
+    if (b->iteration >= b->result.warmup + b->result.reps) return 0;
+    
+    // Counters only run during timed iterations
+    if (b->result.perf_enabled && b->iteration >= b->result.warmup) perf_counters_enable();
+    b->iteration++;
+    b->trace_start = trace_begin();
+    b->start = omp_get_wtime();
+    return 1;
+}
+
+void json_escape(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; s && *s; s++) {
+        if ((unsigned char)*s < 0x20) {
+            fprintf(fp, "\\u%04x", (unsigned char)*s);
+            continue;
+        }
+        if (*s == '"' || *s == '\\') fputc('\\', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+// Quoted CSV field, embedded quotes doubled (RFC 4180)
+static void csv_quote(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; s && *s; s++) {
+        if (*s == '"') fputc('"', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+// "name":value pairs of one counter set (null for unavailable events)
+static void write_perf_json(FILE *fp, const PerfCounts *c) {
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        fprintf(fp, "%s\"%s\":", e ? "," : "", perf_event_name(e));
+        if (c->counts[e] < 0) {
+            fprintf(fp, "null");
+        } else {
+            fprintf(fp, "%.6g", c->counts[e]);
+        }
+    }
+}
+
+static void bench_write_json(const BenchResult *r, const PerfCounts *per_thread,
+                             int num_threads, const char *path) {
+    FILE *fp = fopen(path, "a");
+    if (!fp) {
+        fprintf(stderr, "Warning: cannot open BENCH_JSON file '%s'\n", path);
+        return;
+    }
+    fprintf(fp, "{\"task\":");
+    json_escape(fp, r->task);
+    fprintf(fp, ",\"kernel\":");
+    json_escape(fp, r->kernel);
+    fprintf(fp, ",\"context\":");
+    json_escape(fp, bench_context);
+    fprintf(fp, ",\"compiler\":");
+    json_escape(fp, __VERSION__);
+    fprintf(fp, ",\"index_mode\":");
+    json_escape(fp, INDEX_MODE);
+    if (bench_json_fields[0]) fprintf(fp, ",%s", bench_json_fields);
+    fprintf(fp, ",\"size\":%ld,\"threads\":%d,\"warmup\":%d,\"reps\":%d"
+                ",\"min_s\":%.9g,\"median_s\":%.9g,\"p95_s\":%.9g,\"mean_s\":%.9g,\"stddev_s\":%.9g"
+                ",\"flops\":%.9g,\"bytes\":%.9g,\"gflops\":%.6g,\"gbytes_per_s\":%.6g",
+            r->size, r->threads, r->warmup, r->reps,
+            r->min, r->median, r->p95, r->mean, r->stddev,
+            r->flops, r->bytes,
+            r->flops / r->median / 1e9, r->bytes / r->median / 1e9);
+    
+    if (r->perf_enabled) {
+        fprintf(fp, ",\"perf\":{");
+        write_perf_json(fp, &r->perf);
+        fprintf(fp, ",\"per_thread\":[");
+        for (int t = 0; t < num_threads; t++) {
+            fprintf(fp, "%s{", t ? "," : "");
+            write_perf_json(fp, &per_thread[t]);
+            fprintf(fp, "}");
+        }
+        fprintf(fp, "]}");
+    }
+    fprintf(fp, "}\n");
+    fclose(fp);
+}
+
+static void bench_write_csv(const BenchResult *r, const char *path) {
+    FILE *probe = fopen(path, "r");
+    int new_file = (probe == NULL);
+    if (probe) {
+        fseek(probe, 0, SEEK_END);
+        new_file = (ftell(probe) == 0);
+        fclose(probe);
+    }
+    
+    FILE *fp = fopen(path, "a");
+    if (!fp) {
+        fprintf(stderr, "Warning: cannot open BENCH_CSV file '%s'\n", path);
+        return;
+    }
+    if (new_file) {
+        fprintf(fp, "task,kernel,context,size,threads,warmup,reps,min_s,median_s,p95_s,"
+                    "mean_s,stddev_s,flops,bytes,gflops,gbytes_per_s");
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) fprintf(fp, ",%s", perf_event_name(e));
+        fprintf(fp, "\n");
+    }
+    csv_quote(fp, r->task);
+    fputc(',', fp);
+    csv_quote(fp, r->kernel);
+    fputc(',', fp);
+    csv_quote(fp, bench_context);
+    fprintf(fp, ",%ld,%d,%d,%d,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.6g,%.6g",
+            r->size, r->threads, r->warmup, r->reps,
+            r->min, r->median, r->p95, r->mean, r->stddev, r->flops, r->bytes,
+            r->flops / r->median / 1e9, r->bytes / r->median / 1e9);
+    // Counter columns stay empty when BENCH_PERF is off or the event is unavailable
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        if (r->perf_enabled && r->perf.counts[e] >= 0) {
+            fprintf(fp, ",%.6g", r->perf.counts[e]);
+        } else {
+            fprintf(fp, ",");
+        }
+    }
+    fprintf(fp, "\n");
+    fclose(fp);
+}
+
+// Per-thread counter table (per timed run)
+static void print_perf_threads(const PerfCounts *per_thread, int num_threads) {
+    printf("    %6s", "Thread");
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) printf(" %13s", perf_event_name(e));
+    printf("\n");
+    for (int t = 0; t < num_threads; t++) {
+        printf("    %6d", t);
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+            if (per_thread[t].counts[e] < 0) {
+                printf(" %13s", "n/a");
+            } else {
+                printf(" %13.4g", per_thread[t].counts[e]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+BenchResult bench_end(Benchmark *b) {
+    BenchResult *r = &b->result;
+    int n = r->reps;
+    
+    qsort(b->samples, n, sizeof(double), compare_doubles);
+    
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += b->samples[i];
+    r->mean = sum / n;
+    
+    double sq = 0.0;
+    for (int i = 0; i < n; i++) sq += (b->samples[i] - r->mean) * (b->samples[i] - r->mean);
+    r->stddev = (n > 1) ? sqrt(sq / (n - 1)) : 0.0;
+    
+    r->min = b->samples[0];
+    r->median = (n % 2) ? b->samples[n / 2]
+                        : 0.5 * (b->samples[n / 2 - 1] + b->samples[n / 2]);
+    int p95_rank = (int)ceil(0.95 * n) - 1;  // Nearest-rank percentile
+    r->p95 = b->samples[(p95_rank < 0) ? 0 : p95_rank];
+    
+    free(b->samples);
+    b->samples = NULL;
+    
+    // Per-thread counters, averaged per timed run, and their sum
+    int num_threads = 0;
+    PerfCounts *per_thread = NULL;
+    if (r->perf_enabled) {
+        num_threads = perf_counters_threads();
+        per_thread = (PerfCounts *)malloc(num_threads * sizeof(PerfCounts));
+        if (!per_thread) {
+            r->perf_enabled = 0;
+            num_threads = 0;
+        } else {
+            perf_counters_read(per_thread, num_threads);
+        }
+    }
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        r->perf.counts[e] = -1.0;
+        for (int t = 0; t < num_threads; t++) {
+            if (per_thread[t].counts[e] < 0) continue;
+            per_thread[t].counts[e] /= n;
+            r->perf.counts[e] = ((r->perf.counts[e] < 0) ? 0.0 : r->perf.counts[e]) +
+                                per_thread[t].counts[e];
+        }
+    }
+    
+    bench_print(r);
+    if (r->perf_enabled) print_perf_threads(per_thread, num_threads);
+    
+    const char *json = getenv("BENCH_JSON");
+    const char *csv = getenv("BENCH_CSV");
+    if (json && *json) bench_write_json(r, per_thread, num_threads, json);
+    if (csv && *csv) bench_write_csv(r, csv);
+    
+    free(per_thread);
+    return *r;
+}
+
+void bench_print(const BenchResult *r) {
+    printf("    Time: %.6f s median (min %.6f, p95 %.6f, stddev %.6f, %d runs)\n",
+           r->median, r->min, r->p95, r->stddev, r->reps);
+    if (r->flops > 0 && r->bytes > 0) {
+        printf("    Rate: %.3f GFLOP/s, %.2f GB/s\n",
+               r->flops / r->median / 1e9, r->bytes / r->median / 1e9);
+    } else if (r->bytes > 0) {
+        printf("    Rate: %.2f GB/s\n", r->bytes / r->median / 1e9);
+    }
+    
+    if (r->perf_enabled) {
+        const double *c = r->perf.counts;
+        printf("    Counters per run:");
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+            if (c[e] >= 0) printf(" %s=%.4g", perf_event_name(e), c[e]);
+        }
+        if (c[PERF_CYCLES] > 0 && c[PERF_INSTRUCTIONS] >= 0) {
+            printf(" (IPC %.2f)", c[PERF_INSTRUCTIONS] / c[PERF_CYCLES]);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Shared: Repeated-Iteration Benchmark Harness
+ * 
+ * Description:
+ *   Runs a kernel for a number of untimed warmup iterations followed by
+ *   N timed repetitions, then reports min / median / p95 / mean / stddev
+ *   and the FLOP/s and bytes/s derived from the kernel's known work.
+ * 
+ *   Usage pattern (no callbacks - the loop body is the kernel call):
+ * 
+ *       Benchmark b = bench_begin("vector_addition", "parallel_static",
+ *                                 size, flops, bytes);
+ *       while (bench_next(&b)) {
+ *           vector_add_parallel_static(A, B, C, size);
+ *       }
+ *       BenchResult r = bench_end(&b);
+ * 
+ *   Configuration (environment):
+ *     BENCH_WARMUP=n   untimed warmup iterations        (default 1)
+ *     BENCH_REPS=n     timed repetitions                (default 5)
+ *     BENCH_JSON=file  append one JSON object per result (JSON Lines)
+ *     BENCH_CSV=file   append one CSV row per result (header if new)
+ *     BENCH_PERF=1     count cycles, instructions, LLC/dTLB/branch misses
+ *                      and page faults per thread (see perf_counters.h)
+ *     TRACE_FILE=file  per-thread timeline of every run (see trace.h)
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "perf_counters.h"
+
+typedef struct {
+    const char *task;
+    const char *kernel;
+    long size;            // Problem size as given on the command line
+    int threads;
+    int warmup;
+    int reps;
+    double flops;         // Floating-point operations per run
+    double bytes;         // Compulsory memory traffic per run
+    double min;           // Seconds
+    double median;
+    double p95;
+    double mean;
+    double stddev;
+    int perf_enabled;     // BENCH_PERF=1 and at least one event opened
+    PerfCounts perf;      // All threads, averaged per timed run
+} BenchResult;
+
+typedef struct {
+    BenchResult result;
+    double *samples;
+    int iteration;        // Counts warmup + timed iterations started so far
+    double start;
+    uint64_t trace_start;
+} Benchmark;
+
+// Free-form parameters recorded with every result, e.g. "block_size=64"
+void bench_set_context(const char *context);
+
+// Extra members of every BENCH_JSON object, e.g. "\"matrix\":{\"rows\":100}"
+// (comma-separated "name":value pairs; NULL or "" for none)
+void bench_set_json_fields(const char *fields);
+
+Benchmark bench_begin(const char *task, const char *kernel, long size,
+                      double flops, double bytes);
+int bench_next(Benchmark *b);
+BenchResult bench_end(Benchmark *b);
+
+// Human-readable statistics line (printed by bench_end)
+void bench_print(const BenchResult *r);
+
+// Write s as a quoted JSON string (also used by the trace export)
+void json_escape(FILE *fp, const char *s);
+
+#endif // BENCH_H
@@ -0,0 +1,67 @@
+/*
+ * Shared: Index Types and Overflow-Checked Sizes
+ * 
+ * Description:
+ *   Every problem size, loop index and CSR row pointer is an index_t. The
+ *   default build keeps 32-bit indices (smaller CSR structures, the same
+ *   code the tasks always had); `make INDEX64=1` switches to 64-bit indices
+ *   for arrays beyond 2^31 elements:
+ * 
+ *     build               index_t / row_ptr    col_index_t (CSR columns)
+ *     default             int32                int32
+ *     INDEX64=1           int64                int64
+ *     INDEX64=1 COL32=1   int64                int32 (num_cols < 2^31)
+ * 
+ *   index_t must hold the TOTAL element count of every array (N * N for
+ *   the dense tasks, nnz for CSR); index_count_fits checks that before
+ *   anything is allocated, and checked_array_bytes catches size_t overflow
+ *   of count * element size.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef INDEX_TYPES_H
+#define INDEX_TYPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef INDEX64
+typedef int64_t index_t;
+#define INDEX_MAX INT64_MAX
+#else
+typedef int32_t index_t;
+#define INDEX_MAX INT32_MAX
+#endif
+
+#if defined(INDEX64) && !defined(COL_INDEX32)
+typedef int64_t col_index_t;
+#define COL_INDEX_MAX INT64_MAX
+#else
+typedef int32_t col_index_t;
+#define COL_INDEX_MAX INT32_MAX
+#endif
+
+// Name of the index configuration, recorded with benchmark results
+#if defined(INDEX64) && defined(COL_INDEX32)
+#define INDEX_MODE "index64-col32"
+#elif defined(INDEX64)
+#define INDEX_MODE "index64"
+#else
+#define INDEX_MODE "index32"
+#endif
+
+// Can index_t address `count` elements? (count = total array length)
+static inline int index_count_fits(double count) {
+    return count >= 0.0 && count <= (double)INDEX_MAX;
+}
+
+// bytes = count * elem_size, 0 if it does not fit in size_t
+static inline int checked_array_bytes(size_t count, size_t elem_size, size_t *bytes) {
+    if (elem_size != 0 && count > SIZE_MAX / elem_size) return 0;
+    *bytes = count * elem_size;
+    return 1;
+}
+
+#endif // INDEX_TYPES_H
@@ -0,0 +1,287 @@
+/*
+ * Shared: NUMA-Aware Allocation and Thread Placement
+ * 
+ * See numa_alloc.h for the placement policies.
+ * 
+ * Compilation: linked into every task (add -DUSE_LIBNUMA -lnuma for
+ *              interleaved placement, e.g. `make NUMA=1`)
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <omp.h>
+#ifdef USE_LIBNUMA
+#include <numa.h>
+#endif
+
+#include "numa_alloc.h"
+#include "index_types.h"
+
+#define MAX_NODES 64
+
+// Bytes reserved in front of every block to remember the mapping size: a
+// whole page, so writing it leaves the first data page untouched for the
+// placement policy. The returned pointer is page (and so 64-byte) aligned.
+static size_t alloc_header(void) {
+    static size_t page = 0;
+    if (page == 0) page = (size_t)sysconf(_SC_PAGESIZE);
+    return page;
+}
+
+// Apply a placement policy to pages that have not been touched yet
+void numa_place_pages(void *ptr, size_t bytes, MemoryPlacement placement) {
+    if (placement == PLACEMENT_INTERLEAVE) {
+#ifdef USE_LIBNUMA
+        if (numa_available() >= 0) {
+            // mbind works on whole pages: widen the range to page bounds
+            size_t page = (size_t)sysconf(_SC_PAGESIZE);
+            uintptr_t begin = (uintptr_t)ptr / page * page;
+            numa_interleave_memory((void *)begin, (uintptr_t)ptr + bytes - begin, numa_all_nodes_ptr);
+            return;
+        }
+#endif
+        static int warned = 0;
+        if (!warned) {
+            fprintf(stderr, "Warning: interleave needs libnuma (build with NUMA=1), "
+                            "falling back to first-touch\n");
+            warned = 1;
+        }
+        placement = PLACEMENT_FIRST_TOUCH;
+    }
+    
+    if (placement == PLACEMENT_FIRST_TOUCH) {
+        /*
+         * Touch with the SAME static partition the kernels use:
+         * element i of a double array is written by the thread that later
+         * processes index i, so each thread's chunk lives on its own node.
+         */
+        double *elems = (double *)ptr;
+        size_t count = bytes / sizeof(double);
+        
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < count; i++) {
+            elems[i] = 0.0;
+        }
+        memset((char *)ptr + count * sizeof(double), 0, bytes - count * sizeof(double));
+    }
+}
+
+// Allocate `bytes` with the requested page placement
+void *numa_aware_alloc(size_t bytes, MemoryPlacement placement) {
+    size_t header = alloc_header();
+    if (bytes > SIZE_MAX - header) return NULL;
+    size_t total = bytes + header;
+    
+    // mmap'd pages are not backed until first written, so placement is
+    // decided by whoever touches them first (or by the interleave policy)
+    void *base = mmap(NULL, total, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return NULL;
+    
+    *(size_t *)base = total;
+    char *ptr = (char *)base + header;
+    numa_place_pages(ptr, bytes, placement);
+    return ptr;
+}
+
+// Report a count * elem_size that does not fit in size_t
+static void report_size_overflow(size_t count, size_t elem_size) {
+    fprintf(stderr, "Allocation of %zu x %zu bytes overflows size_t\n", count, elem_size);
+}
+
+void *numa_aware_alloc_array(size_t count, size_t elem_size, MemoryPlacement placement) {
+    size_t bytes;
+    if (!checked_array_bytes(count, elem_size, &bytes)) {
+        report_size_overflow(count, elem_size);
+        return NULL;
+    }
+    return numa_aware_alloc(bytes, placement);
+}
+
+void *malloc_array(size_t count, size_t elem_size) {
+    size_t bytes;
+    if (!checked_array_bytes(count, elem_size, &bytes)) {
+        report_size_overflow(count, elem_size);
+        return NULL;
+    }
+    return malloc(bytes);
+}
+
+// Release memory obtained from numa_aware_alloc
+void numa_aware_free(void *ptr) {
+    if (!ptr) return;
+    char *base = (char *)ptr - alloc_header();
+    munmap(base, *(size_t *)base);
+}
+
+// Read the placement policy from NUMA_PLACEMENT (default if unset)
+MemoryPlacement placement_from_env(void) {
+    const char *env = getenv("NUMA_PLACEMENT");
+    if (!env || strcmp(env, "default") == 0) return PLACEMENT_DEFAULT;
+    if (strcmp(env, "first-touch") == 0) return PLACEMENT_FIRST_TOUCH;
+    if (strcmp(env, "interleave") == 0) return PLACEMENT_INTERLEAVE;
+    
+    fprintf(stderr, "Warning: unknown NUMA_PLACEMENT '%s' "
+                    "(use default, first-touch or interleave)\n", env);
+    return PLACEMENT_DEFAULT;
+}
+
+const char *placement_name(MemoryPlacement placement) {
+    switch (placement) {
+    case PLACEMENT_FIRST_TOUCH: return "first-touch";
+    case PLACEMENT_INTERLEAVE:  return "interleave";
+    default:                    return "default";
+    }
+}
+
+// Number of NUMA nodes (1 if the topology cannot be determined)
+int numa_node_count(void) {
+#ifdef USE_LIBNUMA
+    if (numa_available() >= 0) return numa_max_node() + 1;
+#endif
+    int count = 0;
+    DIR *dir = opendir("/sys/devices/system/node");
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, "node", 4) == 0 &&
+                entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+                count++;
+            }
+        }
+        closedir(dir);
+    }
+    return (count > 0) ? count : 1;
+}
+
+// Size of the highest cache level reported by sysfs for cpu0 (0 if unknown)
+size_t last_level_cache_bytes(void) {
+    size_t best_size = 0;
+    int best_level = 0;
+    
+    // /sys/devices/system/cpu/cpu0/cache/indexN/{level,size}, size like "32768K"
+    for (int index = 0; index < 16; index++) {
+        char path[96], unit = 'B';
+        int level = 0;
+        unsigned long value = 0;
+        
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        FILE *fp = fopen(path, "r");
+        if (!fp) break;
+        int ok = (fscanf(fp, "%d", &level) == 1);
+        fclose(fp);
+        
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        fp = fopen(path, "r");
+        if (!fp) continue;
+        ok = ok && (fscanf(fp, "%lu%c", &value, &unit) >= 1);
+        fclose(fp);
+        if (!ok) continue;
+        
+        size_t bytes = value;
+        if (unit == 'K') bytes <<= 10;
+        else if (unit == 'M') bytes <<= 20;
+        else if (unit == 'G') bytes <<= 30;
+        if (level > best_level || (level == best_level && bytes > best_size)) {
+            best_level = level;
+            best_size = bytes;
+        }
+    }
+    return best_size;
+}
+
+// NUMA node of the CPU the calling thread is running on
+int current_numa_node(void) {
+    int cpu = sched_getcpu();
+    if (cpu < 0) return 0;
+#ifdef USE_LIBNUMA
+    if (numa_available() >= 0) return numa_node_of_cpu(cpu);
+#endif
+    // sysfs links every CPU to its node: /sys/devices/system/cpu/cpuN/nodeM
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    int node = 0;
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, "node", 4) == 0 &&
+                entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+                node = atoi(entry->d_name + 4);
+                break;
+            }
+        }
+        closedir(dir);
+    }
+    return node;
+}
+
+// Show OMP_PROC_BIND / OMP_PLACES and where every thread actually runs
+void print_thread_binding(void) {
+    static const char *bind_names[] = {"false", "true", "master", "close", "spread"};
+    omp_proc_bind_t bind = omp_get_proc_bind();
+    const char *places = getenv("OMP_PLACES");
+    
+    printf("Thread binding: OMP_PROC_BIND=%s, OMP_PLACES=%s (%d places, %d NUMA nodes)\n",
+           (bind >= 0 && bind <= 4) ? bind_names[bind] : "?",
+           places ? places : "(unset)", omp_get_num_places(), numa_node_count());
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int cpu = sched_getcpu();
+        int node = current_numa_node();
+        int place = omp_get_place_num();
+        
+        #pragma omp for ordered schedule(static, 1)
+        for (int t = 0; t < omp_get_num_threads(); t++) {
+            #pragma omp ordered
+            {
+                printf("    Thread %2d: cpu %3d, node %d, place %d\n", tid, cpu, node, place);
+            }
+        }
+    }
+    
+    if (bind == omp_proc_bind_false) {
+        printf("    Note: threads are not pinned - set OMP_PROC_BIND=close and "
+               "OMP_PLACES=cores\n          so first-touch pages stay local\n");
+    }
+}
+
+// Per-node bandwidth: bytes moved by the node's threads / slowest of them
+void print_node_bandwidth(const int *thread_node, const double *thread_bytes,
+                          const double *thread_seconds, int num_threads) {
+    double node_bytes[MAX_NODES] = {0};
+    double node_time[MAX_NODES] = {0};
+    int node_threads[MAX_NODES] = {0};
+    double total_bytes = 0.0, total_time = 0.0;
+    
+    for (int t = 0; t < num_threads; t++) {
+        int node = (thread_node[t] >= 0 && thread_node[t] < MAX_NODES) ? thread_node[t] : 0;
+        node_bytes[node] += thread_bytes[t];
+        node_threads[node]++;
+        if (thread_seconds[t] > node_time[node]) node_time[node] = thread_seconds[t];
+        total_bytes += thread_bytes[t];
+        if (thread_seconds[t] > total_time) total_time = thread_seconds[t];
+    }
+    
+    printf("    Node  Threads   Traffic (MB)   Bandwidth (GB/s)\n");
+    for (int node = 0; node < MAX_NODES; node++) {
+        if (node_threads[node] == 0) continue;
+        printf("    %4d  %7d   %12.1f   %16.2f\n", node, node_threads[node],
+               node_bytes[node] / (1024.0 * 1024.0),
+               (node_time[node] > 0) ? node_bytes[node] / node_time[node] / 1e9 : 0.0);
+    }
+    printf("    Total %7d   %12.1f   %16.2f\n", num_threads, total_bytes / (1024.0 * 1024.0),
+           (total_time > 0) ? total_bytes / total_time / 1e9 : 0.0);
+}
@@ -0,0 +1,59 @@
+/*
+ * Shared: NUMA-Aware Allocation and Thread Placement
+ * 
+ * Description:
+ *   Page-granular allocation with an explicit placement policy, so that
+ *   large arrays end up on the NUMA node of the threads that use them:
+ *     - default:     pages land wherever they are first written (usually
+ *                    the node of the thread that initializes sequentially)
+ *     - first-touch: pages are touched in parallel with schedule(static),
+ *                    the same partition the static kernels use
+ *     - interleave:  pages are spread round-robin over all nodes
+ *                    (requires building with NUMA=1 / libnuma)
+ * 
+ *   The policy is read from the NUMA_PLACEMENT environment variable.
+ *   Pin threads with OMP_PROC_BIND=close|spread and OMP_PLACES=cores so
+ *   the first-touch partition stays on the node it was created on.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef NUMA_ALLOC_H
+#define NUMA_ALLOC_H
+
+#include <stddef.h>
+
+typedef enum {
+    PLACEMENT_DEFAULT,
+    PLACEMENT_FIRST_TOUCH,
+    PLACEMENT_INTERLEAVE
+} MemoryPlacement;
+
+// Allocation (memory is 64-byte aligned; free with numa_aware_free)
+void *numa_aware_alloc(size_t bytes, MemoryPlacement placement);
+void numa_aware_free(void *ptr);
+
+// The same policy for untouched pages from another allocator (e.g. arena.h)
+void numa_place_pages(void *ptr, size_t bytes, MemoryPlacement placement);
+
+// count * elem_size bytes; NULL (with a message) if the size overflows
+// size_t. malloc_array is the plain-heap equivalent (free with free()).
+void *numa_aware_alloc_array(size_t count, size_t elem_size, MemoryPlacement placement);
+void *malloc_array(size_t count, size_t elem_size);
+
+// Policy selection
+MemoryPlacement placement_from_env(void);
+const char *placement_name(MemoryPlacement placement);
+
+// Topology and binding
+int numa_node_count(void);
+int current_numa_node(void);
+size_t last_level_cache_bytes(void);
+void print_thread_binding(void);
+
+// Aggregate per-thread traffic into a per-node bandwidth table
+void print_node_bandwidth(const int *thread_node, const double *thread_bytes,
+                          const double *thread_seconds, int num_threads);
+
+#endif // NUMA_ALLOC_H
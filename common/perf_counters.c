@@ -0,0 +1,179 @@
+/*
+ * Shared: Hardware Performance Counters (perf_event_open)
+ * 
+ * See perf_counters.h for the threading model and permissions.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <omp.h>
+
+#include "perf_counters.h"
+
+typedef struct {
+    const char *name;
+    unsigned int type;
+    unsigned long long config;
+} PerfEventSpec;
+
+#define HW_CACHE(cache, op, result) \
+    ((cache) | ((op) << 8) | ((result) << 16))
+
+static const PerfEventSpec event_specs[PERF_NUM_EVENTS] = {
+    {"cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"llc_misses",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"dtlb_misses",   PERF_TYPE_HW_CACHE,
+     HW_CACHE(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"page_faults",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+// fds[thread * PERF_NUM_EVENTS + event], -1 if not open
+static int *perf_fds = NULL;
+static int perf_threads = 0;
+
+static int perf_event_open(struct perf_event_attr *attr, int group_fd) {
+    // pid = 0, cpu = -1: count the calling thread on any CPU
+    return (int)syscall(SYS_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+
+static int read_paranoid_level(void) {
+    int level = -99;
+    FILE *fp = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+    if (fp) {
+        if (fscanf(fp, "%d", &level) != 1) level = -99;
+        fclose(fp);
+    }
+    return level;
+}
+
+int perf_counters_open(int num_threads) {
+    if (perf_fds) return perf_counters_threads() > 0;
+    
+    perf_fds = (int *)malloc(num_threads * PERF_NUM_EVENTS * sizeof(int));
+    if (!perf_fds) return 0;
+    for (int i = 0; i < num_threads * PERF_NUM_EVENTS; i++) perf_fds[i] = -1;
+    perf_threads = num_threads;
+    
+    int opened[PERF_NUM_EVENTS] = {0};
+    int first_errno = 0;
+    
+    // Each thread opens its own group so the counters follow that thread
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int tid = omp_get_thread_num();
+        int *fds = &perf_fds[tid * PERF_NUM_EVENTS];
+        int leader = -1;
+        
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = event_specs[e].type;
+            attr.config = event_specs[e].config;
+            attr.disabled = (leader < 0);    // Group is enabled via the leader
+            attr.exclude_kernel = 1;         // Allowed at paranoid level 2
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            
+            int fd = perf_event_open(&attr, leader);
+            if (fd < 0 && leader >= 0) {
+                // The group may not fit on the PMU - count it on its own
+                attr.disabled = 1;
+                fd = perf_event_open(&attr, -1);
+            }
+            if (fd < 0) {
+                #pragma omp critical
+                if (!first_errno) first_errno = errno;
+                continue;
+            }
+            fds[e] = fd;
+            if (leader < 0) leader = fd;
+            
+            #pragma omp atomic
+            opened[e]++;
+        }
+    }
+    
+    int available = 0;
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        if (opened[e] > 0) available++;
+    }
+    
+    if (available < PERF_NUM_EVENTS) {
+        fprintf(stderr, "Note: %d of %d perf events unavailable (%s, perf_event_paranoid=%d):",
+                PERF_NUM_EVENTS - available, PERF_NUM_EVENTS,
+                strerror(first_errno), read_paranoid_level());
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+            if (opened[e] == 0) fprintf(stderr, " %s", event_specs[e].name);
+        }
+        fprintf(stderr, "\n");
+    }
+    return available;
+}
+
+void perf_counters_close(void) {
+    if (!perf_fds) return;
+    for (int i = 0; i < perf_threads * PERF_NUM_EVENTS; i++) {
+        if (perf_fds[i] >= 0) close(perf_fds[i]);
+    }
+    free(perf_fds);
+    perf_fds = NULL;
+    perf_threads = 0;
+}
+
+int perf_counters_threads(void) {
+    return perf_threads;
+}
+
+// Apply an ioctl to every open counter. Group members are covered by their
+// leader's ioctl too; repeating it on them is harmless.
+static void perf_ioctl_all(unsigned long request) {
+    if (!perf_fds) return;
+    for (int i = 0; i < perf_threads * PERF_NUM_EVENTS; i++) {
+        if (perf_fds[i] >= 0) ioctl(perf_fds[i], request, 0);
+    }
+}
+
+void perf_counters_enable(void) {
+    perf_ioctl_all(PERF_EVENT_IOC_ENABLE);
+}
+
+void perf_counters_disable(void) {
+    perf_ioctl_all(PERF_EVENT_IOC_DISABLE);
+}
+
+void perf_counters_reset(void) {
+    perf_ioctl_all(PERF_EVENT_IOC_RESET);
+}
+
+void perf_counters_read(PerfCounts *per_thread, int num_threads) {
+    for (int t = 0; t < num_threads; t++) {
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+            int fd = (perf_fds && t < perf_threads) ? perf_fds[t * PERF_NUM_EVENTS + e] : -1;
+            unsigned long long buf[3];  // value, time enabled, time running
+            
+            if (fd < 0 || read(fd, buf, sizeof(buf)) != sizeof(buf)) {
+                per_thread[t].counts[e] = -1.0;
+                continue;
+            }
+            // Scale up if the PMU multiplexed this event
+            double scale = (buf[2] > 0) ? (double)buf[1] / buf[2] : 1.0;
+            per_thread[t].counts[e] = (buf[1] > 0) ? buf[0] * scale : 0.0;
+        }
+    }
+}
+
+const char *perf_event_name(PerfEvent event) {
+    return (event >= 0 && event < PERF_NUM_EVENTS) ? event_specs[event].name : "?";
+}
@@ -0,0 +1,55 @@
+/*
+ * Shared: Hardware Performance Counters (perf_event_open)
+ * 
+ * Description:
+ *   Per-thread counting of cycles, instructions, LLC misses, dTLB misses,
+ *   branch misses and page faults around a kernel, without root:
+ *   counters are opened for the calling threads only and exclude kernel
+ *   mode, which /proc/sys/kernel/perf_event_paranoid <= 2 permits.
+ * 
+ *   Counters are opened once from inside a parallel region, one group per
+ *   OpenMP thread. This relies on the runtime reusing the same OS thread
+ *   for the same thread number across parallel regions (true for libgomp
+ *   and libomp with a fixed team size and no nesting).
+ * 
+ *   Events the CPU or hypervisor does not expose are reported as
+ *   unavailable (-1); the rest still count.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_PAGE_FAULTS,
+    PERF_NUM_EVENTS
+} PerfEvent;
+
+typedef struct {
+    double counts[PERF_NUM_EVENTS];   // -1 if the event is unavailable
+} PerfCounts;
+
+// Open counters for `num_threads` OpenMP threads; returns the number of
+// events that could be opened (0 = counters unavailable)
+int perf_counters_open(int num_threads);
+void perf_counters_close(void);
+int perf_counters_threads(void);
+
+// Start / stop counting on every thread (counts accumulate until reset)
+void perf_counters_enable(void);
+void perf_counters_disable(void);
+void perf_counters_reset(void);
+
+// Multiplexing-scaled counts for each of the first num_threads threads
+void perf_counters_read(PerfCounts *per_thread, int num_threads);
+
+const char *perf_event_name(PerfEvent event);
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,50 @@
+/*
+ * Shared: Counter-Based Random Numbers
+ * 
+ * See rng.h for the generator and why its fills are thread-count independent.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <omp.h>
+#include "rng.h"
+
+void rng_fill_ints(int *out, index_t count, int bound, uint64_t seed) {
+    #pragma omp parallel for simd schedule(static)
+    for (index_t i = 0; i < count; i++) {
+        out[i] = (int)rng_below(rng_bits(seed, 0, (uint64_t)i), (uint32_t)bound);
+    }
+}
+
+void rng_fill_int_values(double *out, index_t count, int bound, uint64_t seed) {
+    #pragma omp parallel for simd schedule(static)
+    for (index_t i = 0; i < count; i++) {
+        out[i] = (double)rng_below(rng_bits(seed, 0, (uint64_t)i), (uint32_t)bound);
+    }
+}
+
+void rng_fill_uniform(double *out, index_t count, double lo, double hi, uint64_t seed) {
+    double scale = hi - lo;
+    #pragma omp parallel for simd schedule(static)
+    for (index_t i = 0; i < count; i++) {
+        out[i] = lo + scale * rng_unit(rng_bits(seed, 0, (uint64_t)i));
+    }
+}
+
+void rng_fill_bytes(unsigned char *out, size_t count, uint64_t offset, uint64_t seed) {
+    if (count == 0) return;
+    
+    // Byte b of the sequence is byte b % 8 (little-endian) of draw b / 8
+    uint64_t first = offset / 8, last = (offset + count - 1) / 8;
+    #pragma omp parallel for schedule(static)
+    for (uint64_t w = first; w <= last; w++) {
+        uint64_t bits = rng_bits(seed, 0, w);
+        for (int b = 0; b < 8; b++) {
+            uint64_t pos = w * 8 + (uint64_t)b;
+            if (pos >= offset && pos < offset + count) {
+                out[pos - offset] = (unsigned char)(bits >> (8 * b));
+            }
+        }
+    }
+}
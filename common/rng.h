@@ -0,0 +1,59 @@
+/*
+ * Shared: Counter-Based Random Numbers
+ * 
+ * Description:
+ *   srand / rand keep one hidden state: the draws come out in a single
+ *   serial order, the calls are not thread-safe, and generating a few
+ *   hundred MB of input takes longer than most kernels run on it. A
+ *   counter-based generator has no state to carry:
+ * 
+ *       draw k of stream s under seed = mix(seed, s, k)
+ * 
+ *   where mix is the SplitMix64 finalizer (two multiply-xorshift rounds
+ *   over a Weyl sequence). Any element can be generated without its
+ *   predecessors, so the fill loops below split the range over threads
+ *   and vectorize (omp simd; AVX-512 has the 64-bit multiply), and their
+ *   output is the same for every thread count and schedule.
+ * 
+ *   Streams separate independent sequences under one seed (e.g. one per
+ *   matrix row); fills use stream 0 with the element index as counter.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "index_types.h"
+
+// 64 random bits: draw k of stream `stream` under `seed`
+static inline uint64_t rng_bits(uint64_t seed, uint64_t stream, uint64_t k) {
+    uint64_t z = seed + stream * 0x9E3779B97F4A7C15ULL + (k + 1) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform double in [0, 1) from the top 53 bits
+static inline double rng_unit(uint64_t bits) {
+    return (bits >> 11) * 0x1.0p-53;
+}
+
+// Integer in [0, bound) by multiply-shift of the top 32 bits (no division;
+// bias below bound / 2^32)
+static inline uint32_t rng_below(uint64_t bits, uint32_t bound) {
+    return (uint32_t)(((bits >> 32) * bound) >> 32);
+}
+
+// Parallel fills, identical for any thread count; element i is draw i of
+// stream 0. rng_fill_bytes continues the same byte sequence from `offset`,
+// so a file written in pieces matches one written at once.
+void rng_fill_ints(int *out, index_t count, int bound, uint64_t seed);
+void rng_fill_int_values(double *out, index_t count, int bound, uint64_t seed);
+void rng_fill_uniform(double *out, index_t count, double lo, double hi, uint64_t seed);
+void rng_fill_bytes(unsigned char *out, size_t count, uint64_t offset, uint64_t seed);
+
+#endif // RNG_H
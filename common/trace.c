@@ -0,0 +1,112 @@
+/*
+ * Shared: Per-Thread Timeline Tracing (Chrome trace / Perfetto export)
+ * 
+ * See trace.h for the recording API.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "trace.h"
+#include "bench.h"
+
+int trace_enabled = 0;
+int trace_num_threads = 0;
+TraceBuffer *trace_buffers = NULL;
+
+static const char *trace_path = NULL;
+static uint64_t trace_tsc0;
+static double trace_wtime0;
+
+void trace_init(void) {
+    if (trace_buffers) return;
+    
+    trace_path = getenv("TRACE_FILE");
+    if (!trace_path || !*trace_path) return;
+    
+    // One buffer per thread plus the driver track
+    trace_num_threads = omp_get_max_threads();
+    trace_buffers = (TraceBuffer *)calloc(trace_num_threads + 1, sizeof(TraceBuffer));
+    if (!trace_buffers) return;
+    for (int t = 0; t <= trace_num_threads; t++) {
+        trace_buffers[t].events = (TraceEvent *)malloc(TRACE_CAPACITY * sizeof(TraceEvent));
+        if (!trace_buffers[t].events) {
+            fprintf(stderr, "Warning: tracing disabled (out of memory)\n");
+            for (int k = 0; k < t; k++) free(trace_buffers[k].events);
+            free(trace_buffers);
+            trace_buffers = NULL;
+            return;
+        }
+    }
+    
+    trace_tsc0 = trace_now();
+    trace_wtime0 = omp_get_wtime();
+    trace_enabled = 1;
+    atexit(trace_write);
+}
+
+static void write_event(FILE *fp, const TraceEvent *ev, int tid, double ticks_per_us, int *first) {
+    fprintf(fp, "%s\n{\"name\":", *first ? "" : ",");
+    json_escape(fp, ev->name);
+    fprintf(fp, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"id\":%ld}}", tid,
+            (double)(ev->begin - trace_tsc0) / ticks_per_us,
+            (double)(ev->end - ev->begin) / ticks_per_us, ev->arg);
+    *first = 0;
+}
+
+// Export as Chrome trace JSON and print a per-thread busy/idle summary
+void trace_write(void) {
+    if (!trace_enabled) return;
+    trace_enabled = 0;
+    
+    // Calibrate TSC ticks against the OpenMP wall clock
+    double elapsed = omp_get_wtime() - trace_wtime0;
+    double ticks_per_us = (elapsed > 0) ? (double)(trace_now() - trace_tsc0) / (elapsed * 1e6) : 1.0;
+    if (ticks_per_us <= 0) ticks_per_us = 1.0;
+    
+    FILE *fp = fopen(trace_path, "w");
+    if (!fp) {
+        fprintf(stderr, "Warning: cannot write trace file '%s'\n", trace_path);
+        return;
+    }
+    
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    int first = 1;
+    for (int t = 0; t <= trace_num_threads; t++) {
+        fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                    "\"args\":{\"name\":\"%s %d\"}}",
+                first ? "" : ",", t, (t < trace_num_threads) ? "OpenMP thread" : "driver", t);
+        first = 0;
+    }
+    
+    printf("\nTrace: %s\n", trace_path);
+    printf("    %6s %10s %12s %12s\n", "Thread", "Events", "Busy (ms)", "Dropped");
+    for (int t = 0; t <= trace_num_threads; t++) {
+        TraceBuffer *buf = &trace_buffers[t];
+        uint64_t kept = (buf->count < TRACE_CAPACITY) ? buf->count : TRACE_CAPACITY;
+        uint64_t start = buf->count - kept;
+        double busy = 0.0;
+        
+        for (uint64_t k = start; k < buf->count; k++) {
+            const TraceEvent *ev = &buf->events[k % TRACE_CAPACITY];
+            write_event(fp, ev, t, ticks_per_us, &first);
+            busy += (double)(ev->end - ev->begin) / ticks_per_us;
+        }
+        if (t < trace_num_threads) {
+            printf("    %6d %10llu %12.3f %12llu\n", t, (unsigned long long)kept,
+                   busy / 1000.0, (unsigned long long)start);
+        }
+        free(buf->events);
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    
+    free(trace_buffers);
+    trace_buffers = NULL;
+}
@@ -0,0 +1,89 @@
+/*
+ * Shared: Per-Thread Timeline Tracing (Chrome trace / Perfetto export)
+ * 
+ * Description:
+ *   Records begin/end events of chunks, blocks or phases into one ring
+ *   buffer per OpenMP thread. Timestamps come from the TSC (rdtsc), and
+ *   a thread only ever writes its own buffer, so the hot path takes no
+ *   locks and touches no shared cache lines.
+ * 
+ *   Enable with TRACE_FILE=trace.json; the file is written at exit and
+ *   can be opened in chrome://tracing or https://ui.perfetto.dev to see
+ *   per-thread work, idle time and scheduling gaps. When TRACE_FILE is
+ *   unset every call below is a single predictable branch.
+ * 
+ *   Usage:
+ *       uint64_t t0 = trace_begin();
+ *       ... work on one chunk ...
+ *       trace_end("spmv_dynamic chunk", t0, first_row);
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <omp.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+#define TRACE_CAPACITY (1 << 16)   // Events kept per thread (oldest dropped)
+
+typedef struct {
+    const char *name;    // Must outlive the trace (string literal)
+    uint64_t begin;
+    uint64_t end;
+    long arg;            // Chunk / block identifier shown in the viewer
+} TraceEvent;
+
+typedef struct {
+    TraceEvent *events;
+    uint64_t count;      // Total events recorded (ring index = count % capacity)
+    char pad[64 - sizeof(TraceEvent *) - sizeof(uint64_t)];  // No false sharing
+} TraceBuffer;
+
+extern int trace_enabled;
+extern int trace_num_threads;
+extern TraceBuffer *trace_buffers;
+
+// Read TRACE_FILE and allocate buffers; the trace is written at exit
+void trace_init(void);
+void trace_write(void);
+
+static inline uint64_t trace_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t trace_begin(void) {
+    return trace_enabled ? trace_now() : 0;
+}
+
+// Record an event on `track` (an OpenMP thread number, or trace_num_threads
+// for the driver track used outside parallel regions)
+static inline void trace_record(int track, const char *name, uint64_t begin, long arg) {
+    if (!trace_enabled || track < 0 || track > trace_num_threads) return;
+    TraceBuffer *buf = &trace_buffers[track];
+    TraceEvent *ev = &buf->events[buf->count % TRACE_CAPACITY];
+    ev->name = name;
+    ev->begin = begin;
+    ev->end = trace_now();
+    ev->arg = arg;
+    buf->count++;
+}
+
+static inline void trace_end(const char *name, uint64_t begin, long arg) {
+    trace_record(omp_get_thread_num(), name, begin, arg);
+}
+
+#endif // TRACE_H
@@ -0,0 +1,1150 @@
+/*
+ * Kernel Driver: One Binary for Every Kernel in libdatapatterns
+ * 
+ * Description:
+ *   Selects a kernel, an engine (parallelization strategy), a problem size
+ *   and a thread count from the command line, runs it through the shared
+ *   benchmark harness and verifies it against the sequential engine.
+ *   Results go to stdout and, like every task, to BENCH_JSON / BENCH_CSV.
+ * 
+ * Compilation: make driver  (links libdatapatterns: ../kernels, ../common)
+ * Usage: ./data_patterns.exe --kernel NAME [--engine NAME|all] [--size N]
+ *                            [--threads T] [--block B] [--density D]
+ *                            [--chunk BYTES] [--schedule SPEC] [--no-verify]
+ *                            [--matrix FILE] [--save-csr FILE] [--skew S] [--rhs K]
+ *                            [--reorder rcm|degree|none] [--precision double|float|half]
+ *                            [--max-iterations N] [--tolerance TOL] [--updates N]
+ *        ./data_patterns.exe --list
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <omp.h>
+#include "data_patterns.h"
+
+#define MAX_ENGINES 12
+#define DRIVER_MAX_FILL 4.0   // sell / ell engines skip matrices padded beyond this
+#define DRIVER_DELETE_SHARE 0.5  // spmv_dynamic: deletes among the updates of a batch
+
+typedef struct {
+    const char *kernel;
+    const char *engine;      // Engine name or "all"
+    long size;               // 0 = kernel default
+    int threads;             // 0 = OMP_NUM_THREADS
+    int block_size;
+    double density;
+    double skew;             // spmv: power-law row lengths, 0 = uniform
+    int chunk_size;
+    const char *schedule;    // Spec for the 'scheduled' engine, NULL = env / adaptive
+    const char *matrix;      // Sparse kernels: .mtx / .csr file instead of a random matrix
+    const char *save_csr;    // spmv: write the matrix as binary CSR
+    ReorderKind reorder;     // spmv: permute the matrix before the engines run
+    ValuePrecision precision; // spmv: value storage of the varint / block16 engines
+    int rhs;                 // spmm: right-hand sides per block
+    int max_iterations;      // solver: iteration limit
+    double tolerance;        // solver: relative residual to converge to
+    int updates;             // spmv_dynamic: inserts + deletes per batch
+    int verify;
+} DriverOptions;
+
+typedef struct KernelInfo {
+    const char *name;
+    const char *description;
+    const char *size_meaning;
+    long default_size;
+    int square;              // size is a matrix dimension: size^2 elements
+    const char *engines[MAX_ENGINES];
+    int (*run)(const struct KernelInfo *info, const DriverOptions *opt);
+} KernelInfo;
+
+static int run_gemm(const KernelInfo *info, const DriverOptions *opt);
+static int run_transpose(const KernelInfo *info, const DriverOptions *opt);
+static int run_histogram(const KernelInfo *info, const DriverOptions *opt);
+static int run_vector_add(const KernelInfo *info, const DriverOptions *opt);
+static int run_spmv(const KernelInfo *info, const DriverOptions *opt);
+static int run_spmm(const KernelInfo *info, const DriverOptions *opt);
+static int run_spmv_sym(const KernelInfo *info, const DriverOptions *opt);
+static int run_spmv_t(const KernelInfo *info, const DriverOptions *opt);
+static int run_solver(const KernelInfo *info, const DriverOptions *opt);
+static int run_spgemm(const KernelInfo *info, const DriverOptions *opt);
+static int run_spmv_dynamic(const KernelInfo *info, const DriverOptions *opt);
+static int run_xor(const KernelInfo *info, const DriverOptions *opt);
+static int run_alloc(const KernelInfo *info, const DriverOptions *opt);
+
+static const KernelInfo kernels[] = {
+    {"gemm", "dense matrix multiplication C = A * B", "matrix dimension N",
+     512, 1, {"sequential", "blocked"}, run_gemm},
+    {"transpose", "square matrix transpose B = A^T", "matrix dimension N",
+     4096, 1, {"sequential", "naive", "blocked"}, run_transpose},
+    {"histogram", "histogram of integers 0-9", "array length",
+     10000000, 0, {"sequential", "atomic", "reduction"}, run_histogram},
+    {"vector_add", "vector addition C = A + B", "vector length",
+     100000000, 0, {"sequential", "static", "dynamic", "simd", "scheduled"}, run_vector_add},
+    {"spmv", "CSR sparse matrix-vector product y = A * x", "number of rows (square)",
+     50000, 0, {"sequential", "static", "dynamic", "scheduled", "nnz_balanced", "merge_path",
+             "sell", "ell", "varint", "block16", "advised"}, run_spmv},
+    {"spmm", "CSR times a block of dense vectors Y = A * X", "number of rows (square)",
+     50000, 0, {"sequential", "spmv_loop", "spmm"}, run_spmm},
+    {"spmv_sym", "symmetric SpMV from the upper triangle only", "number of rows (square)",
+     50000, 0, {"sequential", "dynamic", "upper"}, run_spmv_sym},
+    {"spmv_t", "transposed SpMV y = A^T * x", "number of rows (square)",
+     50000, 0, {"sequential", "transposed", "direct"}, run_spmv_t},
+    {"solver", "CG / BiCGSTAB solve of A x = b (diagonally dominant A)", "number of rows (square)",
+     50000, 0, {"cg_unfused", "cg", "cg_jacobi", "bicgstab", "bicgstab_jacobi"}, run_solver},
+    {"spgemm", "sparse matrix-matrix product C = A * A", "number of rows (square)",
+     50000, 0, {"sequential", "hash", "dense", "auto"}, run_spgemm},
+    {"spmv_dynamic", "batches of edge updates, each followed by y = A * x", "number of rows (square)",
+     50000, 0, {"rebuild", "delta"}, run_spmv_dynamic},
+    {"xor", "chunked XOR transform of a byte buffer", "buffer size in bytes",
+     10 * 1024 * 1024, 0, {"sequential", "chunks"}, run_xor},
+    {"alloc", "allocate, write and release a buffer per run", "buffer size in bytes",
+     256L * 1024 * 1024, 0, {"malloc", "arena", "arena_populate", "arena_thp", "arena_2m",
+                             "arena_1g"}, run_alloc},
+};
+
+#define NUM_KERNELS ((int)(sizeof(kernels) / sizeof(kernels[0])))
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s --kernel NAME [options]\n", prog);
+    printf("  -k, --kernel NAME    kernel to run (see --list)\n");
+    printf("  -e, --engine NAME    engine to run, or 'all' (default)\n");
+    printf("  -n, --size N         problem size (kernel specific, see --list)\n");
+    printf("  -t, --threads T      OpenMP threads (default: OMP_NUM_THREADS)\n");
+    printf("  -b, --block B        block size for gemm/transpose (default 64)\n");
+    printf("  -d, --density D      non-zero fraction for spmv (default 0.05)\n");
+    printf("      --skew S         spmv: power-law row lengths, weight ~ rank^-S (default 0)\n");
+    printf("  -c, --chunk BYTES    chunk size for xor (default 1 MB)\n");
+    printf("  -s, --schedule SPEC  kind[:chunk] for the 'scheduled' engine, kind one of\n");
+    printf("                       static|dynamic|guided|taskloop|steal|adaptive\n");
+    printf("                       (default: VECTOR_SCHEDULE / SPMV_SCHEDULE, else adaptive)\n");
+    printf("  -m, --matrix FILE    sparse kernels: load a Matrix Market (.mtx) or binary CSR\n");
+    printf("                       (.csr) file instead of generating (size, density ignored)\n");
+    printf("      --save-csr FILE  spmv: write the matrix as binary CSR for fast reloads\n");
+    printf("      --rhs K          spmm: right-hand sides per block (default 16)\n");
+    printf("      --reorder KIND   spmv: rcm|degree|none, reorder before the engines and\n");
+    printf("                       report bandwidth / reuse distance before and after\n");
+    printf("      --precision P    spmv: double|float|half values for the compressed CSR\n");
+    printf("                       engines varint / block16 (default double)\n");
+    printf("      --max-iterations N  solver: iteration limit (default 1000)\n");
+    printf("      --tolerance TOL  solver: stop at ||b - Ax|| / ||b|| <= TOL (default 1e-8)\n");
+    printf("      --updates N      spmv_dynamic: inserts + deletes per batch (default 4096)\n");
+    printf("      --no-verify      skip the comparison against 'sequential'\n");
+    printf("  -l, --list           list kernels and engines\n");
+}
+
+static void print_kernel_list(void) {
+    printf("Kernels (size meaning, default size) and engines:\n");
+    for (int k = 0; k < NUM_KERNELS; k++) {
+        printf("  %-11s %s\n", kernels[k].name, kernels[k].description);
+        printf("              size: %s (default %ld)\n",
+               kernels[k].size_meaning, kernels[k].default_size);
+        printf("              engines:");
+        for (int e = 0; e < MAX_ENGINES && kernels[k].engines[e]; e++) {
+            printf(" %s", kernels[k].engines[e]);
+        }
+        printf("\n");
+    }
+}
+
+static const KernelInfo *find_kernel(const char *name) {
+    for (int k = 0; k < NUM_KERNELS; k++) {
+        if (strcmp(kernels[k].name, name) == 0) return &kernels[k];
+    }
+    return NULL;
+}
+
+static int kernel_has_engine(const KernelInfo *info, const char *engine) {
+    if (strcmp(engine, "all") == 0) return 1;
+    for (int e = 0; e < MAX_ENGINES && info->engines[e]; e++) {
+        if (strcmp(info->engines[e], engine) == 0) return 1;
+    }
+    return 0;
+}
+
+// Should this engine run under the current --engine selection?
+static int engine_selected(const DriverOptions *opt, const char *engine) {
+    return strcmp(opt->engine, "all") == 0 || strcmp(opt->engine, engine) == 0;
+}
+
+// Start of one engine's section of the report
+static void announce_engine(const KernelInfo *info, const char *engine) {
+    printf("\n[%s] Running %s engine...\n", info->name, engine);
+}
+
+// Schedule of the 'scheduled' engine: --schedule, else the first entry of the
+// kernel's environment variable, else adaptive
+static Schedule driver_schedule(const DriverOptions *opt, const char *env_var) {
+    Schedule sched = {SCHED_ADAPTIVE, 0};
+    if (opt->schedule) {
+        schedule_parse(opt->schedule, &sched);
+    } else {
+        schedule_list_from_env(env_var, &sched, 1);
+    }
+    char spec[32];
+    schedule_format(sched, spec, sizeof(spec));
+    printf("Schedule (scheduled engine): %s\n", spec);
+    return sched;
+}
+
+// Print the outcome of one verification and pass it through
+static int report_check(const char *engine, int correct) {
+    if (correct) {
+        printf("    ✓ %s matches the sequential reference\n", engine);
+    } else {
+        printf("    ✗ %s differs from the sequential reference\n", engine);
+    }
+    return correct;
+}
+
+// ---------------------------------------------------------------------------
+// Kernels
+// ---------------------------------------------------------------------------
+
+static int run_gemm(const KernelInfo *info, const DriverOptions *opt) {
+    index_t N = (index_t)opt->size;
+    MemoryPlacement placement = placement_from_env();
+    double *A = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    double *B = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    double *C = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    double *C_ref = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    if (!A || !B || !C || !C_ref) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    for (long i = 0; i < (long)N * N; i++) {
+        A[i] = (double)(i % 10);
+        B[i] = (double)((i * 7) % 10);
+    }
+    if (opt->verify) sequential_multiply(A, B, C_ref, N);
+    
+    double flops = 2.0 * N * N * N;
+    double bytes = 3.0 * N * N * sizeof(double);
+    int correct = 1;
+    
+    if (engine_selected(opt, "sequential")) {
+        announce_engine(info, "sequential");
+        Benchmark b = bench_begin("gemm", "sequential", N, flops, bytes);
+        while (bench_next(&b)) sequential_multiply(A, B, C, N);
+        bench_end(&b);
+    }
+    if (engine_selected(opt, "blocked")) {
+        announce_engine(info, "blocked");
+        Benchmark b = bench_begin("gemm", "blocked", N, flops, bytes);
+        while (bench_next(&b)) parallel_multiply_blocked(A, B, C, N, opt->block_size);
+        bench_end(&b);
+        if (opt->verify) {
+            correct &= report_check("blocked", verify_results(C_ref, C, (long)N * N, 1e-6));
+        }
+    }
+    
+    numa_aware_free(A);
+    numa_aware_free(B);
+    numa_aware_free(C);
+    numa_aware_free(C_ref);
+    return correct;
+}
+
+static int run_transpose(const KernelInfo *info, const DriverOptions *opt) {
+    index_t N = (index_t)opt->size;
+    MemoryPlacement placement = placement_from_env();
+    double *A = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    double *B = (double *)numa_aware_alloc_array((size_t)N * N, sizeof(double), placement);
+    if (!A || !B) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    for (long i = 0; i < (long)N * N; i++) A[i] = (double)i;
+    
+    // One read and one write per element
+    double bytes = 2.0 * N * N * sizeof(double);
+    int correct = 1;
+    
+    for (int e = 0; e < 3; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        announce_engine(info, engine);
+        Benchmark b = bench_begin("transpose", engine, N, 0.0, bytes);
+        while (bench_next(&b)) {
+            if (e == 0) transpose_sequential(A, B, N);
+            else if (e == 1) transpose_parallel_naive(A, B, N);
+            else transpose_parallel_blocked(A, B, N, opt->block_size);
+        }
+        bench_end(&b);
+        // The reference is the definition itself: B[j][i] == A[i][j]
+        if (opt->verify) correct &= report_check(engine, verify_transpose(A, B, N));
+    }
+    
+    numa_aware_free(A);
+    numa_aware_free(B);
+    return correct;
+}
+
+static int run_histogram(const KernelInfo *info, const DriverOptions *opt) {
+    index_t size = (index_t)opt->size;
+    int *data = (int *)malloc_array(size, sizeof(int));
+    if (!data) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    rng_fill_ints(data, size, NUM_BINS, 42);
+    
+    index_t hist_ref[NUM_BINS], hist[NUM_BINS];
+    if (opt->verify) histogram_sequential(data, size, hist_ref);
+    
+    double bytes = (double)size * sizeof(int);
+    int correct = 1;
+    
+    for (int e = 0; e < 3; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        announce_engine(info, engine);
+        Benchmark b = bench_begin("histogram", engine, size, 0.0, bytes);
+        while (bench_next(&b)) {
+            if (e == 0) histogram_sequential(data, size, hist);
+            else if (e == 1) histogram_parallel_atomic(data, size, hist);
+            else histogram_parallel_reduction(data, size, hist);
+        }
+        bench_end(&b);
+        if (opt->verify && e > 0) correct &= report_check(engine, verify_histograms(hist_ref, hist));
+    }
+    
+    free(data);
+    return correct;
+}
+
+static int run_vector_add(const KernelInfo *info, const DriverOptions *opt) {
+    index_t size = (index_t)opt->size;
+    MemoryPlacement placement = placement_from_env();
+    double *A = (double *)numa_aware_alloc_array(size, sizeof(double), placement);
+    double *B = (double *)numa_aware_alloc_array(size, sizeof(double), placement);
+    double *C = (double *)numa_aware_alloc_array(size, sizeof(double), placement);
+    double *C_ref = (double *)numa_aware_alloc_array(size, sizeof(double), placement);
+    if (!A || !B || !C || !C_ref) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < size; i++) {
+        A[i] = (double)i;
+        B[i] = 2.0 * i;
+    }
+    if (opt->verify) vector_add_sequential(A, B, C_ref, size);
+    
+    // 1 FLOP per element; read A and B, write C
+    double bytes = 3.0 * size * sizeof(double);
+    int correct = 1;
+    
+    // The simd engine picks non-temporal stores once A, B, C exceed the LLC
+    int streaming = vector_add_streaming_default(size);
+    Schedule sched = driver_schedule(opt, "VECTOR_SCHEDULE");
+    long chunk_used = 0;
+    
+    for (int e = 0; e < 5; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        announce_engine(info, engine);
+        Benchmark b = bench_begin("vector_add", engine, size, (double)size, bytes);
+        while (bench_next(&b)) {
+            if (e == 0) vector_add_sequential(A, B, C, size);
+            else if (e == 1) vector_add_parallel_static(A, B, C, size);
+            else if (e == 2) vector_add_parallel_dynamic(A, B, C, size);
+            else if (e == 3) vector_add_simd(A, B, C, size, streaming, VECTOR_PREFETCH_DEFAULT);
+            else chunk_used = vector_add_scheduled(A, B, C, size, sched);
+        }
+        bench_end(&b);
+        if (e == 4) printf("    Chunk used: %ld elements\n", chunk_used);
+        if (opt->verify && e > 0) correct &= report_check(engine, verify_results(C_ref, C, size, 1e-9));
+    }
+    
+    numa_aware_free(A);
+    numa_aware_free(B);
+    numa_aware_free(C);
+    numa_aware_free(C_ref);
+    return correct;
+}
+
+static void print_locality(const char *label, const CSRMatrix *A) {
+    LocalityStats stats;
+    locality_stats(A, 0, &stats);
+    printf("Locality %-9s bandwidth %ld, profile %.4g, reuse distance %.1f nnz, hit rate %.1f%%\n",
+           label, (long)stats.bandwidth, stats.profile, stats.mean_reuse_nnz,
+           stats.reuse_hit_rate * 100.0);
+}
+
+// Replace *A by P A P^T and x, y_ref by their permuted copies (scratch: n doubles)
+static index_t *reorder_spmv_problem(CSRMatrix **A, ReorderKind kind, double *x, double *y_ref,
+                                     double *scratch) {
+    index_t n = (*A)->num_rows;
+    print_locality("before:", *A);
+    double start = omp_get_wtime();
+    index_t *perm = reorder_permutation(*A, kind);
+    CSRMatrix *B = perm ? csr_permute(*A, perm) : NULL;
+    if (!B) {
+        free(perm);
+        return NULL;
+    }
+    permute_vector(x, perm, n, scratch);
+    memcpy(x, scratch, n * sizeof(double));
+    double cost = omp_get_wtime() - start;
+    permute_vector(y_ref, perm, n, scratch);
+    memcpy(y_ref, scratch, n * sizeof(double));
+    
+    free_csr_matrix(*A);
+    *A = B;
+    print_locality("after:", B);
+    printf("Reordering (%s): %.3f ms for permutation, matrix and x\n", reorder_name(kind), cost * 1e3);
+    return perm;
+}
+
+static int run_spmv(const KernelInfo *info, const DriverOptions *opt) {
+    double load_start = omp_get_wtime();
+    CSRMatrix *A = opt->matrix ? csr_load(opt->matrix)
+                               : create_skewed_sparse_matrix((index_t)opt->size, (index_t)opt->size,
+                                                             opt->density, opt->skew);
+    if (!A) return 0;
+    printf("Matrix %s: %ld x %ld in %.3f s\n", opt->matrix ? opt->matrix : "generated",
+           (long)A->num_rows, (long)A->num_cols, omp_get_wtime() - load_start);
+    if (opt->save_csr) {
+        if (!csr_write_binary(A, opt->save_csr)) return 0;
+        printf("Saved binary CSR: %s\n", opt->save_csr);
+    }
+    index_t num_rows = A->num_rows;
+    double *x = (double *)malloc_array(A->num_cols, sizeof(double));
+    double *y = (double *)malloc_array(num_rows, sizeof(double));
+    double *y_ref = (double *)malloc_array(num_rows, sizeof(double));
+    if (!x || !y || !y_ref) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    for (index_t i = 0; i < A->num_cols; i++) x[i] = 1.0 + (i % 7);
+    if (opt->verify || opt->reorder != REORDER_NONE) spmv_sequential(A, x, y_ref);
+    
+    // Engines run on the permuted problem; the reference is the original
+    // product, permuted, so the check covers the reordering too
+    index_t *perm = NULL;
+    if (opt->reorder != REORDER_NONE) {
+        perm = reorder_spmv_problem(&A, opt->reorder, x, y_ref, y);
+        if (!perm) return 0;
+    }
+    
+    printf("Non-zeros: %ld (%.2f per row)\n", (long)A->nnz, (double)A->nnz / num_rows);
+    double flops = 2.0 * A->nnz;
+    double bytes = csr_matrix_bytes(A) + (double)(A->num_cols + num_rows) * sizeof(double);
+    int correct = 1;
+    Schedule sched = driver_schedule(opt, "SPMV_SCHEDULE");
+    long chunk_used = 0;
+    
+    // Structure of the matrix as run (after any reordering): printed,
+    // attached to every JSON result, and applied by the advised engine
+    SparseMatrixStats stats;
+    SpmvAdvice advice;
+    sparse_matrix_stats(A, 0, &stats);
+    spmv_advise(&stats, &advice);
+    sparse_stats_print(&stats, &advice);
+    char stats_json[1024];
+    if (sparse_stats_json(&stats, &advice, stats_json, sizeof(stats_json))) {
+        bench_set_json_fields(stats_json);
+    }
+    
+    for (int e = 0; e < 11; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        // sell / ell / varint / block16 / advised: convert outside the timed
+        // region, traffic of the converted arrays
+        SellMatrix *S = NULL;
+        CompressedCSR *M = NULL;
+        SpmvPlan *plan = NULL;
+        if (e == 6 || e == 7) {
+            double fill = (e == 6) ? sell_fill_ratio(A, SELL_DEFAULT_CHUNK, SELL_DEFAULT_SIGMA)
+                                   : ell_fill_ratio(A);
+            if (fill > DRIVER_MAX_FILL) {
+                printf("\n[spmv] Skipping %s engine: %.1f stored slots per non-zero\n", engine, fill);
+                continue;
+            }
+            S = (e == 6) ? sell_from_csr(A, SELL_DEFAULT_CHUNK, SELL_DEFAULT_SIGMA) : ell_from_csr(A);
+            if (!S) return 0;
+        }
+        if (e == 8 || e == 9) {
+            M = compressed_csr_from_csr(A, (e == 8) ? COLUMN_CODEC_VARINT : COLUMN_CODEC_BLOCK16,
+                                        opt->precision);
+            if (!M) return 0;
+        }
+        if (e == 10) {
+            plan = spmv_plan_create(A, &advice);
+            if (!plan) return 0;
+        }
+        
+        announce_engine(info, engine);
+        double engine_bytes = bytes;
+        if (S) engine_bytes = bytes - csr_matrix_bytes(A) + sell_matrix_bytes(S);
+        if (M) engine_bytes = bytes - csr_matrix_bytes(A) + compressed_csr_bytes(M);
+        if (plan) engine_bytes = bytes - csr_matrix_bytes(A) + spmv_plan_bytes(plan);
+        Benchmark b = bench_begin("spmv", engine, num_rows, flops, engine_bytes);
+        while (bench_next(&b)) {
+            if (e == 0) spmv_sequential(A, x, y);
+            else if (e == 1) spmv_parallel_static(A, x, y);
+            else if (e == 2) spmv_parallel_dynamic(A, x, y);
+            else if (e == 3) chunk_used = spmv_scheduled(A, x, y, sched);
+            else if (e == 4) spmv_nnz_balanced(A, x, y);
+            else if (e == 5) spmv_merge_path(A, x, y);
+            else if (S) sell_spmv(S, x, y);
+            else if (M) spmv_compressed(M, x, y);
+            else spmv_plan_run(plan, x, y);
+        }
+        bench_end(&b);
+        if (e == 3) printf("    Chunk used: %ld rows\n", chunk_used);
+        if (S) {
+            double padding = (S->nnz > 0) ? (double)(S->stored - S->nnz) / S->nnz : 0.0;
+            printf("    Padding: %.1f%% (%s gathers)\n", padding * 100.0,
+                   simd_isa_name(vector_simd_isa()));
+            free_sell_matrix(S);
+        }
+        if (M) {
+            printf("    Compressed: %.2f bytes/nnz (%s values, CSR %.2f)\n",
+                   (M->nnz > 0) ? compressed_csr_bytes(M) / M->nnz : 0.0,
+                   value_precision_name(M->precision),
+                   (A->nnz > 0) ? csr_matrix_bytes(A) / A->nnz : 0.0);
+            free_compressed_csr(M);
+        }
+        if (plan) {
+            printf("    Advised: %s partition, %s storage\n",
+                   spmv_partition_name(advice.partition), sparse_format_name(advice.format));
+            free_spmv_plan(plan);
+        }
+        // merge_path (also as advised) sums split rows in a different order; float / half
+        // values are off by their rounding relative to the largest |y|
+        double tolerance = (e == 5 || e == 10) ? 1e-6 : 1e-9;
+        if (M && opt->precision != VALUE_PRECISION_DOUBLE) {
+            double y_max = 0.0;
+            for (index_t i = 0; i < num_rows; i++) {
+                if (fabs(y_ref[i]) > y_max) y_max = fabs(y_ref[i]);
+            }
+            tolerance = y_max * ((opt->precision == VALUE_PRECISION_FLOAT) ? 1e-6 : 1e-3);
+        }
+        if (opt->verify && e > 0) correct &= report_check(engine, verify_results(y_ref, y, num_rows, tolerance));
+    }
+    
+    free_csr_matrix(A);
+    free(perm);
+    free(x);
+    free(y);
+    free(y_ref);
+    return correct;
+}
+
+static int run_spmm(const KernelInfo *info, const DriverOptions *opt) {
+    CSRMatrix *A = opt->matrix ? csr_load(opt->matrix)
+                               : create_skewed_sparse_matrix((index_t)opt->size, (index_t)opt->size,
+                                                             opt->density, opt->skew);
+    if (!A) return 0;
+    int k = opt->rhs;
+    index_t rows = A->num_rows, cols = A->num_cols;
+    // X / Y row-major blocks; the k vectors also stored one after another
+    // for the SpMV engines
+    double *X = (double *)malloc_array((size_t)cols * k, sizeof(double));
+    double *Y = (double *)malloc_array((size_t)rows * k, sizeof(double));
+    double *X_vectors = (double *)malloc_array((size_t)cols * k, sizeof(double));
+    double *Y_vectors = (double *)malloc_array((size_t)rows * k, sizeof(double));
+    double *Y_ref = (double *)malloc_array((size_t)rows * k, sizeof(double));
+    if (!X || !Y || !X_vectors || !Y_vectors || !Y_ref) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    for (index_t c = 0; c < cols; c++) {
+        for (int r = 0; r < k; r++) {
+            X[(size_t)c * k + r] = 1.0 + ((c + r) % 7);
+            X_vectors[(size_t)r * cols + c] = X[(size_t)c * k + r];
+        }
+    }
+    if (opt->verify) {
+        for (int r = 0; r < k; r++) {
+            spmv_sequential(A, X_vectors + (size_t)r * cols, Y_ref + (size_t)r * rows);
+        }
+    }
+    
+    printf("Non-zeros: %ld, right-hand sides: %d (%s)\n", (long)A->nnz, k,
+           simd_isa_name(vector_simd_isa()));
+    double flops = 2.0 * A->nnz * k;
+    double vector_bytes = (double)(cols + rows) * k * sizeof(double);
+    int correct = 1;
+    
+    for (int e = 0; e < 3; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        // The SpMV engines stream the matrix once per right-hand side
+        announce_engine(info, engine);
+        double matrix_bytes = (e < 2 ? k : 1) * csr_matrix_bytes(A);
+        Benchmark b = bench_begin("spmm", engine, rows, flops, matrix_bytes + vector_bytes);
+        while (bench_next(&b)) {
+            if (e == 2) {
+                spmm_csr(A, X, Y, k);
+                continue;
+            }
+            for (int r = 0; r < k; r++) {
+                double *x = X_vectors + (size_t)r * cols, *y = Y_vectors + (size_t)r * rows;
+                if (e == 0) spmv_sequential(A, x, y);
+                else spmv_parallel_dynamic(A, x, y);
+            }
+        }
+        bench_end(&b);
+        if (!opt->verify || e == 0) continue;
+        
+        // SpMM results back to one-vector-after-another order; FMA may
+        // round the sums differently
+        if (e == 2) {
+            for (index_t i = 0; i < rows; i++) {
+                for (int r = 0; r < k; r++) Y_vectors[(size_t)r * rows + i] = Y[(size_t)i * k + r];
+            }
+        }
+        correct &= report_check(engine, verify_results(Y_ref, Y_vectors, (long)rows * k, 1e-6));
+    }
+    
+    free_csr_matrix(A);
+    free(X);
+    free(Y);
+    free(X_vectors);
+    free(Y_vectors);
+    free(Y_ref);
+    return correct;
+}
+
+// Matrix of --matrix / the generator, mirrored from its upper triangle
+// unless already symmetric
+static CSRMatrix *load_symmetric_matrix(const DriverOptions *opt) {
+    CSRMatrix *A = opt->matrix ? csr_load(opt->matrix)
+                               : create_skewed_sparse_matrix((index_t)opt->size, (index_t)opt->size,
+                                                             opt->density, opt->skew);
+    if (!A || csr_is_symmetric(A)) return A;
+    CSRMatrix *F = csr_symmetrize_upper(A);
+    free_csr_matrix(A);
+    if (F) printf("Matrix is not symmetric: using its upper triangle mirrored\n");
+    return F;
+}
+
+static int run_spmv_sym(const KernelInfo *info, const DriverOptions *opt) {
+    CSRMatrix *A = load_symmetric_matrix(opt);
+    if (!A) return 0;
+    double build_start = omp_get_wtime();
+    SymmetricCSR *S = symmetric_from_csr(A);
+    if (!S) return 0;
+    printf("Upper triangle: %ld of %ld non-zeros stored, built in %.3f ms\n",
+           (long)S->upper->nnz, (long)A->nnz, (omp_get_wtime() - build_start) * 1e3);
+    index_t n = A->num_rows;
+    double *x = (double *)malloc_array(n, sizeof(double));
+    double *y = (double *)malloc_array(n, sizeof(double));
+    double *y_ref = (double *)malloc_array(n, sizeof(double));
+    if (!x || !y || !y_ref) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    for (index_t i = 0; i < n; i++) x[i] = 1.0 + (i % 7);
+    if (opt->verify) spmv_sequential(A, x, y_ref);
+    
+    double flops = 2.0 * A->nnz;
+    double vector_bytes = 2.0 * n * sizeof(double);
+    int correct = 1;
+    for (int e = 0; e < 3; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        announce_engine(info, engine);
+        double matrix_bytes = (e == 2) ? symmetric_csr_bytes(S) : csr_matrix_bytes(A);
+        Benchmark b = bench_begin("spmv_sym", engine, n, flops, matrix_bytes + vector_bytes);
+        while (bench_next(&b)) {
+            if (e == 0) spmv_sequential(A, x, y);
+            else if (e == 1) spmv_parallel_dynamic(A, x, y);
+            else spmv_symmetric(S, x, y);
+        }
+        bench_end(&b);
+        // upper adds the transposed half in a different order
+        if (opt->verify && e > 0) correct &= report_check(engine, verify_results(y_ref, y, n, 1e-6));
+    }
+    
+    free_symmetric_csr(S);
+    free_csr_matrix(A);
+    free(x);
+    free(y);
+    free(y_ref);
+    return correct;
+}
+
+static int run_spmv_t(const KernelInfo *info, const DriverOptions *opt) {
+    CSRMatrix *A = opt->matrix ? csr_load(opt->matrix)
+                               : create_skewed_sparse_matrix((index_t)opt->size, (index_t)opt->size,
+                                                             opt->density, opt->skew);
+    if (!A) return 0;
+    double transpose_start = omp_get_wtime();
+    CSRMatrix *T = csr_transpose(A);
+    if (!T) return 0;
+    printf("Explicit transpose (transposed engine): %.3f ms\n",
+           (omp_get_wtime() - transpose_start) * 1e3);
+    double *x = (double *)malloc_array(A->num_rows, sizeof(double));
+    double *y = (double *)malloc_array(A->num_cols, sizeof(double));
+    double *y_ref = (double *)malloc_array(A->num_cols, sizeof(double));
+    if (!x || !y || !y_ref) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    for (index_t i = 0; i < A->num_rows; i++) x[i] = 1.0 + (i % 7);
+    if (opt->verify) spmv_sequential(T, x, y_ref);
+    
+    double flops = 2.0 * A->nnz;
+    double bytes = csr_matrix_bytes(A) + (double)(A->num_rows + A->num_cols) * sizeof(double);
+    int correct = 1;
+    for (int e = 0; e < 3; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        announce_engine(info, engine);
+        Benchmark b = bench_begin("spmv_t", engine, A->num_rows, flops, bytes);
+        while (bench_next(&b)) {
+            if (e == 0) spmv_sequential(T, x, y);
+            else if (e == 1) spmv_parallel_dynamic(T, x, y);
+            else spmv_transpose(A, x, y);
+        }
+        bench_end(&b);
+        // direct sums the per-thread buffers in a different order
+        if (opt->verify && e > 0) {
+            correct &= report_check(engine, verify_results(y_ref, y, A->num_cols, 1e-6));
+        }
+    }
+    
+    free_csr_matrix(T);
+    free_csr_matrix(A);
+    free(x);
+    free(y);
+    free(y_ref);
+    return correct;
+}
+
+// CG engines solve with the symmetric matrix of spmv_sym, BiCGSTAB engines
+// with the matrix as generated / loaded; both get a dominant diagonal so the
+// systems are well posed. One benchmark run is one whole solve from x = 0.
+static int run_solver(const KernelInfo *info, const DriverOptions *opt) {
+    CSRMatrix *S = load_symmetric_matrix(opt);
+    CSRMatrix *G = opt->matrix ? csr_load(opt->matrix)
+                               : create_skewed_sparse_matrix((index_t)opt->size, (index_t)opt->size,
+                                                             opt->density, opt->skew);
+    if (!S || !G) return 0;
+    if (G->num_rows != G->num_cols) {
+        fprintf(stderr, "solver needs a square matrix\n");
+        return 0;
+    }
+    CSRMatrix *spd = csr_diagonally_dominant(S, 1.0);
+    CSRMatrix *general = csr_diagonally_dominant(G, 1.0);
+    free_csr_matrix(S);
+    free_csr_matrix(G);
+    index_t n = general->num_rows;
+    double *b = (double *)malloc_array(n, sizeof(double));
+    double *x = (double *)malloc_array(n, sizeof(double));
+    if (!spd || !general || !b || !x) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    for (index_t i = 0; i < n; i++) b[i] = 1.0 + (i % 5);
+    printf("Tolerance %.0e, at most %d iterations; SPD matrix %ld non-zeros, general %ld\n",
+           opt->tolerance, opt->max_iterations, (long)spd->nnz, (long)general->nnz);
+    
+    int correct = 1;
+    for (int e = 0; e < 5; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        SolverOptions sopt = {opt->max_iterations, opt->tolerance, e == 2 || e == 4};
+        SolverResult (*solve)(CSRMatrix *, const double *, double *, const SolverOptions *) =
+            (e == 0) ? cg_solve_unfused : (e <= 2) ? cg_solve : bicgstab_solve;
+        CSRMatrix *A = (e <= 2) ? spd : general;
+        
+        // Untimed solve for the iteration count behind the byte / flop totals
+        for (index_t i = 0; i < n; i++) x[i] = 0.0;
+        SolverResult r = solve(A, b, x, &sopt);
+        
+        announce_engine(info, engine);
+        Benchmark bench = bench_begin("solver", engine, n, r.flops_per_iteration * r.iterations,
+                                      r.bytes_per_iteration * r.iterations);
+        while (bench_next(&bench)) {
+            for (index_t i = 0; i < n; i++) x[i] = 0.0;
+            r = solve(A, b, x, &sopt);
+        }
+        double seconds = bench_end(&bench).median;
+        int it = (r.iterations > 0) ? r.iterations : 1;
+        printf("    %d iterations, %.4f ms per iteration, %.2f GB/s (streaming model)\n",
+               r.iterations, seconds / it * 1e3, r.bytes_per_iteration * it / seconds / 1e9);
+        if (opt->verify) {
+            double true_residual = solver_true_residual(A, b, x);
+            int ok = r.converged && true_residual <= 10.0 * opt->tolerance;
+            printf("    %s %s: ||b - Ax|| / ||b|| = %.2e\n", ok ? "✓" : "✗", engine, true_residual);
+            correct &= ok;
+        }
+    }
+    
+    free_csr_matrix(spd);
+    free_csr_matrix(general);
+    free(b);
+    free(x);
+    return correct;
+}
+
+// C = A * A (A * A^T for a rectangular --matrix). The generator's default
+// density makes C nearly dense: use e.g. --density 0.0005.
+static int run_spgemm(const KernelInfo *info, const DriverOptions *opt) {
+    CSRMatrix *A = opt->matrix ? csr_load(opt->matrix)
+                               : create_skewed_sparse_matrix((index_t)opt->size, (index_t)opt->size,
+                                                             opt->density, opt->skew);
+    if (!A) return 0;
+    CSRMatrix *B = (A->num_rows == A->num_cols) ? A : csr_transpose(A);
+    if (!B) return 0;
+    double products = spgemm_products(A, B);
+    CSRMatrix *reference = opt->verify ? spgemm_sequential(A, B) : NULL;
+    if (opt->verify && !reference) return 0;
+    printf("A: %ld non-zeros; A * B: %.3g multiply-adds\n", (long)A->nnz, products);
+    
+    // Both phases read A and the gathered rows of B, the numeric one writes C
+    double gather_bytes = 2.0 * (csr_matrix_bytes(A)
+                                 + products * (sizeof(double) + sizeof(col_index_t)));
+    int correct = 1;
+    for (int e = 0; e < 4; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        announce_engine(info, engine);
+        SpgemmStats stats = {0.0, 0, 0, 0.0, 0.0};
+        SpgemmAccumulator acc = (e == 1) ? SPGEMM_HASH : (e == 2) ? SPGEMM_DENSE : SPGEMM_AUTO;
+        CSRMatrix *C = NULL;
+        double bytes = gather_bytes + (reference ? csr_matrix_bytes(reference) : 0.0);
+        Benchmark b = bench_begin("spgemm", engine, A->num_rows, 2.0 * products, bytes);
+        while (bench_next(&b)) {
+            free_csr_matrix(C);
+            C = (e == 0) ? spgemm_sequential(A, B) : spgemm(A, B, acc, &stats);
+        }
+        bench_end(&b);
+        if (!C) return 0;
+        if (e > 0) {
+            printf("    C: %ld non-zeros; symbolic %.3f ms, numeric %.3f ms; "
+                   "%ld hash rows, %ld dense rows\n", (long)C->nnz, stats.symbolic_seconds * 1e3,
+                   stats.numeric_seconds * 1e3, (long)stats.hash_rows, (long)stats.dense_rows);
+        }
+        // Every accumulator sums a row in the same order
+        if (opt->verify && e > 0) {
+            correct &= report_check(engine, csr_matrices_match(C, reference, 1e-12));
+        }
+        free_csr_matrix(C);
+    }
+    
+    free_csr_matrix(reference);
+    if (B != A) free_csr_matrix(B);
+    free_csr_matrix(A);
+    return correct;
+}
+
+static int run_spmv_dynamic(const KernelInfo *info, const DriverOptions *opt) {
+    CSRMatrix *A = opt->matrix ? csr_load(opt->matrix)
+                               : create_skewed_sparse_matrix((index_t)opt->size, (index_t)opt->size,
+                                                             opt->density, opt->skew);
+    if (!A) return 0;
+    index_t batch = (index_t)opt->updates;
+    double *x = (double *)malloc_array(A->num_cols, sizeof(double));
+    double *y = (double *)malloc_array(A->num_rows, sizeof(double));
+    double *y_ref = (double *)malloc_array(A->num_rows, sizeof(double));
+    if (!x || !y || !y_ref) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    for (index_t i = 0; i < A->num_cols; i++) x[i] = 1.0 + (i % 7);
+    printf("Non-zeros: %ld; batches of %ld updates (%.0f%% deletes), each followed by one SpMV\n",
+           (long)A->nnz, (long)batch, DRIVER_DELETE_SHARE * 100.0);
+    
+    // One run: apply a batch, then y = A * x on the updated matrix
+    double flops = 2.0 * A->nnz;
+    double bytes = csr_matrix_bytes(A) + (double)(A->num_cols + A->num_rows) * sizeof(double)
+                 + (double)batch * sizeof(SparseUpdate);
+    int correct = 1;
+    for (int e = 0; e < 2; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        // rebuild merges every batch into a fresh CSR; delta compacts at
+        // the threshold only
+        DynamicCSR *D = dynamic_csr_create(A, (e == 0) ? INFINITY : 0.0);
+        if (!D) return 0;
+        announce_engine(info, engine);
+        Benchmark b = bench_begin("spmv_dynamic", engine, A->num_rows, flops, bytes);
+        int runs = b.result.warmup + b.result.reps;
+        SparseUpdate *updates = (SparseUpdate *)malloc_array((size_t)runs * batch,
+                                                             sizeof(SparseUpdate));
+        if (!updates) return 0;
+        for (int r = 0; r < runs; r++) {
+            dynamic_random_updates(A, batch, DRIVER_DELETE_SHARE, SPARSE_RANDOM_SEED, r,
+                                   updates + (size_t)r * batch);
+        }
+        int applied = 1;
+        while (bench_next(&b)) {
+            applied &= dynamic_csr_apply(D, updates + (size_t)(b.iteration - 1) * batch, batch);
+            if (e == 0) applied &= dynamic_csr_compact(D);
+            dynamic_csr_spmv(D, x, y);
+        }
+        bench_end(&b);
+        free(updates);
+        if (!applied) return 0;
+        printf("    Updates: %.3f ms per batch; %ld compactions (%.3f ms each); "
+               "%ld delta entries, %ld deleted pending\n", D->update_seconds / runs * 1e3,
+               D->compactions, D->compactions ? D->compact_seconds / D->compactions * 1e3 : 0.0,
+               (long)D->delta_count, (long)D->removed_count);
+        
+        // Reference: sequential SpMV of the merged matrix
+        if (opt->verify) {
+            CSRMatrix *S = dynamic_csr_snapshot(D);
+            if (!S) return 0;
+            spmv_sequential(S, x, y_ref);
+            correct &= report_check(engine, verify_results(y_ref, y, A->num_rows, 1e-9));
+            free_csr_matrix(S);
+        }
+        free_dynamic_csr(D);
+    }
+    
+    free_csr_matrix(A);
+    free(x);
+    free(y);
+    free(y_ref);
+    return correct;
+}
+
+static int run_xor(const KernelInfo *info, const DriverOptions *opt) {
+    long size = opt->size;
+    unsigned char key = 0xA5;
+    unsigned char *data = (unsigned char *)malloc(size);
+    unsigned char *original = (unsigned char *)malloc(size);
+    if (!data || !original) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 0;
+    }
+    rng_fill_bytes(original, size, 0, 42);
+    
+    // Each byte is read and written once
+    double bytes = 2.0 * size;
+    int correct = 1;
+    
+    for (int e = 0; e < 2; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        memcpy(data, original, size);
+        announce_engine(info, engine);
+        Benchmark b = bench_begin("xor", engine, size, 0.0, bytes);
+        while (bench_next(&b)) {
+            if (e == 0) xor_transform_sequential(data, size, key);
+            else xor_transform_chunks(data, size, key, opt->chunk_size);
+        }
+        int runs = b.result.warmup + b.result.reps;
+        bench_end(&b);
+        
+        // An even number of runs restores the input, an odd number encrypts it
+        if (opt->verify) {
+            long errors = 0;
+            unsigned char expect_key = (runs % 2) ? key : 0;
+            for (long i = 0; i < size; i++) {
+                if (data[i] != (unsigned char)(original[i] ^ expect_key)) errors++;
+            }
+            correct &= report_check(engine, errors == 0);
+        }
+    }
+    
+    free(data);
+    free(original);
+    return correct;
+}
+
+// One buffer per run, from malloc or from an arena kept across runs, so
+// only the arena's first run maps and faults its pages
+static int run_alloc(const KernelInfo *info, const DriverOptions *opt) {
+    index_t count = (index_t)(opt->size / (long)sizeof(double));
+    if (count <= 0) {
+        fprintf(stderr, "Error: --size must be at least %zu bytes\n", sizeof(double));
+        return 0;
+    }
+    static const PageSize pages[] = {PAGES_DEFAULT, PAGES_DEFAULT, PAGES_DEFAULT,
+                                     PAGES_TRANSPARENT, PAGES_HUGE_2MB, PAGES_HUGE_1GB};
+    static const int populate[] = {0, 0, 1, 0, 0, 0};
+    double bytes = (double)count * sizeof(double);
+    printf("Buffer: %.1f MB of doubles, written in parallel every run\n", bytes / (1024.0 * 1024.0));
+    int correct = 1;
+    
+    for (int e = 0; e < 6; e++) {
+        const char *engine = info->engines[e];
+        if (!engine_selected(opt, engine)) continue;
+        
+        Arena arena;
+        arena_init(&arena, pages[e], populate[e]);
+        Arena *use = (e == 0) ? NULL : &arena;
+        announce_engine(info, engine);
+        long faults = process_page_faults(), first_faults = 0;
+        long errors = 0;
+        Benchmark b = bench_begin("alloc", engine, count, 0.0, bytes);
+        while (bench_next(&b)) {
+            if (b.iteration == 2) first_faults = process_page_faults() - faults;
+            double *data = use ? (double *)arena_alloc_array(use, count, sizeof(double))
+                               : (double *)malloc_array(count, sizeof(double));
+            if (!data) {
+                errors = -1;
+                break;
+            }
+            #pragma omp parallel for schedule(static)
+            for (index_t i = 0; i < count; i++) data[i] = (double)i;
+            
+            // Spot checks, so the writes cannot be dropped
+            if (data[0] != 0.0 || data[count / 2] != (double)(count / 2) ||
+                data[count - 1] != (double)(count - 1)) {
+                errors++;
+            }
+            if (use) arena_free(use, data);
+            else free(data);
+        }
+        int runs = b.iteration;
+        bench_end(&b);
+        if (errors < 0) {
+            fprintf(stderr, "Memory allocation failed!\n");
+            arena_destroy(&arena);
+            return 0;
+        }
+        
+        long total = process_page_faults() - faults;
+        if (runs < 2) first_faults = total;
+        printf("    Page faults: %ld on the first run, %.1f per later run\n", first_faults,
+               (runs > 1) ? (double)(total - first_faults) / (runs - 1) : 0.0);
+        if (use) arena_print_stats(use, engine);
+        arena_destroy(&arena);
+        if (opt->verify) correct &= report_check(engine, errors == 0);
+    }
+    return correct;
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+    DriverOptions opt = {NULL, "all", 0, 0, 64, 0.05, 0.0, 1024 * 1024, NULL, NULL, NULL,
+                         REORDER_NONE, VALUE_PRECISION_DOUBLE, 16, 1000, 1e-8, 4096, 1};
+    
+    static const struct option long_options[] = {
+        {"kernel",    required_argument, NULL, 'k'},
+        {"engine",    required_argument, NULL, 'e'},
+        {"size",      required_argument, NULL, 'n'},
+        {"threads",   required_argument, NULL, 't'},
+        {"block",     required_argument, NULL, 'b'},
+        {"density",   required_argument, NULL, 'd'},
+        {"chunk",     required_argument, NULL, 'c'},
+        {"schedule",  required_argument, NULL, 's'},
+        {"matrix",    required_argument, NULL, 'm'},
+        {"save-csr",  required_argument, NULL, 'S'},
+        {"skew",      required_argument, NULL, 'w'},
+        {"rhs",       required_argument, NULL, 'r'},
+        {"reorder",   required_argument, NULL, 'o'},
+        {"precision", required_argument, NULL, 'p'},
+        {"max-iterations", required_argument, NULL, 'i'},
+        {"tolerance", required_argument, NULL, 'T'},
+        {"updates",   required_argument, NULL, 'u'},
+        {"no-verify", no_argument,       NULL, 'V'},
+        {"list",      no_argument,       NULL, 'l'},
+        {"help",      no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    
+    int c;
+    while ((c = getopt_long(argc, argv, "k:e:n:t:b:d:c:s:m:lh", long_options, NULL)) != -1) {
+        switch (c) {
+        case 'k': opt.kernel = optarg; break;
+        case 'e': opt.engine = optarg; break;
+        case 'n': opt.size = atol(optarg); break;
+        case 't': opt.threads = atoi(optarg); break;
+        case 'b': opt.block_size = atoi(optarg); break;
+        case 'd': opt.density = atof(optarg); break;
+        case 'c': opt.chunk_size = atoi(optarg); break;
+        case 's': opt.schedule = optarg; break;
+        case 'm': opt.matrix = optarg; break;
+        case 'S': opt.save_csr = optarg; break;
+        case 'w': opt.skew = atof(optarg); break;
+        case 'r': opt.rhs = atoi(optarg); break;
+        case 'o':
+            if (!reorder_parse(optarg, &opt.reorder)) {
+                fprintf(stderr, "Unknown ordering '%s' (rcm, degree or none)\n", optarg);
+                return 1;
+            }
+            break;
+        case 'p':
+            if (!value_precision_parse(optarg, &opt.precision)) {
+                fprintf(stderr, "Unknown precision '%s' (double, float or half)\n", optarg);
+                return 1;
+            }
+            break;
+        case 'i': opt.max_iterations = atoi(optarg); break;
+        case 'T': opt.tolerance = atof(optarg); break;
+        case 'u': opt.updates = atoi(optarg); break;
+        case 'V': opt.verify = 0; break;
+        case 'l': print_kernel_list(); return 0;
+        case 'h': print_usage(argv[0]); return 0;
+        default:  print_usage(argv[0]); return 1;
+        }
+    }
+    
+    if (!opt.kernel) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const KernelInfo *info = find_kernel(opt.kernel);
+    if (!info) {
+        fprintf(stderr, "Unknown kernel '%s'\n", opt.kernel);
+        print_kernel_list();
+        return 1;
+    }
+    if (!kernel_has_engine(info, opt.engine)) {
+        fprintf(stderr, "Kernel '%s' has no engine '%s'\n", info->name, opt.engine);
+        print_kernel_list();
+        return 1;
+    }
+    if (opt.size <= 0) opt.size = info->default_size;
+    double elements = info->square ? (double)opt.size * opt.size : (double)opt.size;
+    if (!check_index_count(elements, info->name)) return 1;
+    Schedule parsed;
+    if (opt.schedule && !schedule_parse(opt.schedule, &parsed)) {
+        fprintf(stderr, "Unknown schedule '%s' (static|dynamic|guided|taskloop|steal|adaptive[:chunk])\n",
+                opt.schedule);
+        return 1;
+    }
+    if (opt.block_size <= 0 || opt.chunk_size <= 0 || opt.rhs <= 0 || opt.updates <= 0) {
+        fprintf(stderr, "Block, chunk, right-hand side and update counts must be positive\n");
+        return 1;
+    }
+    if (opt.threads > 0) omp_set_num_threads(opt.threads);
+    
+    printf("==============================================\n");
+    printf("  KERNEL DRIVER: %s\n", info->description);
+    printf("==============================================\n");
+    printf("Engine: %s\n", opt.engine);
+    if (opt.matrix) {
+        printf("Matrix file: %s\n", opt.matrix);
+    } else {
+        printf("Size: %ld (%s)\n", opt.size, info->size_meaning);
+    }
+    printf("Number of threads: %d\n", omp_get_max_threads());
+    printf("==============================================\n\n");
+    
+    char context[96];
+    snprintf(context, sizeof(context), "driver block_size=%d density=%g skew=%g chunk=%d",
+             opt.block_size, opt.density, opt.skew, opt.chunk_size);
+    bench_set_context(context);
+    
+    int correct = info->run(info, &opt);
+    
+    printf("\n%s\n", correct ? "✓ All selected engines verified." : "✗ Verification failed!");
+    return correct ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+/*
+ * Kernel Library: Public Header
+ * 
+ * Description:
+ *   Single include for code linking against libdatapatterns (built by
+ *   `make lib` as build/libdatapatterns.a and build/libdatapatterns.so):
+ * 
+ *       #include "data_patterns.h"
+ *       cc -fopenmp -Ikernels -Icommon app.c build/libdatapatterns.a -lm
+ * 
+ *   Kernels:   gemm.h, transpose.h, histogram.h, vector_ops.h, spmv.h,
+ *              file_transform.h, schedule.h (run-time loop scheduling),
+ *              sparse_io.h (Matrix Market / binary CSR files),
+ *              sparse_formats.h (SELL-C-sigma / ELL with SIMD SpMV),
+ *              reorder.h (RCM / degree reordering, locality statistics),
+ *              sparse_compress.h (encoded columns, float / half values),
+ *              sparse_symmetric.h (upper-triangle storage, transpose, Aᵀx),
+ *              solvers.h (fused CG / BiCGSTAB with Jacobi preconditioning),
+ *              spgemm.h (two-phase C = A * B, hash / dense accumulators),
+ *              sparse_stats.h (matrix statistics, SpMV partition / format advisor),
+ *              sparse_dynamic.h (updatable CSR with delta buffers and compaction)
+ *   Support:   numa_alloc.h (placement-aware allocation), arena.h
+ *              (reused arena with huge pages and pre-faulting), rng.h
+ *              (counter-based random fills), bench.h
+ *              (benchmark harness), perf_counters.h, trace.h,
+ *              array_utils.h (verification and printing), index_types.h
+ *              (32/64-bit index build mode, `make INDEX64=1`)
+ * 
+ *   All kernels are plain OpenMP functions: they use the calling thread's
+ *   team size (omp_set_num_threads / OMP_NUM_THREADS) and print nothing
+ *   on success. A failure (NULL or the documented error value) or a
+ *   fallback to a slower path is reported in one line on stderr; only the
+ *   printing (print_*, *_print) and verify_* helpers write to stdout.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef DATA_PATTERNS_H
+#define DATA_PATTERNS_H
+
+#include "gemm.h"
+#include "transpose.h"
+#include "histogram.h"
+#include "vector_ops.h"
+#include "spmv.h"
+#include "file_transform.h"
+#include "schedule.h"
+#include "sparse_io.h"
+#include "sparse_formats.h"
+#include "reorder.h"
+#include "sparse_compress.h"
+#include "sparse_symmetric.h"
+#include "solvers.h"
+#include "spgemm.h"
+#include "sparse_stats.h"
+#include "sparse_dynamic.h"
+
+#include "numa_alloc.h"
+#include "arena.h"
+#include "rng.h"
+#include "bench.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "array_utils.h"
+#include "index_types.h"
+
+#endif // DATA_PATTERNS_H
@@ -0,0 +1,149 @@
+/*
+ * Kernel Library: Chunked Byte Transforms (XOR Encryption)
+ * 
+ * See file_transform.h for the interface.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include "file_transform.h"
+#include "trace.h"
+
+// XOR every byte of a buffer with the key
+void xor_transform_sequential(unsigned char *data, long size, unsigned char key) {
+    for (long i = 0; i < size; i++) {
+        data[i] ^= key;
+    }
+}
+
+// Chunk decomposition: each thread XORs whole chunks of the buffer
+void xor_transform_chunks(unsigned char *data, long size, unsigned char key, int chunk_size) {
+    // Calculate number of chunks
+    int num_chunks = (int)((size + chunk_size - 1) / chunk_size);
+    
+    // Chunks are disjoint byte ranges - no synchronization needed
+    #pragma omp parallel for schedule(static)
+    for (int chunk = 0; chunk < num_chunks; chunk++) {
+        uint64_t trace_t0 = trace_begin();
+        long start_pos = (long)chunk * chunk_size;
+        long end_pos = start_pos + chunk_size;
+        if (end_pos > size) end_pos = size;
+        
+        // Encrypt this chunk
+        for (long i = start_pos; i < end_pos; i++) {
+            data[i] ^= key;
+        }
+        trace_end("encrypt chunk", trace_t0, chunk);
+    }
+}
+
+// Get file size
+long get_file_size(const char *filename) {
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) return 0;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+// Sequential file encryption
+void encrypt_sequential(const char *input, const char *output, unsigned char key) {
+    FILE *fin = fopen(input, "rb");
+    FILE *fout = fopen(output, "wb");
+    
+    if (!fin || !fout) {
+        fprintf(stderr, "Failed to open files for sequential encryption!\n");
+        exit(1);
+    }
+    
+    unsigned char buffer[4096];
+    size_t bytes_read;
+    
+    while ((bytes_read = fread(buffer, 1, 4096, fin)) > 0) {
+        xor_transform_sequential(buffer, (long)bytes_read, key);
+        fwrite(buffer, 1, bytes_read, fout);
+    }
+    
+    fclose(fin);
+    fclose(fout);
+}
+
+// Parallel file encryption with chunk decomposition
+void encrypt_parallel(const char *input, const char *output, unsigned char key, int chunk_size) {
+    // Read entire file into memory
+    long file_size = get_file_size(input);
+    unsigned char *file_data = (unsigned char *)malloc(file_size);
+    
+    if (!file_data) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    FILE *fin = fopen(input, "rb");
+    if (!fin) {
+        fprintf(stderr, "Failed to open input file!\n");
+        free(file_data);
+        exit(1);
+    }
+    
+    fread(file_data, 1, file_size, fin);
+    fclose(fin);
+    
+    // Parallel encryption of chunks
+    xor_transform_chunks(file_data, file_size, key, chunk_size);
+    
+    // Write encrypted data (synchronized, single-threaded)
+    FILE *fout = fopen(output, "wb");
+    if (!fout) {
+        fprintf(stderr, "Failed to open output file!\n");
+        free(file_data);
+        exit(1);
+    }
+    
+    fwrite(file_data, 1, file_size, fout);
+    fclose(fout);
+    free(file_data);
+}
+
+// Verify encryption by comparing outputs
+int verify_encryption(const char *original, const char *encrypted, unsigned char key) {
+    FILE *fin = fopen(original, "rb");
+    FILE *fenc = fopen(encrypted, "rb");
+    
+    if (!fin || !fenc) {
+        fprintf(stderr, "Failed to open files for verification!\n");
+        return 0;
+    }
+    
+    unsigned char buf_orig, buf_enc;
+    long pos = 0;
+    int errors = 0;
+    
+    while (fread(&buf_orig, 1, 1, fin) == 1) {
+        if (fread(&buf_enc, 1, 1, fenc) != 1) {
+            printf("    Error: File size mismatch!\n");
+            errors++;
+            break;
+        }
+        
+        // Encrypted byte should be original XOR key
+        if (buf_enc != (buf_orig ^ key)) {
+            errors++;
+            if (errors <= 5) {
+                printf("    Error at position %ld: expected 0x%02X, got 0x%02X\n",
+                       pos, buf_orig ^ key, buf_enc);
+            }
+        }
+        pos++;
+    }
+    
+    fclose(fin);
+    fclose(fenc);
+    
+    return (errors == 0);
+}
@@ -0,0 +1,27 @@
+/*
+ * Kernel Library: Chunked Byte Transforms (XOR Encryption)
+ * 
+ * Description:
+ *   XOR-transforms a byte buffer sequentially or in fixed-size chunks that
+ *   are distributed among threads, and the file-to-file wrappers built on
+ *   top of them. XOR with the same key is its own inverse, so the same
+ *   kernels encrypt and decrypt.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef FILE_TRANSFORM_H
+#define FILE_TRANSFORM_H
+
+// In-memory transforms (in place)
+void xor_transform_sequential(unsigned char *data, long size, unsigned char key);
+void xor_transform_chunks(unsigned char *data, long size, unsigned char key, int chunk_size);
+
+// File transforms
+long get_file_size(const char *filename);
+void encrypt_sequential(const char *input, const char *output, unsigned char key);
+void encrypt_parallel(const char *input, const char *output, unsigned char key, int chunk_size);
+int verify_encryption(const char *original, const char *encrypted, unsigned char key);
+
+#endif // FILE_TRANSFORM_H
@@ -0,0 +1,21 @@
+/*
+ * Kernel Library: Dense Matrix Multiplication
+ * 
+ * Description:
+ *   C = A * B for square row-major N x N matrices. The blocked parallel
+ *   kernel partitions OUTPUT blocks among threads so no synchronization
+ *   is needed (see gemm.c).
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef GEMM_H
+#define GEMM_H
+
+#include "index_types.h"
+
+void sequential_multiply(double *A, double *B, double *C, index_t N);
+void parallel_multiply_blocked(double *A, double *B, double *C, index_t N, int block_size);
+
+#endif // GEMM_H
@@ -0,0 +1,99 @@
+/*
+ * Kernel Library: Histogram of Small Integers
+ * 
+ * See histogram.h for the interface.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <omp.h>
+#include "histogram.h"
+#include "trace.h"
+
+// Sequential histogram computation
+void histogram_sequential(int *data, index_t size, index_t *histogram) {
+    // Initialize histogram to zero
+    memset(histogram, 0, NUM_BINS * sizeof(index_t));
+    
+    // Count occurrences
+    for (index_t i = 0; i < size; i++) {
+        histogram[data[i]]++;
+    }
+}
+
+// Parallel histogram with atomic operations
+// WARNING: This implementation is SLOW due to excessive contention
+// Atomic operations on every element cause cache line bouncing and serialization
+// Expected performance: 100-1000x SLOWER than sequential for high contention
+// Use histogram_parallel_reduction() for good performance
+void histogram_parallel_atomic(int *data, index_t size, index_t *histogram) {
+    // Initialize histogram to zero
+    memset(histogram, 0, NUM_BINS * sizeof(index_t));
+    
+    #pragma omp parallel
+    {
+        // Each thread processes its portion of data
+        // PERFORMANCE ISSUE: Atomic on every iteration causes massive contention
+        // With only 10 bins, all threads constantly compete for the same memory locations
+        uint64_t trace_t0 = trace_begin();
+        #pragma omp for nowait
+        for (index_t i = 0; i < size; i++) {
+            // Atomic increment to avoid race conditions
+            // This serializes execution when multiple threads access same bin
+            #pragma omp atomic
+            histogram[data[i]]++;
+        }
+        trace_end("histogram atomic", trace_t0, omp_get_thread_num());
+    }
+}
+
+// Parallel histogram with local histograms and reduction
+// CORRECT APPROACH: Each thread builds private histogram, then combines at end
+// This minimizes synchronization overhead - only 10 bins need to be merged
+void histogram_parallel_reduction(int *data, index_t size, index_t *histogram) {
+    // Initialize global histogram to zero
+    memset(histogram, 0, NUM_BINS * sizeof(index_t));
+    
+    #pragma omp parallel
+    {
+        // Each thread has its own local histogram - NO CONTENTION during counting
+        index_t local_hist[NUM_BINS] = {0};
+        
+        // Phase 1: Each thread computes its local histogram independently
+        // NO synchronization needed - each thread works on private data
+        uint64_t trace_t0 = trace_begin();
+        #pragma omp for nowait
+        for (index_t i = 0; i < size; i++) {
+            local_hist[data[i]]++;  // Fast - no atomic, no contention
+        }
+        trace_end("histogram count", trace_t0, omp_get_thread_num());
+        
+        // Phase 2: Combine local histograms into global histogram
+        // Only NUM_BINS operations per thread (very few compared to data size)
+        // Using critical section for the entire reduction is more efficient than
+        // atomic on each bin since we're updating multiple related values
+        trace_t0 = trace_begin();  // Includes waiting for the lock
+        #pragma omp critical
+        {
+            for (int bin = 0; bin < NUM_BINS; bin++) {
+                histogram[bin] += local_hist[bin];
+            }
+        }
+        trace_end("histogram merge", trace_t0, omp_get_thread_num());
+    }
+}
+
+// Verify that two histograms are equal
+int verify_histograms(index_t *h1, index_t *h2) {
+    int errors = 0;
+    for (int i = 0; i < NUM_BINS; i++) {
+        if (h1[i] != h2[i]) {
+            printf("    Error in bin %d: h1=%ld, h2=%ld\n", i, (long)h1[i], (long)h2[i]);
+            errors++;
+        }
+    }
+    return (errors == 0);
+}
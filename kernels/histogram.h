@@ -0,0 +1,24 @@
+/*
+ * Kernel Library: Histogram of Small Integers
+ * 
+ * Description:
+ *   Counts values in [0, NUM_BINS) with a sequential loop, a (deliberately
+ *   slow) per-element atomic kernel and a private-histogram reduction.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "index_types.h"
+
+#define NUM_BINS 10
+
+void histogram_sequential(int *data, index_t size, index_t *histogram);
+void histogram_parallel_atomic(int *data, index_t size, index_t *histogram);
+void histogram_parallel_reduction(int *data, index_t size, index_t *histogram);
+int verify_histograms(index_t *h1, index_t *h2);
+
+#endif // HISTOGRAM_H
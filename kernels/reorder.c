@@ -0,0 +1,327 @@
+/*
+ * Kernel Library: Locality Reordering of Sparse Matrices
+ * 
+ * See reorder.h for the orderings.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <omp.h>
+#include "reorder.h"
+#include "numa_alloc.h"
+
+// Frontiers smaller than this are expanded by the calling thread alone
+#define REORDER_PARALLEL_FRONTIER 1024
+
+typedef struct {
+    index_t degree;
+    index_t node;
+} NodeKey;
+
+static int compare_degree_ascending(const void *a, const void *b) {
+    const NodeKey *ka = (const NodeKey *)a, *kb = (const NodeKey *)b;
+    if (ka->degree != kb->degree) return (ka->degree > kb->degree) - (ka->degree < kb->degree);
+    return (ka->node > kb->node) - (ka->node < kb->node);
+}
+
+static int compare_degree_descending(const void *a, const void *b) {
+    const NodeKey *ka = (const NodeKey *)a, *kb = (const NodeKey *)b;
+    if (ka->degree != kb->degree) return (ka->degree < kb->degree) - (ka->degree > kb->degree);
+    return (ka->node > kb->node) - (ka->node < kb->node);
+}
+
+static inline index_t degree(const CSRMatrix *A, index_t v) {
+    return A->row_ptr[v + 1] - A->row_ptr[v];
+}
+
+// All nodes as (degree, node) keys, sorted with `compare`
+static NodeKey *sorted_node_keys(const CSRMatrix *A, int (*compare)(const void *, const void *)) {
+    NodeKey *keys = (NodeKey *)malloc_array((size_t)A->num_rows + 1, sizeof(NodeKey));
+    if (!keys) return NULL;
+    #pragma omp parallel for schedule(static)
+    for (index_t v = 0; v < A->num_rows; v++) {
+        keys[v].degree = degree(A, v);
+        keys[v].node = v;
+    }
+    qsort(keys, A->num_rows, sizeof(NodeKey), compare);
+    return keys;
+}
+
+// Children of one frontier node, placed by the CM rule: increasing degree
+static void sort_by_degree(const CSRMatrix *A, index_t *nodes, index_t count) {
+    for (index_t i = 1; i < count; i++) {
+        index_t v = nodes[i];
+        index_t j = i;
+        while (j > 0 && (degree(A, nodes[j - 1]) > degree(A, v) ||
+                         (degree(A, nodes[j - 1]) == degree(A, v) && nodes[j - 1] > v))) {
+            nodes[j] = nodes[j - 1];
+            j--;
+        }
+        nodes[j] = v;
+    }
+}
+
+/*
+ * Cuthill-McKee order, one BFS level at a time. Sequential CM appends the
+ * unvisited neighbors of each frontier node in frontier order, so a node
+ * belongs to the FIRST frontier node that reaches it. In parallel:
+ *   1. every frontier node p lowers owner[v] to p for its unvisited
+ *      neighbors (atomic min),
+ *   2. every p counts the neighbors it owns (claiming them, so duplicate
+ *      entries count once), a scan turns counts into output offsets,
+ *   3. every p writes its children at its offset and sorts them by degree.
+ * The order is the same as the sequential algorithm's for any team size.
+ * Each component starts at its unvisited node of minimum degree.
+ */
+static index_t *cuthill_mckee(const CSRMatrix *A) {
+    index_t n = A->num_rows;
+    index_t *order = (index_t *)malloc_array((size_t)n + 1, sizeof(index_t));
+    index_t *counts = (index_t *)malloc_array((size_t)n + 1, sizeof(index_t));
+    char *visited = (char *)calloc((size_t)n + 1, 1);
+    _Atomic int64_t *owner = (_Atomic int64_t *)malloc_array((size_t)n + 1, sizeof(*owner));
+    NodeKey *starts = sorted_node_keys(A, compare_degree_ascending);
+    if (!order || !counts || !visited || !owner || !starts) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(order);
+        free(counts);
+        free(visited);
+        free(owner);
+        free(starts);
+        return NULL;
+    }
+    #pragma omp parallel for schedule(static)
+    for (index_t v = 0; v < n; v++) atomic_init(&owner[v], INT64_MAX);
+    
+    index_t placed = 0, cursor = 0;
+    while (placed < n) {
+        while (visited[starts[cursor].node]) cursor++;
+        index_t start = starts[cursor].node;
+        visited[start] = 1;
+        order[placed++] = start;
+        index_t frontier_begin = placed - 1, frontier_end = placed;
+        
+        while (frontier_begin < frontier_end) {
+            index_t frontier = frontier_end - frontier_begin;
+            const index_t *nodes = order + frontier_begin;
+            int parallel = frontier > REORDER_PARALLEL_FRONTIER;
+            
+            #pragma omp parallel for schedule(dynamic, 64) if(parallel)
+            for (index_t p = 0; p < frontier; p++) {
+                index_t u = nodes[p];
+                for (index_t j = A->row_ptr[u]; j < A->row_ptr[u + 1]; j++) {
+                    index_t v = A->col_indices[j];
+                    if (visited[v]) continue;
+                    int64_t seen = atomic_load(&owner[v]);
+                    while (seen > p && !atomic_compare_exchange_weak(&owner[v], &seen, p)) {
+                    }
+                }
+            }
+            
+            #pragma omp parallel for schedule(dynamic, 64) if(parallel)
+            for (index_t p = 0; p < frontier; p++) {
+                index_t u = nodes[p], count = 0;
+                for (index_t j = A->row_ptr[u]; j < A->row_ptr[u + 1]; j++) {
+                    index_t v = A->col_indices[j];
+                    int64_t mine = p;
+                    if (!visited[v] && atomic_compare_exchange_strong(&owner[v], &mine, -1 - (int64_t)p)) {
+                        count++;
+                    }
+                }
+                counts[p + 1] = count;
+            }
+            counts[0] = 0;
+            index_t next = csr_counts_to_offsets(counts, frontier);
+            
+            #pragma omp parallel for schedule(dynamic, 64) if(parallel)
+            for (index_t p = 0; p < frontier; p++) {
+                index_t u = nodes[p];
+                index_t *children = order + frontier_end + counts[p];
+                index_t count = 0;
+                for (index_t j = A->row_ptr[u]; j < A->row_ptr[u + 1]; j++) {
+                    index_t v = A->col_indices[j];
+                    if (atomic_load(&owner[v]) == -1 - (int64_t)p && !visited[v]) {
+                        visited[v] = 1;
+                        children[count++] = v;
+                    }
+                }
+                sort_by_degree(A, children, count);
+            }
+            
+            frontier_begin = frontier_end;
+            frontier_end += next;
+            placed = frontier_end;
+        }
+    }
+    
+    free(counts);
+    free(visited);
+    free(owner);
+    free(starts);
+    return order;
+}
+
+// perm[new] = old for the requested ordering
+index_t* reorder_permutation(const CSRMatrix *A, ReorderKind kind) {
+    if (A->num_rows != A->num_cols) {
+        fprintf(stderr, "Reordering needs a square matrix (got %ld x %ld)\n",
+                (long)A->num_rows, (long)A->num_cols);
+        return NULL;
+    }
+    index_t n = A->num_rows;
+    
+    if (kind == REORDER_RCM) {
+        index_t *order = cuthill_mckee(A);
+        if (!order) return NULL;
+        for (index_t i = 0; i < n / 2; i++) {
+            index_t t = order[i];
+            order[i] = order[n - 1 - i];
+            order[n - 1 - i] = t;
+        }
+        return order;
+    }
+    
+    index_t *perm = (index_t *)malloc_array((size_t)n + 1, sizeof(index_t));
+    if (!perm) return NULL;
+    if (kind == REORDER_DEGREE) {
+        NodeKey *keys = sorted_node_keys(A, compare_degree_descending);
+        if (!keys) {
+            free(perm);
+            return NULL;
+        }
+        #pragma omp parallel for schedule(static)
+        for (index_t i = 0; i < n; i++) perm[i] = keys[i].node;
+        free(keys);
+    } else {
+        #pragma omp parallel for schedule(static)
+        for (index_t i = 0; i < n; i++) perm[i] = i;
+    }
+    return perm;
+}
+
+// B = P A P^T: row i of B is row perm[i] of A with columns renumbered
+CSRMatrix* csr_permute(const CSRMatrix *A, const index_t *perm) {
+    index_t n = A->num_rows;
+    index_t *inverse = (index_t *)malloc_array((size_t)n + 1, sizeof(index_t));
+    CSRMatrix *B = csr_alloc_rows(n, A->num_cols);
+    if (!inverse || !B) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(inverse);
+        free_csr_matrix(B);
+        return NULL;
+    }
+    
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < n; i++) {
+        inverse[perm[i]] = i;
+        B->row_ptr[i + 1] = degree(A, perm[i]);
+    }
+    B->nnz = csr_counts_to_offsets(B->row_ptr, n);
+    B->values = (double *)malloc_array((size_t)B->nnz + 1, sizeof(double));
+    B->col_indices = (col_index_t *)malloc_array((size_t)B->nnz + 1, sizeof(col_index_t));
+    if (!B->values || !B->col_indices) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(inverse);
+        free_csr_matrix(B);
+        return NULL;
+    }
+    
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < n; i++) {
+        index_t src = A->row_ptr[perm[i]], dst = B->row_ptr[i];
+        index_t len = degree(A, perm[i]);
+        for (index_t j = 0; j < len; j++) {
+            B->col_indices[dst + j] = (col_index_t)inverse[A->col_indices[src + j]];
+            B->values[dst + j] = A->values[src + j];
+        }
+    }
+    csr_sort_rows(B);
+    
+    free(inverse);
+    return B;
+}
+
+void permute_vector(const double *v, const index_t *perm, index_t n, double *out) {
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < n; i++) out[i] = v[perm[i]];
+}
+
+void unpermute_vector(const double *v, const index_t *perm, index_t n, double *out) {
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < n; i++) out[perm[i]] = v[i];
+}
+
+/*
+ * Bandwidth and profile in parallel. Reuse distance is estimated in one
+ * sequential pass in SpMV order: for every gather of x[c], the non-zeros
+ * streamed since the previous gather of x[c]. A reuse counts as a hit if
+ * the bytes streamed in between (values, column indices and the x entries
+ * gathered) fit in `cache_bytes`; first touches count as misses.
+ */
+void locality_stats(const CSRMatrix *A, size_t cache_bytes, LocalityStats *stats) {
+    index_t bandwidth = 0;
+    double profile = 0.0;
+    
+    #pragma omp parallel for schedule(static) reduction(max:bandwidth) reduction(+:profile)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        index_t first = i;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            index_t c = A->col_indices[j];
+            index_t distance = (c > i) ? c - i : i - c;
+            if (distance > bandwidth) bandwidth = distance;
+            if (c < first) first = c;
+        }
+        profile += i - first;
+    }
+    stats->bandwidth = bandwidth;
+    stats->profile = profile;
+    
+    if (cache_bytes == 0) cache_bytes = last_level_cache_bytes();
+    if (cache_bytes == 0) cache_bytes = 32UL << 20;
+    double window = cache_bytes / (double)(2 * sizeof(double) + sizeof(col_index_t));
+    int64_t *last = (int64_t *)malloc_array((size_t)A->num_cols + 1, sizeof(int64_t));
+    stats->mean_reuse_nnz = 0.0;
+    stats->reuse_hit_rate = 0.0;
+    if (!last || A->nnz == 0) {
+        free(last);
+        return;
+    }
+    memset(last, 0xff, ((size_t)A->num_cols + 1) * sizeof(int64_t));
+    
+    double distance_sum = 0.0;
+    int64_t reuses = 0, hits = 0;
+    for (int64_t k = 0; k < A->nnz; k++) {
+        col_index_t c = A->col_indices[k];
+        if (last[c] >= 0) {
+            int64_t distance = k - last[c];
+            distance_sum += distance;
+            reuses++;
+            if (distance <= window) hits++;
+        }
+        last[c] = k;
+    }
+    stats->mean_reuse_nnz = reuses ? distance_sum / reuses : 0.0;
+    stats->reuse_hit_rate = (double)hits / A->nnz;
+    free(last);
+}
+
+static const char *reorder_names[] = {"none", "rcm", "degree"};
+
+int reorder_parse(const char *text, ReorderKind *kind) {
+    for (int k = 0; k < (int)(sizeof(reorder_names) / sizeof(reorder_names[0])); k++) {
+        if (strcmp(text, reorder_names[k]) == 0) {
+            *kind = (ReorderKind)k;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const char *reorder_name(ReorderKind kind) {
+    return reorder_names[kind];
+}
@@ -0,0 +1,67 @@
+/*
+ * Kernel Library: Locality Reordering of Sparse Matrices
+ * 
+ * Description:
+ *   SpMV gathers x[col_indices[j]]; when the columns of nearby rows are
+ *   scattered over x nearly every gather misses. A symmetric permutation
+ *   B = P A P^T (row and column i of B are row and column perm[i] of A)
+ *   renumbers the unknowns so rows that share columns sit close together:
+ * 
+ *     REORDER_RCM     Reverse Cuthill-McKee: breadth-first from a
+ *                     minimum-degree node, neighbors in increasing degree,
+ *                     order reversed. Minimizes bandwidth on meshes.
+ *                     Level-synchronous BFS: every level is expanded in
+ *                     parallel and the result is identical to the
+ *                     sequential algorithm for any thread count.
+ *     REORDER_DEGREE  rows by decreasing degree: hubs of power-law matrices
+ *                     (the most gathered x entries) share cache lines.
+ * 
+ *   Orderings use the row pattern of A as the graph (rows' columns are
+ *   their neighbors); for structurally unsymmetric matrices that is still
+ *   a valid, if weaker, ordering. Only square matrices can be reordered.
+ *   With y_perm = B * x_perm where x_perm = permute(x), unpermute(y_perm)
+ *   equals A * x.
+ * 
+ *   locality_stats measures what the ordering is for: bandwidth, profile,
+ *   and the reuse distance of x gathers in SpMV order.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "index_types.h"
+#include "spmv.h"
+
+typedef enum {
+    REORDER_NONE,
+    REORDER_RCM,
+    REORDER_DEGREE
+} ReorderKind;
+
+typedef struct {
+    index_t bandwidth;         // max |i - j| over non-zeros
+    double profile;            // sum over rows of i - (first column <= i)
+    double mean_reuse_nnz;     // Mean non-zeros streamed between two gathers of one x entry
+    double reuse_hit_rate;     // Share of gathers reused within a cache-sized window
+} LocalityStats;
+
+// perm[new] = old (NULL if the matrix is not square or on allocation failure)
+index_t* reorder_permutation(const CSRMatrix *A, ReorderKind kind);
+
+// B = P A P^T, columns sorted within each row
+CSRMatrix* csr_permute(const CSRMatrix *A, const index_t *perm);
+
+// out[i] = v[perm[i]] / out[perm[i]] = v[i]
+void permute_vector(const double *v, const index_t *perm, index_t n, double *out);
+void unpermute_vector(const double *v, const index_t *perm, index_t n, double *out);
+
+// cache_bytes = 0: use the last-level cache size
+void locality_stats(const CSRMatrix *A, size_t cache_bytes, LocalityStats *stats);
+
+int reorder_parse(const char *text, ReorderKind *kind);
+const char *reorder_name(ReorderKind kind);
+
+#endif // REORDER_H
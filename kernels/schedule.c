@@ -0,0 +1,307 @@
+/*
+ * Kernel Library: Pluggable Loop Scheduling
+ * 
+ * See schedule.h for the strategies.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <omp.h>
+#include "schedule.h"
+#include "trace.h"
+
+// Adaptive probe: each thread times one chunk of ~n / (threads * ADAPTIVE_PROBE_FRACTION)
+#define ADAPTIVE_PROBE_FRACTION 512
+
+// Work-stealing slot: a packed [begin, end) range, one cache line per thread
+typedef struct {
+    _Atomic uint64_t range;
+    char pad[64 - sizeof(uint64_t)];
+} StealSlot;
+
+static const char *kind_names[] = {"static", "dynamic", "guided", "taskloop", "steal", "adaptive"};
+
+static inline long min_long(long a, long b) {
+    return (a < b) ? a : b;
+}
+
+// Run one chunk, recorded on the calling thread's trace track
+static inline void run_chunk(ScheduleBody body, void *arg, long begin, long end) {
+    uint64_t trace_t0 = trace_begin();
+    body(begin, end, arg);
+    trace_end("schedule chunk", trace_t0, begin);
+}
+
+// Automatic chunk: ~100 chunks per thread, like spmv_dynamic_chunk_size
+static long default_chunk(long n, int num_threads) {
+    long chunk = n / ((long)num_threads * 100);
+    return (chunk < 1) ? 1 : chunk;
+}
+
+static long run_static(long n, long chunk, ScheduleBody body, void *arg) {
+    if (chunk > 0) {
+        long units = (n + chunk - 1) / chunk;
+        #pragma omp parallel for schedule(static, 1)
+        for (long u = 0; u < units; u++) {
+            run_chunk(body, arg, u * chunk, min_long(n, (u + 1) * chunk));
+        }
+        return chunk;
+    }
+    
+    // One contiguous block per thread, the same split as schedule(static)
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long per_thread = n / nthreads, extra = n % nthreads;
+        long begin = tid * per_thread + (tid < extra ? tid : extra);
+        long end = begin + per_thread + (tid < extra);
+        if (begin < end) run_chunk(body, arg, begin, end);
+    }
+    return (n + omp_get_max_threads() - 1) / omp_get_max_threads();
+}
+
+static long run_dynamic(long n, long chunk, ScheduleBody body, void *arg) {
+    long units = (n + chunk - 1) / chunk;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (long u = 0; u < units; u++) {
+        run_chunk(body, arg, u * chunk, min_long(n, (u + 1) * chunk));
+    }
+    return chunk;
+}
+
+static long run_guided(long n, long chunk, ScheduleBody body, void *arg) {
+    /*
+     * The runtime hands out shrinking groups of `chunk`-index units; each
+     * unit is one body call, so `chunk` is the guided minimum chunk size.
+     */
+    long units = (n + chunk - 1) / chunk;
+    #pragma omp parallel for schedule(guided)
+    for (long u = 0; u < units; u++) {
+        run_chunk(body, arg, u * chunk, min_long(n, (u + 1) * chunk));
+    }
+    return chunk;
+}
+
+static long run_taskloop(long n, long grain, ScheduleBody body, void *arg) {
+    long units = (n + grain - 1) / grain;
+    #pragma omp parallel
+    #pragma omp single
+    {
+        // One task per grain: the producer thread joins the consumers
+        // once all tasks are created
+        #pragma omp taskloop grainsize(1)
+        for (long u = 0; u < units; u++) {
+            run_chunk(body, arg, u * grain, min_long(n, (u + 1) * grain));
+        }
+    }
+    return grain;
+}
+
+static inline uint64_t pack_range(uint32_t begin, uint32_t end) {
+    return ((uint64_t)begin << 32) | end;
+}
+
+static long run_steal(long n, long chunk, ScheduleBody body, void *arg) {
+    /*
+     * Every thread starts with its static block in its own slot. The owner
+     * takes `chunk` indices from the front of its range, a thief that ran
+     * dry takes the back half of a victim's range. Both sides update the
+     * packed (begin, end) word with a compare-and-swap, so an index is
+     * handed out exactly once without locks. Once a scan finds every slot
+     * empty there is no unclaimed work left and the thread leaves.
+     */
+    int max_threads = omp_get_max_threads();
+    StealSlot *slots = (StealSlot *)aligned_alloc(64, max_threads * sizeof(StealSlot));
+    if (!slots) {
+        fprintf(stderr, "schedule: work-stealing slots allocation failed, using dynamic\n");
+        return run_dynamic(n, chunk, body, arg);
+    }
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long per_thread = n / nthreads, extra = n % nthreads;
+        long begin = tid * per_thread + (tid < extra ? tid : extra);
+        long end = begin + per_thread + (tid < extra);
+        StealSlot *mine = &slots[tid];
+        atomic_store(&mine->range, pack_range((uint32_t)begin, (uint32_t)end));
+        
+        #pragma omp barrier
+        
+        for (;;) {
+            uint64_t r = atomic_load(&mine->range);
+            uint32_t b = (uint32_t)(r >> 32), e = (uint32_t)r;
+            if (b < e) {
+                uint32_t nb = (e - b > chunk) ? b + (uint32_t)chunk : e;
+                if (atomic_compare_exchange_weak(&mine->range, &r, pack_range(nb, e))) {
+                    run_chunk(body, arg, b, nb);
+                }
+                continue;
+            }
+            
+            // Own range exhausted: steal the back half of someone else's
+            int found_work = 0, stolen = 0;
+            for (int k = 1; k < nthreads && !stolen; k++) {
+                StealSlot *victim = &slots[(tid + k) % nthreads];
+                uint64_t v = atomic_load(&victim->range);
+                uint32_t vb = (uint32_t)(v >> 32), ve = (uint32_t)v;
+                if (vb >= ve) continue;
+                found_work = 1;
+                uint32_t split = ve - (ve - vb + 1) / 2;
+                if (atomic_compare_exchange_strong(&victim->range, &v, pack_range(vb, split))) {
+                    atomic_store(&mine->range, pack_range(split, ve));
+                    stolen = 1;
+                }
+            }
+            if (!found_work) break;
+        }
+    }
+    
+    free(slots);
+    return chunk;
+}
+
+static long run_adaptive(long n, ScheduleBody body, void *arg) {
+    /*
+     * Self-scheduling from one shared counter. Phase 1: every thread claims
+     * and times a small probe chunk. Phase 2: the median cost per index
+     * sets the chunk size so one chunk takes ~ADAPTIVE_TARGET_US - large
+     * enough to amortize the atomic, small enough to balance - capped to
+     * leave at least 4 chunks per thread for the remaining work.
+     */
+    int max_threads = omp_get_max_threads();
+    double *cost = (double *)malloc(max_threads * sizeof(double));
+    if (!cost) {
+        // Without probes: the largest chunk adaptive would allow (4 per thread)
+        long chunk = n / (4L * max_threads);
+        fprintf(stderr, "schedule: adaptive probe allocation failed, using dynamic\n");
+        return run_dynamic(n, (chunk > 0) ? chunk : 1, body, arg);
+    }
+    _Atomic long next = 0;
+    long chosen = 1;
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long probe = n / ((long)nthreads * ADAPTIVE_PROBE_FRACTION);
+        if (probe < 1) probe = 1;
+        
+        long begin = atomic_fetch_add(&next, probe);
+        cost[tid] = -1.0;
+        if (begin < n) {
+            long end = min_long(n, begin + probe);
+            double t0 = omp_get_wtime();
+            run_chunk(body, arg, begin, end);
+            cost[tid] = (omp_get_wtime() - t0) / (end - begin);
+        }
+        
+        #pragma omp barrier
+        #pragma omp single
+        {
+            // Median per-index cost of the probes that ran (insertion sort)
+            double sorted[nthreads];
+            int count = 0;
+            for (int t = 0; t < nthreads; t++) {
+                if (cost[t] < 0.0) continue;
+                int j = count++;
+                while (j > 0 && sorted[j - 1] > cost[t]) {
+                    sorted[j] = sorted[j - 1];
+                    j--;
+                }
+                sorted[j] = cost[t];
+            }
+            double per_index = (count > 0) ? sorted[count / 2] : 0.0;
+            long remaining = n - min_long(n, atomic_load(&next));
+            long cap = remaining / ((long)nthreads * 4);
+            
+            chosen = (per_index > 0.0) ? (long)(ADAPTIVE_TARGET_US * 1e-6 / per_index) : cap;
+            if (chosen > cap) chosen = cap;
+            if (chosen < 1) chosen = 1;
+        }
+        
+        long chunk = chosen;
+        for (;;) {
+            begin = atomic_fetch_add(&next, chunk);
+            if (begin >= n) break;
+            run_chunk(body, arg, begin, min_long(n, begin + chunk));
+        }
+    }
+    
+    free(cost);
+    return chosen;
+}
+
+// Run body over [0, n) with the requested strategy
+long schedule_for(long n, Schedule sched, ScheduleBody body, void *arg) {
+    if (n <= 0) return 0;
+    long chunk = (sched.chunk > 0) ? sched.chunk : default_chunk(n, omp_get_max_threads());
+    
+    switch (sched.kind) {
+    case SCHED_STATIC:
+        return run_static(n, sched.chunk, body, arg);
+    case SCHED_DYNAMIC:
+        return run_dynamic(n, chunk, body, arg);
+    case SCHED_GUIDED:
+        return run_guided(n, chunk, body, arg);
+    case SCHED_TASKLOOP:
+        return run_taskloop(n, chunk, body, arg);
+    case SCHED_STEAL:
+        // Ranges are packed into 32-bit halves
+        if (n > UINT32_MAX) return run_dynamic(n, chunk, body, arg);
+        return run_steal(n, chunk, body, arg);
+    case SCHED_ADAPTIVE:
+        return run_adaptive(n, body, arg);
+    }
+    return 0;
+}
+
+// Parse "kind" or "kind:chunk"
+int schedule_parse(const char *text, Schedule *sched) {
+    int num_kinds = (int)(sizeof(kind_names) / sizeof(kind_names[0]));
+    const char *colon = strchr(text, ':');
+    size_t name_len = colon ? (size_t)(colon - text) : strlen(text);
+    
+    for (int k = 0; k < num_kinds; k++) {
+        if (strlen(kind_names[k]) == name_len && strncmp(text, kind_names[k], name_len) == 0) {
+            sched->kind = (ScheduleKind)k;
+            sched->chunk = colon ? atol(colon + 1) : 0;
+            return sched->chunk >= 0;
+        }
+    }
+    return 0;
+}
+
+void schedule_format(Schedule sched, char *buf, size_t len) {
+    if (sched.chunk > 0) {
+        snprintf(buf, len, "%s:%ld", kind_names[sched.kind], sched.chunk);
+    } else {
+        snprintf(buf, len, "%s", kind_names[sched.kind]);
+    }
+}
+
+int schedule_list_from_env(const char *var, Schedule *list, int max) {
+    const char *env = getenv(var);
+    if (!env || !*env) return 0;
+    
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", env);
+    int count = 0;
+    for (char *tok = strtok(copy, ","); tok && count < max; tok = strtok(NULL, ",")) {
+        if (!schedule_parse(tok, &list[count])) {
+            fprintf(stderr, "%s: unknown schedule '%s' (static|dynamic|guided|taskloop|"
+                    "steal|adaptive[:chunk])\n", var, tok);
+            return 0;
+        }
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,62 @@
+/*
+ * Kernel Library: Pluggable Loop Scheduling
+ * 
+ * Description:
+ *   Runs a body over the index range [0, n) split into chunks, with the
+ *   distribution strategy chosen at run time instead of being baked into
+ *   a `#pragma omp for schedule(...)` clause:
+ * 
+ *     static[:k]    contiguous block per thread (or round-robin k-chunks)
+ *     dynamic[:k]   OpenMP dynamic scheduling of k-index chunks
+ *     guided[:k]    OpenMP guided scheduling, minimum chunk k
+ *     taskloop[:g]  one OpenMP task per g indices
+ *     steal[:k]     per-thread index ranges in a lock-free work-stealing
+ *                   structure: owners pop k indices from the front,
+ *                   idle threads steal the back half of a victim's range
+ *     adaptive      every thread times a small probe chunk, the chunk size
+ *                   is then chosen so one chunk costs ~ADAPTIVE_TARGET_US
+ * 
+ *   k/g = 0 (or omitted) picks a size from the loop length and team size.
+ *   Kernels take a Schedule argument (vector_add_scheduled, spmv_scheduled)
+ *   so each one can use the strategy that suits its inputs.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stddef.h>
+
+#define ADAPTIVE_TARGET_US 20.0   // Target cost of one adaptive chunk
+
+typedef enum {
+    SCHED_STATIC,
+    SCHED_DYNAMIC,
+    SCHED_GUIDED,
+    SCHED_TASKLOOP,
+    SCHED_STEAL,
+    SCHED_ADAPTIVE
+} ScheduleKind;
+
+typedef struct {
+    ScheduleKind kind;
+    long chunk;        // Chunk / grain size in indices, 0 = automatic
+} Schedule;
+
+// Body over a half-open index range; called concurrently for disjoint ranges
+typedef void (*ScheduleBody)(long begin, long end, void *arg);
+
+// Run body over [0, n); returns the chunk size that was used
+long schedule_for(long n, Schedule sched, ScheduleBody body, void *arg);
+
+// "kind[:chunk]" <-> Schedule (schedule_parse returns 0 on bad input)
+int schedule_parse(const char *text, Schedule *sched);
+void schedule_format(Schedule sched, char *buf, size_t len);
+
+// Comma-separated list of schedules from an environment variable (e.g.
+// SPMV_SCHEDULE=steal,adaptive); returns the count, 0 if unset or invalid
+int schedule_list_from_env(const char *var, Schedule *list, int max);
+
+#endif // SCHEDULE_H
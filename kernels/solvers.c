@@ -0,0 +1,454 @@
+/*
+ * Kernel Library: Krylov Solvers (CG, BiCGSTAB) on CSR Matrices
+ * 
+ * See solvers.h for the fusion scheme.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include "solvers.h"
+#include "numa_alloc.h"
+#include "arena.h"
+#include "trace.h"
+
+#define REDUCE_STRIDE 8     // Doubles per thread slot: one 64-byte line each
+#define REDUCE_MAX_VALUES 4 // Values combined by one team_sum
+
+// ---------------------------------------------------------------------------
+// Team building blocks (called by every thread of the solver region)
+// ---------------------------------------------------------------------------
+
+// Per-thread partial sums; two slot sets used alternately, so a set is
+// only rewritten after the barrier of the reduction in between
+typedef struct {
+    double *slots;          // 2 * max_threads * REDUCE_STRIDE
+    int tid;
+    int nthreads;
+    int set;
+} TeamReduce;
+
+// Sum `count` values over the team, in thread order; every thread gets the
+// same sums. Contains the barrier that publishes the caller's pass.
+static void team_sum(TeamReduce *red, double *values, int count) {
+    double *base = red->slots + (size_t)red->set * red->nthreads * REDUCE_STRIDE;
+    for (int k = 0; k < count; k++) base[red->tid * REDUCE_STRIDE + k] = values[k];
+    #pragma omp barrier
+    for (int k = 0; k < count; k++) {
+        double sum = 0.0;
+        for (int t = 0; t < red->nthreads; t++) sum += base[t * REDUCE_STRIDE + k];
+        values[k] = sum;
+    }
+    red->set ^= 1;
+}
+
+static inline double row_dot(const CSRMatrix *A, index_t i, const double *v) {
+    double sum = 0.0;
+    for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+        sum += A->values[j] * v[A->col_indices[j]];
+    }
+    return sum;
+}
+
+// 1 / A[i][i], or 1 where the diagonal is missing or zero
+static double diagonal_inverse(const CSRMatrix *A, index_t i) {
+    for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+        if (A->col_indices[j] == i && A->values[j] != 0.0) return 1.0 / A->values[j];
+    }
+    return 1.0;
+}
+
+// n-element work vectors plus the reduction slots; NULL on failure
+static double *alloc_work(index_t n, double **vectors, int count) {
+    double *slots = (double *)scratch_alloc((size_t)2 * omp_get_max_threads() * REDUCE_STRIDE,
+                                            sizeof(double));
+    int ok = (slots != NULL);
+    for (int k = 0; k < count; k++) {
+        vectors[k] = (double *)scratch_alloc((size_t)n + 1, sizeof(double));
+        ok &= (vectors[k] != NULL);
+    }
+    if (ok) return slots;
+    fprintf(stderr, "Memory allocation failed!\n");
+    scratch_free(slots);
+    for (int k = 0; k < count; k++) scratch_free(vectors[k]);
+    return NULL;
+}
+
+static void free_work(double *slots, double **vectors, int count) {
+    scratch_free(slots);
+    for (int k = 0; k < count; k++) scratch_free(vectors[k]);
+}
+
+// ---------------------------------------------------------------------------
+// CG
+// ---------------------------------------------------------------------------
+
+/*
+ * Per iteration:
+ *   pass 1  q = A p                         + p·q   (reduce)
+ *   pass 2  x += αp, r -= αq, z = M⁻¹r      + r·z, r·r (reduce)
+ *   pass 3  p = z + βp                      (barrier: next SpMV gathers p)
+ * Without Jacobi, z is r.
+ */
+SolverResult cg_solve(CSRMatrix *A, const double *b, double *x, const SolverOptions *opt) {
+    SolverResult result = {0, 0, 0.0, 0.0, 0.0, 0.0};
+    index_t n = A->num_rows;
+    double *work[5] = {NULL, NULL, NULL, NULL, NULL};
+    int num_work = opt->jacobi ? 5 : 3;
+    double *slots = alloc_work(n, work, num_work);
+    if (!slots) return result;
+    double *r = work[0], *p = work[1], *q = work[2];
+    double *z = opt->jacobi ? work[3] : r, *dinv = work[4];
+    
+    double start = omp_get_wtime();
+    int iterations = 0;
+    double residual = 0.0;
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t begin = csr_nnz_partition(A, nthreads, tid);
+        index_t end = csr_nnz_partition(A, nthreads, tid + 1);
+        TeamReduce red = {slots, tid, nthreads, 0};
+        
+        // r = b - A x, z = M⁻¹r, p = z
+        double sums[3] = {0.0, 0.0, 0.0};   // r·z, r·r, b·b
+        for (index_t i = begin; i < end; i++) {
+            r[i] = b[i] - row_dot(A, i, x);
+            if (opt->jacobi) {
+                dinv[i] = diagonal_inverse(A, i);
+                z[i] = dinv[i] * r[i];
+            }
+            p[i] = z[i];
+            sums[0] += r[i] * z[i];
+            sums[1] += r[i] * r[i];
+            sums[2] += b[i] * b[i];
+        }
+        team_sum(&red, sums, 3);
+        double rz = sums[0];
+        double b_norm = (sums[2] > 0.0) ? sqrt(sums[2]) : 1.0;
+        double res = sqrt(sums[1]) / b_norm;
+        int it = 0;
+        
+        while (res > opt->tolerance && it < opt->max_iterations) {
+            uint64_t trace_t0 = trace_begin();
+            double pq = 0.0;
+            for (index_t i = begin; i < end; i++) {
+                q[i] = row_dot(A, i, p);
+                pq += p[i] * q[i];
+            }
+            team_sum(&red, &pq, 1);
+            if (!(pq > 0.0)) break;             // A is not positive definite
+            double alpha = rz / pq;
+            
+            double dots[2] = {0.0, 0.0};        // r·z, r·r
+            for (index_t i = begin; i < end; i++) {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+                if (opt->jacobi) z[i] = dinv[i] * r[i];
+                dots[0] += r[i] * z[i];
+                dots[1] += r[i] * r[i];
+            }
+            team_sum(&red, dots, 2);
+            double beta = dots[0] / rz;
+            rz = dots[0];
+            res = sqrt(dots[1]) / b_norm;
+            it++;
+            if (res <= opt->tolerance) break;
+            
+            for (index_t i = begin; i < end; i++) p[i] = z[i] + beta * p[i];
+            trace_end("cg iteration", trace_t0, it);
+            #pragma omp barrier
+        }
+        
+        if (tid == 0) {
+            iterations = it;
+            residual = res;
+        }
+    }
+    
+    result.seconds = omp_get_wtime() - start;
+    result.iterations = iterations;
+    result.relative_residual = residual;
+    result.converged = (residual <= opt->tolerance);
+    // SpMV: matrix + p + q; pass 2: x, r (read+write), p, q (+ dinv, z);
+    // pass 3: z, p (read+write)
+    result.bytes_per_iteration = csr_matrix_bytes(A)
+                               + (2.0 + 6.0 + 3.0 + (opt->jacobi ? 2.0 : 0.0)) * n * sizeof(double);
+    result.flops_per_iteration = 2.0 * A->nnz + (12.0 + (opt->jacobi ? 1.0 : 0.0)) * n;
+    free_work(slots, work, num_work);
+    return result;
+}
+
+// The same CG from separate parallel kernels: a region per SpMV, dot and AXPY
+SolverResult cg_solve_unfused(CSRMatrix *A, const double *b, double *x, const SolverOptions *opt) {
+    SolverResult result = {0, 0, 0.0, 0.0, 0.0, 0.0};
+    index_t n = A->num_rows;
+    double *work[5] = {NULL, NULL, NULL, NULL, NULL};
+    int num_work = opt->jacobi ? 5 : 3;
+    double *slots = alloc_work(n, work, num_work);
+    if (!slots) return result;
+    double *r = work[0], *p = work[1], *q = work[2];
+    double *z = opt->jacobi ? work[3] : r, *dinv = work[4];
+    double start = omp_get_wtime();
+    
+    spmv_parallel_dynamic(A, x, q);
+    double rz = 0.0, rr = 0.0, bb = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:rz, rr, bb)
+    for (index_t i = 0; i < n; i++) {
+        r[i] = b[i] - q[i];
+        if (opt->jacobi) {
+            dinv[i] = diagonal_inverse(A, i);
+            z[i] = dinv[i] * r[i];
+        }
+        p[i] = z[i];
+        rz += r[i] * z[i];
+        rr += r[i] * r[i];
+        bb += b[i] * b[i];
+    }
+    double b_norm = (bb > 0.0) ? sqrt(bb) : 1.0;
+    double res = sqrt(rr) / b_norm;
+    int it = 0;
+    
+    while (res > opt->tolerance && it < opt->max_iterations) {
+        spmv_parallel_dynamic(A, p, q);
+        double pq = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:pq)
+        for (index_t i = 0; i < n; i++) pq += p[i] * q[i];
+        if (!(pq > 0.0)) break;
+        double alpha = rz / pq;
+        
+        #pragma omp parallel for schedule(static)
+        for (index_t i = 0; i < n; i++) x[i] += alpha * p[i];
+        #pragma omp parallel for schedule(static)
+        for (index_t i = 0; i < n; i++) r[i] -= alpha * q[i];
+        if (opt->jacobi) {
+            #pragma omp parallel for schedule(static)
+            for (index_t i = 0; i < n; i++) z[i] = dinv[i] * r[i];
+        }
+        double rz_new = 0.0;
+        rr = 0.0;
+        if (opt->jacobi) {
+            #pragma omp parallel for schedule(static) reduction(+:rz_new)
+            for (index_t i = 0; i < n; i++) rz_new += r[i] * z[i];
+        }
+        #pragma omp parallel for schedule(static) reduction(+:rr)
+        for (index_t i = 0; i < n; i++) rr += r[i] * r[i];
+        if (!opt->jacobi) rz_new = rr;
+        
+        double beta = rz_new / rz;
+        rz = rz_new;
+        res = sqrt(rr) / b_norm;
+        it++;
+        if (res <= opt->tolerance) break;
+        #pragma omp parallel for schedule(static)
+        for (index_t i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+    }
+    
+    result.seconds = omp_get_wtime() - start;
+    result.iterations = it;
+    result.relative_residual = res;
+    result.converged = (res <= opt->tolerance);
+    // SpMV: matrix + p + q; p·q, x, r (+ z, r·z), r·r, p
+    result.bytes_per_iteration = csr_matrix_bytes(A)
+                               + (2.0 + 2.0 + 3.0 + 3.0 + (opt->jacobi ? 4.0 : 0.0) + 1.0 + 3.0)
+                                 * n * sizeof(double);
+    result.flops_per_iteration = 2.0 * A->nnz + (12.0 + (opt->jacobi ? 1.0 : 0.0)) * n;
+    free_work(slots, work, num_work);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// BiCGSTAB
+// ---------------------------------------------------------------------------
+
+/*
+ * Right-preconditioned BiCGSTAB, per iteration:
+ *   pass 1  p = r + β(p - ωv), p̂ = M⁻¹p          (barrier)
+ *   pass 2  v = A p̂                      + r̂·v     (reduce)
+ *   pass 3  s = r - αv, ŝ = M⁻¹s          + s·s     (reduce; may stop here)
+ *   pass 4  t = A ŝ                      + t·s, t·t (reduce)
+ *   pass 5  x += αp̂ + ωŝ, r = s - ωt     + r̂·r, r·r (reduce)
+ * Without Jacobi, p̂ is p and ŝ is s.
+ */
+SolverResult bicgstab_solve(CSRMatrix *A, const double *b, double *x, const SolverOptions *opt) {
+    SolverResult result = {0, 0, 0.0, 0.0, 0.0, 0.0};
+    index_t n = A->num_rows;
+    double *work[9] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+    int num_work = opt->jacobi ? 9 : 6;
+    double *slots = alloc_work(n, work, num_work);
+    if (!slots) return result;
+    double *r = work[0], *r_hat = work[1], *p = work[2], *v = work[3], *s = work[4], *t = work[5];
+    double *p_hat = opt->jacobi ? work[6] : p, *s_hat = opt->jacobi ? work[7] : s;
+    double *dinv = work[8];
+    
+    double start = omp_get_wtime();
+    int iterations = 0;
+    double residual = 0.0;
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t begin = csr_nnz_partition(A, nthreads, tid);
+        index_t end = csr_nnz_partition(A, nthreads, tid + 1);
+        TeamReduce red = {slots, tid, nthreads, 0};
+        
+        // r = r̂ = b - A x, p = v = 0
+        double sums[2] = {0.0, 0.0};        // r·r, b·b
+        for (index_t i = begin; i < end; i++) {
+            r[i] = b[i] - row_dot(A, i, x);
+            r_hat[i] = r[i];
+            p[i] = 0.0;
+            v[i] = 0.0;
+            if (opt->jacobi) dinv[i] = diagonal_inverse(A, i);
+            sums[0] += r[i] * r[i];
+            sums[1] += b[i] * b[i];
+        }
+        team_sum(&red, sums, 2);
+        double b_norm = (sums[1] > 0.0) ? sqrt(sums[1]) : 1.0;
+        double res = sqrt(sums[0]) / b_norm;
+        double rho = 1.0, rho_next = sums[0], alpha = 1.0, omega = 1.0;
+        int it = 0;
+        
+        while (res > opt->tolerance && it < opt->max_iterations && rho_next != 0.0) {
+            uint64_t trace_t0 = trace_begin();
+            double beta = (rho_next / rho) * (alpha / omega);
+            rho = rho_next;
+            for (index_t i = begin; i < end; i++) {
+                p[i] = r[i] + beta * (p[i] - omega * v[i]);
+                if (opt->jacobi) p_hat[i] = dinv[i] * p[i];
+            }
+            #pragma omp barrier
+            
+            double rv = 0.0;
+            for (index_t i = begin; i < end; i++) {
+                v[i] = row_dot(A, i, p_hat);
+                rv += r_hat[i] * v[i];
+            }
+            team_sum(&red, &rv, 1);
+            if (rv == 0.0) break;
+            alpha = rho / rv;
+            
+            double ss = 0.0;
+            for (index_t i = begin; i < end; i++) {
+                s[i] = r[i] - alpha * v[i];
+                if (opt->jacobi) s_hat[i] = dinv[i] * s[i];
+                ss += s[i] * s[i];
+            }
+            team_sum(&red, &ss, 1);
+            it++;
+            if (sqrt(ss) / b_norm <= opt->tolerance) {
+                // Converged half way: x += αp̂
+                for (index_t i = begin; i < end; i++) x[i] += alpha * p_hat[i];
+                res = sqrt(ss) / b_norm;
+                break;
+            }
+            
+            double ts[2] = {0.0, 0.0};      // t·s, t·t
+            for (index_t i = begin; i < end; i++) {
+                t[i] = row_dot(A, i, s_hat);
+                ts[0] += t[i] * s[i];
+                ts[1] += t[i] * t[i];
+            }
+            team_sum(&red, ts, 2);
+            if (ts[1] == 0.0) break;
+            omega = ts[0] / ts[1];
+            
+            double dots[2] = {0.0, 0.0};    // r̂·r, r·r
+            for (index_t i = begin; i < end; i++) {
+                x[i] += alpha * p_hat[i] + omega * s_hat[i];
+                r[i] = s[i] - omega * t[i];
+                dots[0] += r_hat[i] * r[i];
+                dots[1] += r[i] * r[i];
+            }
+            team_sum(&red, dots, 2);
+            rho_next = dots[0];
+            res = sqrt(dots[1]) / b_norm;
+            trace_end("bicgstab iteration", trace_t0, it);
+            if (omega == 0.0) break;
+        }
+        
+        if (tid == 0) {
+            iterations = it;
+            residual = res;
+        }
+    }
+    
+    result.seconds = omp_get_wtime() - start;
+    result.iterations = iterations;
+    result.relative_residual = residual;
+    result.converged = (residual <= opt->tolerance);
+    // 2 SpMVs (matrix + input + output each); pass 1: r, p (read+write), v
+    // (+ dinv, p̂); pass 3: r, v, s (+ dinv, ŝ); pass 5: x (read+write),
+    // p̂, ŝ, s, t, r, r̂ (ŝ is s without Jacobi)
+    double vectors = 4.0 + 4.0 + 3.0 + 8.0 + (opt->jacobi ? 4.0 : -1.0);
+    result.bytes_per_iteration = 2.0 * csr_matrix_bytes(A) + vectors * n * sizeof(double);
+    result.flops_per_iteration = 4.0 * A->nnz + (24.0 + (opt->jacobi ? 2.0 : 0.0)) * n;
+    free_work(slots, work, num_work);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Test problems and checks
+// ---------------------------------------------------------------------------
+
+double solver_true_residual(CSRMatrix *A, const double *b, const double *x) {
+    double rr = 0.0, bb = 0.0;
+    #pragma omp parallel for schedule(dynamic, 256) reduction(+:rr, bb)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        double r = b[i] - row_dot(A, i, x);
+        rr += r * r;
+        bb += b[i] * b[i];
+    }
+    return sqrt(rr) / ((bb > 0.0) ? sqrt(bb) : 1.0);
+}
+
+CSRMatrix* csr_diagonally_dominant(const CSRMatrix *A, double margin) {
+    if (A->num_rows != A->num_cols) return NULL;
+    index_t n = A->num_rows;
+    CSRMatrix *D = csr_alloc_rows(n, n);
+    if (!D) return NULL;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < n; i++) {
+        index_t count = 1;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            if (A->col_indices[j] != i) count++;
+        }
+        D->row_ptr[i + 1] = count;
+    }
+    D->nnz = csr_counts_to_offsets(D->row_ptr, n);
+    D->values = (double *)malloc_array((size_t)D->nnz + 1, sizeof(double));
+    D->col_indices = (col_index_t *)malloc_array((size_t)D->nnz + 1, sizeof(col_index_t));
+    if (!D->values || !D->col_indices) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(D);
+        return NULL;
+    }
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < n; i++) {
+        index_t out = D->row_ptr[i];
+        double off_diagonal = 0.0;
+        index_t diagonal = -1;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            index_t c = A->col_indices[j];
+            if (c == i) continue;
+            if (diagonal < 0 && c > i) diagonal = out++;
+            D->col_indices[out] = (col_index_t)c;
+            D->values[out++] = A->values[j];
+            off_diagonal += fabs(A->values[j]);
+        }
+        if (diagonal < 0) diagonal = out;
+        D->col_indices[diagonal] = (col_index_t)i;
+        D->values[diagonal] = margin + off_diagonal;
+    }
+    csr_sort_rows(D);
+    return D;
+}
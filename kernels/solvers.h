@@ -0,0 +1,66 @@
+/*
+ * Kernel Library: Krylov Solvers (CG, BiCGSTAB) on CSR Matrices
+ * 
+ * Description:
+ *   A solver iteration is one or two SpMVs plus a handful of dot products
+ *   and AXPYs over vectors as long as the matrix has rows, all memory
+ *   bound. Called one library kernel at a time, each operation would fork
+ *   a team, stream its vectors and join again. Here the whole solve runs in
+ *   ONE parallel region instead:
+ * 
+ *     - every thread owns the same row block (equal non-zeros, see
+ *       csr_nnz_partition) in the SpMV and in every vector pass, so the
+ *       vector entries it writes stay in its cache / on its NUMA node;
+ *     - dot products ride along with the pass that produces their inputs
+ *       (p·q inside the SpMV, r·z and r·r inside the x/r update);
+ *     - per-thread partial sums are combined in thread order by every
+ *       thread, so all threads see the same scalars and make the same
+ *       convergence decision, and results do not depend on timing.
+ * 
+ *   CG (symmetric positive definite A): 3 passes and 2 reductions per
+ *   iteration. BiCGSTAB (general A): 2 SpMVs, 3 vector passes, 4
+ *   reductions. Jacobi preconditioning (M = diag(A)) is folded into the
+ *   passes. cg_solve_unfused is the same CG built from separate parallel
+ *   kernels, for comparison.
+ * 
+ *   Bytes and flops per iteration are a streaming model: the matrix once
+ *   per SpMV, each vector read or written once per pass.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SOLVERS_H
+#define SOLVERS_H
+
+#include "index_types.h"
+#include "spmv.h"
+
+typedef struct {
+    int max_iterations;
+    double tolerance;             // Stop at ||r|| / ||b|| <= tolerance
+    int jacobi;                   // 1: diagonal (Jacobi) preconditioning
+} SolverOptions;
+
+typedef struct {
+    int iterations;
+    int converged;
+    double relative_residual;     // ||r|| / ||b|| of the recurrence at exit
+    double seconds;               // Whole solve, setup included
+    double bytes_per_iteration;   // Streaming model
+    double flops_per_iteration;
+} SolverResult;
+
+// x holds the initial guess on entry and the solution on exit
+SolverResult cg_solve(CSRMatrix *A, const double *b, double *x, const SolverOptions *opt);
+SolverResult cg_solve_unfused(CSRMatrix *A, const double *b, double *x, const SolverOptions *opt);
+SolverResult bicgstab_solve(CSRMatrix *A, const double *b, double *x, const SolverOptions *opt);
+
+// ||b - A x|| / ||b||, computed independently of the solvers' recurrences
+double solver_true_residual(CSRMatrix *A, const double *b, const double *x);
+
+// Copy of A with diagonal entries set to margin + sum of |off-diagonal|
+// in the row (inserted where missing): symmetric inputs become SPD
+CSRMatrix* csr_diagonally_dominant(const CSRMatrix *A, double margin);
+
+#endif // SOLVERS_H
@@ -0,0 +1,400 @@
+/*
+ * Kernel Library: Compressed CSR (Encoded Column Indices, Narrow Values)
+ * 
+ * See sparse_compress.h for the encodings.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include "sparse_compress.h"
+#include "numa_alloc.h"
+#include "trace.h"
+
+// ---------------------------------------------------------------------------
+// binary16
+// ---------------------------------------------------------------------------
+
+// Exponent and mantissa shifted into float position, then rebiased by one
+// multiply (2^(127-15)); this also turns half subnormals into float normals
+static inline __attribute__((always_inline)) float half_bits_to_float(uint16_t bits) {
+    uint32_t magnitude = (uint32_t)(bits & 0x7fff) << 13;
+    float value;
+    memcpy(&value, &magnitude, sizeof(value));
+    value *= 0x1p112f;
+    memcpy(&magnitude, &value, sizeof(value));
+    if (value >= 65536.0f) magnitude |= 0xffu << 23;   // Infinity / NaN
+    magnitude |= (uint32_t)(bits & 0x8000) << 16;
+    memcpy(&value, &magnitude, sizeof(value));
+    return value;
+}
+
+float half_to_float(uint16_t bits) {
+    return half_bits_to_float(bits);
+}
+
+uint16_t float_to_half(float value) {
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+    uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+    x &= 0x7fffffff;
+    if (x >= 0x7f800000) return sign | 0x7c00 | (x > 0x7f800000 ? 0x200 : 0);
+    if (x >= 0x477ff000) return sign | 0x7c00;        // Rounds to 65520 or more
+    if (x < 0x38800000) {                             // Below 2^-14: subnormal or zero
+        float magnitude;
+        memcpy(&magnitude, &x, sizeof(magnitude));
+        return sign | (uint16_t)nearbyintf(magnitude * 0x1p24f);
+    }
+    x += 0xfff + ((x >> 13) & 1);                     // Round to nearest even
+    return sign | (uint16_t)((x - (112u << 23)) >> 13);
+}
+
+// ---------------------------------------------------------------------------
+// Encoding
+// ---------------------------------------------------------------------------
+
+static inline int varint_length(uint64_t value) {
+    int length = 1;
+    while (value >= 128) {
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+static inline uint8_t *varint_put(uint8_t *p, uint64_t value) {
+    while (value >= 128) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static size_t value_size(ValuePrecision precision) {
+    switch (precision) {
+    case VALUE_PRECISION_FLOAT: return sizeof(float);
+    case VALUE_PRECISION_HALF:  return sizeof(uint16_t);
+    default:                    return sizeof(double);
+    }
+}
+
+// Gaps of each row into col_bytes (-1: a row is unsorted, -2: too many bytes)
+static int encode_varint(const CSRMatrix *A, CompressedCSR *M) {
+    index_t n = A->num_rows;
+    int unsorted = 0;
+    int64_t total = 0;
+    #pragma omp parallel for schedule(dynamic, 256) reduction(|:unsorted) reduction(+:total)
+    for (index_t i = 0; i < n; i++) {
+        index_t bytes = 0, previous = 0;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            index_t c = A->col_indices[j];
+            if (c < previous) unsorted = 1;
+            bytes += varint_length((uint64_t)(c - previous));
+            previous = c;
+        }
+        M->col_ptr[i + 1] = bytes;
+        total += bytes;
+    }
+    if (unsorted) return -1;
+    if (!index_count_fits((double)total)) return -2;
+    M->col_ptr[0] = 0;
+    csr_counts_to_offsets(M->col_ptr, n);
+    
+    M->col_bytes = (uint8_t *)malloc_array((size_t)total + VARINT_PADDING, 1);
+    if (!M->col_bytes) return 0;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < n; i++) {
+        uint8_t *p = M->col_bytes + M->col_ptr[i];
+        index_t previous = 0;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            p = varint_put(p, (uint64_t)(A->col_indices[j] - previous));
+            previous = A->col_indices[j];
+        }
+    }
+    return 1;
+}
+
+// 16-bit offsets, plus a segment per (row, 65536-column block) when needed
+static int encode_block16(const CSRMatrix *A, CompressedCSR *M) {
+    index_t n = A->num_rows;
+    M->col_low = (uint16_t *)malloc_array((size_t)A->nnz + 1, sizeof(uint16_t));
+    if (!M->col_low) return 0;
+    
+    if (A->num_cols > BLOCK16_COLUMNS) {
+        M->col_ptr = (index_t *)malloc_array((size_t)n + 1, sizeof(index_t));
+        if (!M->col_ptr) return 0;
+        int unsorted = 0;
+        #pragma omp parallel for schedule(dynamic, 256) reduction(|:unsorted)
+        for (index_t i = 0; i < n; i++) {
+            index_t count = 0, block = -1;
+            for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                index_t b = A->col_indices[j] / BLOCK16_COLUMNS;
+                if (b < block) unsorted = 1;
+                if (b != block) count++;
+                block = b;
+            }
+            M->col_ptr[i + 1] = count;
+        }
+        if (unsorted) return -1;
+        M->col_ptr[0] = 0;
+        index_t num_segments = csr_counts_to_offsets(M->col_ptr, n);
+        M->segments = (ColumnSegment *)malloc_array((size_t)num_segments + 1, sizeof(ColumnSegment));
+        if (!M->segments) return 0;
+        
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (index_t i = 0; i < n; i++) {
+            index_t s = M->col_ptr[i] - 1, block = -1;
+            for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                index_t b = A->col_indices[j] / BLOCK16_COLUMNS;
+                if (b != block) {
+                    M->segments[++s].base = b * BLOCK16_COLUMNS;
+                    block = b;
+                }
+                M->segments[s].end = j + 1;
+            }
+        }
+    }
+    
+    #pragma omp parallel for schedule(static)
+    for (index_t j = 0; j < A->nnz; j++) {
+        M->col_low[j] = (uint16_t)(A->col_indices[j] % BLOCK16_COLUMNS);
+    }
+    return 1;
+}
+
+CompressedCSR* compressed_csr_from_csr(const CSRMatrix *A, ColumnCodec codec,
+                                       ValuePrecision precision) {
+    index_t n = A->num_rows;
+    CompressedCSR *M = (CompressedCSR *)calloc(1, sizeof(CompressedCSR));
+    if (!M) return NULL;
+    M->num_rows = n;
+    M->num_cols = A->num_cols;
+    M->nnz = A->nnz;
+    M->codec = codec;
+    M->precision = precision;
+    M->row_ptr = (index_t *)malloc_array((size_t)n + 1, sizeof(index_t));
+    M->values = malloc_array((size_t)A->nnz + 1, value_size(precision));
+    if (codec == COLUMN_CODEC_VARINT) {
+        M->col_ptr = (index_t *)malloc_array((size_t)n + 1, sizeof(index_t));
+    }
+    if (!M->row_ptr || !M->values || (codec == COLUMN_CODEC_VARINT && !M->col_ptr)) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_compressed_csr(M);
+        return NULL;
+    }
+    
+    int status = (codec == COLUMN_CODEC_VARINT) ? encode_varint(A, M) : encode_block16(A, M);
+    if (status != 1) {
+        if (status == -1) {
+            fprintf(stderr, "Compressed CSR (%s): rows must have sorted columns\n",
+                    column_codec_name(codec));
+        } else if (status == -2) {
+            fprintf(stderr, "Compressed CSR (%s): column bytes exceed the %s index type\n",
+                    column_codec_name(codec), INDEX_MODE);
+        } else {
+            fprintf(stderr, "Memory allocation failed!\n");
+        }
+        free_compressed_csr(M);
+        return NULL;
+    }
+    
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i <= n; i++) M->row_ptr[i] = A->row_ptr[i];
+    
+    #pragma omp parallel for schedule(static)
+    for (index_t j = 0; j < A->nnz; j++) {
+        double v = A->values[j];
+        switch (precision) {
+        case VALUE_PRECISION_FLOAT: ((float *)M->values)[j] = (float)v; break;
+        case VALUE_PRECISION_HALF:  ((uint16_t *)M->values)[j] = float_to_half((float)v); break;
+        default:                    ((double *)M->values)[j] = v; break;
+        }
+    }
+    return M;
+}
+
+void free_compressed_csr(CompressedCSR *M) {
+    if (!M) return;
+    free(M->row_ptr);
+    free(M->col_ptr);
+    free(M->col_bytes);
+    free(M->col_low);
+    free(M->segments);
+    free(M->values);
+    free(M);
+}
+
+double compressed_csr_bytes(const CompressedCSR *M) {
+    double bytes = (double)(M->num_rows + 1) * sizeof(index_t)
+                 + (double)M->nnz * value_size(M->precision);
+    if (M->codec == COLUMN_CODEC_VARINT) {
+        bytes += (double)(M->num_rows + 1) * sizeof(index_t) + (double)M->col_ptr[M->num_rows];
+    } else {
+        bytes += (double)M->nnz * sizeof(uint16_t);
+        if (M->segments) {
+            bytes += (double)(M->num_rows + 1) * sizeof(index_t)
+                   + (double)M->col_ptr[M->num_rows] * sizeof(ColumnSegment);
+        }
+    }
+    return bytes;
+}
+
+// ---------------------------------------------------------------------------
+// Decode-fused SpMV
+// ---------------------------------------------------------------------------
+
+static inline __attribute__((always_inline))
+double load_value(const void *values, ValuePrecision precision, index_t j) {
+    switch (precision) {
+    case VALUE_PRECISION_FLOAT: return ((const float *)values)[j];
+    case VALUE_PRECISION_HALF:  return half_bits_to_float(((const uint16_t *)values)[j]);
+    default:                    return ((const double *)values)[j];
+    }
+}
+
+/*
+ * One gap per non-zero. Gaps below 16384 (1 or 2 bytes, the common case
+ * unless a row has fewer than num_cols / 16384 entries) decode without a
+ * branch from an 8-byte load: the first byte's continuation bit selects
+ * whether the second byte is added and how far p advances.
+ */
+static inline __attribute__((always_inline))
+double varint_row(const CompressedCSR *M, const double *x, index_t i, ValuePrecision precision) {
+    const uint8_t *p = M->col_bytes + M->col_ptr[i];
+    uint64_t col = 0;
+    double sum = 0.0;
+    for (index_t j = M->row_ptr[i]; j < M->row_ptr[i + 1]; j++) {
+        uint64_t word, gap;
+        memcpy(&word, p, sizeof(word));
+        if ((word & 0x8080) != 0x8080) {
+            uint64_t two = (word >> 7) & 1;
+            gap = (word & 0x7f) | (((word >> 1) & 0x3f80) & (0 - two));
+            p += 1 + two;
+        } else {
+            uint64_t byte = *p++;
+            gap = byte & 0x7f;
+            for (int shift = 7; byte & 0x80; shift += 7) {
+                byte = *p++;
+                gap |= (byte & 0x7f) << shift;
+            }
+        }
+        col += gap;
+        sum += load_value(M->values, precision, j) * x[col];
+    }
+    return sum;
+}
+
+static inline __attribute__((always_inline))
+double block16_row(const CompressedCSR *M, const double *x, index_t i, ValuePrecision precision) {
+    index_t j = M->row_ptr[i], end = M->row_ptr[i + 1];
+    double sum = 0.0;
+    if (!M->segments) {
+        for (; j < end; j++) sum += load_value(M->values, precision, j) * x[M->col_low[j]];
+        return sum;
+    }
+    for (index_t s = M->col_ptr[i]; s < M->col_ptr[i + 1]; s++) {
+        const double *x_block = x + M->segments[s].base;
+        for (; j < M->segments[s].end; j++) {
+            sum += load_value(M->values, precision, j) * x_block[M->col_low[j]];
+        }
+    }
+    return sum;
+}
+
+static inline __attribute__((always_inline))
+void compressed_rows(const CompressedCSR *M, const double *x, double *y, index_t begin,
+                     index_t end, ColumnCodec codec, ValuePrecision precision) {
+    for (index_t i = begin; i < end; i++) {
+        y[i] = (codec == COLUMN_CODEC_VARINT) ? varint_row(M, x, i, precision)
+                                              : block16_row(M, x, i, precision);
+    }
+}
+
+// One loop per codec / precision pair, so neither is tested per non-zero
+static void compressed_chunk(const CompressedCSR *M, const double *x, double *y,
+                             index_t begin, index_t end) {
+    if (M->codec == COLUMN_CODEC_VARINT) {
+        switch (M->precision) {
+        case VALUE_PRECISION_FLOAT:
+            compressed_rows(M, x, y, begin, end, COLUMN_CODEC_VARINT, VALUE_PRECISION_FLOAT);
+            break;
+        case VALUE_PRECISION_HALF:
+            compressed_rows(M, x, y, begin, end, COLUMN_CODEC_VARINT, VALUE_PRECISION_HALF);
+            break;
+        default:
+            compressed_rows(M, x, y, begin, end, COLUMN_CODEC_VARINT, VALUE_PRECISION_DOUBLE);
+            break;
+        }
+    } else {
+        switch (M->precision) {
+        case VALUE_PRECISION_FLOAT:
+            compressed_rows(M, x, y, begin, end, COLUMN_CODEC_BLOCK16, VALUE_PRECISION_FLOAT);
+            break;
+        case VALUE_PRECISION_HALF:
+            compressed_rows(M, x, y, begin, end, COLUMN_CODEC_BLOCK16, VALUE_PRECISION_HALF);
+            break;
+        default:
+            compressed_rows(M, x, y, begin, end, COLUMN_CODEC_BLOCK16, VALUE_PRECISION_DOUBLE);
+            break;
+        }
+    }
+}
+
+void spmv_compressed(const CompressedCSR *M, const double *x, double *y) {
+    #pragma omp parallel
+    {
+        int chunk_size = spmv_dynamic_chunk_size(M->num_rows, omp_get_num_threads());
+        index_t num_chunks = (M->num_rows + chunk_size - 1) / chunk_size;
+        
+        #pragma omp for schedule(dynamic)
+        for (index_t c = 0; c < num_chunks; c++) {
+            uint64_t trace_t0 = trace_begin();
+            index_t begin = c * chunk_size;
+            index_t end = (begin + chunk_size < M->num_rows) ? begin + chunk_size : M->num_rows;
+            compressed_chunk(M, x, y, begin, end);
+            trace_end("spmv compressed chunk", trace_t0, c);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Names
+// ---------------------------------------------------------------------------
+
+static const char *codec_names[] = {"varint", "block16"};
+static const char *precision_names[] = {"double", "float", "half"};
+
+const char *column_codec_name(ColumnCodec codec) {
+    return codec_names[codec];
+}
+
+const char *value_precision_name(ValuePrecision precision) {
+    return precision_names[precision];
+}
+
+int column_codec_parse(const char *text, ColumnCodec *codec) {
+    for (int k = 0; k < (int)(sizeof(codec_names) / sizeof(codec_names[0])); k++) {
+        if (strcmp(text, codec_names[k]) == 0) {
+            *codec = (ColumnCodec)k;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int value_precision_parse(const char *text, ValuePrecision *precision) {
+    for (int k = 0; k < (int)(sizeof(precision_names) / sizeof(precision_names[0])); k++) {
+        if (strcmp(text, precision_names[k]) == 0) {
+            *precision = (ValuePrecision)k;
+            return 1;
+        }
+    }
+    return 0;
+}
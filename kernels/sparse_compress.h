@@ -0,0 +1,90 @@
+/*
+ * Kernel Library: Compressed CSR (Encoded Column Indices, Narrow Values)
+ * 
+ * Description:
+ *   SpMV streams every non-zero once and does 2 flops with it, so its speed
+ *   is bytes per non-zero: 12 in CSR (double value, 32-bit column). This
+ *   variant shrinks both parts and decodes them inside the SpMV loop:
+ * 
+ *   Column codecs (rows must have sorted columns):
+ *     COLUMN_CODEC_VARINT   gap to the previous column of the row (first:
+ *                           the column itself) as a LEB128 varint, 7 bits
+ *                           per byte: 1 byte for gaps < 128, 2 for < 16384
+ *     COLUMN_CODEC_BLOCK16  16 bits per column, relative to the 65536-column
+ *                           block it falls in; a row crossing blocks keeps a
+ *                           short list of segments (none at <= 65536 columns)
+ * 
+ *   Value precisions (products are always accumulated in double):
+ *     VALUE_PRECISION_DOUBLE  8 bytes, exact
+ *     VALUE_PRECISION_FLOAT   4 bytes, ~7 significant digits
+ *     VALUE_PRECISION_HALF    2 bytes IEEE binary16, ~3 digits, |v| <= 65504
+ * 
+ *   Decoding costs instructions SpMV has to spare while it waits on memory;
+ *   compare bytes/nnz and GFLOP/s against CSR to see where it pays.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SPARSE_COMPRESS_H
+#define SPARSE_COMPRESS_H
+
+#include <stdint.h>
+#include "index_types.h"
+#include "spmv.h"
+
+#define BLOCK16_COLUMNS 65536     // Columns addressed by one 16-bit block offset
+#define VARINT_PADDING 8          // Bytes after the varint stream (8-byte loads at its end)
+
+typedef enum {
+    COLUMN_CODEC_VARINT,
+    COLUMN_CODEC_BLOCK16
+} ColumnCodec;
+
+typedef enum {
+    VALUE_PRECISION_DOUBLE,
+    VALUE_PRECISION_FLOAT,
+    VALUE_PRECISION_HALF
+} ValuePrecision;
+
+typedef struct {
+    index_t end;              // One past the segment's last non-zero
+    index_t base;             // First column of its 65536-column block
+} ColumnSegment;
+
+typedef struct {
+    index_t num_rows;
+    index_t num_cols;
+    index_t nnz;
+    ColumnCodec codec;
+    ValuePrecision precision;
+    index_t *row_ptr;         // Non-zeros of row i: row_ptr[i] .. row_ptr[i+1]-1
+    index_t *col_ptr;         // VARINT: byte offset of row i in col_bytes
+                              // BLOCK16 with segments: first segment of row i
+    uint8_t *col_bytes;       // VARINT: encoded gaps, col_ptr[num_rows] bytes
+    uint16_t *col_low;        // BLOCK16: column - segment base, one per non-zero
+    ColumnSegment *segments;  // BLOCK16 over > BLOCK16_COLUMNS columns, else NULL
+    void *values;             // double / float / uint16_t (binary16 bits)
+} CompressedCSR;
+
+// Encode A (NULL if a row is unsorted, or on overflow / allocation failure)
+CompressedCSR* compressed_csr_from_csr(const CSRMatrix *A, ColumnCodec codec,
+                                       ValuePrecision precision);
+void free_compressed_csr(CompressedCSR *M);
+
+// Bytes of row_ptr + column encoding + values (what one SpMV streams)
+double compressed_csr_bytes(const CompressedCSR *M);
+
+// y = M * x, dynamic row chunks as in spmv_parallel_dynamic
+void spmv_compressed(const CompressedCSR *M, const double *x, double *y);
+
+// IEEE binary16 conversion (round to nearest even, overflow to infinity)
+uint16_t float_to_half(float value);
+float half_to_float(uint16_t bits);
+
+const char *column_codec_name(ColumnCodec codec);
+const char *value_precision_name(ValuePrecision precision);
+int column_codec_parse(const char *text, ColumnCodec *codec);
+int value_precision_parse(const char *text, ValuePrecision *precision);
+
+#endif // SPARSE_COMPRESS_H
@@ -0,0 +1,356 @@
+/*
+ * Kernel Library: Updatable CSR (Delta Buffers) for Dynamic Graphs
+ * 
+ * See sparse_dynamic.h for the layout and the compaction rule.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "sparse_dynamic.h"
+#include "numa_alloc.h"
+#include "rng.h"
+
+// An update that misses the base, with its position in the batch
+typedef struct {
+    index_t row;
+    col_index_t col;
+    double value;
+    int remove;
+    index_t order;
+} PendingUpdate;
+
+static int compare_pending(const void *a, const void *b) {
+    const PendingUpdate *pa = (const PendingUpdate *)a, *pb = (const PendingUpdate *)b;
+    if (pa->row != pb->row) return (pa->row > pb->row) - (pa->row < pb->row);
+    if (pa->col != pb->col) return (pa->col > pb->col) - (pa->col < pb->col);
+    return (pa->order > pb->order) - (pa->order < pb->order);
+}
+
+static inline int key_less(index_t r1, col_index_t c1, index_t r2, col_index_t c2) {
+    return r1 < r2 || (r1 == r2 && c1 < c2);
+}
+
+// Position of (row, col) in the base, or -1
+static index_t base_find(const CSRMatrix *A, index_t row, col_index_t col) {
+    index_t lo = A->row_ptr[row], hi = A->row_ptr[row + 1];
+    while (lo < hi) {
+        index_t mid = lo + (hi - lo) / 2;
+        if (A->col_indices[mid] < col) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < A->row_ptr[row + 1] && A->col_indices[lo] == col) ? lo : -1;
+}
+
+// First delta entry in a row >= row
+static index_t delta_lower_bound(const DynamicCSR *D, index_t row) {
+    index_t lo = 0, hi = D->delta_count;
+    while (lo < hi) {
+        index_t mid = lo + (hi - lo) / 2;
+        if (D->delta_rows[mid] < row) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+DynamicCSR* dynamic_csr_create(const CSRMatrix *A, double compact_ratio) {
+    DynamicCSR *D = (DynamicCSR *)calloc(1, sizeof(DynamicCSR));
+    CSRMatrix *base = csr_alloc_rows(A->num_rows, A->num_cols);
+    size_t slots = (A->nnz > 0) ? (size_t)A->nnz : 1;
+    if (base) {
+        base->nnz = A->nnz;
+        base->values = (double *)malloc_array(slots, sizeof(double));
+        base->col_indices = (col_index_t *)malloc_array(slots, sizeof(col_index_t));
+    }
+    unsigned char *removed = (unsigned char *)calloc(slots, 1);
+    if (!D || !base || !base->values || !base->col_indices || !removed) {
+        free(D);
+        free_csr_matrix(base);
+        free(removed);
+        return NULL;
+    }
+    
+    // Copy row blocks on the threads that will run them (first touch)
+    memcpy(base->row_ptr, A->row_ptr, ((size_t)A->num_rows + 1) * sizeof(index_t));
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        index_t start = A->row_ptr[i], len = A->row_ptr[i + 1] - start;
+        memcpy(base->values + start, A->values + start, len * sizeof(double));
+        memcpy(base->col_indices + start, A->col_indices + start, len * sizeof(col_index_t));
+    }
+    D->base = base;
+    D->removed = removed;
+    D->compact_ratio = (compact_ratio > 0.0) ? compact_ratio : DYNAMIC_COMPACT_RATIO;
+    return D;
+}
+
+void free_dynamic_csr(DynamicCSR *D) {
+    if (!D) return;
+    free_csr_matrix(D->base);
+    free(D->removed);
+    free(D->delta_rows);
+    free(D->delta_cols);
+    free(D->delta_values);
+    free(D);
+}
+
+int dynamic_csr_apply(DynamicCSR *D, const SparseUpdate *updates, index_t count) {
+    CSRMatrix *A = D->base;
+    for (index_t k = 0; k < count; k++) {
+        if (updates[k].row < 0 || updates[k].row >= A->num_rows ||
+            updates[k].col < 0 || updates[k].col >= A->num_cols) {
+            fprintf(stderr, "Update %ld: (%ld, %ld) is outside the %ld x %ld matrix\n", (long)k,
+                    (long)updates[k].row, (long)updates[k].col, (long)A->num_rows,
+                    (long)A->num_cols);
+            return 0;
+        }
+    }
+    if ((int64_t)A->nnz + D->delta_count + count > INDEX_MAX) {
+        fprintf(stderr, "Updated matrix does not fit %s indices\n", INDEX_MODE);
+        return 0;
+    }
+    
+    double start = omp_get_wtime();
+    size_t slots = (count > 0) ? (size_t)count : 1;
+    index_t *position = (index_t *)malloc_array(slots, sizeof(index_t));
+    PendingUpdate *pending = (PendingUpdate *)malloc_array(slots, sizeof(PendingUpdate));
+    if (!position || !pending) {
+        free(position);
+        free(pending);
+        return 0;
+    }
+    
+    // Updates that hit a base entry change it in place; the others are
+    // sorted by (row, col, order) and merged into the delta
+    #pragma omp parallel for schedule(static)
+    for (index_t k = 0; k < count; k++) {
+        position[k] = base_find(A, updates[k].row, updates[k].col);
+    }
+    index_t num_pending = 0;
+    for (index_t k = 0; k < count; k++) {
+        if (position[k] >= 0) continue;
+        PendingUpdate *p = &pending[num_pending++];
+        p->row = updates[k].row;
+        p->col = updates[k].col;
+        p->value = updates[k].value;
+        p->remove = updates[k].remove;
+        p->order = k;
+    }
+    qsort(pending, num_pending, sizeof(PendingUpdate), compare_pending);
+    
+    size_t capacity = ((size_t)D->delta_count + num_pending > 0)
+                    ? (size_t)D->delta_count + num_pending : 1;
+    index_t *rows = (index_t *)malloc_array(capacity, sizeof(index_t));
+    col_index_t *cols = (col_index_t *)malloc_array(capacity, sizeof(col_index_t));
+    double *values = (double *)malloc_array(capacity, sizeof(double));
+    if (!rows || !cols || !values) {
+        free(position);
+        free(pending);
+        free(rows);
+        free(cols);
+        free(values);
+        return 0;
+    }
+    
+    // In batch order, so the last update of an entry wins
+    for (index_t k = 0; k < count; k++) {
+        index_t j = position[k];
+        if (j < 0) continue;
+        D->removed_count += updates[k].remove - D->removed[j];
+        D->removed[j] = (unsigned char)updates[k].remove;
+        A->values[j] = updates[k].remove ? 0.0 : updates[k].value;
+    }
+    
+    // Merge the sorted runs: per entry the last pending update decides
+    index_t d = 0, p = 0, out = 0;
+    while (d < D->delta_count || p < num_pending) {
+        if (p == num_pending || (d < D->delta_count &&
+                                 key_less(D->delta_rows[d], D->delta_cols[d],
+                                          pending[p].row, pending[p].col))) {
+            rows[out] = D->delta_rows[d];
+            cols[out] = D->delta_cols[d];
+            values[out++] = D->delta_values[d++];
+            continue;
+        }
+        index_t last = p;
+        while (last + 1 < num_pending && pending[last + 1].row == pending[p].row &&
+               pending[last + 1].col == pending[p].col) {
+            last++;
+        }
+        if (d < D->delta_count && D->delta_rows[d] == pending[p].row &&
+            D->delta_cols[d] == pending[p].col) {
+            d++;
+        }
+        if (!pending[last].remove) {
+            rows[out] = pending[last].row;
+            cols[out] = pending[last].col;
+            values[out++] = pending[last].value;
+        }
+        p = last + 1;
+    }
+    free(D->delta_rows);
+    free(D->delta_cols);
+    free(D->delta_values);
+    D->delta_rows = rows;
+    D->delta_cols = cols;
+    D->delta_values = values;
+    D->delta_count = out;
+    free(position);
+    free(pending);
+    D->update_seconds += omp_get_wtime() - start;
+    
+    index_t changes = D->delta_count + D->removed_count;
+    if (changes > 0 && changes >= D->compact_ratio * A->nnz) return dynamic_csr_compact(D);
+    return 1;
+}
+
+CSRMatrix* dynamic_csr_snapshot(const DynamicCSR *D) {
+    const CSRMatrix *A = D->base;
+    CSRMatrix *C = csr_alloc_rows(A->num_rows, A->num_cols);
+    if (!C) return NULL;
+    
+    // Row counts, then the merge, over the same blocks of equal base nnz
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t begin = csr_nnz_partition(A, nthreads, tid);
+        index_t end = csr_nnz_partition(A, nthreads, tid + 1);
+        index_t d = delta_lower_bound(D, begin);
+        for (index_t i = begin; i < end; i++) {
+            index_t count = 0;
+            for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) count += !D->removed[j];
+            for (; d < D->delta_count && D->delta_rows[d] == i; d++) count++;
+            C->row_ptr[i + 1] = count;
+        }
+    }
+    C->nnz = csr_counts_to_offsets(C->row_ptr, C->num_rows);
+    size_t slots = (C->nnz > 0) ? (size_t)C->nnz : 1;
+    C->values = (double *)malloc_array(slots, sizeof(double));
+    C->col_indices = (col_index_t *)malloc_array(slots, sizeof(col_index_t));
+    if (!C->values || !C->col_indices) {
+        free_csr_matrix(C);
+        return NULL;
+    }
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t begin = csr_nnz_partition(A, nthreads, tid);
+        index_t end = csr_nnz_partition(A, nthreads, tid + 1);
+        index_t d = delta_lower_bound(D, begin);
+        for (index_t i = begin; i < end; i++) {
+            index_t out = C->row_ptr[i];
+            index_t j = A->row_ptr[i], row_end = A->row_ptr[i + 1];
+            while (j < row_end || (d < D->delta_count && D->delta_rows[d] == i)) {
+                if (j < row_end && D->removed[j]) {
+                    j++;
+                } else if (j < row_end && (d == D->delta_count || D->delta_rows[d] != i ||
+                                           A->col_indices[j] < D->delta_cols[d])) {
+                    C->col_indices[out] = A->col_indices[j];
+                    C->values[out++] = A->values[j++];
+                } else {
+                    C->col_indices[out] = D->delta_cols[d];
+                    C->values[out++] = D->delta_values[d++];
+                }
+            }
+        }
+    }
+    return C;
+}
+
+int dynamic_csr_compact(DynamicCSR *D) {
+    double start = omp_get_wtime();
+    CSRMatrix *C = dynamic_csr_snapshot(D);
+    unsigned char *removed = C ? (unsigned char *)calloc(C->nnz > 0 ? (size_t)C->nnz : 1, 1)
+                               : NULL;
+    if (!removed) {
+        free_csr_matrix(C);
+        return 0;
+    }
+    free_csr_matrix(D->base);
+    free(D->removed);
+    free(D->delta_rows);
+    free(D->delta_cols);
+    free(D->delta_values);
+    D->base = C;
+    D->removed = removed;
+    D->removed_count = 0;
+    D->delta_rows = NULL;
+    D->delta_cols = NULL;
+    D->delta_values = NULL;
+    D->delta_count = 0;
+    D->compactions++;
+    D->compact_seconds += omp_get_wtime() - start;
+    return 1;
+}
+
+void dynamic_csr_spmv(const DynamicCSR *D, const double *x, double *y) {
+    const CSRMatrix *A = D->base;
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t begin = csr_nnz_partition(A, nthreads, tid);
+        index_t end = csr_nnz_partition(A, nthreads, tid + 1);
+        index_t d = delta_lower_bound(D, begin);
+        for (index_t i = begin; i < end; i++) {
+            double sum = 0.0;
+            for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                sum += A->values[j] * x[A->col_indices[j]];
+            }
+            for (; d < D->delta_count && D->delta_rows[d] == i; d++) {
+                sum += D->delta_values[d] * x[D->delta_cols[d]];
+            }
+            y[i] = sum;
+        }
+    }
+}
+
+index_t dynamic_csr_nnz(const DynamicCSR *D) {
+    return D->base->nnz - D->removed_count + D->delta_count;
+}
+
+double dynamic_csr_bytes(const DynamicCSR *D) {
+    return csr_matrix_bytes(D->base)
+         + (double)D->delta_count * (sizeof(index_t) + sizeof(col_index_t) + sizeof(double));
+}
+
+// Row holding entry j of A
+static index_t row_of_entry(const CSRMatrix *A, index_t j) {
+    index_t lo = 0, hi = A->num_rows - 1;
+    while (lo < hi) {
+        index_t mid = lo + (hi - lo + 1) / 2;
+        if (A->row_ptr[mid] <= j) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+void dynamic_random_updates(const CSRMatrix *A, index_t count, double delete_share,
+                            uint64_t seed, uint64_t batch, SparseUpdate *updates) {
+    #pragma omp parallel for schedule(static)
+    for (index_t k = 0; k < count; k++) {
+        uint64_t draw = 4 * (uint64_t)k;
+        double u = rng_unit(rng_bits(seed, batch, draw));
+        SparseUpdate *update = &updates[k];
+        if (u < delete_share && A->nnz > 0) {
+            index_t j = (index_t)(rng_bits(seed, batch, draw + 1) % (uint64_t)A->nnz);
+            update->row = row_of_entry(A, j);
+            update->col = A->col_indices[j];
+            update->value = 0.0;
+            update->remove = 1;
+        } else {
+            update->row = (index_t)(rng_bits(seed, batch, draw + 1) % (uint64_t)A->num_rows);
+            update->col = (col_index_t)(rng_bits(seed, batch, draw + 2) % (uint64_t)A->num_cols);
+            update->value = rng_unit(rng_bits(seed, batch, draw + 3)) * 10.0;
+            update->remove = 0;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * Kernel Library: Updatable CSR (Delta Buffers) for Dynamic Graphs
+ * 
+ * Description:
+ *   CSRMatrix is immutable: one inserted edge shifts every later entry.
+ *   A DynamicCSR keeps a CSR base and absorbs small batches of changes
+ *   next to it:
+ * 
+ *     update of an existing entry   its value is overwritten in place;
+ *     delete of a base entry        flagged and its value zeroed, so the
+ *                                   SpMV needs no test;
+ *     insert of a new entry         goes to the delta, a COO buffer kept
+ *                                   sorted by (row, col), i.e. grouped into
+ *                                   per-row runs.
+ * 
+ *   dynamic_csr_spmv reads both: every thread takes a block of base rows
+ *   with equal non-zeros and finds the delta run of its first row by
+ *   binary search, then streams base rows and delta runs side by side.
+ * 
+ *   Once the pending changes (delta entries + deleted base entries) reach
+ *   compact_ratio * nnz, the update call compacts: per-row counts, a
+ *   parallel scan, and a parallel merge of every base row with its delta
+ *   run into a fresh CSR, which replaces the base. Between compactions a
+ *   batch costs O(batch log batch + delta) instead of a full rebuild.
+ * 
+ *   Rows of the base must be sorted by column (every CSR constructor of
+ *   this library produces them so). Rows with a delta run are summed in a
+ *   different order than after compaction.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SPARSE_DYNAMIC_H
+#define SPARSE_DYNAMIC_H
+
+#include <stdint.h>
+#include "index_types.h"
+#include "spmv.h"
+
+#define DYNAMIC_COMPACT_RATIO 0.05   // Compact at 5% pending changes (default)
+
+typedef struct {
+    index_t row;
+    col_index_t col;
+    double value;             // Ignored by deletes
+    int remove;               // 1: delete (row, col) if present, 0: insert or overwrite
+} SparseUpdate;
+
+typedef struct {
+    CSRMatrix *base;          // Sorted rows; deleted entries hold 0.0
+    unsigned char *removed;   // Per base entry: deleted since the last compaction
+    index_t removed_count;
+    
+    // Entries not in the base, sorted by (row, col)
+    index_t *delta_rows;
+    col_index_t *delta_cols;
+    double *delta_values;
+    index_t delta_count;
+    
+    double compact_ratio;
+    long compactions;
+    double compact_seconds;   // Totals since creation
+    double update_seconds;    // Applying batches, compactions excluded
+} DynamicCSR;
+
+// Copy of A as the base; compact_ratio <= 0 selects DYNAMIC_COMPACT_RATIO,
+// INFINITY leaves compaction to dynamic_csr_compact. NULL on failure.
+DynamicCSR* dynamic_csr_create(const CSRMatrix *A, double compact_ratio);
+void free_dynamic_csr(DynamicCSR *D);
+
+// Applies the updates in order (later ones win on the same entry) and
+// compacts at the threshold. Returns 0, leaving D unchanged, if an update
+// is out of range or the result could outgrow this build's index types;
+// also 0 if an allocation fails (D stays usable).
+int dynamic_csr_apply(DynamicCSR *D, const SparseUpdate *updates, index_t count);
+
+// Merge the delta and drop deleted entries now (1 on success)
+int dynamic_csr_compact(DynamicCSR *D);
+
+// y = D * x, in parallel
+void dynamic_csr_spmv(const DynamicCSR *D, const double *x, double *y);
+
+// Current matrix as a new CSR (D is not modified); NULL on failure
+CSRMatrix* dynamic_csr_snapshot(const DynamicCSR *D);
+
+index_t dynamic_csr_nnz(const DynamicCSR *D);        // Stored entries
+double dynamic_csr_bytes(const DynamicCSR *D);       // Bytes dynamic_csr_spmv streams
+
+// count updates against the entries of A: a share delete_share deletes
+// random existing entries, the rest insert random (row, col) pairs with
+// values in [0, 10). Deterministic in (seed, batch).
+void dynamic_random_updates(const CSRMatrix *A, index_t count, double delete_share,
+                            uint64_t seed, uint64_t batch, SparseUpdate *updates);
+
+#endif // SPARSE_DYNAMIC_H
@@ -0,0 +1,368 @@
+/*
+ * Kernel Library: Sliced ELLPACK Formats (SELL-C-sigma and ELL)
+ * 
+ * See sparse_formats.h for the layout.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <omp.h>
+#include "sparse_formats.h"
+#include "vector_ops.h"
+#include "numa_alloc.h"
+#include "trace.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+#if defined(INDEX64) && !defined(COL_INDEX32)
+#define SELL_WIDE_COLS 1          // 64-bit column indices: 64-bit gathers
+#endif
+
+#define SELL_BLOCKS_PER_CHUNK 16  // Dynamic scheduling unit of sell_spmv, in 8-row blocks
+
+typedef struct {
+    index_t len;
+    index_t row;
+} RowKey;
+
+// Longest row first; equal lengths keep their original order
+static int compare_row_keys(const void *a, const void *b) {
+    const RowKey *ka = (const RowKey *)a, *kb = (const RowKey *)b;
+    if (ka->len != kb->len) return (ka->len < kb->len) ? 1 : -1;
+    return (ka->row > kb->row) - (ka->row < kb->row);
+}
+
+static inline index_t row_length(const CSRMatrix *A, index_t row) {
+    return A->row_ptr[row + 1] - A->row_ptr[row];
+}
+
+/*
+ * Slice layout shared by conversion and the fill-ratio estimate: rows are
+ * sorted by length inside windows of sigma rows (rounded up to whole
+ * slices, so no slice straddles two windows), then cut into slices of
+ * `chunk` rows. Returns the stored slot count; fills slice widths
+ * (slice_ptr[s + 1] = chunk * width, as counts for csr_counts_to_offsets)
+ * and the row permutation when those arrays are given.
+ */
+static int64_t sell_plan(const CSRMatrix *A, index_t chunk, index_t sigma, index_t num_slices,
+                         index_t *slice_ptr, index_t *row_perm) {
+    int64_t padded_rows = (int64_t)num_slices * chunk;
+    int64_t window = (sigma <= 1) ? chunk : (sigma + chunk - 1) / chunk * chunk;
+    int64_t num_windows = (padded_rows + window - 1) / window;
+    int64_t total = 0;
+    int failed = 0;
+    
+    #pragma omp parallel reduction(|:failed)
+    {
+        RowKey *keys = (RowKey *)malloc_array((size_t)window, sizeof(RowKey));
+        if (!keys) failed = 1;
+        
+        #pragma omp for schedule(dynamic) reduction(+:total)
+        for (int64_t w = 0; w < num_windows; w++) {
+            if (!keys) continue;
+            int64_t first = w * window;
+            int64_t rows = (first + window < A->num_rows) ? window : A->num_rows - first;
+            if (rows < 0) rows = 0;
+            for (int64_t r = 0; r < rows; r++) {
+                keys[r].row = (index_t)(first + r);
+                keys[r].len = row_length(A, (index_t)(first + r));
+            }
+            if (sigma > 1) qsort(keys, rows, sizeof(RowKey), compare_row_keys);
+            
+            int64_t window_end = (first + window < padded_rows) ? first + window : padded_rows;
+            for (int64_t s0 = first; s0 < window_end; s0 += chunk) {
+                index_t width = 0;
+                for (int64_t r = s0; r < s0 + chunk; r++) {
+                    int64_t k = r - first;
+                    if (k < rows && keys[k].len > width) width = keys[k].len;
+                    if (row_perm) row_perm[r] = (k < rows) ? keys[k].row : -1;
+                }
+                if (slice_ptr) slice_ptr[s0 / chunk + 1] = chunk * width;
+                total += (int64_t)chunk * width;
+            }
+        }
+        free(keys);
+    }
+    return failed ? -1 : total;
+}
+
+static index_t sell_num_slices(const CSRMatrix *A, index_t chunk) {
+    return (index_t)(((int64_t)A->num_rows + chunk - 1) / chunk);
+}
+
+double sell_fill_ratio(const CSRMatrix *A, index_t chunk, index_t sigma) {
+    if (chunk <= 0 || A->nnz == 0) return 1.0;
+    int64_t stored = sell_plan(A, chunk, sigma, sell_num_slices(A, chunk), NULL, NULL);
+    return (stored < 0) ? INFINITY : (double)stored / A->nnz;
+}
+
+double ell_fill_ratio(const CSRMatrix *A) {
+    RowLengthStats stats;
+    row_length_stats(A, &stats);
+    double padded_rows = ceil(A->num_rows / (double)SELL_LANES) * SELL_LANES;
+    return (A->nnz > 0) ? padded_rows * stats.max / A->nnz : 1.0;
+}
+
+// Convert CSR to SELL-chunk-sigma
+SellMatrix* sell_from_csr(const CSRMatrix *A, index_t chunk, index_t sigma) {
+    if (chunk <= 0 || chunk % SELL_LANES != 0) {
+        fprintf(stderr, "SELL chunk %ld is not a multiple of %d\n", (long)chunk, SELL_LANES);
+        return NULL;
+    }
+    SellMatrix *S = (SellMatrix *)calloc(1, sizeof(SellMatrix));
+    if (!S) return NULL;
+    S->num_rows = A->num_rows;
+    S->num_cols = A->num_cols;
+    S->nnz = A->nnz;
+    S->chunk = chunk;
+    S->sigma = (sigma < 1) ? 1 : sigma;
+    S->num_slices = sell_num_slices(A, chunk);
+    S->slice_ptr = (index_t *)malloc_array((size_t)S->num_slices + 1, sizeof(index_t));
+    S->row_perm = (index_t *)malloc_array((size_t)S->num_slices * chunk + 1, sizeof(index_t));
+    if (!S->slice_ptr || !S->row_perm) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_sell_matrix(S);
+        return NULL;
+    }
+    
+    S->slice_ptr[0] = 0;
+    int64_t stored = sell_plan(A, chunk, S->sigma, S->num_slices, S->slice_ptr, S->row_perm);
+    if (stored < 0 || !index_count_fits((double)stored)) {
+        fprintf(stderr, "SELL-%ld-%ld: %lld stored slots exceed the %s index type\n",
+                (long)chunk, (long)S->sigma, (long long)stored, INDEX_MODE);
+        free_sell_matrix(S);
+        return NULL;
+    }
+    S->stored = csr_counts_to_offsets(S->slice_ptr, S->num_slices);
+    S->values = (double *)malloc_array((size_t)S->stored + 1, sizeof(double));
+    S->col_indices = (col_index_t *)malloc_array((size_t)S->stored + 1, sizeof(col_index_t));
+    if (!S->values || !S->col_indices) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_sell_matrix(S);
+        return NULL;
+    }
+    
+    // Fill in 8-row blocks, the unit of sell_spmv: a block's step j is one
+    // 64-byte line of values, so threads never share a written line
+    index_t blocks_per_slice = chunk / SELL_LANES;
+    int64_t num_blocks = (int64_t)S->num_slices * blocks_per_slice;
+    #pragma omp parallel for schedule(dynamic, SELL_BLOCKS_PER_CHUNK)
+    for (int64_t b = 0; b < num_blocks; b++) {
+        index_t s = (index_t)(b / blocks_per_slice);
+        index_t base = S->slice_ptr[s] + (index_t)(b % blocks_per_slice) * SELL_LANES;
+        index_t width = (S->slice_ptr[s + 1] - S->slice_ptr[s]) / chunk;
+        for (int l = 0; l < SELL_LANES; l++) {
+            index_t row = S->row_perm[b * SELL_LANES + l];
+            index_t start = (row >= 0) ? A->row_ptr[row] : 0;
+            index_t len = (row >= 0) ? row_length(A, row) : 0;
+            for (index_t j = 0; j < width; j++) {
+                index_t slot = base + j * chunk + l;
+                S->values[slot] = (j < len) ? A->values[start + j] : 0.0;
+                S->col_indices[slot] = (j < len) ? A->col_indices[start + j] : 0;
+            }
+        }
+    }
+    return S;
+}
+
+// ELL: one slice holding every row (rounded up to whole SIMD blocks)
+SellMatrix* ell_from_csr(const CSRMatrix *A) {
+    index_t chunk = (A->num_rows + SELL_LANES - 1) / SELL_LANES * SELL_LANES;
+    return sell_from_csr(A, (chunk > 0) ? chunk : SELL_LANES, 1);
+}
+
+void free_sell_matrix(SellMatrix *S) {
+    if (!S) return;
+    free(S->slice_ptr);
+    free(S->row_perm);
+    free(S->values);
+    free(S->col_indices);
+    free(S);
+}
+
+double sell_matrix_bytes(const SellMatrix *S) {
+    return S->stored * (double)(sizeof(double) + sizeof(col_index_t)) +
+           (S->num_slices + 1.0) * sizeof(index_t) +
+           (double)S->num_slices * S->chunk * sizeof(index_t);
+}
+
+/*
+ * One block of SELL_LANES rows: step j loads the rows' j-th values and
+ * column indices (contiguous, `stride` apart between steps) and gathers
+ * x. Multiply and add stay separate so every row sums exactly like
+ * spmv_sequential.
+ */
+static void sell_block_scalar(const double *values, const col_index_t *cols, index_t width,
+                              index_t stride, const double *x, double *acc) {
+    for (int l = 0; l < SELL_LANES; l++) acc[l] = 0.0;
+    for (index_t j = 0; j < width; j++) {
+        const double *v = values + (size_t)j * stride;
+        const col_index_t *c = cols + (size_t)j * stride;
+        #pragma omp simd
+        for (int l = 0; l < SELL_LANES; l++) acc[l] += v[l] * x[c[l]];
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("avx512f")))
+static void sell_block_avx512(const double *values, const col_index_t *cols, index_t width,
+                              index_t stride, const double *x, double *acc) {
+    __m512d sum = _mm512_setzero_pd();
+    for (index_t j = 0; j < width; j++) {
+        const double *v = values + (size_t)j * stride;
+        const col_index_t *c = cols + (size_t)j * stride;
+#ifdef SELL_WIDE_COLS
+        __m512d xv = _mm512_i64gather_pd(_mm512_loadu_si512((const void *)c), x, 8);
+#else
+        __m512d xv = _mm512_i32gather_pd(_mm256_loadu_si256((const __m256i *)c), x, 8);
+#endif
+        sum = _mm512_add_pd(sum, _mm512_mul_pd(_mm512_loadu_pd(v), xv));
+    }
+    _mm512_storeu_pd(acc, sum);
+}
+
+__attribute__((target("avx2")))
+static void sell_block_avx2(const double *values, const col_index_t *cols, index_t width,
+                            index_t stride, const double *x, double *acc) {
+    __m256d lo = _mm256_setzero_pd(), hi = _mm256_setzero_pd();
+    for (index_t j = 0; j < width; j++) {
+        const double *v = values + (size_t)j * stride;
+        const col_index_t *c = cols + (size_t)j * stride;
+#ifdef SELL_WIDE_COLS
+        __m256d x_lo = _mm256_i64gather_pd(x, _mm256_loadu_si256((const __m256i *)c), 8);
+        __m256d x_hi = _mm256_i64gather_pd(x, _mm256_loadu_si256((const __m256i *)(c + 4)), 8);
+#else
+        __m256d x_lo = _mm256_i32gather_pd(x, _mm_loadu_si128((const __m128i *)c), 8);
+        __m256d x_hi = _mm256_i32gather_pd(x, _mm_loadu_si128((const __m128i *)(c + 4)), 8);
+#endif
+        lo = _mm256_add_pd(lo, _mm256_mul_pd(_mm256_loadu_pd(v), x_lo));
+        hi = _mm256_add_pd(hi, _mm256_mul_pd(_mm256_loadu_pd(v + 4), x_hi));
+    }
+    _mm256_storeu_pd(acc, lo);
+    _mm256_storeu_pd(acc + 4, hi);
+}
+#endif
+
+// SELL / ELL SpMV, one 8-row block per step
+void sell_spmv(const SellMatrix *S, const double *x, double *y) {
+    SimdIsa isa = vector_simd_isa();
+    index_t blocks_per_slice = S->chunk / SELL_LANES;
+    int64_t num_blocks = (int64_t)S->num_slices * blocks_per_slice;
+    
+    /*
+     * Slices of a sorted window shrink in width, so blocks differ in cost:
+     * dynamic scheduling over groups of blocks. Each block writes its own
+     * rows of y through row_perm - no two blocks share a row.
+     */
+    #pragma omp parallel for schedule(dynamic, SELL_BLOCKS_PER_CHUNK)
+    for (int64_t b = 0; b < num_blocks; b++) {
+        index_t s = (index_t)(b / blocks_per_slice);
+        index_t r0 = (index_t)(b % blocks_per_slice) * SELL_LANES;
+        index_t base = S->slice_ptr[s] + r0;
+        index_t width = (S->slice_ptr[s + 1] - S->slice_ptr[s]) / S->chunk;
+        double acc[SELL_LANES];
+        
+        switch (isa) {
+#ifdef HAVE_X86_SIMD
+        case SIMD_ISA_AVX512:
+            sell_block_avx512(S->values + base, S->col_indices + base, width, S->chunk, x, acc);
+            break;
+        case SIMD_ISA_AVX2:
+            sell_block_avx2(S->values + base, S->col_indices + base, width, S->chunk, x, acc);
+            break;
+#endif
+        default:
+            sell_block_scalar(S->values + base, S->col_indices + base, width, S->chunk, x, acc);
+            break;
+        }
+        
+        const index_t *perm = S->row_perm + b * SELL_LANES;
+        for (int l = 0; l < SELL_LANES; l++) {
+            if (perm[l] >= 0) y[perm[l]] = acc[l];
+        }
+    }
+}
+
+/*
+ * Gini coefficient of the row lengths from their histogram: with lengths
+ * sorted ascending (x_1..x_n), G = 2 * sum(i * x_i) / (n * sum(x)) - (n+1)/n.
+ * The histogram has max + 1 bins and is filled in one pass over row_ptr.
+ */
+static double row_length_gini(const CSRMatrix *A, index_t max_len) {
+    if (A->num_rows == 0 || A->nnz == 0) return 0.0;
+    index_t *count = (index_t *)calloc((size_t)max_len + 1, sizeof(index_t));
+    if (!count) return NAN;
+    for (index_t i = 0; i < A->num_rows; i++) count[row_length(A, i)]++;
+    double n = (double)A->num_rows, rank = 0.0, weighted = 0.0;
+    for (index_t len = 0; len <= max_len; len++) {
+        double c = (double)count[len];
+        weighted += (double)len * (c * rank + c * (c + 1.0) / 2.0);
+        rank += c;
+    }
+    free(count);
+    return 2.0 * weighted / (n * (double)A->nnz) - (n + 1.0) / n;
+}
+
+// Min / max / mean / variance / Gini of the row lengths
+void row_length_stats(const CSRMatrix *A, RowLengthStats *stats) {
+    index_t min_len = INDEX_MAX, max_len = 0, empty = 0;
+    double sum = 0.0, sum_sq = 0.0;
+    
+    #pragma omp parallel for schedule(static) reduction(min:min_len) reduction(max:max_len) \
+                                              reduction(+:sum, sum_sq, empty)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        index_t len = row_length(A, i);
+        if (len < min_len) min_len = len;
+        if (len > max_len) max_len = len;
+        if (len == 0) empty++;
+        sum += len;
+        sum_sq += (double)len * len;
+    }
+    
+    double n = (A->num_rows > 0) ? (double)A->num_rows : 1.0;
+    stats->min = (A->num_rows > 0) ? min_len : 0;
+    stats->max = max_len;
+    stats->mean = sum / n;
+    stats->variance = sum_sq / n - stats->mean * stats->mean;
+    if (stats->variance < 0.0) stats->variance = 0.0;
+    stats->cv = (stats->mean > 0.0) ? sqrt(stats->variance) / stats->mean : 0.0;
+    stats->gini = row_length_gini(A, max_len);
+    stats->empty = empty;
+}
+
+/*
+ * Uniform rows (small coefficient of variation) pad little in ELL, which
+ * needs no permutation; otherwise SELL-C-sigma while sorting inside sigma
+ * windows keeps padding bounded; CSR when even that wastes too much.
+ */
+SparseFormat sparse_format_choose(const RowLengthStats *stats, index_t nnz, double ell_fill,
+                                  double sell_fill) {
+    if (nnz == 0) return SPARSE_FORMAT_CSR;
+    if (stats->cv <= FORMAT_ELL_MAX_CV && ell_fill <= FORMAT_ELL_MAX_FILL) return SPARSE_FORMAT_ELL;
+    if (sell_fill <= FORMAT_SELL_MAX_FILL) return SPARSE_FORMAT_SELL;
+    return SPARSE_FORMAT_CSR;
+}
+
+SparseFormat sparse_format_select(const CSRMatrix *A) {
+    if (A->nnz == 0) return SPARSE_FORMAT_CSR;
+    RowLengthStats stats;
+    row_length_stats(A, &stats);
+    return sparse_format_choose(&stats, A->nnz, ell_fill_ratio(A),
+                                sell_fill_ratio(A, SELL_DEFAULT_CHUNK, SELL_DEFAULT_SIGMA));
+}
+
+const char *sparse_format_name(SparseFormat format) {
+    switch (format) {
+    case SPARSE_FORMAT_ELL:  return "ell";
+    case SPARSE_FORMAT_SELL: return "sell";
+    default:                 return "csr";
+    }
+}
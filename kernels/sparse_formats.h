@@ -0,0 +1,95 @@
+/*
+ * Kernel Library: Sliced ELLPACK Formats (SELL-C-sigma and ELL)
+ * 
+ * Description:
+ *   CSR's inner loop walks one row at a time, so SIMD lanes can only split
+ *   a row (short rows waste them). Sliced ELLPACK stores C rows side by
+ *   side, column-major within a slice of C rows, padded to the slice's
+ *   longest row: one SIMD lane per row, a contiguous load of values and
+ *   column indices per step and a gather from x.
+ * 
+ *     SELL-C-sigma  rows are sorted by length (descending) inside windows of
+ *                   sigma rows before slicing, so rows of a slice have
+ *                   similar lengths and padding stays small
+ *     ELL           one slice of all rows, padded to the longest row
+ *                   (SELL-C-1 with C = rows): no permutation, but padding
+ *                   explodes when row lengths vary
+ * 
+ *   sell_spmv uses AVX-512 or AVX2 gathers (run-time selected, VECTOR_ISA
+ *   narrows it, see vector_ops.h) with 8 rows per block, and a scalar
+ *   fallback. sparse_format_select picks CSR, ELL or SELL from the
+ *   row-length variance and the padding it would cost.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SPARSE_FORMATS_H
+#define SPARSE_FORMATS_H
+
+#include "index_types.h"
+#include "spmv.h"
+
+#define SELL_LANES 8              // Rows per SIMD block (one AVX-512 register of doubles)
+#define SELL_DEFAULT_CHUNK 8      // C: rows per slice, a multiple of SELL_LANES
+#define SELL_DEFAULT_SIGMA 512    // sigma: sorting window in rows
+
+// Auto-selection thresholds (coefficient of variation of row lengths)
+#define FORMAT_ELL_MAX_CV 0.1     // ELL only for near-uniform rows...
+#define FORMAT_ELL_MAX_FILL 1.25  // ...and at most 25% padding
+#define FORMAT_SELL_MAX_FILL 1.5  // SELL while sorting keeps padding below 50%
+
+typedef enum {
+    SPARSE_FORMAT_CSR,
+    SPARSE_FORMAT_ELL,
+    SPARSE_FORMAT_SELL
+} SparseFormat;
+
+typedef struct {
+    index_t num_rows;
+    index_t num_cols;
+    index_t nnz;              // Real non-zeros
+    index_t stored;           // Stored slots including padding
+    index_t chunk;            // C (ELL: all rows rounded up to SELL_LANES)
+    index_t sigma;            // Sorting window (1 = rows in original order)
+    index_t num_slices;
+    index_t *slice_ptr;       // Offset of slice s in values / col_indices
+    index_t *row_perm;        // Slice row position -> original row, -1 = padding row
+    double *values;           // Slice s, row r, step j at slice_ptr[s] + j * chunk + r
+    col_index_t *col_indices; // Padding slots: value 0, column 0
+} SellMatrix;
+
+typedef struct {
+    index_t min;
+    index_t max;
+    double mean;
+    double variance;
+    double cv;                // stddev / mean
+    double gini;              // 0: equal rows, towards 1: non-zeros in a few rows
+    index_t empty;            // Rows without non-zeros
+} RowLengthStats;
+
+// Conversion (NULL if chunk is not a multiple of SELL_LANES, or on overflow)
+SellMatrix* sell_from_csr(const CSRMatrix *A, index_t chunk, index_t sigma);
+SellMatrix* ell_from_csr(const CSRMatrix *A);
+void free_sell_matrix(SellMatrix *S);
+
+// Stored slots / nnz that sell_from_csr would produce, without building it
+double sell_fill_ratio(const CSRMatrix *A, index_t chunk, index_t sigma);
+double ell_fill_ratio(const CSRMatrix *A);
+
+// Bytes of values + col_indices + slice_ptr + row_perm
+double sell_matrix_bytes(const SellMatrix *S);
+
+// y = S * x (original row order)
+void sell_spmv(const SellMatrix *S, const double *x, double *y);
+
+// Row-length statistics and the format they favor; sparse_format_choose
+// decides from precomputed statistics and fill ratios
+void row_length_stats(const CSRMatrix *A, RowLengthStats *stats);
+SparseFormat sparse_format_select(const CSRMatrix *A);
+SparseFormat sparse_format_choose(const RowLengthStats *stats, index_t nnz, double ell_fill,
+                                  double sell_fill);
+const char *sparse_format_name(SparseFormat format);
+
+#endif // SPARSE_FORMATS_H
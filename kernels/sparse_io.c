@@ -0,0 +1,472 @@
+/*
+ * Kernel Library: Sparse Matrix Files (Matrix Market and Binary CSR)
+ * 
+ * See sparse_io.h for the formats.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <omp.h>
+#include "sparse_io.h"
+#include "numa_alloc.h"
+
+#define CSR_BINARY_ALIGN 64
+
+// Whole file into a NUL-terminated buffer, every thread reading one slice
+static char *read_file_parallel(const char *path, size_t *size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+    char *buffer = (char *)malloc(*size + 1);
+    if (!buffer) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        close(fd);
+        return NULL;
+    }
+    
+    int failed = 0;
+    #pragma omp parallel reduction(|:failed)
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        size_t begin = *size / nthreads * tid;
+        size_t end = (tid == nthreads - 1) ? *size : *size / nthreads * (tid + 1);
+        while (begin < end) {
+            ssize_t got = pread(fd, buffer + begin, end - begin, (off_t)begin);
+            if (got <= 0) {
+                failed = 1;
+                break;
+            }
+            begin += (size_t)got;
+        }
+    }
+    close(fd);
+    if (failed) {
+        fprintf(stderr, "%s: read error\n", path);
+        free(buffer);
+        return NULL;
+    }
+    buffer[*size] = '\0';
+    return buffer;
+}
+
+static const char *next_line(const char *p, const char *end) {
+    while (p < end && *p != '\n') p++;
+    return (p < end) ? p + 1 : end;
+}
+
+// Start of the first line at or after `p` (p itself if it starts a line)
+static const char *line_start_at(const char *p, const char *begin, const char *end) {
+    if (p <= begin || p[-1] == '\n') return p;
+    return next_line(p, end);
+}
+
+// Is this line an entry (not blank, not a comment)?
+static int is_entry_line(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p < end && *p != '\n' && *p != '%';
+}
+
+// Read a Matrix Market coordinate file in parallel
+CSRMatrix* csr_read_matrix_market(const char *path) {
+    size_t size;
+    char *text = read_file_parallel(path, &size);
+    if (!text) return NULL;
+    const char *end = text + size;
+    
+    // Banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+    char object[32], format[32], field[32], symmetry[32];
+    if (sscanf(text, "%%%%MatrixMarket %31s %31s %31s %31s", object, format, field, symmetry) != 4 ||
+        strcasecmp(object, "matrix") != 0 || strcasecmp(format, "coordinate") != 0) {
+        fprintf(stderr, "%s: not a Matrix Market coordinate file\n", path);
+        free(text);
+        return NULL;
+    }
+    int pattern = (strcasecmp(field, "pattern") == 0);
+    int symmetric = (strcasecmp(symmetry, "symmetric") == 0);
+    int skew = (strcasecmp(symmetry, "skew-symmetric") == 0);
+    if ((!pattern && strcasecmp(field, "real") != 0 && strcasecmp(field, "integer") != 0) ||
+        (!symmetric && !skew && strcasecmp(symmetry, "general") != 0)) {
+        fprintf(stderr, "%s: unsupported Matrix Market type '%s %s'\n", path, field, symmetry);
+        free(text);
+        return NULL;
+    }
+    
+    // Size line: first non-comment line after the banner
+    const char *p = next_line(text, end);
+    while (p < end && !is_entry_line(p, end)) p = next_line(p, end);
+    long long rows, cols, declared;
+    if (sscanf(p, "%lld %lld %lld", &rows, &cols, &declared) != 3 || rows < 0 || cols < 0) {
+        fprintf(stderr, "%s: missing or invalid size line\n", path);
+        free(text);
+        return NULL;
+    }
+    const char *data = next_line(p, end);
+    double max_stored = (symmetric || skew) ? 2.0 * declared : (double)declared;
+    if (!index_count_fits((double)rows) || !index_count_fits(max_stored) ||
+        (double)cols > (double)COL_INDEX_MAX) {
+        fprintf(stderr, "%s: %lld x %lld with %lld entries exceeds the %s index types; "
+                "rebuild with `make INDEX64=1`\n", path, rows, cols, declared, INDEX_MODE);
+        free(text);
+        return NULL;
+    }
+    
+    /*
+     * Pass 1: every thread counts the entries in its byte range (a range
+     * owns the lines that START inside it) and how many it will store
+     * (symmetric off-diagonal entries are stored twice).
+     * Pass 2: offsets from a scan over threads, then every thread parses
+     * its lines straight into its slice of the COO arrays.
+     */
+    int max_threads = omp_get_max_threads();
+    int64_t *thread_lines = (int64_t *)calloc(max_threads + 1, sizeof(int64_t));
+    int64_t *thread_stored = (int64_t *)calloc(max_threads + 1, sizeof(int64_t));
+    if (!thread_lines || !thread_stored) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(thread_lines);
+        free(thread_stored);
+        free(text);
+        return NULL;
+    }
+    index_t *coo_row = NULL;
+    col_index_t *coo_col = NULL;
+    double *coo_val = NULL;
+    int64_t total_lines = 0, total_stored = 0;
+    int bad_entry = 0;
+    
+    #pragma omp parallel reduction(|:bad_entry)
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        size_t span = (size_t)(end - data);
+        const char *begin = line_start_at(data + span / nthreads * tid, data, end);
+        const char *stop = (tid == nthreads - 1) ? end :
+                           line_start_at(data + span / nthreads * (tid + 1), data, end);
+        
+        int64_t lines = 0, stored = 0;
+        for (const char *q = begin; q < stop; q = next_line(q, end)) {
+            if (!is_entry_line(q, end)) continue;
+            char *after;
+            long long r = strtoll(q, &after, 10);
+            long long c = strtoll(after, &after, 10);
+            lines++;
+            stored += ((symmetric || skew) && r != c) ? 2 : 1;
+        }
+        thread_lines[tid + 1] = lines;
+        thread_stored[tid + 1] = stored;
+        
+        #pragma omp barrier
+        #pragma omp single
+        {
+            for (int t = 0; t < nthreads; t++) {
+                thread_lines[t + 1] += thread_lines[t];
+                thread_stored[t + 1] += thread_stored[t];
+            }
+            total_lines = thread_lines[nthreads];
+            total_stored = thread_stored[nthreads];
+            coo_row = (index_t *)malloc_array((size_t)total_stored + 1, sizeof(index_t));
+            coo_col = (col_index_t *)malloc_array((size_t)total_stored + 1, sizeof(col_index_t));
+            coo_val = (double *)malloc_array((size_t)total_stored + 1, sizeof(double));
+        }
+        
+        if (coo_row && coo_col && coo_val) {
+            int64_t k = thread_stored[tid];
+            for (const char *q = begin; q < stop; q = next_line(q, end)) {
+                if (!is_entry_line(q, end)) continue;
+                char *after;
+                long long r = strtoll(q, &after, 10);
+                long long c = strtoll(after, &after, 10);
+                double v = pattern ? 1.0 : strtod(after, &after);
+                if (r < 1 || r > rows || c < 1 || c > cols) {
+                    bad_entry = 1;
+                    break;
+                }
+                coo_row[k] = (index_t)(r - 1);
+                coo_col[k] = (col_index_t)(c - 1);
+                coo_val[k] = v;
+                k++;
+                if ((symmetric || skew) && r != c) {
+                    coo_row[k] = (index_t)(c - 1);
+                    coo_col[k] = (col_index_t)(r - 1);
+                    coo_val[k] = skew ? -v : v;
+                    k++;
+                }
+            }
+        }
+    }
+    free(thread_lines);
+    free(thread_stored);
+    free(text);
+    
+    CSRMatrix *matrix = NULL;
+    if (!coo_row || !coo_col || !coo_val) {
+        fprintf(stderr, "Memory allocation failed!\n");
+    } else if (bad_entry || total_lines != declared) {
+        fprintf(stderr, "%s: %s (%lld entries declared, %lld found)\n", path,
+                bad_entry ? "entry outside the matrix" : "entry count mismatch",
+                declared, (long long)total_lines);
+    } else {
+        matrix = csr_alloc_rows((index_t)rows, (index_t)cols);
+    }
+    if (!matrix) {
+        free(coo_row);
+        free(coo_col);
+        free(coo_val);
+        return NULL;
+    }
+    
+    // COO -> CSR: row counts, offsets, scatter, then sort each row by column
+    index_t nnz = (index_t)total_stored;
+    index_t *next = (index_t *)malloc_array((size_t)rows + 1, sizeof(index_t));
+    matrix->col_indices = (col_index_t *)malloc_array((size_t)nnz + 1, sizeof(col_index_t));
+    matrix->values = (double *)malloc_array((size_t)nnz + 1, sizeof(double));
+    if (!next || !matrix->col_indices || !matrix->values) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free(next);
+        free(coo_row);
+        free(coo_col);
+        free(coo_val);
+        free_csr_matrix(matrix);
+        return NULL;
+    }
+    
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 1; i <= (index_t)rows; i++) matrix->row_ptr[i] = 0;
+    #pragma omp parallel for schedule(static)
+    for (index_t k = 0; k < nnz; k++) {
+        #pragma omp atomic
+        matrix->row_ptr[coo_row[k] + 1]++;
+    }
+    matrix->nnz = csr_counts_to_offsets(matrix->row_ptr, (index_t)rows);
+    memcpy(next, matrix->row_ptr, ((size_t)rows + 1) * sizeof(index_t));
+    
+    #pragma omp parallel for schedule(static)
+    for (index_t k = 0; k < nnz; k++) {
+        index_t slot;
+        #pragma omp atomic capture
+        slot = next[coo_row[k]]++;
+        matrix->col_indices[slot] = coo_col[k];
+        matrix->values[slot] = coo_val[k];
+    }
+    
+    csr_sort_rows(matrix);
+    
+    free(next);
+    free(coo_row);
+    free(coo_col);
+    free(coo_val);
+    return matrix;
+}
+
+static uint64_t align_offset(uint64_t offset) {
+    return (offset + CSR_BINARY_ALIGN - 1) / CSR_BINARY_ALIGN * CSR_BINARY_ALIGN;
+}
+
+// Write the matrix in the binary CSR format, at this build's index widths
+int csr_write_binary(const CSRMatrix *A, const char *path) {
+    CSRBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CSR_BINARY_MAGIC, sizeof(header.magic));
+    header.row_ptr_bytes = sizeof(index_t);
+    header.col_bytes = sizeof(col_index_t);
+    header.num_rows = A->num_rows;
+    header.num_cols = A->num_cols;
+    header.nnz = A->nnz;
+    header.row_ptr_offset = align_offset(sizeof(header));
+    header.col_offset = align_offset(header.row_ptr_offset +
+                                     ((uint64_t)A->num_rows + 1) * sizeof(index_t));
+    header.values_offset = align_offset(header.col_offset + (uint64_t)A->nnz * sizeof(col_index_t));
+    
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror(path);
+        return 0;
+    }
+    static const char zeros[CSR_BINARY_ALIGN] = {0};
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    const void *arrays[3] = {A->row_ptr, A->col_indices, A->values};
+    uint64_t offsets[3] = {header.row_ptr_offset, header.col_offset, header.values_offset};
+    size_t bytes[3] = {((size_t)A->num_rows + 1) * sizeof(index_t),
+                       (size_t)A->nnz * sizeof(col_index_t), (size_t)A->nnz * sizeof(double)};
+    for (int a = 0; a < 3 && ok; a++) {
+        long pad = (long)offsets[a] - ftell(fp);
+        ok = pad >= 0 && fwrite(zeros, 1, pad, fp) == (size_t)pad &&
+             fwrite(arrays[a], 1, bytes[a], fp) == bytes[a];
+    }
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "%s: write error\n", path);
+    return ok;
+}
+
+// Widen or narrow one index array into this build's type
+static void convert_indices(const void *src, int src_bytes, void *dst, int dst_bytes, size_t count) {
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < count; i++) {
+        int64_t v = (src_bytes == 4) ? ((const int32_t *)src)[i] : ((const int64_t *)src)[i];
+        if (dst_bytes == 4) ((int32_t *)dst)[i] = (int32_t)v;
+        else ((int64_t *)dst)[i] = v;
+    }
+}
+
+// Entry i of an index array stored with `bytes` (4 or 8) per entry
+static inline int64_t stored_index(const void *array, uint32_t bytes, size_t i) {
+    return (bytes == 4) ? ((const int32_t *)array)[i] : ((const int64_t *)array)[i];
+}
+
+// The arrays go to the kernels unchecked, so check them here, in parallel:
+// row_ptr starts at 0, never decreases and ends at nnz; columns < num_cols
+static int binary_structure_valid(const CSRBinaryHeader *header, const void *row_ptr,
+                                  const void *col_indices) {
+    size_t rows = (size_t)header->num_rows, nnz = (size_t)header->nnz;
+    if (stored_index(row_ptr, header->row_ptr_bytes, 0) != 0 ||
+        stored_index(row_ptr, header->row_ptr_bytes, rows) != header->nnz) {
+        return 0;
+    }
+    int bad = 0;
+    #pragma omp parallel for schedule(static) reduction(|:bad)
+    for (size_t i = 0; i < rows; i++) {
+        bad |= stored_index(row_ptr, header->row_ptr_bytes, i) >
+               stored_index(row_ptr, header->row_ptr_bytes, i + 1);
+    }
+    #pragma omp parallel for schedule(static) reduction(|:bad)
+    for (size_t k = 0; k < nnz; k++) {
+        int64_t col = stored_index(col_indices, header->col_bytes, k);
+        bad |= col < 0 || col >= header->num_cols;
+    }
+    return !bad;
+}
+
+// Map a binary CSR file; zero-copy when its widths match this build
+CSRMatrix* csr_load_binary(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CSRBinaryHeader)) {
+        fprintf(stderr, "%s: not a binary CSR file\n", path);
+        close(fd);
+        return NULL;
+    }
+    size_t file_bytes = (size_t)st.st_size;
+    
+    // Private writable mapping: kernels may scribble on the arrays without
+    // touching the file (copy-on-write)
+    char *base = (char *)mmap(NULL, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror(path);
+        return NULL;
+    }
+    
+    CSRBinaryHeader header;
+    memcpy(&header, base, sizeof(header));
+    int widths_ok = (header.row_ptr_bytes == 4 || header.row_ptr_bytes == 8) &&
+                    (header.col_bytes == 4 || header.col_bytes == 8);
+    if (memcmp(header.magic, CSR_BINARY_MAGIC, sizeof(header.magic)) != 0 || !widths_ok ||
+        header.num_rows < 0 || header.num_cols < 0 || header.nnz < 0) {
+        fprintf(stderr, "%s: not a binary CSR file\n", path);
+        munmap(base, file_bytes);
+        return NULL;
+    }
+    if (!index_count_fits((double)header.num_rows) || !index_count_fits((double)header.nnz) ||
+        (double)header.num_cols > (double)COL_INDEX_MAX) {
+        fprintf(stderr, "%s: %lld x %lld with %lld non-zeros exceeds the %s index types; "
+                "rebuild with `make INDEX64=1`\n", path, (long long)header.num_rows,
+                (long long)header.num_cols, (long long)header.nnz, INDEX_MODE);
+        munmap(base, file_bytes);
+        return NULL;
+    }
+    
+    // Sizes first (no product can overflow past these), then every array
+    // inside the file and aligned for its element type
+    int sizes_ok = header.num_rows < INT64_MAX / 8 && header.nnz < INT64_MAX / 8;
+    uint64_t row_ptr_size = ((uint64_t)header.num_rows + 1) * header.row_ptr_bytes;
+    uint64_t col_size = (uint64_t)header.nnz * header.col_bytes;
+    uint64_t values_size = (uint64_t)header.nnz * sizeof(double);
+    int layout_ok = sizes_ok &&
+                    header.row_ptr_offset <= file_bytes && row_ptr_size <= file_bytes - header.row_ptr_offset &&
+                    header.col_offset <= file_bytes && col_size <= file_bytes - header.col_offset &&
+                    header.values_offset <= file_bytes && values_size <= file_bytes - header.values_offset &&
+                    header.row_ptr_offset % header.row_ptr_bytes == 0 &&
+                    header.col_offset % header.col_bytes == 0 &&
+                    header.values_offset % sizeof(double) == 0;
+    if (!layout_ok) {
+        fprintf(stderr, "%s: truncated or misaligned binary CSR file\n", path);
+        munmap(base, file_bytes);
+        return NULL;
+    }
+    
+    void *row_ptr = base + header.row_ptr_offset;
+    void *col_indices = base + header.col_offset;
+    double *values = (double *)(base + header.values_offset);
+    if (!binary_structure_valid(&header, row_ptr, col_indices)) {
+        fprintf(stderr, "%s: corrupt binary CSR file (row pointers or column indices out of range)\n",
+                path);
+        munmap(base, file_bytes);
+        return NULL;
+    }
+    
+    if (header.row_ptr_bytes == sizeof(index_t) && header.col_bytes == sizeof(col_index_t)) {
+        CSRMatrix *matrix = (CSRMatrix *)calloc(1, sizeof(CSRMatrix));
+        if (!matrix) {
+            munmap(base, file_bytes);
+            return NULL;
+        }
+        matrix->num_rows = (index_t)header.num_rows;
+        matrix->num_cols = (index_t)header.num_cols;
+        matrix->nnz = (index_t)header.nnz;
+        matrix->row_ptr = (index_t *)row_ptr;
+        matrix->col_indices = (col_index_t *)col_indices;
+        matrix->values = values;
+        matrix->mapping = base;
+        matrix->mapping_bytes = file_bytes;
+        return matrix;
+    }
+    
+    // Different index widths: convert into heap arrays
+    CSRMatrix *matrix = csr_alloc_rows((index_t)header.num_rows, (index_t)header.num_cols);
+    if (matrix) {
+        matrix->nnz = (index_t)header.nnz;
+        matrix->col_indices = (col_index_t *)malloc_array((size_t)header.nnz + 1, sizeof(col_index_t));
+        matrix->values = (double *)malloc_array((size_t)header.nnz + 1, sizeof(double));
+    }
+    if (!matrix || !matrix->col_indices || !matrix->values) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(matrix);
+        munmap(base, file_bytes);
+        return NULL;
+    }
+    convert_indices(row_ptr, header.row_ptr_bytes, matrix->row_ptr, sizeof(index_t),
+                    (size_t)header.num_rows + 1);
+    convert_indices(col_indices, header.col_bytes, matrix->col_indices, sizeof(col_index_t),
+                    (size_t)header.nnz);
+    memcpy(matrix->values, values, (size_t)header.nnz * sizeof(double));
+    munmap(base, file_bytes);
+    return matrix;
+}
+
+CSRMatrix* csr_load(const char *path) {
+    size_t len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".csr") == 0) return csr_load_binary(path);
+    return csr_read_matrix_market(path);
+}
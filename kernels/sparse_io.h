@@ -0,0 +1,51 @@
+/*
+ * Kernel Library: Sparse Matrix Files (Matrix Market and Binary CSR)
+ * 
+ * Description:
+ *   Loads real matrices into CSRMatrix:
+ *     - Matrix Market coordinate files (.mtx; real, integer or pattern,
+ *       general or symmetric), read and parsed in parallel: the entry
+ *       section is split into per-thread byte ranges at line boundaries,
+ *       each thread counts then parses its lines into COO, and COO is
+ *       bucketed into CSR rows with columns sorted.
+ *     - A binary CSR format (.csr): a fixed header followed by row_ptr,
+ *       col_indices and values at 64-byte aligned offsets. Loading maps the
+ *       file and, when its index widths match the build, uses the arrays in
+ *       place - no parsing, no copy, pages fault in on first use.
+ * 
+ *   All loaders return NULL (with a message) on malformed input or if the
+ *   matrix does not fit this build's index types.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SPARSE_IO_H
+#define SPARSE_IO_H
+
+#include <stdint.h>
+#include "spmv.h"
+
+#define CSR_BINARY_MAGIC "CSRBIN01"
+
+// On-disk header of a binary CSR file (little-endian, offsets from file start)
+typedef struct {
+    char magic[8];
+    uint32_t row_ptr_bytes;   // 4 or 8
+    uint32_t col_bytes;       // 4 or 8
+    int64_t num_rows;
+    int64_t num_cols;
+    int64_t nnz;
+    uint64_t row_ptr_offset;
+    uint64_t col_offset;
+    uint64_t values_offset;
+} CSRBinaryHeader;
+
+CSRMatrix* csr_read_matrix_market(const char *path);
+CSRMatrix* csr_load_binary(const char *path);
+int csr_write_binary(const CSRMatrix *A, const char *path);
+
+// Dispatch on the extension: .csr -> binary, anything else -> Matrix Market
+CSRMatrix* csr_load(const char *path);
+
+#endif // SPARSE_IO_H
@@ -0,0 +1,204 @@
+/*
+ * Kernel Library: Sparse Matrix Statistics and SpMV Advisor
+ * 
+ * See sparse_stats.h for the statistics and the advice rules.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include "sparse_stats.h"
+#include "sparse_symmetric.h"
+#include "numa_alloc.h"
+
+// Max / mean nnz over `parts` blocks of equal row counts (spmv_parallel_static)
+static double row_block_imbalance(const CSRMatrix *A, int parts) {
+    if (A->nnz == 0 || parts <= 1) return 1.0;
+    index_t largest = 0;
+    for (int p = 0; p < parts; p++) {
+        index_t begin = (index_t)((int64_t)A->num_rows * p / parts);
+        index_t end = (index_t)((int64_t)A->num_rows * (p + 1) / parts);
+        index_t nnz = A->row_ptr[end] - A->row_ptr[begin];
+        if (nnz > largest) largest = nnz;
+    }
+    return largest / ((double)A->nnz / parts);
+}
+
+void sparse_matrix_stats(const CSRMatrix *A, int threads, SparseMatrixStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->num_rows = A->num_rows;
+    stats->num_cols = A->num_cols;
+    stats->nnz = A->nnz;
+    stats->threads = (threads > 0) ? threads : omp_get_max_threads();
+    row_length_stats(A, &stats->rows);
+    locality_stats(A, 0, &stats->locality);
+    
+    // Diagonal dominance: |a_ii| against the off-diagonal sum of its row,
+    // over rows with a stored diagonal (the others count in diagonal_fraction)
+    index_t with_diagonal = 0, dominant = 0;
+    double min_dominance = INFINITY;
+    #pragma omp parallel for schedule(static) reduction(+:with_diagonal, dominant) \
+                                              reduction(min:min_dominance)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        double diagonal = 0.0, off_diagonal = 0.0;
+        int has_diagonal = 0;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            if (A->col_indices[j] == i) {
+                diagonal += fabs(A->values[j]);
+                has_diagonal = 1;
+            } else {
+                off_diagonal += fabs(A->values[j]);
+            }
+        }
+        if (!has_diagonal) continue;
+        with_diagonal++;
+        if (diagonal >= off_diagonal) dominant++;
+        double ratio = (off_diagonal > 0.0) ? diagonal / off_diagonal : INFINITY;
+        if (ratio < min_dominance) min_dominance = ratio;
+    }
+    double rows = (A->num_rows > 0) ? (double)A->num_rows : 1.0;
+    stats->diagonal_fraction = with_diagonal / rows;
+    stats->dominant_fraction = dominant / rows;
+    stats->min_dominance = min_dominance;
+    
+    stats->symmetric = csr_is_symmetric(A);
+    stats->ell_fill = ell_fill_ratio(A);
+    stats->sell_fill = sell_fill_ratio(A, SELL_DEFAULT_CHUNK, SELL_DEFAULT_SIGMA);
+    stats->row_block_imbalance = row_block_imbalance(A, stats->threads);
+}
+
+void spmv_advise(const SparseMatrixStats *stats, SpmvAdvice *advice) {
+    const char *partition_why, *reorder_why;
+    double thread_share = (double)stats->nnz / stats->threads;
+    if (stats->row_block_imbalance <= ADVISE_STATIC_MAX_IMBALANCE) {
+        advice->partition = SPMV_PARTITION_STATIC;
+        partition_why = "row blocks carry near-equal non-zeros";
+    } else if (stats->rows.max > ADVISE_MERGE_ROW_SHARE * thread_share) {
+        advice->partition = SPMV_PARTITION_MERGE;
+        partition_why = "longest row outweighs half a thread's share";
+    } else {
+        advice->partition = SPMV_PARTITION_NNZ;
+        partition_why = "row blocks are imbalanced";
+    }
+    
+    advice->format = sparse_format_choose(&stats->rows, stats->nnz, stats->ell_fill,
+                                          stats->sell_fill);
+    
+    advice->reorder = REORDER_NONE;
+    reorder_why = "x gathers mostly reused in cache";
+    if (stats->num_rows != stats->num_cols) {
+        reorder_why = "not square";
+    } else if (stats->nnz > 0 && stats->locality.reuse_hit_rate < ADVISE_REORDER_MAX_HIT) {
+        int skewed = stats->rows.gini >= ADVISE_SKEWED_GINI;
+        advice->reorder = skewed ? REORDER_DEGREE : REORDER_RCM;
+        reorder_why = skewed ? "poor x reuse, skewed rows" : "poor x reuse";
+    }
+    advice->symmetric_storage = stats->symmetric;
+    snprintf(advice->reason, sizeof(advice->reason), "%s; %s", partition_why, reorder_why);
+}
+
+void sparse_stats_print(const SparseMatrixStats *stats, const SpmvAdvice *advice) {
+    const RowLengthStats *r = &stats->rows;
+    const LocalityStats *l = &stats->locality;
+    printf("Row lengths:   min %ld, max %ld, mean %.2f, variance %.2f, cv %.2f, Gini %.3f, "
+           "%ld empty\n", (long)r->min, (long)r->max, r->mean, r->variance, r->cv, r->gini,
+           (long)r->empty);
+    printf("Locality:      bandwidth %ld, profile %.3g, reuse distance %.3g nnz, "
+           "%.1f%% cached reuse\n", (long)l->bandwidth, l->profile, l->mean_reuse_nnz,
+           l->reuse_hit_rate * 100.0);
+    char dominance[32] = "n/a";
+    if (stats->diagonal_fraction > 0.0) snprintf(dominance, sizeof(dominance), "%.3g", stats->min_dominance);
+    printf("Diagonal:      %.1f%% stored, %.1f%% dominant rows, min |a_ii| / sum|a_ij| %s "
+           "(rows with a diagonal)%s\n", stats->diagonal_fraction * 100.0,
+           stats->dominant_fraction * 100.0, dominance, stats->symmetric ? ", symmetric" : "");
+    printf("Partitioning:  row blocks %.2fx the mean nnz over %d threads; "
+           "ELL fill %.2f, SELL fill %.2f\n", stats->row_block_imbalance, stats->threads,
+           stats->ell_fill, stats->sell_fill);
+    printf("Advice:        %s partition, %s storage, ordering %s%s (%s)\n",
+           spmv_partition_name(advice->partition), sparse_format_name(advice->format),
+           reorder_name(advice->reorder), advice->symmetric_storage ? ", upper-triangle storage" : "",
+           advice->reason);
+}
+
+int sparse_stats_json(const SparseMatrixStats *stats, const SpmvAdvice *advice,
+                      char *buf, size_t len) {
+    const RowLengthStats *r = &stats->rows;
+    const LocalityStats *l = &stats->locality;
+    // JSON has no infinity: rows without off-diagonals give null
+    char dominance[32];
+    if (isfinite(stats->min_dominance)) {
+        snprintf(dominance, sizeof(dominance), "%.6g", stats->min_dominance);
+    } else {
+        snprintf(dominance, sizeof(dominance), "null");
+    }
+    int written = snprintf(buf, len,
+        "\"matrix_stats\":{\"rows\":%ld,\"cols\":%ld,\"nnz\":%ld,"
+        "\"row_min\":%ld,\"row_max\":%ld,\"row_mean\":%.6g,\"row_variance\":%.6g,"
+        "\"row_cv\":%.6g,\"row_gini\":%.6g,\"empty_rows\":%ld,"
+        "\"bandwidth\":%ld,\"profile\":%.6g,\"reuse_distance\":%.6g,\"reuse_hit_rate\":%.6g,"
+        "\"diagonal_fraction\":%.6g,\"dominant_fraction\":%.6g,\"min_dominance\":%s,"
+        "\"symmetric\":%s,\"ell_fill\":%.6g,\"sell_fill\":%.6g,"
+        "\"row_block_imbalance\":%.6g,\"advice_threads\":%d,"
+        "\"advised_partition\":\"%s\",\"advised_format\":\"%s\",\"advised_reorder\":\"%s\"}",
+        (long)stats->num_rows, (long)stats->num_cols, (long)stats->nnz,
+        (long)r->min, (long)r->max, r->mean, r->variance, r->cv, r->gini, (long)r->empty,
+        (long)l->bandwidth, l->profile, l->mean_reuse_nnz, l->reuse_hit_rate,
+        stats->diagonal_fraction, stats->dominant_fraction, dominance,
+        stats->symmetric ? "true" : "false", stats->ell_fill, stats->sell_fill,
+        stats->row_block_imbalance, stats->threads,
+        spmv_partition_name(advice->partition), sparse_format_name(advice->format),
+        reorder_name(advice->reorder));
+    return written >= 0 && (size_t)written < len;
+}
+
+SpmvPlan* spmv_plan_create(CSRMatrix *A, const SpmvAdvice *advice) {
+    SpmvPlan *plan = (SpmvPlan *)calloc(1, sizeof(SpmvPlan));
+    if (!plan) return NULL;
+    plan->A = A;
+    plan->advice = *advice;
+    if (advice->format == SPARSE_FORMAT_ELL) plan->sell = ell_from_csr(A);
+    if (advice->format == SPARSE_FORMAT_SELL) {
+        plan->sell = sell_from_csr(A, SELL_DEFAULT_CHUNK, SELL_DEFAULT_SIGMA);
+    }
+    if (advice->format != SPARSE_FORMAT_CSR && !plan->sell) {
+        free(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+void spmv_plan_run(const SpmvPlan *plan, double *x, double *y) {
+    if (plan->sell) {
+        sell_spmv(plan->sell, x, y);
+        return;
+    }
+    switch (plan->advice.partition) {
+    case SPMV_PARTITION_NNZ:   spmv_nnz_balanced(plan->A, x, y); break;
+    case SPMV_PARTITION_MERGE: spmv_merge_path(plan->A, x, y); break;
+    default:                   spmv_parallel_static(plan->A, x, y); break;
+    }
+}
+
+double spmv_plan_bytes(const SpmvPlan *plan) {
+    return plan->sell ? sell_matrix_bytes(plan->sell) : csr_matrix_bytes(plan->A);
+}
+
+void free_spmv_plan(SpmvPlan *plan) {
+    if (!plan) return;
+    free_sell_matrix(plan->sell);
+    free(plan);
+}
+
+const char *spmv_partition_name(SpmvPartition partition) {
+    switch (partition) {
+    case SPMV_PARTITION_NNZ:   return "nnz_balanced";
+    case SPMV_PARTITION_MERGE: return "merge_path";
+    default:                   return "static";
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Kernel Library: Sparse Matrix Statistics and SpMV Advisor
+ * 
+ * Description:
+ *   Which SpMV variant wins depends on the matrix more than on the
+ *   machine. sparse_matrix_stats collects the structure that decides it in
+ *   one call:
+ * 
+ *     row lengths   min / max / mean / variance / Gini (sparse_formats.h)
+ *     locality      bandwidth, profile, reuse distance of x (reorder.h)
+ *     diagonal      stored diagonals, diagonally dominant rows
+ *     partitioning  nnz imbalance of equal row blocks over the team
+ *     storage       ELL / SELL-C-sigma padding, symmetry
+ * 
+ *   spmv_advise turns the statistics into a recommendation:
+ * 
+ *     partition  static row blocks when they already carry equal work,
+ *                merge path when one row outweighs a share of a thread,
+ *                otherwise blocks of equal non-zeros;
+ *     storage    sparse_format_choose (ELL for uniform rows, SELL while
+ *                sorting keeps padding low, else CSR);
+ *     ordering   RCM, or degree ordering for skewed rows, when few x
+ *                gathers are reused within the cache.
+ * 
+ *   An SpmvPlan applies the partition and storage advice (the ordering
+ *   and symmetric storage change the matrix and stay recommendations).
+ *   sparse_stats_json formats the statistics for bench_set_json_fields, so
+ *   every benchmark result carries the structure of its matrix.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SPARSE_STATS_H
+#define SPARSE_STATS_H
+
+#include <stddef.h>
+#include "index_types.h"
+#include "spmv.h"
+#include "sparse_formats.h"
+#include "reorder.h"
+
+// Advisor thresholds
+#define ADVISE_STATIC_MAX_IMBALANCE 1.1  // Row blocks within 10% of equal nnz
+#define ADVISE_MERGE_ROW_SHARE 0.5       // One row above half a thread's nnz
+#define ADVISE_REORDER_MAX_HIT 0.5       // Reorder below 50% cached x reuse
+#define ADVISE_SKEWED_GINI 0.5           // Degree ordering above this Gini
+
+typedef enum {
+    SPMV_PARTITION_STATIC,       // spmv_parallel_static
+    SPMV_PARTITION_NNZ,          // spmv_nnz_balanced
+    SPMV_PARTITION_MERGE         // spmv_merge_path
+} SpmvPartition;
+
+typedef struct {
+    index_t num_rows;
+    index_t num_cols;
+    index_t nnz;
+    RowLengthStats rows;
+    LocalityStats locality;
+    double diagonal_fraction;    // Rows with a stored diagonal entry
+    double dominant_fraction;    // Rows with a stored diagonal and |a_ii| >= sum of |a_ij|, j != i
+    double min_dominance;        // Smallest |a_ii| / sum |a_ij| (j != i) over rows with a
+                                 // stored diagonal; INFINITY if there are none
+    int symmetric;
+    double ell_fill;             // Stored slots per non-zero in ELL
+    double sell_fill;            // ... in SELL-C-sigma (default C, sigma)
+    int threads;                 // Team size the imbalance refers to
+    double row_block_imbalance;  // Max / mean nnz of equal row blocks
+} SparseMatrixStats;
+
+typedef struct {
+    SpmvPartition partition;     // For CSR storage
+    SparseFormat format;
+    ReorderKind reorder;
+    int symmetric_storage;       // Upper-triangle storage (sparse_symmetric.h) applies
+    char reason[192];
+} SpmvAdvice;
+
+typedef struct {
+    CSRMatrix *A;
+    SpmvAdvice advice;
+    SellMatrix *sell;            // ELL / SELL advice: the converted matrix
+} SpmvPlan;
+
+// threads = 0: omp_get_max_threads()
+void sparse_matrix_stats(const CSRMatrix *A, int threads, SparseMatrixStats *stats);
+void spmv_advise(const SparseMatrixStats *stats, SpmvAdvice *advice);
+void sparse_stats_print(const SparseMatrixStats *stats, const SpmvAdvice *advice);
+
+// "matrix_stats":{...} with the advice; returns 0 if buf is too small
+int sparse_stats_json(const SparseMatrixStats *stats, const SpmvAdvice *advice,
+                      char *buf, size_t len);
+
+// Auto-selected SpMV: builds the advised storage once (NULL on failure)
+SpmvPlan* spmv_plan_create(CSRMatrix *A, const SpmvAdvice *advice);
+void spmv_plan_run(const SpmvPlan *plan, double *x, double *y);
+double spmv_plan_bytes(const SpmvPlan *plan);   // Matrix bytes the plan streams
+void free_spmv_plan(SpmvPlan *plan);
+
+const char *spmv_partition_name(SpmvPartition partition);
+
+#endif // SPARSE_STATS_H
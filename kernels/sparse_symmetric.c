@@ -0,0 +1,383 @@
+/*
+ * Kernel Library: Symmetric and Transposed Sparse Products
+ * 
+ * See sparse_symmetric.h for the storage and the write-conflict scheme.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "sparse_symmetric.h"
+#include "numa_alloc.h"
+#include "arena.h"
+#include "trace.h"
+
+// Diagonal and upper triangle of A, in A's row order
+static CSRMatrix *csr_upper(const CSRMatrix *A) {
+    CSRMatrix *U = csr_alloc_rows(A->num_rows, A->num_cols);
+    if (!U) return NULL;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        index_t count = 0;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            if (A->col_indices[j] >= i) count++;
+        }
+        U->row_ptr[i + 1] = count;
+    }
+    U->nnz = csr_counts_to_offsets(U->row_ptr, A->num_rows);
+    U->values = (double *)malloc_array((size_t)U->nnz + 1, sizeof(double));
+    U->col_indices = (col_index_t *)malloc_array((size_t)U->nnz + 1, sizeof(col_index_t));
+    if (!U->values || !U->col_indices) {
+        free_csr_matrix(U);
+        return NULL;
+    }
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        index_t out = U->row_ptr[i];
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            if (A->col_indices[j] >= i) {
+                U->col_indices[out] = A->col_indices[j];
+                U->values[out++] = A->values[j];
+            }
+        }
+    }
+    return U;
+}
+
+// ---------------------------------------------------------------------------
+// Transpose
+// ---------------------------------------------------------------------------
+
+/*
+ * Counting sort by column. Every thread counts the columns of its row
+ * block (equal non-zeros) privately; a pass over columns turns the counts
+ * into each thread's first slot in every output row; the threads then
+ * scatter their blocks. Blocks are in row order, so every row of Aᵀ comes
+ * out sorted and the result does not depend on timing.
+ */
+CSRMatrix* csr_transpose(const CSRMatrix *A) {
+    if (A->num_rows > COL_INDEX_MAX) {
+        fprintf(stderr, "Transpose: %ld rows do not fit the column index type\n",
+                (long)A->num_rows);
+        return NULL;
+    }
+    index_t cols = A->num_cols;
+    int max_threads = omp_get_max_threads();
+    CSRMatrix *T = csr_alloc_rows(cols, A->num_rows);
+    index_t *slots = (index_t *)scratch_alloc((size_t)max_threads * cols + 1, sizeof(index_t));
+    if (!T || !slots) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(T);
+        scratch_free(slots);
+        return NULL;
+    }
+    
+    int team = 1;
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t begin = csr_nnz_partition(A, nthreads, tid);
+        index_t end = csr_nnz_partition(A, nthreads, tid + 1);
+        index_t *mine = slots + (size_t)tid * cols;
+        #pragma omp single
+        team = nthreads;
+        
+        memset(mine, 0, cols * sizeof(index_t));
+        for (index_t j = A->row_ptr[begin]; j < A->row_ptr[end]; j++) mine[A->col_indices[j]]++;
+        #pragma omp barrier
+        
+        #pragma omp for schedule(static)
+        for (index_t c = 0; c < cols; c++) {
+            index_t total = 0;
+            for (int t = 0; t < nthreads; t++) {
+                index_t count = slots[(size_t)t * cols + c];
+                slots[(size_t)t * cols + c] = total;
+                total += count;
+            }
+            T->row_ptr[c + 1] = total;
+        }
+    }
+    T->nnz = csr_counts_to_offsets(T->row_ptr, cols);
+    T->values = (double *)malloc_array((size_t)T->nnz + 1, sizeof(double));
+    T->col_indices = (col_index_t *)malloc_array((size_t)T->nnz + 1, sizeof(col_index_t));
+    if (!T->values || !T->col_indices) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(T);
+        scratch_free(slots);
+        return NULL;
+    }
+    
+    // The row blocks of the counting pass; the runtime may grant fewer
+    // threads than asked, so each thread scatters every block it is dealt
+    #pragma omp parallel num_threads(team)
+    {
+        for (int b = omp_get_thread_num(); b < team; b += omp_get_num_threads()) {
+            index_t begin = csr_nnz_partition(A, team, b);
+            index_t end = csr_nnz_partition(A, team, b + 1);
+            index_t *mine = slots + (size_t)b * cols;
+            for (index_t i = begin; i < end; i++) {
+                for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                    index_t c = A->col_indices[j];
+                    index_t out = T->row_ptr[c] + mine[c]++;
+                    T->col_indices[out] = (col_index_t)i;
+                    T->values[out] = A->values[j];
+                }
+            }
+        }
+    }
+    scratch_free(slots);
+    return T;
+}
+
+/*
+ * y = Aᵀ x. Each thread scatters its row block (equal non-zeros) into a
+ * private buffer over the columns its rows touch (first to last column of
+ * each sorted row), then every y[c] is summed over the buffers in thread
+ * order. Without a buffer (allocation failure) the scatter runs serially.
+ */
+void spmv_transpose(const CSRMatrix *A, const double *x, double *y) {
+    index_t cols = A->num_cols;
+    int max_threads = omp_get_max_threads();
+    double *partials = (double *)scratch_alloc((size_t)max_threads * cols + 1, sizeof(double));
+    if (!partials) {
+        memset(y, 0, cols * sizeof(double));
+        for (index_t i = 0; i < A->num_rows; i++) {
+            for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                y[A->col_indices[j]] += A->values[j] * x[i];
+            }
+        }
+        return;
+    }
+    index_t lo[max_threads], hi[max_threads];
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t begin = csr_nnz_partition(A, nthreads, tid);
+        index_t end = csr_nnz_partition(A, nthreads, tid + 1);
+        double *mine = partials + (size_t)tid * cols;
+        
+        uint64_t trace_t0 = trace_begin();
+        index_t first = cols, last = 0;
+        for (index_t i = begin; i < end; i++) {
+            if (A->row_ptr[i] == A->row_ptr[i + 1]) continue;
+            if (A->col_indices[A->row_ptr[i]] < first) first = A->col_indices[A->row_ptr[i]];
+            if (A->col_indices[A->row_ptr[i + 1] - 1] + 1 > last) {
+                last = A->col_indices[A->row_ptr[i + 1] - 1] + 1;
+            }
+        }
+        if (first < last) memset(mine + first, 0, (last - first) * sizeof(double));
+        for (index_t i = begin; i < end; i++) {
+            double xi = x[i];
+            for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                mine[A->col_indices[j]] += A->values[j] * xi;
+            }
+        }
+        lo[tid] = first;
+        hi[tid] = last;
+        trace_end("spmv transpose scatter", trace_t0, begin);
+        #pragma omp barrier
+        
+        #pragma omp for schedule(static)
+        for (index_t c = 0; c < cols; c++) {
+            double sum = 0.0;
+            for (int t = 0; t < nthreads; t++) {
+                if (c >= lo[t] && c < hi[t]) sum += partials[(size_t)t * cols + c];
+            }
+            y[c] = sum;
+        }
+    }
+    scratch_free(partials);
+}
+
+// ---------------------------------------------------------------------------
+// Symmetric storage
+// ---------------------------------------------------------------------------
+
+int csr_is_symmetric(const CSRMatrix *A) {
+    if (A->num_rows != A->num_cols) return 0;
+    CSRMatrix *T = csr_transpose(A);
+    if (!T) return 0;
+    int different = (T->nnz != A->nnz);
+    if (!different) {
+        // Rows of A are sorted (every constructor here leaves them so), like Aᵀ's
+        #pragma omp parallel for schedule(dynamic, 256) reduction(|:different)
+        for (index_t i = 0; i < A->num_rows; i++) {
+            if (A->row_ptr[i + 1] != T->row_ptr[i + 1]) {
+                different = 1;
+                continue;
+            }
+            for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                if (A->col_indices[j] != T->col_indices[j] || A->values[j] != T->values[j]) {
+                    different = 1;
+                    break;
+                }
+            }
+        }
+    }
+    free_csr_matrix(T);
+    return !different;
+}
+
+SymmetricCSR* symmetric_from_csr(const CSRMatrix *A) {
+    if (A->num_rows != A->num_cols) {
+        fprintf(stderr, "Symmetric storage needs a square matrix (got %ld x %ld)\n",
+                (long)A->num_rows, (long)A->num_cols);
+        return NULL;
+    }
+    SymmetricCSR *S = (SymmetricCSR *)calloc(1, sizeof(SymmetricCSR));
+    if (!S) return NULL;
+    S->upper = csr_upper(A);
+    S->num_blocks = omp_get_max_threads();
+    S->block_rows = (index_t *)malloc_array((size_t)S->num_blocks + 1, sizeof(index_t));
+    S->spill_end = (index_t *)malloc_array((size_t)S->num_blocks, sizeof(index_t));
+    S->spill_offset = (size_t *)malloc_array((size_t)S->num_blocks + 1, sizeof(size_t));
+    if (!S->upper || !S->block_rows || !S->spill_end || !S->spill_offset) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_symmetric_csr(S);
+        return NULL;
+    }
+    
+    // Row blocks of equal stored non-zeros; each spills up to its largest column
+    const CSRMatrix *U = S->upper;
+    S->spill_offset[0] = 0;
+    for (int b = 0; b <= S->num_blocks; b++) {
+        S->block_rows[b] = csr_nnz_partition(U, S->num_blocks, b);
+    }
+    for (int b = 0; b < S->num_blocks; b++) {
+        index_t end = S->block_rows[b + 1], reach = end;
+        #pragma omp parallel for schedule(static) reduction(max:reach)
+        for (index_t j = U->row_ptr[S->block_rows[b]]; j < U->row_ptr[end]; j++) {
+            if (U->col_indices[j] + 1 > reach) reach = U->col_indices[j] + 1;
+        }
+        S->spill_end[b] = reach;
+        S->spill_offset[b + 1] = S->spill_offset[b] + (size_t)(reach - end);
+    }
+    S->spill = (double *)malloc_array(S->spill_offset[S->num_blocks] + 1, sizeof(double));
+    if (!S->spill) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_symmetric_csr(S);
+        return NULL;
+    }
+    return S;
+}
+
+void free_symmetric_csr(SymmetricCSR *S) {
+    if (!S) return;
+    free_csr_matrix(S->upper);
+    free(S->block_rows);
+    free(S->spill_end);
+    free(S->spill_offset);
+    free(S->spill);
+    free(S);
+}
+
+// Rows of Uᵀ below the diagonal followed by the rows of U
+CSRMatrix* csr_symmetrize_upper(const CSRMatrix *A) {
+    if (A->num_rows != A->num_cols) return NULL;
+    CSRMatrix *U = csr_upper(A);
+    CSRMatrix *L = U ? csr_transpose(U) : NULL;
+    CSRMatrix *F = csr_alloc_rows(A->num_rows, A->num_cols);
+    if (!U || !L || !F) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(U);
+        free_csr_matrix(L);
+        free_csr_matrix(F);
+        return NULL;
+    }
+    index_t n = A->num_rows;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < n; i++) {
+        index_t below = 0;
+        for (index_t j = L->row_ptr[i]; j < L->row_ptr[i + 1] && L->col_indices[j] < i; j++) below++;
+        F->row_ptr[i + 1] = below + (U->row_ptr[i + 1] - U->row_ptr[i]);
+    }
+    F->nnz = csr_counts_to_offsets(F->row_ptr, n);
+    F->values = (double *)malloc_array((size_t)F->nnz + 1, sizeof(double));
+    F->col_indices = (col_index_t *)malloc_array((size_t)F->nnz + 1, sizeof(col_index_t));
+    if (!F->values || !F->col_indices) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(U);
+        free_csr_matrix(L);
+        free_csr_matrix(F);
+        return NULL;
+    }
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < n; i++) {
+        index_t out = F->row_ptr[i];
+        for (index_t j = L->row_ptr[i]; j < L->row_ptr[i + 1] && L->col_indices[j] < i; j++) {
+            F->col_indices[out] = L->col_indices[j];
+            F->values[out++] = L->values[j];
+        }
+        for (index_t j = U->row_ptr[i]; j < U->row_ptr[i + 1]; j++) {
+            F->col_indices[out] = U->col_indices[j];
+            F->values[out++] = U->values[j];
+        }
+    }
+    free_csr_matrix(U);
+    free_csr_matrix(L);
+    csr_sort_rows(F);
+    return F;
+}
+
+double symmetric_csr_bytes(const SymmetricCSR *S) {
+    return csr_matrix_bytes(S->upper);
+}
+
+/*
+ * Pass 1: each block zeroes its rows of y and its spill buffer, then walks
+ * its rows: the row product goes to y[i], transposed products to y[c]
+ * (c inside the block) or to spill (c past it). Pass 2 goes over the
+ * blocks again as destinations: each adds, in block order, the part of
+ * every earlier block's spill that reaches its rows, so the work is the
+ * spilled ranges rather than rows x blocks. Blocks are dealt round-robin,
+ * so any team size gives the same sums.
+ */
+void spmv_symmetric(const SymmetricCSR *S, const double *x, double *y) {
+    const CSRMatrix *U = S->upper;
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        for (int b = tid; b < S->num_blocks; b += nthreads) {
+            uint64_t trace_t0 = trace_begin();
+            index_t begin = S->block_rows[b], end = S->block_rows[b + 1];
+            double *spill = S->spill + S->spill_offset[b];
+            memset(y + begin, 0, (end - begin) * sizeof(double));
+            memset(spill, 0, (S->spill_offset[b + 1] - S->spill_offset[b]) * sizeof(double));
+            for (index_t i = begin; i < end; i++) {
+                double xi = x[i], sum = 0.0;
+                for (index_t j = U->row_ptr[i]; j < U->row_ptr[i + 1]; j++) {
+                    index_t c = U->col_indices[j];
+                    double v = U->values[j];
+                    sum += v * x[c];
+                    if (c == i) continue;
+                    if (c < end) y[c] += v * xi;
+                    else spill[c - end] += v * xi;
+                }
+                y[i] += sum;
+            }
+            trace_end("spmv symmetric block", trace_t0, begin);
+        }
+        #pragma omp barrier
+        
+        #pragma omp for schedule(dynamic, 1)
+        for (int d = 1; d < S->num_blocks; d++) {
+            index_t begin = S->block_rows[d], end = S->block_rows[d + 1];
+            for (int b = 0; b < d; b++) {
+                // Block b spills into rows block_rows[b + 1] .. spill_end[b] - 1
+                index_t stop = (S->spill_end[b] < end) ? S->spill_end[b] : end;
+                const double *spill = S->spill + S->spill_offset[b] + (begin - S->block_rows[b + 1]);
+                for (index_t r = begin; r < stop; r++) y[r] += spill[r - begin];
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Kernel Library: Symmetric and Transposed Sparse Products
+ * 
+ * Description:
+ *   Symmetric storage keeps only the diagonal and the upper triangle, so a
+ *   product streams about half the bytes of full CSR. Each stored U[i][j]
+ *   (j > i) contributes twice:
+ * 
+ *     y[i] += U[i][j] * x[j]     row product, written by the row's owner
+ *     y[j] += U[i][j] * x[i]     transposed product, scattered
+ * 
+ *   The scatter is what makes it hard to parallelize. Rows are split into
+ *   blocks of equal stored non-zeros, fixed when the matrix is built. A
+ *   block only scatters at or below its own rows (j > i). Inside the block
+ *   it adds straight into y. Beyond the block it adds into a private spill
+ *   buffer covering rows end .. (largest column + 1). A second pass adds the
+ *   spill buffers into y in block order, so the result does not depend on
+ *   timing. After a bandwidth-reducing ordering (reorder.h) the spill
+ *   ranges are short.
+ * 
+ *   Aᵀx has the same scatter for every non-zero. spmv_transpose uses a
+ *   private buffer per thread over the column range its rows touch. For
+ *   repeated products, csr_transpose builds Aᵀ once in parallel (CSR of Aᵀ
+ *   = CSC of A), and plain SpMV then runs on it.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SPARSE_SYMMETRIC_H
+#define SPARSE_SYMMETRIC_H
+
+#include "index_types.h"
+#include "spmv.h"
+
+typedef struct {
+    CSRMatrix *upper;         // Diagonal + upper triangle, sorted rows
+    int num_blocks;           // Row blocks (omp_get_max_threads() when built)
+    index_t *block_rows;      // Block b owns rows block_rows[b] .. block_rows[b+1]-1
+    index_t *spill_end;       // Block b spills into rows block_rows[b+1] .. spill_end[b]-1
+    size_t *spill_offset;     // Block b's spill buffer starts at spill + spill_offset[b]
+    double *spill;
+} SymmetricCSR;
+
+// 1 if A is square and A[i][j] == A[j][i] for every stored entry
+int csr_is_symmetric(const CSRMatrix *A);
+
+// Upper triangle of a symmetric A (entries below the diagonal are ignored)
+SymmetricCSR* symmetric_from_csr(const CSRMatrix *A);
+void free_symmetric_csr(SymmetricCSR *S);
+
+// Full symmetric CSR from the upper triangle of A (U + Uᵀ - diag)
+CSRMatrix* csr_symmetrize_upper(const CSRMatrix *A);
+
+// Bytes of the upper triangle (the matrix part of spmv_symmetric traffic)
+double symmetric_csr_bytes(const SymmetricCSR *S);
+
+// y = A * x with A given by its upper triangle
+void spmv_symmetric(const SymmetricCSR *S, const double *x, double *y);
+
+// Aᵀ as CSR (= A in CSC), rows sorted; parallel counting sort by column
+CSRMatrix* csr_transpose(const CSRMatrix *A);
+
+// y = Aᵀ * x without building Aᵀ (x: num_rows, y: num_cols)
+void spmv_transpose(const CSRMatrix *A, const double *x, double *y);
+
+#endif // SPARSE_SYMMETRIC_H
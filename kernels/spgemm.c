@@ -0,0 +1,469 @@
+/*
+ * Kernel Library: Sparse Matrix-Matrix Multiplication (SpGEMM)
+ * 
+ * See spgemm.h for the two phases and the accumulators.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include "spgemm.h"
+#include "numa_alloc.h"
+#include "arena.h"
+#include "trace.h"
+
+#define SPGEMM_CHUNK_ROWS 64      // Rows per dynamic chunk (row costs vary widely)
+#define HASH_MIN_CAPACITY 16
+#define HASH_EMPTY ((col_index_t)-1)
+#define SORT_INSERTION_MAX 32     // Shorter rows of C are insertion sorted
+#define RADIX_BITS 8              // Longer ones radix sorted, 8 bits per pass
+
+// Per-thread scratch, allocated on first use: a thread that only meets
+// short rows never pays for the dense accumulator
+typedef struct {
+    col_index_t *keys;        // Hash table, HASH_EMPTY where free
+    double *values;
+    index_t *marker;          // Dense: per column of B, -1 where unused
+    col_index_t *sort_cols;   // Radix sort buffers, max_row entries
+    double *sort_values;
+    index_t capacity;         // Slots allocated in keys / values
+    index_t num_cols;
+    index_t max_row;          // Longest row of C
+    int failed;
+} RowAccumulator;
+
+static void accumulator_free(RowAccumulator *acc) {
+    free(acc->keys);
+    free(acc->values);
+    free(acc->marker);
+    free(acc->sort_cols);
+    free(acc->sort_values);
+}
+
+static int hash_reserve(RowAccumulator *acc, int numeric) {
+    if (acc->keys) return 1;
+    acc->keys = (col_index_t *)malloc_array((size_t)acc->capacity, sizeof(col_index_t));
+    if (numeric) acc->values = (double *)malloc_array((size_t)acc->capacity, sizeof(double));
+    if (!acc->keys || (numeric && !acc->values)) {
+        acc->failed = 1;
+        return 0;
+    }
+    for (index_t s = 0; s < acc->capacity; s++) acc->keys[s] = HASH_EMPTY;
+    return 1;
+}
+
+static int dense_reserve(RowAccumulator *acc) {
+    if (acc->marker) return 1;
+    acc->marker = (index_t *)malloc_array((size_t)acc->num_cols + 1, sizeof(index_t));
+    if (!acc->marker) {
+        acc->failed = 1;
+        return 0;
+    }
+    for (index_t c = 0; c < acc->num_cols; c++) acc->marker[c] = -1;
+    return 1;
+}
+
+static int sort_reserve(RowAccumulator *acc) {
+    if (acc->sort_cols) return 1;
+    acc->sort_cols = (col_index_t *)malloc_array((size_t)acc->max_row + 1, sizeof(col_index_t));
+    acc->sort_values = (double *)malloc_array((size_t)acc->max_row + 1, sizeof(double));
+    if (!acc->sort_cols || !acc->sort_values) {
+        acc->failed = 1;
+        return 0;
+    }
+    return 1;
+}
+
+// Smallest power of two >= 2 * products (load factor <= 1/2)
+static index_t hash_capacity(index_t products) {
+    index_t capacity = HASH_MIN_CAPACITY;
+    while (capacity < 2 * products) capacity *= 2;
+    return capacity;
+}
+
+static inline index_t hash_slot(col_index_t col, index_t mask) {
+    return (index_t)(((uint64_t)col * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+// Number of multiply-adds in row i of A * B
+static inline index_t row_products(const CSRMatrix *A, const CSRMatrix *B, index_t i) {
+    index_t count = 0;
+    for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+        col_index_t k = A->col_indices[j];
+        count += B->row_ptr[k + 1] - B->row_ptr[k];
+    }
+    return count;
+}
+
+/*
+ * Sort one row of C by column. Rows come out of the accumulators in hash /
+ * first-touch order; csr_sort_rows would qsort every long row through a
+ * temporary, which costs more than the product itself. Long rows get an LSD
+ * radix sort on (column - smallest column) instead, with as many 8-bit
+ * passes as the row's column span needs.
+ */
+static void sort_row(col_index_t *cols, double *values, index_t len, RowAccumulator *acc) {
+    if (len <= SORT_INSERTION_MAX) {
+        for (index_t i = 1; i < len; i++) {
+            col_index_t c = cols[i];
+            double v = values[i];
+            index_t j = i;
+            while (j > 0 && cols[j - 1] > c) {
+                cols[j] = cols[j - 1];
+                values[j] = values[j - 1];
+                j--;
+            }
+            cols[j] = c;
+            values[j] = v;
+        }
+        return;
+    }
+    if (!sort_reserve(acc)) return;
+    col_index_t low = cols[0], high = cols[0];
+    for (index_t i = 1; i < len; i++) {
+        if (cols[i] < low) low = cols[i];
+        if (cols[i] > high) high = cols[i];
+    }
+    uint64_t span = (uint64_t)(high - low);
+    col_index_t *src_cols = cols, *dst_cols = acc->sort_cols;
+    double *src_values = values, *dst_values = acc->sort_values;
+    for (int shift = 0; shift == 0 || (shift < 64 && (span >> shift) != 0); shift += RADIX_BITS) {
+        index_t offset[(1 << RADIX_BITS) + 1];
+        memset(offset, 0, sizeof(offset));
+        for (index_t i = 0; i < len; i++) {
+            offset[(((uint64_t)(src_cols[i] - low) >> shift) & ((1 << RADIX_BITS) - 1)) + 1]++;
+        }
+        for (int d = 0; d < (1 << RADIX_BITS); d++) offset[d + 1] += offset[d];
+        for (index_t i = 0; i < len; i++) {
+            index_t slot = offset[((uint64_t)(src_cols[i] - low) >> shift) & ((1 << RADIX_BITS) - 1)]++;
+            dst_cols[slot] = src_cols[i];
+            dst_values[slot] = src_values[i];
+        }
+        col_index_t *swap_cols = src_cols;
+        double *swap_values = src_values;
+        src_cols = dst_cols;
+        src_values = dst_values;
+        dst_cols = swap_cols;
+        dst_values = swap_values;
+    }
+    if (src_cols != cols) {
+        memcpy(cols, src_cols, (size_t)len * sizeof(col_index_t));
+        memcpy(values, src_values, (size_t)len * sizeof(double));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Row kernels
+// ---------------------------------------------------------------------------
+
+// Distinct columns of row i of A * B
+static index_t symbolic_hash(const CSRMatrix *A, const CSRMatrix *B, index_t i,
+                             RowAccumulator *acc, index_t products) {
+    index_t mask = hash_capacity(products) - 1;
+    index_t count = 0;
+    for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+        col_index_t k = A->col_indices[j];
+        for (index_t jb = B->row_ptr[k]; jb < B->row_ptr[k + 1]; jb++) {
+            col_index_t c = B->col_indices[jb];
+            index_t s = hash_slot(c, mask);
+            while (acc->keys[s] != HASH_EMPTY && acc->keys[s] != c) s = (s + 1) & mask;
+            if (acc->keys[s] == HASH_EMPTY) {
+                acc->keys[s] = c;
+                count++;
+            }
+        }
+    }
+    for (index_t s = 0; s <= mask; s++) acc->keys[s] = HASH_EMPTY;
+    return count;
+}
+
+static index_t symbolic_dense(const CSRMatrix *A, const CSRMatrix *B, index_t i,
+                              RowAccumulator *acc) {
+    index_t count = 0;
+    for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+        col_index_t k = A->col_indices[j];
+        for (index_t jb = B->row_ptr[k]; jb < B->row_ptr[k + 1]; jb++) {
+            col_index_t c = B->col_indices[jb];
+            if (acc->marker[c] != i) {
+                acc->marker[c] = i;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// Row i of C into its slot, sorted
+static void numeric_hash(const CSRMatrix *A, const CSRMatrix *B, index_t i,
+                         RowAccumulator *acc, index_t products, CSRMatrix *C) {
+    index_t mask = hash_capacity(products) - 1;
+    for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+        col_index_t k = A->col_indices[j];
+        double a = A->values[j];
+        for (index_t jb = B->row_ptr[k]; jb < B->row_ptr[k + 1]; jb++) {
+            col_index_t c = B->col_indices[jb];
+            index_t s = hash_slot(c, mask);
+            while (acc->keys[s] != HASH_EMPTY && acc->keys[s] != c) s = (s + 1) & mask;
+            if (acc->keys[s] == HASH_EMPTY) {
+                acc->keys[s] = c;
+                acc->values[s] = a * B->values[jb];
+            } else {
+                acc->values[s] += a * B->values[jb];
+            }
+        }
+    }
+    index_t out = C->row_ptr[i];
+    for (index_t s = 0; s <= mask; s++) {
+        if (acc->keys[s] == HASH_EMPTY) continue;
+        C->col_indices[out] = acc->keys[s];
+        C->values[out++] = acc->values[s];
+        acc->keys[s] = HASH_EMPTY;
+    }
+    sort_row(C->col_indices + C->row_ptr[i], C->values + C->row_ptr[i], out - C->row_ptr[i], acc);
+}
+
+// The marker holds the slot in C where a column's sum lives; sorted like
+// numeric_hash
+static void numeric_dense(const CSRMatrix *A, const CSRMatrix *B, index_t i,
+                          RowAccumulator *acc, CSRMatrix *C) {
+    index_t start = C->row_ptr[i];
+    index_t out = start;
+    for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+        col_index_t k = A->col_indices[j];
+        double a = A->values[j];
+        for (index_t jb = B->row_ptr[k]; jb < B->row_ptr[k + 1]; jb++) {
+            col_index_t c = B->col_indices[jb];
+            index_t slot = acc->marker[c];
+            if (slot < start || slot >= out) {
+                acc->marker[c] = out;
+                C->col_indices[out] = c;
+                C->values[out++] = a * B->values[jb];
+            } else {
+                C->values[slot] += a * B->values[jb];
+            }
+        }
+    }
+    sort_row(C->col_indices + start, C->values + start, out - start, acc);
+}
+
+// ---------------------------------------------------------------------------
+// Product
+// ---------------------------------------------------------------------------
+
+CSRMatrix* spgemm(const CSRMatrix *A, const CSRMatrix *B, SpgemmAccumulator acc,
+                  SpgemmStats *stats) {
+    if (A->num_cols != B->num_rows) {
+        fprintf(stderr, "SpGEMM: inner dimensions differ (%ld vs %ld)\n",
+                (long)A->num_cols, (long)B->num_rows);
+        return NULL;
+    }
+    index_t n = A->num_rows;
+    double start = omp_get_wtime();
+    
+    // Product count per row: picks the accumulator and sizes the hash tables
+    index_t *products = (index_t *)scratch_alloc((size_t)n + 1, sizeof(index_t));
+    CSRMatrix *C = csr_alloc_rows(n, B->num_cols);
+    if (!products || !C) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        scratch_free(products);
+        free_csr_matrix(C);
+        return NULL;
+    }
+    // Rows with at least dense_from products use the dense accumulator
+    double marker_bytes = (double)B->num_cols * sizeof(index_t) * omp_get_max_threads();
+    index_t dense_from = (acc == SPGEMM_DENSE) ? 0
+                       : (acc == SPGEMM_HASH) ? INDEX_MAX
+                       : (marker_bytes <= (double)last_level_cache_bytes()) ? 0
+                       : (B->num_cols + SPGEMM_DENSE_RATIO - 1) / SPGEMM_DENSE_RATIO;
+    double total_products = 0.0, total_nnz = 0.0;
+    index_t max_hash_products = 0, dense_rows = 0, max_row = 0;
+    int failed = 0;
+    
+    #pragma omp parallel
+    {
+        #pragma omp for schedule(static) reduction(+:total_products, dense_rows) \
+                        reduction(max:max_hash_products)
+        for (index_t i = 0; i < n; i++) {
+            products[i] = row_products(A, B, i);
+            total_products += (double)products[i];
+            if (products[i] >= dense_from) {
+                dense_rows++;
+            } else if (products[i] > max_hash_products) {
+                max_hash_products = products[i];
+            }
+        }
+        
+        // Symbolic phase: row lengths of C
+        RowAccumulator scratch = {NULL, NULL, NULL, NULL, NULL, hash_capacity(max_hash_products),
+                                  B->num_cols, 0, 0};
+        uint64_t trace_t0 = trace_begin();
+        #pragma omp for schedule(dynamic, SPGEMM_CHUNK_ROWS) reduction(+:total_nnz) \
+                        reduction(max:max_row)
+        for (index_t i = 0; i < n; i++) {
+            index_t count = 0;
+            if (products[i] >= dense_from) {
+                if (dense_reserve(&scratch)) count = symbolic_dense(A, B, i, &scratch);
+            } else if (products[i] > 0) {
+                if (hash_reserve(&scratch, 0)) count = symbolic_hash(A, B, i, &scratch, products[i]);
+            }
+            C->row_ptr[i + 1] = count;
+            total_nnz += (double)count;
+            if (count > max_row) max_row = count;
+        }
+        trace_end("spgemm symbolic", trace_t0, n);
+        if (scratch.failed) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+        accumulator_free(&scratch);
+    }
+    
+    if (failed || !index_count_fits(total_nnz)) {
+        fprintf(stderr, failed ? "Memory allocation failed!\n"
+                               : "SpGEMM: result does not fit this build's index type\n");
+        scratch_free(products);
+        free_csr_matrix(C);
+        return NULL;
+    }
+    C->nnz = csr_counts_to_offsets(C->row_ptr, n);
+    C->values = (double *)malloc_array((size_t)C->nnz + 1, sizeof(double));
+    C->col_indices = (col_index_t *)malloc_array((size_t)C->nnz + 1, sizeof(col_index_t));
+    if (!C->values || !C->col_indices) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        scratch_free(products);
+        free_csr_matrix(C);
+        return NULL;
+    }
+    double symbolic_end = omp_get_wtime();
+    
+    // Numeric phase: values, written straight into C and sorted in place
+    #pragma omp parallel
+    {
+        RowAccumulator scratch = {NULL, NULL, NULL, NULL, NULL, hash_capacity(max_hash_products),
+                                  B->num_cols, max_row, 0};
+        uint64_t trace_t0 = trace_begin();
+        #pragma omp for schedule(dynamic, SPGEMM_CHUNK_ROWS)
+        for (index_t i = 0; i < n; i++) {
+            if (products[i] >= dense_from) {
+                if (dense_reserve(&scratch)) numeric_dense(A, B, i, &scratch, C);
+            } else if (products[i] > 0) {
+                if (hash_reserve(&scratch, 1)) numeric_hash(A, B, i, &scratch, products[i], C);
+            }
+        }
+        trace_end("spgemm numeric", trace_t0, n);
+        if (scratch.failed) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+        accumulator_free(&scratch);
+    }
+    scratch_free(products);
+    if (failed) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(C);
+        return NULL;
+    }
+    
+    if (stats) {
+        stats->products = total_products;
+        stats->dense_rows = dense_rows;
+        stats->hash_rows = n - dense_rows;
+        stats->symbolic_seconds = symbolic_end - start;
+        stats->numeric_seconds = omp_get_wtime() - symbolic_end;
+    }
+    return C;
+}
+
+double spgemm_products(const CSRMatrix *A, const CSRMatrix *B) {
+    if (A->num_cols != B->num_rows) return 0.0;
+    double total = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:total)
+    for (index_t i = 0; i < A->num_rows; i++) total += (double)row_products(A, B, i);
+    return total;
+}
+
+CSRMatrix* spgemm_sequential(const CSRMatrix *A, const CSRMatrix *B) {
+    if (A->num_cols != B->num_rows) return NULL;
+    index_t n = A->num_rows;
+    CSRMatrix *C = csr_alloc_rows(n, B->num_cols);
+    RowAccumulator scratch = {NULL, NULL, NULL, NULL, NULL, 0, B->num_cols, 0, 0};
+    if (!C || !dense_reserve(&scratch)) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(C);
+        accumulator_free(&scratch);
+        return NULL;
+    }
+    double total_nnz = 0.0;
+    for (index_t i = 0; i < n; i++) {
+        C->row_ptr[i + 1] = symbolic_dense(A, B, i, &scratch);
+        total_nnz += (double)C->row_ptr[i + 1];
+        if (C->row_ptr[i + 1] > scratch.max_row) scratch.max_row = C->row_ptr[i + 1];
+    }
+    if (!index_count_fits(total_nnz)) {
+        fprintf(stderr, "SpGEMM: result does not fit this build's index type\n");
+        free_csr_matrix(C);
+        accumulator_free(&scratch);
+        return NULL;
+    }
+    for (index_t i = 0; i < n; i++) C->row_ptr[i + 1] += C->row_ptr[i];
+    C->nnz = C->row_ptr[n];
+    C->values = (double *)malloc_array((size_t)C->nnz + 1, sizeof(double));
+    C->col_indices = (col_index_t *)malloc_array((size_t)C->nnz + 1, sizeof(col_index_t));
+    if (!C->values || !C->col_indices) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(C);
+        accumulator_free(&scratch);
+        return NULL;
+    }
+    for (index_t c = 0; c < B->num_cols; c++) scratch.marker[c] = -1;
+    for (index_t i = 0; i < n; i++) numeric_dense(A, B, i, &scratch, C);
+    int failed = scratch.failed;
+    accumulator_free(&scratch);
+    if (failed) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(C);
+        return NULL;
+    }
+    return C;
+}
+
+int csr_matrices_match(const CSRMatrix *X, const CSRMatrix *Y, double tolerance) {
+    if (X->num_rows != Y->num_rows || X->num_cols != Y->num_cols || X->nnz != Y->nnz) return 0;
+    int mismatch = 0;
+    #pragma omp parallel for schedule(static) reduction(|:mismatch)
+    for (index_t i = 0; i < X->num_rows; i++) {
+        if (X->row_ptr[i + 1] != Y->row_ptr[i + 1]) {
+            mismatch = 1;
+            continue;
+        }
+        for (index_t j = X->row_ptr[i]; j < X->row_ptr[i + 1]; j++) {
+            if (X->col_indices[j] != Y->col_indices[j] ||
+                fabs(X->values[j] - Y->values[j]) > tolerance * fmax(1.0, fabs(Y->values[j]))) {
+                mismatch = 1;
+            }
+        }
+    }
+    return !mismatch;
+}
+
+static const char *accumulator_names[] = {"auto", "hash", "dense"};
+
+const char* spgemm_accumulator_name(SpgemmAccumulator acc) {
+    return accumulator_names[acc];
+}
+
+int spgemm_accumulator_parse(const char *name, SpgemmAccumulator *acc) {
+    for (int k = 0; k < (int)(sizeof(accumulator_names) / sizeof(accumulator_names[0])); k++) {
+        if (strcmp(name, accumulator_names[k]) == 0) {
+            *acc = (SpgemmAccumulator)k;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * Kernel Library: Sparse Matrix-Matrix Multiplication (SpGEMM)
+ * 
+ * Description:
+ *   C = A * B with A, B and C in CSR (Gustavson's row-by-row algorithm):
+ *   row i of C is the sum of the rows B[k] scaled by A[i][k]. The size of
+ *   C is not known in advance, so the product runs in two parallel phases:
+ * 
+ *     symbolic  count the distinct columns of every row of C, scan the
+ *               counts into row_ptr and allocate C exactly once;
+ *     numeric   recompute every row, now accumulating values, and write
+ *               it into its slot.
+ * 
+ *   Each thread merges a row's products in a private accumulator, picked
+ *   per row from the row's product count (an upper bound on its length):
+ * 
+ *     hash   open-addressing table sized to the row, cleared per row;
+ *            cheap for the short rows of sparse graphs;
+ *     dense  sparse accumulator (SPA) indexed by column, one per thread
+ *            over all of B's columns; no probing, for long rows.
+ * 
+ *   Both sum a row's products in the same order (A's row, then B's rows),
+ *   so every accumulator and thread count gives the same C.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SPGEMM_H
+#define SPGEMM_H
+
+#include "index_types.h"
+#include "spmv.h"
+
+// SPGEMM_AUTO: every row uses the dense accumulator while one per thread
+// fits the last-level cache (its misses then cost less than hashing);
+// beyond that only rows whose product count reaches
+// num_cols / SPGEMM_DENSE_RATIO do
+#define SPGEMM_DENSE_RATIO 16
+
+typedef enum {
+    SPGEMM_AUTO,              // Per row, from its product count and B's width
+    SPGEMM_HASH,
+    SPGEMM_DENSE
+} SpgemmAccumulator;
+
+typedef struct {
+    double products;          // Multiply-adds (sum over A[i][k] of nnz(B[k]))
+    index_t hash_rows;        // Rows merged in a hash table
+    index_t dense_rows;       // Rows merged in the dense accumulator
+    double symbolic_seconds;
+    double numeric_seconds;   // Includes sorting the rows of C
+} SpgemmStats;
+
+// C = A * B with sorted rows; NULL if the shapes do not match or C does not
+// fit this build's index types. stats may be NULL.
+CSRMatrix* spgemm(const CSRMatrix *A, const CSRMatrix *B, SpgemmAccumulator acc,
+                  SpgemmStats *stats);
+
+// Multiply-adds of A * B (the flop count is twice this), without forming it
+double spgemm_products(const CSRMatrix *A, const CSRMatrix *B);
+
+// Single-threaded reference (dense accumulator)
+CSRMatrix* spgemm_sequential(const CSRMatrix *A, const CSRMatrix *B);
+
+// 1 if X and Y have the same structure and values within a relative tolerance
+int csr_matrices_match(const CSRMatrix *X, const CSRMatrix *Y, double tolerance);
+
+const char* spgemm_accumulator_name(SpgemmAccumulator acc);
+int spgemm_accumulator_parse(const char *name, SpgemmAccumulator *acc);
+
+#endif // SPGEMM_H
@@ -0,0 +1,762 @@
+/*
+ * Kernel Library: Sparse Matrix-Vector Multiplication (CSR)
+ * 
+ * See spmv.h for the interface.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <omp.h>
+#include "spmv.h"
+#include "vector_ops.h"
+#include "numa_alloc.h"
+#include "trace.h"
+#include "rng.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_SIMD 1
+#endif
+
+#define ROW_SORT_INSERTION_MAX 32   // Longer rows are sorted with qsort
+
+// Uniform double in [0, 1): draw k of a row's stream (rng.h), so rows can
+// be generated in any order
+static inline double sparse_rand_unit(uint64_t seed, uint64_t stream, uint64_t k) {
+    return rng_unit(rng_bits(seed, stream, k));
+}
+
+/*
+ * Columns of one row: instead of a coin flip per column (O(cols)), draw the
+ * gap to the next non-zero from the geometric distribution,
+ *   gap = floor(log(1 - u) / log(1 - density)),
+ * which gives the same Bernoulli(density) pattern in O(row nnz). With
+ * cols == NULL only the count is returned (pass 1); pass 2 repeats the same
+ * draws and fills the row. Values come from a separate stream.
+ */
+static index_t generate_row(index_t row, index_t cols, double density, double log_keep,
+                            col_index_t *out_cols, double *out_values) {
+    index_t count = 0;
+    if (density <= 0.0) return 0;
+    if (density >= 1.0) {
+        for (index_t j = 0; j < cols; j++) {
+            if (out_cols) {
+                out_cols[count] = (col_index_t)j;
+                out_values[count] = sparse_rand_unit(SPARSE_RANDOM_SEED + 1, row, count) * 10.0;
+            }
+            count++;
+        }
+        return count;
+    }
+    
+    double j = -1.0;
+    for (uint64_t k = 0;; k++) {
+        double u = sparse_rand_unit(SPARSE_RANDOM_SEED, row, k);
+        j += 1.0 + floor(log1p(-u) / log_keep);
+        if (j >= (double)cols) break;
+        if (out_cols) {
+            out_cols[count] = (col_index_t)j;
+            out_values[count] = sparse_rand_unit(SPARSE_RANDOM_SEED + 1, row, count) * 10.0;  // 0-10
+        }
+        count++;
+    }
+    return count;
+}
+
+/*
+ * Non-zero fraction of row i. skew == 0: every row uses `density`. skew > 0:
+ * row weights follow a power law, w = (rows * u + 1)^-skew with u uniform per
+ * row, normalized so the mean row still has `density` (rows saturate at a
+ * full row) - a few rows hold most of the non-zeros, scattered over the
+ * matrix like the hubs of a real graph.
+ */
+static inline double row_density(index_t i, index_t rows, double density, double skew,
+                                 double weight_norm) {
+    if (skew <= 0.0) return density;
+    double u = sparse_rand_unit(SPARSE_RANDOM_SEED + 2, i, 0);
+    double d = density * pow((double)rows * u + 1.0, -skew) * weight_norm;
+    return (d < 1.0) ? d : 1.0;
+}
+
+static CSRMatrix* generate_matrix(index_t rows, index_t cols, double density, double skew) {
+    if ((double)cols > (double)COL_INDEX_MAX) {
+        fprintf(stderr, "Sparse matrix with %ld columns exceeds the %s column index type; "
+                "rebuild with `make INDEX64=1`\n", (long)cols, INDEX_MODE);
+        return NULL;
+    }
+    CSRMatrix *matrix = csr_alloc_rows(rows, cols);
+    if (!matrix) return NULL;
+    if (density <= 0.0 || cols == 0) {
+        for (index_t i = 1; i <= rows; i++) matrix->row_ptr[i] = 0;
+        matrix->values = (double *)malloc(sizeof(double));
+        matrix->col_indices = (col_index_t *)malloc(sizeof(col_index_t));
+        return matrix;
+    }
+    
+    // 1 / E[w], in closed form so it does not depend on a reduction order
+    double weight_norm = 1.0;
+    if (skew > 0.0 && rows > 0) {
+        double n = (double)rows;
+        double mean = (fabs(skew - 1.0) < 1e-12) ? log1p(n) / n
+                                                 : (pow(n + 1.0, 1.0 - skew) - 1.0) / (n * (1.0 - skew));
+        weight_norm = 1.0 / mean;
+    }
+    
+    // Pass 1: non-zeros per row (same static partition as the SpMV kernels)
+    int64_t total = 0;
+    #pragma omp parallel for schedule(static) reduction(+:total)
+    for (index_t i = 0; i < rows; i++) {
+        double d = row_density(i, rows, density, skew, weight_norm);
+        matrix->row_ptr[i + 1] = generate_row(i, cols, d, log1p(-d), NULL, NULL);
+        total += matrix->row_ptr[i + 1];
+    }
+    if (!index_count_fits((double)total)) {
+        fprintf(stderr, "Sparse matrix with %lld non-zeros exceeds the %s index type; "
+                "rebuild with `make INDEX64=1`\n", (long long)total, INDEX_MODE);
+        free_csr_matrix(matrix);
+        return NULL;
+    }
+    
+    // Row offsets, then exactly nnz storage
+    index_t nnz = csr_counts_to_offsets(matrix->row_ptr, rows);
+    matrix->nnz = nnz;
+    matrix->values = (double *)malloc_array((size_t)nnz + 1, sizeof(double));
+    matrix->col_indices = (col_index_t *)malloc_array((size_t)nnz + 1, sizeof(col_index_t));
+    if (!matrix->values || !matrix->col_indices) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        free_csr_matrix(matrix);
+        return NULL;
+    }
+    
+    // Pass 2: every row writes its own slice (first touch by the owning thread)
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < rows; i++) {
+        double d = row_density(i, rows, density, skew, weight_norm);
+        index_t start = matrix->row_ptr[i];
+        generate_row(i, cols, d, log1p(-d), matrix->col_indices + start, matrix->values + start);
+    }
+    
+    return matrix;
+}
+
+// Create random sparse matrix in CSR format
+CSRMatrix* create_random_sparse_matrix(index_t rows, index_t cols, double density) {
+    return generate_matrix(rows, cols, density, 0.0);
+}
+
+// Same mean density, power-law row lengths
+CSRMatrix* create_skewed_sparse_matrix(index_t rows, index_t cols, double density, double skew) {
+    return generate_matrix(rows, cols, density, skew);
+}
+
+// Matrix shell with row_ptr sized for `rows` rows and no non-zeros yet
+CSRMatrix* csr_alloc_rows(index_t rows, index_t cols) {
+    CSRMatrix *matrix = (CSRMatrix *)calloc(1, sizeof(CSRMatrix));
+    if (!matrix) return NULL;
+    matrix->num_rows = rows;
+    matrix->num_cols = cols;
+    matrix->row_ptr = (index_t *)malloc_array((size_t)rows + 1, sizeof(index_t));
+    if (!matrix->row_ptr) {
+        free(matrix);
+        return NULL;
+    }
+    matrix->row_ptr[0] = 0;
+    return matrix;
+}
+
+// In-place exclusive scan of row counts stored in row_ptr[1..num_rows]
+index_t csr_counts_to_offsets(index_t *row_ptr, index_t num_rows) {
+    /*
+     * Two-pass block scan: every thread sums its block of counts, one
+     * thread scans the per-thread totals, then every thread adds its
+     * block's base while scanning its block locally.
+     */
+    int max_threads = omp_get_max_threads();
+    index_t *block_sum = (index_t *)calloc(max_threads + 1, sizeof(index_t));
+    if (!block_sum) {
+        // The result is nnz, not a status: scan serially rather than fail
+        fprintf(stderr, "csr_counts_to_offsets: block sums allocation failed, scanning serially\n");
+        for (index_t i = 0; i < num_rows; i++) row_ptr[i + 1] += row_ptr[i];
+        return row_ptr[num_rows];
+    }
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t per_thread = num_rows / nthreads, extra = num_rows % nthreads;
+        index_t begin = tid * per_thread + (tid < extra ? tid : extra);
+        index_t end = begin + per_thread + (tid < extra);
+        
+        index_t sum = 0;
+        for (index_t i = begin; i < end; i++) sum += row_ptr[i + 1];
+        block_sum[tid + 1] = sum;
+        
+        #pragma omp barrier
+        #pragma omp single
+        for (int t = 0; t < nthreads; t++) block_sum[t + 1] += block_sum[t];
+        
+        index_t running = block_sum[tid];
+        for (index_t i = begin; i < end; i++) {
+            running += row_ptr[i + 1];
+            row_ptr[i + 1] = running;
+        }
+    }
+    
+    free(block_sum);
+    return row_ptr[num_rows];
+}
+
+typedef struct {
+    col_index_t col;
+    double value;
+} SparseEntry;
+
+static int compare_entries(const void *a, const void *b) {
+    col_index_t ca = ((const SparseEntry *)a)->col, cb = ((const SparseEntry *)b)->col;
+    return (ca > cb) - (ca < cb);
+}
+
+// Sort one CSR row by column
+static void sort_row(col_index_t *cols, double *values, index_t len) {
+    if (len <= ROW_SORT_INSERTION_MAX) {
+        for (index_t i = 1; i < len; i++) {
+            col_index_t c = cols[i];
+            double v = values[i];
+            index_t j = i;
+            while (j > 0 && cols[j - 1] > c) {
+                cols[j] = cols[j - 1];
+                values[j] = values[j - 1];
+                j--;
+            }
+            cols[j] = c;
+            values[j] = v;
+        }
+        return;
+    }
+    
+    SparseEntry *entries = (SparseEntry *)malloc_array(len, sizeof(SparseEntry));
+    if (!entries) return;
+    for (index_t i = 0; i < len; i++) {
+        entries[i].col = cols[i];
+        entries[i].value = values[i];
+    }
+    qsort(entries, len, sizeof(SparseEntry), compare_entries);
+    for (index_t i = 0; i < len; i++) {
+        cols[i] = entries[i].col;
+        values[i] = entries[i].value;
+    }
+    free(entries);
+}
+
+// Sort the columns of every row (rows in parallel)
+void csr_sort_rows(CSRMatrix *A) {
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        index_t start = A->row_ptr[i];
+        sort_row(A->col_indices + start, A->values + start, A->row_ptr[i + 1] - start);
+    }
+}
+
+// Free CSR matrix
+void free_csr_matrix(CSRMatrix *matrix) {
+    if (matrix && matrix->mapping) {
+        // Arrays point into the mapped file (see sparse_io.c)
+        munmap(matrix->mapping, matrix->mapping_bytes);
+        free(matrix);
+    } else if (matrix) {
+        free(matrix->values);
+        free(matrix->col_indices);
+        free(matrix->row_ptr);
+        free(matrix);
+    }
+}
+
+// Print CSR format
+void print_csr_format(CSRMatrix *matrix) {
+    printf("\nCSR Format Representation:\n");
+    printf("---------------------------\n");
+    printf("values:      [");
+    for (index_t i = 0; i < matrix->nnz && i < 20; i++) {
+        printf("%.1f", matrix->values[i]);
+        if (i < matrix->nnz - 1) printf(", ");
+    }
+    if (matrix->nnz > 20) printf(", ...");
+    printf("]\n");
+    
+    printf("col_indices: [");
+    for (index_t i = 0; i < matrix->nnz && i < 20; i++) {
+        printf("%ld", (long)matrix->col_indices[i]);
+        if (i < matrix->nnz - 1) printf(", ");
+    }
+    if (matrix->nnz > 20) printf(", ...");
+    printf("]\n");
+    
+    printf("row_ptr:     [");
+    for (index_t i = 0; i <= matrix->num_rows && i < 20; i++) {
+        printf("%ld", (long)matrix->row_ptr[i]);
+        if (i < matrix->num_rows) printf(", ");
+    }
+    if (matrix->num_rows > 20) printf(", ...");
+    printf("]\n");
+    printf("---------------------------\n");
+}
+
+// Matrix part of the SpMV traffic, at this build's index widths
+double csr_matrix_bytes(const CSRMatrix *matrix) {
+    return matrix->nnz * (double)(sizeof(double) + sizeof(col_index_t)) +
+           (matrix->num_rows + 1.0) * sizeof(index_t);
+}
+
+// Copy row_ptr / col_indices into arrays of the requested widths
+int csr_index_widths_create(const CSRMatrix *A, int row_ptr_bytes, int col_bytes,
+                            CSRIndexWidths *widths) {
+    if ((row_ptr_bytes != 4 && row_ptr_bytes != 8) || (col_bytes != 4 && col_bytes != 8)) return 0;
+    if (row_ptr_bytes == 4 && (double)A->nnz > INT32_MAX) return 0;
+    if (col_bytes == 4 && (double)A->num_cols > INT32_MAX) return 0;
+    
+    widths->source = A;
+    widths->row_ptr_bytes = row_ptr_bytes;
+    widths->col_bytes = col_bytes;
+    widths->row_ptr = malloc_array((size_t)A->num_rows + 1, row_ptr_bytes);
+    widths->col_indices = malloc_array(A->nnz, col_bytes);
+    if (!widths->row_ptr || !widths->col_indices) {
+        csr_index_widths_free(widths);
+        return 0;
+    }
+    
+    #pragma omp parallel for schedule(static)
+    for (index_t i = 0; i <= A->num_rows; i++) {
+        if (row_ptr_bytes == 4) ((int32_t *)widths->row_ptr)[i] = (int32_t)A->row_ptr[i];
+        else ((int64_t *)widths->row_ptr)[i] = A->row_ptr[i];
+    }
+    #pragma omp parallel for schedule(static)
+    for (index_t j = 0; j < A->nnz; j++) {
+        if (col_bytes == 4) ((int32_t *)widths->col_indices)[j] = (int32_t)A->col_indices[j];
+        else ((int64_t *)widths->col_indices)[j] = A->col_indices[j];
+    }
+    return 1;
+}
+
+void csr_index_widths_free(CSRIndexWidths *widths) {
+    free(widths->row_ptr);
+    free(widths->col_indices);
+    widths->row_ptr = NULL;
+    widths->col_indices = NULL;
+}
+
+double csr_index_widths_bytes(const CSRIndexWidths *widths) {
+    const CSRMatrix *A = widths->source;
+    return A->nnz * (double)(sizeof(double) + widths->col_bytes) +
+           (A->num_rows + 1.0) * widths->row_ptr_bytes;
+}
+
+// Sequential sparse matrix-vector multiplication
+void spmv_sequential(CSRMatrix *A, double *x, double *y) {
+    for (index_t i = 0; i < A->num_rows; i++) {
+        double sum = 0.0;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            sum += A->values[j] * x[A->col_indices[j]];
+        }
+        y[i] = sum;
+    }
+}
+
+// Parallel SpMV with static scheduling
+void spmv_parallel_static(CSRMatrix *A, double *x, double *y) {
+    /*
+     * CORRECT IMPLEMENTATION: No synchronization needed
+     * 
+     * Key insight: Each row is computed independently
+     * - Thread i computes y[rows assigned to i]
+     * - Different threads write to different y[] elements
+     * - NO shared writes = NO atomic/critical sections needed
+     * 
+     * Static scheduling:
+     * - Good for uniform row workloads (regular sparsity)
+     * - May have load imbalance for irregular patterns
+     */
+    #pragma omp parallel
+    {
+        // Parallelize over rows - each row is independent
+        spmv_team(A, x, y);
+    }
+}
+
+// Static-scheduled SpMV executed by the CALLING team (orphaned worksharing)
+void spmv_team(CSRMatrix *A, double *x, double *y) {
+    #pragma omp for schedule(static)
+    for (index_t i = 0; i < A->num_rows; i++) {
+        double sum = 0.0;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            sum += A->values[j] * x[A->col_indices[j]];
+        }
+        y[i] = sum;  // No race condition - this thread owns y[i]
+    }
+}
+
+// Repeated SpMV inside ONE persistent parallel region
+void spmv_persistent(CSRMatrix *A, double *x, double *y, int iterations) {
+    /*
+     * The team is forked once and reused for every product; consecutive
+     * products are separated only by the implicit barrier of spmv_team.
+     * No I/O in the hot region.
+     */
+    #pragma omp parallel
+    {
+        for (int it = 0; it < iterations; it++) {
+            spmv_team(A, x, y);
+        }
+    }
+}
+
+// Parallel SpMV with dynamic scheduling
+void spmv_parallel_dynamic(CSRMatrix *A, double *x, double *y) {
+    /*
+     * OPTIMIZED IMPLEMENTATION: Dynamic scheduling for load balancing
+     * 
+     * Why dynamic scheduling is better for sparse matrices:
+     * - Rows can have vastly different numbers of non-zeros
+     * - Static gives equal rows to each thread → unequal work
+     * - Dynamic distributes work at runtime → better balance
+     * 
+     * Adaptive chunk size:
+     * - Too small (1): High scheduling overhead
+     * - Too large (1000s): Poor load balancing
+     * - Optimal: ~10-100 rows per chunk
+     */
+    #pragma omp parallel
+    {
+        // Every thread derives the same chunk size from the team size
+        int chunk_size = spmv_dynamic_chunk_size(A->num_rows, omp_get_num_threads());
+        
+        index_t num_chunks = (A->num_rows + chunk_size - 1) / chunk_size;
+        
+        // Dynamic scheduling: runtime load balancing for irregular workloads
+        // Each thread computes different rows - no synchronization needed
+        // (one iteration per chunk == schedule(dynamic, chunk_size), with
+        // chunk boundaries visible for tracing)
+        #pragma omp for schedule(dynamic)
+        for (index_t c = 0; c < num_chunks; c++) {
+            uint64_t trace_t0 = trace_begin();
+            index_t row_end = (c + 1) * chunk_size;
+            if (row_end > A->num_rows) row_end = A->num_rows;
+            
+            for (index_t i = c * chunk_size; i < row_end; i++) {
+                double sum = 0.0;
+                for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                    sum += A->values[j] * x[A->col_indices[j]];
+                }
+                y[i] = sum;  // No race condition - exclusive ownership
+            }
+            trace_end("spmv chunk", trace_t0, c);
+        }
+    }
+}
+
+// One loop per width combination, so the compiler sees fixed-size loads
+static void spmv_rows_32_32(const int32_t *row_ptr, const int32_t *cols, const double *values,
+                            const double *x, double *y, index_t num_rows) {
+    #pragma omp for schedule(static)
+    for (index_t i = 0; i < num_rows; i++) {
+        double sum = 0.0;
+        for (int32_t j = row_ptr[i]; j < row_ptr[i + 1]; j++) sum += values[j] * x[cols[j]];
+        y[i] = sum;
+    }
+}
+
+static void spmv_rows_64_32(const int64_t *row_ptr, const int32_t *cols, const double *values,
+                            const double *x, double *y, index_t num_rows) {
+    #pragma omp for schedule(static)
+    for (index_t i = 0; i < num_rows; i++) {
+        double sum = 0.0;
+        for (int64_t j = row_ptr[i]; j < row_ptr[i + 1]; j++) sum += values[j] * x[cols[j]];
+        y[i] = sum;
+    }
+}
+
+static void spmv_rows_64_64(const int64_t *row_ptr, const int64_t *cols, const double *values,
+                            const double *x, double *y, index_t num_rows) {
+    #pragma omp for schedule(static)
+    for (index_t i = 0; i < num_rows; i++) {
+        double sum = 0.0;
+        for (int64_t j = row_ptr[i]; j < row_ptr[i + 1]; j++) sum += values[j] * x[cols[j]];
+        y[i] = sum;
+    }
+}
+
+static void spmv_rows_32_64(const int32_t *row_ptr, const int64_t *cols, const double *values,
+                            const double *x, double *y, index_t num_rows) {
+    #pragma omp for schedule(static)
+    for (index_t i = 0; i < num_rows; i++) {
+        double sum = 0.0;
+        for (int32_t j = row_ptr[i]; j < row_ptr[i + 1]; j++) sum += values[j] * x[cols[j]];
+        y[i] = sum;
+    }
+}
+
+// Parallel SpMV over re-encoded index arrays (same partition as spmv_team)
+void spmv_index_widths(const CSRIndexWidths *widths, const double *x, double *y) {
+    const CSRMatrix *A = widths->source;
+    int wide_rows = (widths->row_ptr_bytes == 8), wide_cols = (widths->col_bytes == 8);
+    
+    #pragma omp parallel
+    {
+        if (!wide_rows && !wide_cols) {
+            spmv_rows_32_32(widths->row_ptr, widths->col_indices, A->values, x, y, A->num_rows);
+        } else if (wide_rows && !wide_cols) {
+            spmv_rows_64_32(widths->row_ptr, widths->col_indices, A->values, x, y, A->num_rows);
+        } else if (wide_rows) {
+            spmv_rows_64_64(widths->row_ptr, widths->col_indices, A->values, x, y, A->num_rows);
+        } else {
+            spmv_rows_32_64(widths->row_ptr, widths->col_indices, A->values, x, y, A->num_rows);
+        }
+    }
+}
+
+typedef struct {
+    const CSRMatrix *A;
+    const double *x;
+    double *y;
+} SpmvArgs;
+
+static void spmv_rows(long begin, long end, void *arg) {
+    SpmvArgs *s = (SpmvArgs *)arg;
+    const CSRMatrix *A = s->A;
+    for (long i = begin; i < end; i++) {
+        double sum = 0.0;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            sum += A->values[j] * s->x[A->col_indices[j]];
+        }
+        s->y[i] = sum;
+    }
+}
+
+// SpMV with a run-time selected row scheduling strategy
+long spmv_scheduled(CSRMatrix *A, double *x, double *y, Schedule sched) {
+    SpmvArgs args = {A, x, y};
+    return schedule_for(A->num_rows, sched, spmv_rows, &args);
+}
+
+// First row of part p when rows are cut into `parts` blocks of ~nnz / parts
+// non-zeros each (lower bound of p * nnz / parts in row_ptr)
+index_t csr_nnz_partition(const CSRMatrix *A, int parts, int p) {
+    if (p <= 0) return 0;
+    if (p >= parts) return A->num_rows;
+    index_t target = (index_t)((int64_t)A->nnz * p / parts);
+    index_t lo = 0, hi = A->num_rows;
+    while (lo < hi) {
+        index_t mid = lo + (hi - lo) / 2;
+        if (A->row_ptr[mid] < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Parallel SpMV over contiguous row blocks holding equal shares of nnz
+void spmv_nnz_balanced(CSRMatrix *A, double *x, double *y) {
+    /*
+     * Static like spmv_parallel_static, but the block boundaries come from
+     * a binary search in row_ptr instead of row counts, so every thread
+     * streams the same number of non-zeros. Rows stay whole: a single row
+     * longer than nnz / threads still lands on one thread.
+     */
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        index_t begin = csr_nnz_partition(A, nthreads, tid);
+        index_t end = csr_nnz_partition(A, nthreads, tid + 1);
+        
+        uint64_t trace_t0 = trace_begin();
+        for (index_t i = begin; i < end; i++) {
+            double sum = 0.0;
+            for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+                sum += A->values[j] * x[A->col_indices[j]];
+            }
+            y[i] = sum;
+        }
+        trace_end("spmv nnz block", trace_t0, begin);
+    }
+}
+
+// Position on the merge path: rows finished and non-zeros consumed
+typedef struct {
+    index_t row;
+    index_t k;
+} MergeCoord;
+
+/*
+ * Where diagonal d crosses the merge path of the row end offsets
+ * (row_ptr[1..rows]) with the non-zero indices 0..nnz-1: the largest row
+ * count i such that every row before i ends at or before d - i.
+ */
+static MergeCoord merge_path_search(const CSRMatrix *A, int64_t diagonal) {
+    int64_t lo = diagonal - A->nnz, hi = diagonal;
+    if (lo < 0) lo = 0;
+    if (hi > A->num_rows) hi = A->num_rows;
+    while (lo < hi) {
+        int64_t pivot = lo + (hi - lo) / 2;
+        if (A->row_ptr[pivot + 1] <= diagonal - pivot - 1) lo = pivot + 1;
+        else hi = pivot;
+    }
+    MergeCoord coord = {(index_t)lo, (index_t)(diagonal - lo)};
+    return coord;
+}
+
+// Merge-path SpMV: equal shares of (rows + non-zeros) per thread
+void spmv_merge_path(CSRMatrix *A, double *x, double *y) {
+    /*
+     * Finishing a row (writing y) and consuming a non-zero are both one
+     * step along the merge path of row_ptr and the nnz sequence; cutting
+     * the path into equal pieces balances threads no matter how long any
+     * row is. A thread that ends inside a row leaves its partial sum as a
+     * carry; the thread finishing that row writes y, and after a barrier
+     * the carries are added in thread order.
+     */
+    int max_threads = omp_get_max_threads();
+    index_t carry_row[max_threads];
+    double carry_value[max_threads];
+    
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int64_t path_length = (int64_t)A->num_rows + A->nnz;
+        int64_t per_thread = (path_length + nthreads - 1) / nthreads;
+        int64_t d0 = per_thread * tid, d1 = per_thread * (tid + 1);
+        MergeCoord start = merge_path_search(A, (d0 < path_length) ? d0 : path_length);
+        MergeCoord end = merge_path_search(A, (d1 < path_length) ? d1 : path_length);
+        
+        uint64_t trace_t0 = trace_begin();
+        index_t k = start.k;
+        for (index_t i = start.row; i < end.row; i++) {
+            double sum = 0.0;
+            for (; k < A->row_ptr[i + 1]; k++) sum += A->values[k] * x[A->col_indices[k]];
+            y[i] = sum;
+        }
+        double partial = 0.0;
+        for (; k < end.k; k++) partial += A->values[k] * x[A->col_indices[k]];
+        carry_row[tid] = end.row;
+        carry_value[tid] = partial;
+        trace_end("spmv merge path", trace_t0, start.row);
+        
+        #pragma omp barrier
+        #pragma omp single
+        for (int t = 0; t < nthreads; t++) {
+            if (carry_row[t] < A->num_rows) y[carry_row[t]] += carry_value[t];
+        }
+    }
+}
+
+/*
+ * One row of Y = A * X for k right-hand sides. X and Y are row-major
+ * (row c of X holds x_0[c] .. x_{k-1}[c]), so a non-zero A[i][c] scales
+ * one contiguous row of X into the k accumulators of row i: the value and
+ * column index are loaded once for all k products, and the loop over k is
+ * the SIMD dimension. Up to SPMM_MAX_RHS accumulators live on the stack
+ * (registers once k is a compile-time constant); Y is written once.
+ */
+static inline __attribute__((always_inline))
+void spmm_row(const CSRMatrix *A, const double *X, double *Y, index_t i, int k) {
+    double *y = Y + (size_t)i * k;
+    if (k > SPMM_MAX_RHS) {
+        for (int r = 0; r < k; r++) y[r] = 0.0;
+        for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+            double a = A->values[j];
+            const double *x = X + (size_t)A->col_indices[j] * k;
+            #pragma omp simd
+            for (int r = 0; r < k; r++) y[r] += a * x[r];
+        }
+        return;
+    }
+    
+    double acc[SPMM_MAX_RHS];
+    for (int r = 0; r < k; r++) acc[r] = 0.0;
+    for (index_t j = A->row_ptr[i]; j < A->row_ptr[i + 1]; j++) {
+        double a = A->values[j];
+        const double *x = X + (size_t)A->col_indices[j] * k;
+        #pragma omp simd
+        for (int r = 0; r < k; r++) acc[r] += a * x[r];
+    }
+    for (int r = 0; r < k; r++) y[r] = acc[r];
+}
+
+// Rows [begin, end), with k fixed at compile time for the common block widths
+static inline __attribute__((always_inline))
+void spmm_rows(const CSRMatrix *A, const double *X, double *Y, index_t begin, index_t end, int k) {
+    switch (k) {
+    case 8:  for (index_t i = begin; i < end; i++) spmm_row(A, X, Y, i, 8);  break;
+    case 16: for (index_t i = begin; i < end; i++) spmm_row(A, X, Y, i, 16); break;
+    case 32: for (index_t i = begin; i < end; i++) spmm_row(A, X, Y, i, 32); break;
+    case 64: for (index_t i = begin; i < end; i++) spmm_row(A, X, Y, i, 64); break;
+    default: for (index_t i = begin; i < end; i++) spmm_row(A, X, Y, i, k);  break;
+    }
+}
+
+// The same loops compiled for each instruction set (selected at run time)
+#ifdef HAVE_X86_SIMD
+__attribute__((target("avx512f")))
+static void spmm_rows_avx512(const CSRMatrix *A, const double *X, double *Y,
+                             index_t begin, index_t end, int k) {
+    spmm_rows(A, X, Y, begin, end, k);
+}
+
+__attribute__((target("avx2,fma")))
+static void spmm_rows_avx2(const CSRMatrix *A, const double *X, double *Y,
+                           index_t begin, index_t end, int k) {
+    spmm_rows(A, X, Y, begin, end, k);
+}
+#endif
+
+static void spmm_rows_scalar(const CSRMatrix *A, const double *X, double *Y,
+                             index_t begin, index_t end, int k) {
+    spmm_rows(A, X, Y, begin, end, k);
+}
+
+// Y = A * X for k right-hand sides (row-major blocks)
+void spmm_csr(CSRMatrix *A, const double *X, double *Y, int k) {
+    SimdIsa isa = vector_simd_isa();
+    
+    // Same dynamic row chunks as spmv_parallel_dynamic
+    #pragma omp parallel
+    {
+        int chunk_size = spmv_dynamic_chunk_size(A->num_rows, omp_get_num_threads());
+        index_t num_chunks = (A->num_rows + chunk_size - 1) / chunk_size;
+        
+        #pragma omp for schedule(dynamic)
+        for (index_t c = 0; c < num_chunks; c++) {
+            uint64_t trace_t0 = trace_begin();
+            index_t begin = c * chunk_size;
+            index_t end = (begin + chunk_size < A->num_rows) ? begin + chunk_size : A->num_rows;
+            switch (isa) {
+#ifdef HAVE_X86_SIMD
+            case SIMD_ISA_AVX512:
+                spmm_rows_avx512(A, X, Y, begin, end, k);
+                break;
+            case SIMD_ISA_AVX2:
+                spmm_rows_avx2(A, X, Y, begin, end, k);
+                break;
+#endif
+            default:
+                spmm_rows_scalar(A, X, Y, begin, end, k);
+                break;
+            }
+            trace_end("spmm chunk", trace_t0, c);
+        }
+    }
+}
+
+// Adaptive chunk size for dynamic SpMV: aim for ~100 chunks per thread
+int spmv_dynamic_chunk_size(index_t num_rows, int num_threads) {
+    index_t chunk_size = num_rows / (num_threads * 100);
+    if (chunk_size < 10) chunk_size = 10;
+    if (chunk_size > 1000) chunk_size = 1000;
+    return (int)chunk_size;
+}
@@ -0,0 +1,106 @@
+/*
+ * Kernel Library: Sparse Matrix-Vector Multiplication (CSR)
+ * 
+ * Description:
+ *   y = A * x for a matrix in Compressed Sparse Row format. Rows are
+ *   independent, so most parallel kernels partition rows among threads
+ *   (static blocks, dynamic chunks for irregular row lengths, or blocks of
+ *   equal nnz) and no synchronization is needed. The merge-path kernel also
+ *   splits long rows between threads and adds the partial sums afterwards.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef SPMV_H
+#define SPMV_H
+
+#include "index_types.h"
+#include "schedule.h"
+
+// CSR (Compressed Sparse Row) format; index widths follow the build
+// (see index_types.h: row_ptr is index_t, col_indices col_index_t)
+typedef struct {
+    index_t num_rows;
+    index_t num_cols;
+    index_t nnz;              // Number of non-zero elements
+    double *values;           // Non-zero values
+    col_index_t *col_indices; // Column index for each value
+    index_t *row_ptr;         // Row pointer array
+    void *mapping;            // Non-NULL: arrays live in an mmap'd binary CSR file
+    size_t mapping_bytes;
+} CSRMatrix;
+
+// Index arrays of a CSR matrix re-encoded with explicit widths (4 or 8 bytes
+// for row_ptr and for col_indices), sharing the values array. Lets one build
+// measure what wider indices cost in bandwidth on a given matrix.
+typedef struct {
+    const CSRMatrix *source;
+    int row_ptr_bytes;
+    int col_bytes;
+    void *row_ptr;
+    void *col_indices;
+} CSRIndexWidths;
+
+// Construction
+// Parallel O(nnz) generator: every row draws its column gaps from a
+// counter-based RNG keyed by (seed, row), so the matrix is identical for any
+// thread count. Returns NULL if it does not fit this build's index types.
+#define SPARSE_RANDOM_SEED 42
+CSRMatrix* create_random_sparse_matrix(index_t rows, index_t cols, double density);
+
+// Same mean density with power-law row lengths (row weight ~ rank^-skew):
+// the load-balancing stress case of graph-like matrices
+CSRMatrix* create_skewed_sparse_matrix(index_t rows, index_t cols, double density, double skew);
+
+// Empty matrix with row_ptr allocated (counts go in row_ptr[1..rows]);
+// csr_counts_to_offsets turns them into offsets in parallel and returns nnz
+CSRMatrix* csr_alloc_rows(index_t rows, index_t cols);
+index_t csr_counts_to_offsets(index_t *row_ptr, index_t num_rows);
+void csr_sort_rows(CSRMatrix *A);
+void free_csr_matrix(CSRMatrix *matrix);
+void print_csr_format(CSRMatrix *matrix);
+
+// Bytes of values + col_indices + row_ptr (the matrix part of SpMV traffic)
+double csr_matrix_bytes(const CSRMatrix *matrix);
+
+// Returns 0 if the matrix does not fit the requested widths
+int csr_index_widths_create(const CSRMatrix *A, int row_ptr_bytes, int col_bytes,
+                            CSRIndexWidths *widths);
+void csr_index_widths_free(CSRIndexWidths *widths);
+double csr_index_widths_bytes(const CSRIndexWidths *widths);
+
+// Products
+void spmv_sequential(CSRMatrix *A, double *x, double *y);
+void spmv_parallel_static(CSRMatrix *A, double *x, double *y);
+void spmv_parallel_dynamic(CSRMatrix *A, double *x, double *y);
+int spmv_dynamic_chunk_size(index_t num_rows, int num_threads);
+
+// Load balancing by non-zeros instead of rows: static row blocks of equal
+// nnz (csr_nnz_partition gives block boundaries), and merge path, which
+// balances rows + non-zeros exactly and splits rows between threads
+// (split rows are summed in a different order than spmv_sequential)
+index_t csr_nnz_partition(const CSRMatrix *A, int parts, int p);
+void spmv_nnz_balanced(CSRMatrix *A, double *x, double *y);
+void spmv_merge_path(CSRMatrix *A, double *x, double *y);
+
+// SpMM: Y = A * X for k right-hand sides, X (num_cols x k) and Y
+// (num_rows x k) row-major. Every non-zero is loaded once for all k
+// products instead of once per SpMV; the k loop is vectorized (AVX-512 /
+// AVX2 with FMA selected at run time, see vector_simd_isa), so sums may
+// round differently from spmv_sequential.
+#define SPMM_MAX_RHS 64   // Register/stack accumulators up to this k
+void spmm_csr(CSRMatrix *A, const double *X, double *Y, int k);
+
+// Static-scheduled product over re-encoded index arrays
+void spmv_index_widths(const CSRIndexWidths *widths, const double *x, double *y);
+
+// Rows distributed by a run-time selected strategy (see schedule.h);
+// returns the chunk size (rows) used
+long spmv_scheduled(CSRMatrix *A, double *x, double *y, Schedule sched);
+
+// Orphaned static loop run by the calling team (see spmv.c)
+void spmv_team(CSRMatrix *A, double *x, double *y);
+void spmv_persistent(CSRMatrix *A, double *x, double *y, int iterations);
+
+#endif // SPMV_H
@@ -0,0 +1,259 @@
+/*
+ * Kernel Library: Matrix Transpose and Tensor Axis Permutation
+ * 
+ * See transpose.h for the interface.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <omp.h>
+#include "transpose.h"
+#include "trace.h"
+#include "array_utils.h"
+
+// Sequential matrix transpose
+void transpose_sequential(double *A, double *B, index_t N) {
+    for (index_t i = 0; i < N; i++) {
+        for (index_t j = 0; j < N; j++) {
+            B[j * N + i] = A[i * N + j];
+        }
+    }
+}
+
+// Parallel naive transpose (simple parallelization)
+void transpose_parallel_naive(double *A, double *B, index_t N) {
+    #pragma omp parallel
+    {
+        #pragma omp for collapse(2)
+        for (index_t i = 0; i < N; i++) {
+            for (index_t j = 0; j < N; j++) {
+                B[j * N + i] = A[i * N + j];
+            }
+        }
+    }
+}
+
+// Parallel blocked transpose (cache-efficient)
+void transpose_parallel_blocked(double *A, double *B, index_t N, int block_size) {
+    /*
+     * CORRECT IMPLEMENTATION: No synchronization needed
+     * 
+     * Key insight: Each output element B[j][i] is written exactly once
+     * by the thread that processes block (bi, bj) containing that element.
+     * 
+     * No race conditions because:
+     * - Block (bi, bj) owns output elements B[bj:bj+block][bi:bi+block]
+     * - Different blocks write to disjoint memory regions
+     * - NO shared writes = NO atomic/critical sections needed
+     */
+    #pragma omp parallel
+    {
+        // Parallelize over blocks - each block is independent
+        // Dynamic scheduling handles edge blocks and load imbalances better
+        #pragma omp for collapse(2) schedule(dynamic)
+        for (index_t bi = 0; bi < N; bi += block_size) {
+            for (index_t bj = 0; bj < N; bj += block_size) {
+                uint64_t trace_t0 = trace_begin();
+                
+                // Compute block boundaries
+                index_t i_end = (bi + block_size < N) ? bi + block_size : N;
+                index_t j_end = (bj + block_size < N) ? bj + block_size : N;
+                
+                // Transpose this block
+                // Each B[j*N+i] is written exactly once - no conflicts
+                for (index_t i = bi; i < i_end; i++) {
+                    for (index_t j = bj; j < j_end; j++) {
+                        B[j * N + i] = A[i * N + j];
+                    }
+                }
+                trace_end("transpose block", trace_t0, (long)bi * N + bj);
+            }
+        }
+    }
+}
+
+// Verify transpose: B[j][i] should equal A[i][j], checked like verify_results
+// (element k is A[k / N][k % N], VERIFY_SAMPLE applies) on pairs gathered in chunks
+int verify_transpose(double *A, double *B, index_t N) {
+    double tolerance = 1e-9;
+    long count = (long)N * N;
+    long checked = verify_sample_count(count);
+    VerifyStats stats = {0};
+    stats.count = count;
+    
+    #pragma omp parallel
+    {
+        VerifyStats part = {0};
+        double gathered[2][VERIFY_CHUNK];
+        #pragma omp for schedule(static)
+        for (long start = 0; start < checked; start += VERIFY_CHUNK) {
+            long n = (checked - start < VERIFY_CHUNK) ? checked - start : VERIFY_CHUNK;
+            for (long k = 0; k < n; k++) {
+                long e = verify_sample_index(start + k, checked, count);
+                index_t i = e / N, j = e % N;
+                gathered[0][k] = A[i * N + j];
+                gathered[1][k] = B[j * N + i];
+            }
+            verify_accumulate(gathered[0], gathered[1], n, tolerance, &part);
+        }
+        #pragma omp critical(verify_merge)
+        verify_merge(&stats, &part);
+    }
+    
+    long printed = 0;
+    for (long k = 0; k < checked && printed < 5 && stats.errors > 0; k++) {
+        long e = verify_sample_index(k, checked, count);
+        index_t i = e / N, j = e % N;
+        if (verify_mismatch(A[i * N + j], B[j * N + i], tolerance)) {
+            printf("    Error at (%ld,%ld): A[%ld][%ld]=%.2f, B[%ld][%ld]=%.2f\n",
+                   (long)i, (long)j, (long)i, (long)j, A[i * N + j],
+                   (long)j, (long)i, B[j * N + i]);
+            printed++;
+        }
+    }
+    verify_report(&stats);
+    return (stats.errors == 0);
+}
+
+// Batched transpose: A is a stack of `batch` (rows x cols) matrices,
+// B receives the stack of their (cols x rows) transposes
+void transpose_batched(double *A, double *B, index_t batch, index_t rows, index_t cols,
+                       int block_size) {
+    /*
+     * Same tiling as transpose_parallel_blocked, with the batch index as
+     * an extra (outer) parallel dimension. Every (matrix, block) pair owns
+     * a disjoint tile of B, so no synchronization is needed.
+     */
+    long matrix_elems = (long)rows * cols;
+    
+    #pragma omp parallel for collapse(3) schedule(dynamic)
+    for (index_t b = 0; b < batch; b++) {
+        for (index_t bi = 0; bi < rows; bi += block_size) {
+            for (index_t bj = 0; bj < cols; bj += block_size) {
+                double *src = A + b * matrix_elems;
+                double *dst = B + b * matrix_elems;
+                index_t i_end = (bi + block_size < rows) ? bi + block_size : rows;
+                index_t j_end = (bj + block_size < cols) ? bj + block_size : cols;
+                
+                for (index_t i = bi; i < i_end; i++) {
+                    for (index_t j = bj; j < j_end; j++) {
+                        dst[(long)j * rows + i] = src[(long)i * cols + j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Expand a (dims, perm) pair of rank <= 4 to rank 4 by prepending unit axes
+static void pad_to_4d(const int *dims, const int *perm, int ndim, long *d, int *p) {
+    int pad = MAX_TENSOR_DIMS - ndim;
+    for (int k = 0; k < pad; k++) {
+        d[k] = 1;
+        p[k] = k;
+    }
+    for (int k = 0; k < ndim; k++) {
+        d[pad + k] = dims[k];
+        p[pad + k] = pad + perm[k];
+    }
+}
+
+// Compute row-major strides of the input and, for every input axis, its
+// stride in the permuted output (output axis k is input axis perm[k])
+static void permute_strides(const long *d, const int *p, long *in_stride, long *out_stride) {
+    long out_pos_stride[MAX_TENSOR_DIMS];
+    
+    in_stride[MAX_TENSOR_DIMS - 1] = 1;
+    out_pos_stride[MAX_TENSOR_DIMS - 1] = 1;
+    for (int k = MAX_TENSOR_DIMS - 2; k >= 0; k--) {
+        in_stride[k] = in_stride[k + 1] * d[k + 1];
+        out_pos_stride[k] = out_pos_stride[k + 1] * d[p[k + 1]];
+    }
+    for (int k = 0; k < MAX_TENSOR_DIMS; k++) {
+        out_stride[p[k]] = out_pos_stride[k];
+    }
+}
+
+// Sequential reference: B[permuted index] = A[index], element by element
+void permute_sequential(double *A, double *B, const int *dims, const int *perm, int ndim) {
+    long d[MAX_TENSOR_DIMS], in_stride[MAX_TENSOR_DIMS], out_stride[MAX_TENSOR_DIMS];
+    int p[MAX_TENSOR_DIMS];
+    
+    pad_to_4d(dims, perm, ndim, d, p);
+    permute_strides(d, p, in_stride, out_stride);
+    
+    for (long i0 = 0; i0 < d[0]; i0++) {
+        for (long i1 = 0; i1 < d[1]; i1++) {
+            for (long i2 = 0; i2 < d[2]; i2++) {
+                for (long i3 = 0; i3 < d[3]; i3++) {
+                    B[i0 * out_stride[0] + i1 * out_stride[1] +
+                      i2 * out_stride[2] + i3 * out_stride[3]] =
+                        A[i0 * in_stride[0] + i1 * in_stride[1] +
+                          i2 * in_stride[2] + i3];
+                }
+            }
+        }
+    }
+}
+
+// Parallel axis permutation for 3D/4D tensors (cache-blocked)
+void permute_parallel_blocked(double *A, double *B, const int *dims, const int *perm,
+                              int ndim, int block_size) {
+    /*
+     * The two axes that matter for locality are:
+     *   - b: the fastest-varying INPUT axis (contiguous reads)
+     *   - a: the input axis that becomes the fastest-varying OUTPUT axis
+     *        (contiguous writes)
+     * The (a, b) plane is tiled exactly like transpose_parallel_blocked,
+     * and the two remaining (batch / outer) axes are parallelized together
+     * with the tiles. If the innermost axis is not permuted (a == b), the
+     * second-fastest output axis is tiled instead and rows copy straight.
+     *
+     * Each (outer index, tile) owns a disjoint region of B - no races.
+     */
+    long d[MAX_TENSOR_DIMS], in_stride[MAX_TENSOR_DIMS], out_stride[MAX_TENSOR_DIMS];
+    int p[MAX_TENSOR_DIMS];
+    
+    pad_to_4d(dims, perm, ndim, d, p);
+    permute_strides(d, p, in_stride, out_stride);
+    
+    int b = MAX_TENSOR_DIMS - 1;
+    int a = (p[MAX_TENSOR_DIMS - 1] != b) ? p[MAX_TENSOR_DIMS - 1] : p[MAX_TENSOR_DIMS - 2];
+    
+    // Remaining two axes form the outer (batch) iteration space
+    int outer[2], n_outer = 0;
+    for (int k = 0; k < MAX_TENSOR_DIMS; k++) {
+        if (k != a && k != b) outer[n_outer++] = k;
+    }
+    
+    int dim_u = (int)d[outer[0]], dim_v = (int)d[outer[1]];
+    int dim_a = (int)d[a], dim_b = (int)d[b];
+    long is_u = in_stride[outer[0]], is_v = in_stride[outer[1]], is_a = in_stride[a];
+    long os_u = out_stride[outer[0]], os_v = out_stride[outer[1]];
+    long os_a = out_stride[a], os_b = out_stride[b];
+    
+    #pragma omp parallel for collapse(4) schedule(dynamic)
+    for (int u = 0; u < dim_u; u++) {
+        for (int v = 0; v < dim_v; v++) {
+            for (int bi = 0; bi < dim_a; bi += block_size) {
+                for (int bj = 0; bj < dim_b; bj += block_size) {
+                    uint64_t trace_t0 = trace_begin();
+                    double *src = A + u * is_u + v * is_v;
+                    double *dst = B + u * os_u + v * os_v;
+                    int i_end = (bi + block_size < dim_a) ? bi + block_size : dim_a;
+                    int j_end = (bj + block_size < dim_b) ? bj + block_size : dim_b;
+                    
+                    for (int i = bi; i < i_end; i++) {
+                        for (int j = bj; j < j_end; j++) {
+                            dst[i * os_a + j * os_b] = src[i * is_a + j];
+                        }
+                    }
+                    trace_end("permute tile", trace_t0, ((long)u * dim_v + v) * dim_a + bi);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * Kernel Library: Matrix Transpose and Tensor Axis Permutation
+ * 
+ * Description:
+ *   Square N x N transpose (sequential, naive parallel, cache-blocked),
+ *   a batched transpose over a stack of matrices, and a general axis
+ *   permutation for tensors of rank <= MAX_TENSOR_DIMS (e.g. NCHW <-> NHWC).
+ *   Every parallel kernel partitions disjoint output tiles - no races.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef TRANSPOSE_H
+#define TRANSPOSE_H
+
+#include "index_types.h"
+
+#define MAX_TENSOR_DIMS 4
+
+void transpose_sequential(double *A, double *B, index_t N);
+void transpose_parallel_naive(double *A, double *B, index_t N);
+void transpose_parallel_blocked(double *A, double *B, index_t N, int block_size);
+int verify_transpose(double *A, double *B, index_t N);
+
+// A is a stack of `batch` (rows x cols) matrices, B their (cols x rows) transposes
+void transpose_batched(double *A, double *B, index_t batch, index_t rows, index_t cols,
+                       int block_size);
+
+// Output axis k is input axis perm[k]; ndim <= MAX_TENSOR_DIMS
+void permute_sequential(double *A, double *B, const int *dims, const int *perm, int ndim);
+void permute_parallel_blocked(double *A, double *B, const int *dims, const int *perm,
+                              int ndim, int block_size);
+
+#endif // TRANSPOSE_H
@@ -0,0 +1,389 @@
+/*
+ * Kernel Library: Element-Wise Vector Operations
+ * 
+ * See vector_ops.h for the interface.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "vector_ops.h"
+#include "numa_alloc.h"
+#include "trace.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+// Fused chains are evaluated strip by strip: every op of the chain runs over
+// one strip while it is still in L1, so each array crosses memory only once
+#define FUSION_STRIP 1024       // 8 KB of doubles per operand
+
+// Sequential vector addition
+void vector_add_sequential(double *A, double *B, double *C, index_t size) {
+    for (index_t i = 0; i < size; i++) {
+        C[i] = A[i] + B[i];
+    }
+}
+
+// Parallel vector addition with static scheduling
+void vector_add_parallel_static(double *A, double *B, double *C, index_t size) {
+    #pragma omp parallel
+    {
+        vector_add_team(A, B, C, size);
+    }
+}
+
+// Static vector addition executed by the CALLING team
+void vector_add_team(double *A, double *B, double *C, index_t size) {
+    /*
+     * Orphaned worksharing loop: when called inside a parallel region the
+     * iterations are split across the enclosing team, when called outside
+     * one it simply runs sequentially. The implicit barrier at the end of
+     * the loop is all that separates two consecutive invocations.
+     */
+    #pragma omp for schedule(static)
+    for (index_t i = 0; i < size; i++) {
+        C[i] = A[i] + B[i];
+    }
+}
+
+// Repeated invocations, each one opening its own parallel region
+void vector_add_fork_join(double *A, double *B, double *C, index_t size, int iterations) {
+    for (int it = 0; it < iterations; it++) {
+        #pragma omp parallel
+        vector_add_team(A, B, C, size);
+    }
+}
+
+// Repeated invocations inside ONE persistent parallel region
+void vector_add_persistent(double *A, double *B, double *C, index_t size, int iterations) {
+    /*
+     * The team is forked once; every iteration only pays for the barrier
+     * at the end of the worksharing loop. No I/O in the hot region.
+     */
+    #pragma omp parallel
+    {
+        for (int it = 0; it < iterations; it++) {
+            vector_add_team(A, B, C, size);
+        }
+    }
+}
+
+// Parallel vector addition with dynamic scheduling
+void vector_add_parallel_dynamic(double *A, double *B, double *C, index_t size) {
+    #pragma omp parallel
+    {
+        // One iteration per 10000-element chunk == schedule(dynamic, 10000),
+        // with the chunk boundaries visible for tracing
+        #pragma omp for schedule(dynamic)
+        for (index_t start = 0; start < size; start += 10000) {
+            uint64_t trace_t0 = trace_begin();
+            index_t end = (start + 10000 < size) ? start + 10000 : size;
+            for (index_t i = start; i < end; i++) {
+                C[i] = A[i] + B[i];
+            }
+            trace_end("vector_add chunk", trace_t0, start);
+        }
+    }
+}
+
+typedef struct {
+    const double *A;
+    const double *B;
+    double *C;
+} VectorAddArgs;
+
+static void vector_add_range(long begin, long end, void *arg) {
+    VectorAddArgs *v = (VectorAddArgs *)arg;
+    for (long i = begin; i < end; i++) {
+        v->C[i] = v->A[i] + v->B[i];
+    }
+}
+
+// Vector addition with a run-time selected scheduling strategy
+long vector_add_scheduled(double *A, double *B, double *C, index_t size, Schedule sched) {
+    VectorAddArgs args = {A, B, C};
+    return schedule_for(size, sched, vector_add_range, &args);
+}
+
+// Widest instruction set usable on this CPU; VECTOR_ISA=scalar|avx2|avx512
+// narrows the choice (e.g. to compare paths on the same machine)
+SimdIsa vector_simd_isa(void) {
+    SimdIsa best = SIMD_ISA_SCALAR;
+#ifdef HAVE_X86_SIMD
+    if (__builtin_cpu_supports("avx512f")) best = SIMD_ISA_AVX512;
+    else if (__builtin_cpu_supports("avx2")) best = SIMD_ISA_AVX2;
+#endif
+    const char *env = getenv("VECTOR_ISA");
+    if (env) {
+        SimdIsa requested = best;
+        if (strcmp(env, "scalar") == 0) requested = SIMD_ISA_SCALAR;
+        else if (strcmp(env, "avx2") == 0) requested = SIMD_ISA_AVX2;
+        else if (strcmp(env, "avx512") == 0) requested = SIMD_ISA_AVX512;
+        if (requested < best) best = requested;
+    }
+    return best;
+}
+
+const char *simd_isa_name(SimdIsa isa) {
+    switch (isa) {
+    case SIMD_ISA_AVX512: return "avx512";
+    case SIMD_ISA_AVX2:   return "avx2";
+    default:              return "scalar";
+    }
+}
+
+// Non-temporal stores only pay off once A, B and C no longer fit in the
+// last-level cache - below that, C would be re-read from cache by the next
+// kernel and bypassing it only costs a trip to DRAM
+int vector_add_streaming_default(long size) {
+    size_t llc = last_level_cache_bytes();
+    if (llc == 0) llc = 32UL << 20;  // Unknown: assume a 32 MB LLC
+    return 3.0 * size * sizeof(double) > (double)llc;
+}
+
+static void add_range_scalar(const double *A, const double *B, double *C, long start, long end) {
+    #pragma omp simd
+    for (long i = start; i < end; i++) {
+        C[i] = A[i] + B[i];
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+/*
+ * Both SIMD bodies process one 64-byte cache line of C per iteration and
+ * prefetch the matching lines of A and B `pf` elements ahead (prefetches
+ * past the end of an array are harmless hints). Non-temporal stores need
+ * an aligned destination, so a scalar prologue peels elements until C is
+ * 64-byte aligned; numa_aware_alloc returns 64-byte aligned arrays, which
+ * makes the prologue empty for every thread's cache-line-aligned range.
+ */
+__attribute__((target("avx512f")))
+static void add_range_avx512(const double *A, const double *B, double *C,
+                             long start, long end, int streaming, int pf) {
+    long i = start;
+    while (i < end && ((uintptr_t)(C + i) & 63)) {
+        C[i] = A[i] + B[i];
+        i++;
+    }
+    if (streaming) {
+        for (; i + 8 <= end; i += 8) {
+            if (pf) {
+                _mm_prefetch((const char *)(A + i + pf), _MM_HINT_T0);
+                _mm_prefetch((const char *)(B + i + pf), _MM_HINT_T0);
+            }
+            __m512d sum = _mm512_add_pd(_mm512_loadu_pd(A + i), _mm512_loadu_pd(B + i));
+            _mm512_stream_pd(C + i, sum);
+        }
+        _mm_sfence();  // Order the streaming stores before any later access
+    } else {
+        for (; i + 8 <= end; i += 8) {
+            if (pf) {
+                _mm_prefetch((const char *)(A + i + pf), _MM_HINT_T0);
+                _mm_prefetch((const char *)(B + i + pf), _MM_HINT_T0);
+            }
+            __m512d sum = _mm512_add_pd(_mm512_loadu_pd(A + i), _mm512_loadu_pd(B + i));
+            _mm512_store_pd(C + i, sum);
+        }
+    }
+    for (; i < end; i++) C[i] = A[i] + B[i];
+}
+
+__attribute__((target("avx2")))
+static void add_range_avx2(const double *A, const double *B, double *C,
+                           long start, long end, int streaming, int pf) {
+    long i = start;
+    while (i < end && ((uintptr_t)(C + i) & 63)) {
+        C[i] = A[i] + B[i];
+        i++;
+    }
+    if (streaming) {
+        for (; i + 8 <= end; i += 8) {
+            if (pf) {
+                _mm_prefetch((const char *)(A + i + pf), _MM_HINT_T0);
+                _mm_prefetch((const char *)(B + i + pf), _MM_HINT_T0);
+            }
+            __m256d lo = _mm256_add_pd(_mm256_loadu_pd(A + i), _mm256_loadu_pd(B + i));
+            __m256d hi = _mm256_add_pd(_mm256_loadu_pd(A + i + 4), _mm256_loadu_pd(B + i + 4));
+            _mm256_stream_pd(C + i, lo);
+            _mm256_stream_pd(C + i + 4, hi);
+        }
+        _mm_sfence();
+    } else {
+        for (; i + 8 <= end; i += 8) {
+            if (pf) {
+                _mm_prefetch((const char *)(A + i + pf), _MM_HINT_T0);
+                _mm_prefetch((const char *)(B + i + pf), _MM_HINT_T0);
+            }
+            __m256d lo = _mm256_add_pd(_mm256_loadu_pd(A + i), _mm256_loadu_pd(B + i));
+            __m256d hi = _mm256_add_pd(_mm256_loadu_pd(A + i + 4), _mm256_loadu_pd(B + i + 4));
+            _mm256_store_pd(C + i, lo);
+            _mm256_store_pd(C + i + 4, hi);
+        }
+    }
+    for (; i < end; i++) C[i] = A[i] + B[i];
+}
+#endif
+
+// Explicit SIMD vector addition with a cache-line-granular static partition
+void vector_add_simd(double *A, double *B, double *C, index_t size, int streaming,
+                     int prefetch_distance) {
+    SimdIsa isa = vector_simd_isa();
+    
+    #pragma omp parallel
+    {
+        /*
+         * Same ownership as schedule(static), but split on 8-element (64 B)
+         * boundaries: no two threads ever write the same cache line of C,
+         * and every range starts aligned for the streaming stores.
+         */
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long lines = ((long)size + 7) / 8;
+        long per_thread = lines / nthreads, extra = lines % nthreads;
+        long first = tid * per_thread + (tid < extra ? tid : extra);
+        long start = first * 8;
+        long end = (first + per_thread + (tid < extra)) * 8;
+        if (end > size) end = size;
+        if (start > end) start = end;
+        
+        uint64_t trace_t0 = trace_begin();
+        switch (isa) {
+#ifdef HAVE_X86_SIMD
+        case SIMD_ISA_AVX512:
+            add_range_avx512(A, B, C, start, end, streaming, prefetch_distance);
+            break;
+        case SIMD_ISA_AVX2:
+            add_range_avx2(A, B, C, start, end, streaming, prefetch_distance);
+            break;
+#endif
+        default:
+            add_range_scalar(A, B, C, start, end);
+            break;
+        }
+        trace_end("vector_add simd", trace_t0, start);
+    }
+}
+
+// Apply a single operation to elements [start, end)
+static void apply_vector_op(const VectorOp *op, index_t start, index_t end) {
+    double *dst = op->dst;
+    const double *x = op->x;
+    const double *y = op->y;
+    double alpha = op->alpha;
+    double beta = op->beta;
+    
+    switch (op->type) {
+    case VOP_SCALE:
+        for (index_t i = start; i < end; i++) dst[i] = alpha * x[i];
+        break;
+    case VOP_ADD:
+        for (index_t i = start; i < end; i++) dst[i] = x[i] + y[i];
+        break;
+    case VOP_AXPY:
+        for (index_t i = start; i < end; i++) dst[i] = alpha * x[i] + y[i];
+        break;
+    case VOP_TRIAD:
+        for (index_t i = start; i < end; i++) dst[i] = x[i] + alpha * y[i];
+        break;
+    case VOP_SCALE_ADD:
+        for (index_t i = start; i < end; i++) dst[i] = alpha * x[i] + beta;
+        break;
+    case VOP_MUL_ADD:
+        for (index_t i = start; i < end; i++) dst[i] = x[i] * y[i] + beta;
+        break;
+    }
+}
+
+// Does this operation read its y operand?
+static int vector_op_reads_y(VectorOpType type) {
+    return type != VOP_SCALE && type != VOP_SCALE_ADD;
+}
+
+// Baseline: one parallel pass over memory per operation
+void vector_chain_unfused(const VectorOp *ops, int num_ops, index_t size) {
+    for (int k = 0; k < num_ops; k++) {
+        #pragma omp parallel for schedule(static)
+        for (index_t s = 0; s < size; s += FUSION_STRIP) {
+            index_t end = (s + FUSION_STRIP < size) ? s + FUSION_STRIP : size;
+            apply_vector_op(&ops[k], s, end);
+        }
+    }
+}
+
+// Fused: the whole chain in ONE parallel pass over memory
+void vector_chain_fused(const VectorOp *ops, int num_ops, index_t size) {
+    /*
+     * Every op is element-wise (dst[i] depends only on operands at index i),
+     * so running the chain strip by strip gives the same result as running
+     * it op by op. Intermediates written by op k and read by op k+1 stay in
+     * L1 instead of making a round trip to DRAM.
+     *
+     * Strips are statically partitioned - each thread owns its strips of
+     * every dst array, so no synchronization is needed.
+     */
+    #pragma omp parallel for schedule(static)
+    for (index_t s = 0; s < size; s += FUSION_STRIP) {
+        index_t end = (s + FUSION_STRIP < size) ? s + FUSION_STRIP : size;
+        for (int k = 0; k < num_ops; k++) {
+            apply_vector_op(&ops[k], s, end);
+        }
+    }
+}
+
+// Compulsory DRAM traffic of a chain (write-allocate not counted)
+double vector_chain_bytes(const VectorOp *ops, int num_ops, index_t size, int fused) {
+    if (!fused) {
+        long accesses = 0;
+        for (int k = 0; k < num_ops; k++) {
+            int reads_y = vector_op_reads_y(ops[k].type) && ops[k].y != ops[k].x;
+            accesses += 1 + reads_y + 1;  // x, (y), dst
+        }
+        return (double)accesses * size * sizeof(double);
+    }
+    
+    // Fused: each distinct array is loaded once if it is read before being
+    // produced inside the chain, and stored once if the chain writes it
+    double *seen[3 * MAX_CHAIN_OPS];
+    int loaded[3 * MAX_CHAIN_OPS], stored[3 * MAX_CHAIN_OPS];
+    int num_seen = 0;
+    
+    for (int k = 0; k < num_ops; k++) {
+        double *operands[3] = {ops[k].x, vector_op_reads_y(ops[k].type) ? ops[k].y : NULL,
+                               ops[k].dst};
+        for (int o = 0; o < 3; o++) {
+            if (!operands[o]) continue;
+            int idx = 0;
+            while (idx < num_seen && seen[idx] != operands[o]) idx++;
+            if (idx == num_seen) {
+                seen[num_seen] = operands[o];
+                loaded[num_seen] = (o < 2);  // First touched by a read
+                stored[num_seen] = 0;
+                num_seen++;
+            }
+            if (o == 2) stored[idx] = 1;
+        }
+    }
+    
+    long arrays = 0;
+    for (int idx = 0; idx < num_seen; idx++) {
+        arrays += loaded[idx] + stored[idx];
+    }
+    return (double)arrays * size * sizeof(double);
+}
+
+// Floating-point operations performed by a chain
+double vector_chain_flops(const VectorOp *ops, int num_ops, index_t size) {
+    long per_element = 0;
+    for (int k = 0; k < num_ops; k++) {
+        per_element += (ops[k].type == VOP_SCALE || ops[k].type == VOP_ADD) ? 1 : 2;
+    }
+    return (double)per_element * size;
+}
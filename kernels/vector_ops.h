@@ -0,0 +1,80 @@
+/*
+ * Kernel Library: Element-Wise Vector Operations
+ * 
+ * Description:
+ *   C = A + B with static, dynamic, fork/join and persistent-team
+ *   parallelization, plus chains of element-wise operations (AXPY, triad,
+ *   scale-add, multiply-add) that can be evaluated one pass per op or
+ *   fused into a single strip-mined pass over memory.
+ * 
+ *   vector_add_simd is an explicit AVX2/AVX-512 path (selected at run time)
+ *   with optional non-temporal stores for C and software prefetching.
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#ifndef VECTOR_OPS_H
+#define VECTOR_OPS_H
+
+#include "index_types.h"
+#include "schedule.h"
+
+#define MAX_CHAIN_OPS 8
+
+// Software prefetch distance of the SIMD path, in elements ahead (2 KB)
+#define VECTOR_PREFETCH_DEFAULT 256
+
+typedef enum {
+    SIMD_ISA_SCALAR,
+    SIMD_ISA_AVX2,
+    SIMD_ISA_AVX512
+} SimdIsa;
+
+// Element-wise operations that can be chained and fused
+typedef enum {
+    VOP_SCALE,       // dst = alpha * x
+    VOP_ADD,         // dst = x + y
+    VOP_AXPY,        // dst = alpha * x + y
+    VOP_TRIAD,       // dst = x + alpha * y   (STREAM triad)
+    VOP_SCALE_ADD,   // dst = alpha * x + beta
+    VOP_MUL_ADD      // dst = x * y + beta    (FMA chain link)
+} VectorOpType;
+
+typedef struct {
+    VectorOpType type;
+    double *dst;
+    double *x;
+    double *y;       // Unused by VOP_SCALE and VOP_SCALE_ADD
+    double alpha;
+    double beta;
+} VectorOp;
+
+// Vector addition
+void vector_add_sequential(double *A, double *B, double *C, index_t size);
+void vector_add_parallel_static(double *A, double *B, double *C, index_t size);
+void vector_add_parallel_dynamic(double *A, double *B, double *C, index_t size);
+
+// Distribution chosen at run time (see schedule.h); returns the chunk size used
+long vector_add_scheduled(double *A, double *B, double *C, index_t size, Schedule sched);
+
+// Orphaned static loop run by the calling team (see vector_ops.c)
+void vector_add_team(double *A, double *B, double *C, index_t size);
+void vector_add_fork_join(double *A, double *B, double *C, index_t size, int iterations);
+void vector_add_persistent(double *A, double *B, double *C, index_t size, int iterations);
+
+// Explicit SIMD path. streaming=1 writes C with non-temporal stores (no
+// write-allocate); prefetch_distance=0 disables software prefetch.
+SimdIsa vector_simd_isa(void);
+const char *simd_isa_name(SimdIsa isa);
+int vector_add_streaming_default(long size);
+void vector_add_simd(double *A, double *B, double *C, index_t size, int streaming,
+                     int prefetch_distance);
+
+// Operation chains (at most MAX_CHAIN_OPS ops)
+void vector_chain_unfused(const VectorOp *ops, int num_ops, index_t size);
+void vector_chain_fused(const VectorOp *ops, int num_ops, index_t size);
+double vector_chain_bytes(const VectorOp *ops, int num_ops, index_t size, int fused);
+double vector_chain_flops(const VectorOp *ops, int num_ops, index_t size);
+
+#endif // VECTOR_OPS_H
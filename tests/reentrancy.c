@@ -0,0 +1,138 @@
+/*
+ * Test: Kernels Called from Several Threads at Once
+ * 
+ * Description:
+ *   Starts TEST_CALLERS pthreads that each run csr_transpose, spmv_transpose
+ *   and spgemm on the same matrix, in their own OpenMP teams, and compares
+ *   every result with one computed up front. The kernels take their
+ *   scratch through scratch_alloc, so this fails if two callers can share
+ *   scratch memory. Each caller then allocates, fills, checks and frees
+ *   scratch buffers in a tight loop, which hits a shared arena's
+ *   bookkeeping races even on one core.
+ * 
+ * Compilation: make test-reentrancy  (links libdatapatterns)
+ * Usage: ./reentrancy.exe [num_rows] [rounds]
+ * 
+ * Author: High Performance Computing Course
+ * Date: November 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <omp.h>
+#include "data_patterns.h"
+
+#define TEST_CALLERS 2
+#define TEST_TEAM 2            // OpenMP threads per caller
+#define TEST_TOLERANCE 1e-12
+#define TEST_SCRATCH_ROUNDS 1000000
+
+typedef struct {
+    int id;
+    const CSRMatrix *A;
+    const CSRMatrix *transpose;   // References
+    const CSRMatrix *product;
+    const double *x;
+    const double *y_transpose;
+    int rounds;
+    int failures;
+} Caller;
+
+static int vectors_match(const double *a, const double *b, index_t n) {
+    for (index_t i = 0; i < n; i++) {
+        if (fabs(a[i] - b[i]) > TEST_TOLERANCE * (1.0 + fabs(b[i]))) return 0;
+    }
+    return 1;
+}
+
+// Nested scratch buffers stamped with the caller's id; 0 if one was overwritten
+static int scratch_survives(long id) {
+    for (long round = 0; round < TEST_SCRATCH_ROUNDS; round++) {
+        size_t count = 8 + (size_t)(round % 61);
+        long *outer = scratch_alloc(count, sizeof(long));
+        long *inner = scratch_alloc(count, sizeof(long));
+        if (!outer || !inner) return 0;
+        for (size_t k = 0; k < count; k++) outer[k] = inner[k] = id;
+        int intact = 1;
+        for (size_t k = 0; k < count; k++) intact &= (outer[k] == id) & (inner[k] == id);
+        scratch_free(inner);
+        scratch_free(outer);
+        if (!intact) return 0;
+    }
+    return 1;
+}
+
+static void *run_caller(void *arg) {
+    Caller *caller = (Caller *)arg;
+    const CSRMatrix *A = caller->A;
+    double *y = malloc_array(A->num_cols, sizeof(double));
+    omp_set_num_threads(TEST_TEAM);
+    
+    for (int round = 0; round < caller->rounds && y; round++) {
+        CSRMatrix *T = csr_transpose(A);
+        if (!T || !csr_matrices_match(T, caller->transpose, TEST_TOLERANCE)) caller->failures++;
+        free_csr_matrix(T);
+        
+        spmv_transpose(A, caller->x, y);
+        if (!vectors_match(y, caller->y_transpose, A->num_cols)) caller->failures++;
+        
+        CSRMatrix *C = spgemm(A, A, SPGEMM_AUTO, NULL);
+        if (!C || !csr_matrices_match(C, caller->product, TEST_TOLERANCE)) caller->failures++;
+        free_csr_matrix(C);
+    }
+    if (!y || !scratch_survives(caller->id + 1)) caller->failures++;
+    free(y);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    index_t n = (argc > 1) ? (index_t)atol(argv[1]) : 4000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 20;
+    
+    CSRMatrix *A = create_skewed_sparse_matrix(n, n, 0.002, 1.2);
+    double *x = malloc_array(n, sizeof(double));
+    double *y_transpose = malloc_array(n, sizeof(double));
+    if (!A || !x || !y_transpose) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 1;
+    }
+    rng_fill_uniform(x, n, -1.0, 1.0, 1);
+    
+    // References from this thread alone
+    CSRMatrix *transpose = csr_transpose(A);
+    CSRMatrix *product = spgemm_sequential(A, A);
+    spmv_transpose(A, x, y_transpose);
+    if (!transpose || !product) {
+        fprintf(stderr, "Reference computation failed!\n");
+        return 1;
+    }
+    
+    Caller callers[TEST_CALLERS];
+    pthread_t threads[TEST_CALLERS];
+    for (int c = 0; c < TEST_CALLERS; c++) {
+        callers[c] = (Caller){c, A, transpose, product, x, y_transpose, rounds, 0};
+        if (pthread_create(&threads[c], NULL, run_caller, &callers[c]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            return 1;
+        }
+    }
+    
+    int failures = 0;
+    for (int c = 0; c < TEST_CALLERS; c++) {
+        pthread_join(threads[c], NULL);
+        failures += callers[c].failures;
+    }
+    
+    printf("Reentrancy: %d callers x %d rounds (transpose, spmv_transpose, spgemm) "
+           "on %ld x %ld, nnz %ld: %s\n", TEST_CALLERS, rounds, (long)n, (long)n,
+           (long)A->nnz, failures ? "FAILED" : "PASSED");
+    
+    free_csr_matrix(transpose);
+    free_csr_matrix(product);
+    free_csr_matrix(A);
+    free(x);
+    free(y_transpose);
+    return failures ? 1 : 0;
+}